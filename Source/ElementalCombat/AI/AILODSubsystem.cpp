@@ -0,0 +1,305 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "AILODSubsystem.h"
+#include "ElementalCombatAIController.h"
+#include "ElementalCombatEnemy.h"
+#include "PlayerSnapshotSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarAILODEnabled(
+	TEXT("ElementalCombat.AI.LOD.Enabled"),
+	true,
+	TEXT("是否按距离、可见性和战斗状态对AI分级（关闭时所有AI按Engaged层级运行）"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<bool> CVarAILODShowDebug(
+	TEXT("ElementalCombat.AI.LOD.ShowDebug"),
+	false,
+	TEXT("在屏幕上显示AI各层级的人数"),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorld CmdAILODDump(
+	TEXT("ElementalCombat.AI.LOD.Dump"),
+	TEXT("输出AI各层级的人数"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UAILODSubsystem* LODSubsystem = UAILODSubsystem::Get(World))
+		{
+			UE_LOG(LogTemp, Log, TEXT("%s"), *LODSubsystem->GetDebugString());
+		}
+	}));
+
+UAILODSubsystem* UAILODSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (!WorldContextObject)
+	{
+		return nullptr;
+	}
+
+	const UWorld* World = WorldContextObject->GetWorld();
+	return World ? World->GetSubsystem<UAILODSubsystem>() : nullptr;
+}
+
+void UAILODSubsystem::Deinitialize()
+{
+	Agents.Empty();
+	StaleAgents.Empty();
+	FMemory::Memzero(Populations);
+
+	Super::Deinitialize();
+}
+
+TStatId UAILODSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAILODSubsystem, STATGROUP_Tickables);
+}
+
+void UAILODSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	Clock += DeltaTime;
+
+	// 开关切换时立即重新计算
+	TimeUntilEvaluation -= DeltaTime;
+	if (TimeUntilEvaluation <= 0.0f || IsLODEnabled() != bWasLODEnabled)
+	{
+		TimeUntilEvaluation = EvaluationInterval;
+		UpdateLevels();
+	}
+
+	if (CVarAILODShowDebug.GetValueOnGameThread())
+	{
+		DrawDebug();
+	}
+}
+
+// === AI注册 ===
+
+FAILODAgentHandle UAILODSubsystem::RegisterAgent(AElementalCombatAIController* Controller)
+{
+	FAILODAgentHandle Handle;
+	if (!Controller)
+	{
+		return Handle;
+	}
+
+	FAgent NewAgent;
+	NewAgent.Serial = NextSerial++;
+	NewAgent.Controller = Controller;
+	NewAgent.Level = EAILODLevel::Engaged;
+	// 新AI不受最短停留时间限制，直接进入应有的层级
+	NewAgent.LevelEnterTime = Clock - MinTimeInLevel;
+
+	Handle.Index = Agents.Add(MoveTemp(NewAgent));
+	Handle.Serial = Agents[Handle.Index].Serial;
+	AddToPopulation(EAILODLevel::Engaged, 1);
+
+	UpdateAgent(Agents[Handle.Index], *Controller, true);
+	return Handle;
+}
+
+void UAILODSubsystem::UnregisterAgent(FAILODAgentHandle& Handle)
+{
+	if (IsAgentValid(Handle))
+	{
+		AddToPopulation(Agents[Handle.Index].Level, -1);
+		Agents.RemoveAt(Handle.Index);
+	}
+	Handle.Reset();
+}
+
+bool UAILODSubsystem::IsAgentValid(const FAILODAgentHandle& Handle) const
+{
+	return Handle.IsValid() && Agents.IsValidIndex(Handle.Index) && Agents[Handle.Index].Serial == Handle.Serial;
+}
+
+// === 层级 ===
+
+void UAILODSubsystem::UpdateLevels()
+{
+	const bool bEnabled = IsLODEnabled();
+	const bool bForceApply = bEnabled != bWasLODEnabled;
+	bWasLODEnabled = bEnabled;
+
+	StaleAgents.Reset();
+	for (auto It = Agents.CreateIterator(); It; ++It)
+	{
+		AElementalCombatAIController* Controller = It->Controller.Get();
+		if (!Controller)
+		{
+			StaleAgents.Add(It.GetIndex());
+			continue;
+		}
+
+		UpdateAgent(*It, *Controller, bForceApply);
+	}
+
+	// 控制器已销毁但没有注销的AI
+	for (const int32 Index : StaleAgents)
+	{
+		AddToPopulation(Agents[Index].Level, -1);
+		Agents.RemoveAt(Index);
+	}
+}
+
+EAILODLevel UAILODSubsystem::GetAgentLevel(const FAILODAgentHandle& Handle) const
+{
+	return IsAgentValid(Handle) ? Agents[Handle.Index].Level : EAILODLevel::Engaged;
+}
+
+const FAILODLevelSettings& UAILODSubsystem::GetLevelSettings(EAILODLevel Level) const
+{
+	switch (Level)
+	{
+	case EAILODLevel::Near:
+		return NearSettings;
+	case EAILODLevel::Far:
+		return FarSettings;
+	case EAILODLevel::Dormant:
+		return DormantSettings;
+	default:
+		return EngagedSettings;
+	}
+}
+
+bool UAILODSubsystem::IsLODEnabled()
+{
+	return CVarAILODEnabled.GetValueOnGameThread();
+}
+
+FUtilityProfile UAILODSubsystem::MakeFallbackProfile(const FUtilityProfile& Source, int32 MaxConsiderations)
+{
+	FUtilityProfile Fallback = Source;
+	Fallback.ProfileName = Source.ProfileName + TEXT("_LOD");
+
+	const int32 NumToKeep = FMath::Max(MaxConsiderations, 1);
+	if (Fallback.Considerations.Num() > NumToKeep)
+	{
+		// 按权重从高到低保留，权重相同时保持原顺序
+		Fallback.Considerations.StableSort([&Source](const FUtilityConsideration& A, const FUtilityConsideration& B)
+		{
+			return Source.GetWeight(A.ConsiderationType) > Source.GetWeight(B.ConsiderationType);
+		});
+		Fallback.Considerations.SetNum(NumToKeep);
+	}
+
+	return Fallback;
+}
+
+// === 调试 ===
+
+int32 UAILODSubsystem::GetLevelPopulation(EAILODLevel Level) const
+{
+	const int32 LevelIndex = static_cast<int32>(Level);
+	return LevelIndex >= 0 && LevelIndex < static_cast<int32>(EAILODLevel::Count) ? Populations[LevelIndex] : 0;
+}
+
+FString UAILODSubsystem::GetDebugString() const
+{
+	return FString::Printf(TEXT("AI LOD%s：Engaged %d，Near %d，Far %d，Dormant %d（共 %d，累计切换 %llu 次）"),
+		IsLODEnabled() ? TEXT("") : TEXT("（已关闭）"),
+		GetLevelPopulation(EAILODLevel::Engaged),
+		GetLevelPopulation(EAILODLevel::Near),
+		GetLevelPopulation(EAILODLevel::Far),
+		GetLevelPopulation(EAILODLevel::Dormant),
+		Agents.Num(),
+		NumTransitions);
+}
+
+// === 内部实现 ===
+
+EAILODLevel UAILODSubsystem::ComputeDesiredLevel(const FAgent& Agent, const AElementalCombatAIController& Controller) const
+{
+	const AElementalCombatEnemy* Enemy = Controller.GetElementalCombatEnemy();
+	if (!Enemy)
+	{
+		return EAILODLevel::Dormant;
+	}
+
+	// 正在攻击或刚受到伤害的AI始终全速运行
+	if (Enemy->IsAttacking() || Enemy->GetTimeSinceLastDamage() <= EngagementMemory)
+	{
+		return EAILODLevel::Engaged;
+	}
+
+	// 没有玩家时视为无限远
+	float Distance = TNumericLimits<float>::Max();
+	if (UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(this))
+	{
+		FPlayerRelativeInfo RelativeInfo;
+		if (SnapshotSubsystem->GetPlayerSnapshot().bIsValid
+			&& SnapshotSubsystem->GetRelativeInfo(Controller.GetPlayerSnapshotHandle(), RelativeInfo))
+		{
+			Distance = RelativeInfo.Distance;
+		}
+	}
+
+	// 当前层级及更高层级的边界外扩滞后距离，降级需要走得更远
+	const float Boundaries[] = { EngagedDistance, NearDistance, FarDistance };
+	EAILODLevel Desired = EAILODLevel::Dormant;
+	for (int32 LevelIndex = 0; LevelIndex < UE_ARRAY_COUNT(Boundaries); ++LevelIndex)
+	{
+		const float Margin = static_cast<int32>(Agent.Level) <= LevelIndex ? HysteresisDistance : 0.0f;
+		if (Distance <= Boundaries[LevelIndex] + Margin)
+		{
+			Desired = static_cast<EAILODLevel>(LevelIndex);
+			break;
+		}
+	}
+
+	// 不在屏幕上的非战斗AI再降一级
+	if (bDemoteOffscreen && Desired != EAILODLevel::Engaged && Desired != EAILODLevel::Dormant
+		&& !Enemy->WasRecentlyRendered(VisibilityTolerance))
+	{
+		Desired = static_cast<EAILODLevel>(static_cast<int32>(Desired) + 1);
+	}
+
+	return Desired;
+}
+
+void UAILODSubsystem::UpdateAgent(FAgent& Agent, AElementalCombatAIController& Controller, bool bForceApply)
+{
+	const bool bEnabled = IsLODEnabled();
+	EAILODLevel Desired = bEnabled ? ComputeDesiredLevel(Agent, Controller) : EAILODLevel::Engaged;
+
+	// 降级前必须在当前层级停留足够时间，升级立即生效
+	if (bEnabled && Desired > Agent.Level && Clock - Agent.LevelEnterTime < MinTimeInLevel)
+	{
+		Desired = Agent.Level;
+	}
+
+	if (Desired != Agent.Level)
+	{
+		AddToPopulation(Agent.Level, -1);
+		AddToPopulation(Desired, 1);
+		Agent.Level = Desired;
+		Agent.LevelEnterTime = Clock;
+		++NumTransitions;
+		bForceApply = true;
+	}
+
+	if (bForceApply)
+	{
+		Controller.ApplyLODLevel(Agent.Level, GetLevelSettings(Agent.Level));
+	}
+}
+
+void UAILODSubsystem::AddToPopulation(EAILODLevel Level, int32 Delta)
+{
+	const int32 LevelIndex = static_cast<int32>(Level);
+	if (LevelIndex >= 0 && LevelIndex < static_cast<int32>(EAILODLevel::Count))
+	{
+		Populations[LevelIndex] += Delta;
+	}
+}
+
+void UAILODSubsystem::DrawDebug() const
+{
+	if (GEngine)
+	{
+		GEngine->AddOnScreenDebugMessage(static_cast<uint64>(reinterpret_cast<UPTRINT>(this)), 0.0f, FColor::Cyan, GetDebugString());
+	}
+}
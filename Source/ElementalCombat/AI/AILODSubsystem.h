@@ -0,0 +1,259 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Containers/SparseArray.h"
+#include "AI/Utility/UtilityAITypes.h"
+#include "AILODSubsystem.generated.h"
+
+class AElementalCombatAIController;
+
+/**
+ * AI细节层级（数值越大开销越低）
+ */
+UENUM(BlueprintType)
+enum class EAILODLevel : uint8
+{
+	/** 正在战斗：全速运行 */
+	Engaged = 0,
+	/** 靠近玩家 */
+	Near = 1,
+	/** 远离玩家 */
+	Far = 2,
+	/** 很远或长期不可见：只保持最低限度的更新 */
+	Dormant = 3,
+
+	Count UMETA(Hidden)
+};
+
+/**
+ * 单个层级的AI运行参数
+ */
+USTRUCT(BlueprintType)
+struct ELEMENTALCOMBAT_API FAILODLevelSettings
+{
+	GENERATED_BODY()
+
+	/** StateTree组件的Tick间隔（秒，0表示每帧） */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+	float StateTreeTickInterval = 0.0f;
+
+	/** Utility AI子系统中基础评分请求的更新间隔（秒） */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+	float UtilityUpdateInterval = 0.5f;
+
+	/** 是否允许发起新的EQS查询（不允许时任务继续使用上次结果和共享缓存） */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "ElementalCombat|AI")
+	bool bAllowEQS = true;
+
+	/** 是否改用简化的后备配置文件评分 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "ElementalCombat|AI")
+	bool bUseFallbackProfile = false;
+
+	FAILODLevelSettings() = default;
+
+	FAILODLevelSettings(float InStateTreeTickInterval, float InUtilityUpdateInterval, bool bInAllowEQS, bool bInUseFallbackProfile)
+		: StateTreeTickInterval(InStateTreeTickInterval)
+		, UtilityUpdateInterval(InUtilityUpdateInterval)
+		, bAllowEQS(bInAllowEQS)
+		, bUseFallbackProfile(bInUseFallbackProfile)
+	{
+	}
+};
+
+/**
+ * LOD注册句柄
+ * 由UAILODSubsystem分配，槽位复用后旧句柄自动失效
+ */
+struct ELEMENTALCOMBAT_API FAILODAgentHandle
+{
+	/** 槽位下标 */
+	int32 Index = INDEX_NONE;
+
+	/** 分配序号（用于检测槽位复用） */
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	void Reset()
+	{
+		Index = INDEX_NONE;
+		Serial = 0;
+	}
+};
+
+/**
+ * AI细节层级子系统
+ * 按到玩家的距离、是否在屏幕上和是否正在战斗把敌人分到不同层级，
+ * 每个层级决定StateTree的Tick间隔、评分请求的更新间隔、是否允许EQS查询以及是否使用简化配置文件，
+ * AI的总开销随参战敌人数量而不是敌人总数增长
+ * - 升级立即生效，降级需要越过滞后距离并在当前层级停留足够时间，避免在边界上来回切换
+ * - 不在屏幕上的非战斗AI再降一级
+ * 控制台变量ElementalCombat.AI.LOD.Enabled可关闭分级（所有AI按Engaged运行），
+ * ElementalCombat.AI.LOD.ShowDebug在屏幕上显示各层级人数
+ */
+UCLASS(Config = Game)
+class ELEMENTALCOMBAT_API UAILODSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** 获取当前世界的子系统 */
+	static UAILODSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// === AI注册 ===
+
+	/** 注册AI，立即计算一次层级并应用 */
+	FAILODAgentHandle RegisterAgent(AElementalCombatAIController* Controller);
+
+	/** 注销AI并重置句柄 */
+	void UnregisterAgent(FAILODAgentHandle& Handle);
+
+	/** 句柄是否仍然有效 */
+	bool IsAgentValid(const FAILODAgentHandle& Handle) const;
+
+	/** 已注册的AI数量 */
+	int32 GetNumAgents() const { return Agents.Num(); }
+
+	// === 层级 ===
+
+	/** 立即重新计算所有AI的层级（正常情况下按EvaluationInterval在Tick中计算） */
+	void UpdateLevels();
+
+	/** 获取AI当前的层级，句柄无效时返回Engaged */
+	EAILODLevel GetAgentLevel(const FAILODAgentHandle& Handle) const;
+
+	/** 获取层级的运行参数 */
+	const FAILODLevelSettings& GetLevelSettings(EAILODLevel Level) const;
+
+	/** 分级是否启用（受ElementalCombat.AI.LOD.Enabled控制） */
+	static bool IsLODEnabled();
+
+	/**
+	 * 从完整配置文件生成简化的后备配置文件
+	 * 只保留权重最高的若干评分因素，其余设置保持不变
+	 */
+	static FUtilityProfile MakeFallbackProfile(const FUtilityProfile& Source, int32 MaxConsiderations);
+
+	/** 后备配置文件保留的评分因素数量 */
+	int32 GetFallbackMaxConsiderations() const { return FallbackMaxConsiderations; }
+
+	// === 调试 ===
+
+	/** 获取某个层级当前的AI数量 */
+	int32 GetLevelPopulation(EAILODLevel Level) const;
+
+	/** 累计层级切换次数 */
+	uint64 GetNumTransitions() const { return NumTransitions; }
+
+	/** 各层级人数的调试字符串 */
+	FString GetDebugString() const;
+
+protected:
+	/** 层级计算间隔（秒） */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+	float EvaluationInterval = 0.2f;
+
+	/** 视为参战的距离（在此距离内始终为Engaged） */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+	float EngagedDistance = 800.0f;
+
+	/** Near层级的最大距离 */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+	float NearDistance = 2000.0f;
+
+	/** Far层级的最大距离，更远的AI为Dormant */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+	float FarDistance = 5000.0f;
+
+	/** 降级时需要额外越过的距离 */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+	float HysteresisDistance = 200.0f;
+
+	/** 降级前在当前层级的最短停留时间（秒） */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+	float MinTimeInLevel = 1.0f;
+
+	/** 受到伤害后保持参战的时间（秒） */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+	float EngagementMemory = 3.0f;
+
+	/** 是否让不在屏幕上的非战斗AI再降一级 */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI")
+	bool bDemoteOffscreen = true;
+
+	/** 判断是否在屏幕上时允许的渲染延迟（秒） */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0", EditCondition = "bDemoteOffscreen"))
+	float VisibilityTolerance = 0.25f;
+
+	/** 后备配置文件保留的评分因素数量 */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "1"))
+	int32 FallbackMaxConsiderations = 2;
+
+	/** 各层级的运行参数 */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI")
+	FAILODLevelSettings EngagedSettings = FAILODLevelSettings(0.0f, 0.25f, true, false);
+
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI")
+	FAILODLevelSettings NearSettings = FAILODLevelSettings(0.1f, 0.5f, true, false);
+
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI")
+	FAILODLevelSettings FarSettings = FAILODLevelSettings(0.25f, 1.0f, false, true);
+
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI")
+	FAILODLevelSettings DormantSettings = FAILODLevelSettings(0.5f, 2.0f, false, true);
+
+private:
+	/** 注册的AI */
+	struct FAgent
+	{
+		uint32 Serial = 0;
+		TWeakObjectPtr<AElementalCombatAIController> Controller;
+		EAILODLevel Level = EAILODLevel::Engaged;
+
+		/** 进入当前层级的时间 */
+		double LevelEnterTime = 0.0;
+	};
+
+	/** 计算AI期望的层级（已考虑滞后距离和可见性） */
+	EAILODLevel ComputeDesiredLevel(const FAgent& Agent, const AElementalCombatAIController& Controller) const;
+
+	/** 计算并应用单个AI的层级 */
+	void UpdateAgent(FAgent& Agent, AElementalCombatAIController& Controller, bool bForceApply);
+
+	/** 把层级从人数统计中移出或移入 */
+	void AddToPopulation(EAILODLevel Level, int32 Delta);
+
+	/** 显示调试信息 */
+	void DrawDebug() const;
+
+	/** 所有AI */
+	TSparseArray<FAgent> Agents;
+
+	/** 下一个分配序号 */
+	uint32 NextSerial = 1;
+
+	/** 各层级人数 */
+	int32 Populations[static_cast<int32>(EAILODLevel::Count)] = {};
+
+	/** 子系统时钟（秒），由Tick累加 */
+	double Clock = 0.0;
+
+	/** 距离下次计算层级的剩余时间 */
+	float TimeUntilEvaluation = 0.0f;
+
+	/** 上次计算时分级是否启用（切换时强制重新应用） */
+	bool bWasLODEnabled = true;
+
+	/** 累计层级切换次数 */
+	uint64 NumTransitions = 0;
+
+	/** 每次计算复用的待清理列表 */
+	TArray<int32> StaleAgents;
+};
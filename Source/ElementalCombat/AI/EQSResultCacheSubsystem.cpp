@@ -0,0 +1,250 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "EQSResultCacheSubsystem.h"
+#include "Engine/World.h"
+#include "NavigationSystem.h"
+#include "EnvironmentQuery/EnvQuery.h"
+
+// === FEQSResultCacheKey 实现 ===
+
+FEQSResultCacheKey FEQSResultCacheKey::Make(const UEnvQuery* QueryTemplate, const FVector& QuerierLocation, const FVector* Target, float InCellSize)
+{
+	const float SafeCellSize = FMath::Max(InCellSize, 1.0f);
+
+	FEQSResultCacheKey Key;
+	Key.Query = FObjectKey(QueryTemplate);
+	Key.CellSize = FMath::RoundToInt(SafeCellSize);
+	Key.QuerierCell = ToCell(QuerierLocation, SafeCellSize);
+	if (Target)
+	{
+		Key.TargetCell = ToCell(*Target, SafeCellSize);
+		Key.bHasTarget = true;
+	}
+	return Key;
+}
+
+FIntVector FEQSResultCacheKey::ToCell(const FVector& Location, float InCellSize)
+{
+	const double InvCellSize = 1.0 / FMath::Max(InCellSize, 1.0f);
+	return FIntVector(
+		FMath::FloorToInt32(Location.X * InvCellSize),
+		FMath::FloorToInt32(Location.Y * InvCellSize),
+		FMath::FloorToInt32(Location.Z * InvCellSize));
+}
+
+// === UEQSResultCacheSubsystem 实现 ===
+
+UEQSResultCacheSubsystem* UEQSResultCacheSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (!WorldContextObject)
+	{
+		return nullptr;
+	}
+
+	const UWorld* World = WorldContextObject->GetWorld();
+	return World ? World->GetSubsystem<UEQSResultCacheSubsystem>() : nullptr;
+}
+
+void UEQSResultCacheSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// 导航网格重新生成后缓存的位置可能已不可达
+	if (UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld))
+	{
+		NavSystem->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &UEQSResultCacheSubsystem::HandleNavigationGenerationFinished);
+	}
+}
+
+void UEQSResultCacheSubsystem::Deinitialize()
+{
+	if (UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavSystem->OnNavigationGenerationFinishedDelegate.RemoveDynamic(this, &UEQSResultCacheSubsystem::HandleNavigationGenerationFinished);
+	}
+
+	{
+		FWriteScopeLock WriteLock(EntriesLock);
+		Entries.Empty();
+	}
+
+	Super::Deinitialize();
+}
+
+bool UEQSResultCacheSubsystem::Find(const FEQSResultCacheKey& Key, float CurrentTime, float MaxAge, TArray<FVector>& OutLocations, float& OutTimestamp)
+{
+	FWriteScopeLock WriteLock(EntriesLock);
+
+	FEntry* Entry = Entries.Find(Key);
+	if (!Entry)
+	{
+		++Misses;
+		return false;
+	}
+
+	if (IsExpired(*Entry, CurrentTime))
+	{
+		Entries.Remove(Key);
+		++Expirations;
+		++Misses;
+		return false;
+	}
+
+	// 条目仍在有效期内，但对调用方而言太旧
+	if (Entry->Result.IsExpired(CurrentTime, MaxAge))
+	{
+		++Misses;
+		return false;
+	}
+
+	++Hits;
+	OutLocations.Reset();
+	OutLocations.Append(Entry->Result.CachedLocations);
+	OutTimestamp = Entry->Result.CacheTimestamp;
+	return true;
+}
+
+bool UEQSResultCacheSubsystem::Find(const FEQSResultCacheKey& Key, float CurrentTime, float MaxAge, FEQSQueryCache& OutCache)
+{
+	float Timestamp = 0.0f;
+	if (!Find(Key, CurrentTime, MaxAge, OutCache.CachedLocations, Timestamp))
+	{
+		return false;
+	}
+
+	// 写入时拒绝空结果，命中的条目至少有一个位置
+	OutCache.BestLocation = OutCache.CachedLocations[0];
+	OutCache.CacheTimestamp = Timestamp;
+	OutCache.QueryHash = static_cast<int32>(GetTypeHash(Key));
+	OutCache.bIsValid = true;
+	return true;
+}
+
+void UEQSResultCacheSubsystem::Add(const FEQSResultCacheKey& Key, const TArray<FVector>& Locations, float CurrentTime, float TimeToLive)
+{
+	if (Locations.Num() == 0)
+	{
+		return;
+	}
+
+	FWriteScopeLock WriteLock(EntriesLock);
+	if (Capacity <= 0)
+	{
+		return;
+	}
+
+	if (!Entries.Contains(Key) && Entries.Num() >= Capacity)
+	{
+		RemoveExpired(CurrentTime);
+		if (Entries.Num() >= Capacity)
+		{
+			EvictOldest();
+		}
+	}
+
+	FEntry& Entry = Entries.FindOrAdd(Key);
+	Entry.Result.CachedLocations = Locations;
+	Entry.Result.BestLocation = Locations[0];
+	Entry.Result.CacheTimestamp = CurrentTime;
+	Entry.Result.QueryHash = static_cast<int32>(GetTypeHash(Key));
+	Entry.Result.bIsValid = true;
+	Entry.ExpireTime = CurrentTime + FMath::Max(TimeToLive, 0.0f);
+}
+
+void UEQSResultCacheSubsystem::Invalidate()
+{
+	FWriteScopeLock WriteLock(EntriesLock);
+	if (Entries.Num() > 0)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("EQS结果缓存已失效：清除 %d 个条目"), Entries.Num());
+	}
+
+	Entries.Reset();
+	++Invalidations;
+}
+
+void UEQSResultCacheSubsystem::SetCapacity(int32 InCapacity)
+{
+	FWriteScopeLock WriteLock(EntriesLock);
+	Capacity = FMath::Max(InCapacity, 0);
+	while (Entries.Num() > Capacity)
+	{
+		EvictOldest();
+	}
+}
+
+FEQSResultCacheStats UEQSResultCacheSubsystem::GetStats() const
+{
+	FReadScopeLock ReadLock(EntriesLock);
+
+	FEQSResultCacheStats Stats;
+	Stats.Hits = Hits;
+	Stats.Misses = Misses;
+	Stats.Evictions = Evictions;
+	Stats.Expirations = Expirations;
+	Stats.Invalidations = Invalidations;
+	Stats.NumEntries = Entries.Num();
+	Stats.Capacity = Capacity;
+
+	Stats.MemoryBytes = Entries.GetAllocatedSize();
+	for (const TPair<FEQSResultCacheKey, FEntry>& Pair : Entries)
+	{
+		Stats.MemoryBytes += Pair.Value.Result.CachedLocations.GetAllocatedSize();
+	}
+
+	return Stats;
+}
+
+void UEQSResultCacheSubsystem::ResetStats()
+{
+	FWriteScopeLock WriteLock(EntriesLock);
+	Hits = 0;
+	Misses = 0;
+	Evictions = 0;
+	Expirations = 0;
+	Invalidations = 0;
+}
+
+void UEQSResultCacheSubsystem::HandleNavigationGenerationFinished(ANavigationData* NavData)
+{
+	Invalidate();
+}
+
+void UEQSResultCacheSubsystem::RemoveExpired(float CurrentTime)
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (IsExpired(It.Value(), CurrentTime))
+		{
+			It.RemoveCurrent();
+			++Expirations;
+		}
+	}
+}
+
+void UEQSResultCacheSubsystem::EvictOldest()
+{
+	const FEQSResultCacheKey* OldestKey = nullptr;
+	float OldestTimestamp = TNumericLimits<float>::Max();
+	for (const TPair<FEQSResultCacheKey, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.Result.CacheTimestamp < OldestTimestamp)
+		{
+			OldestTimestamp = Pair.Value.Result.CacheTimestamp;
+			OldestKey = &Pair.Key;
+		}
+	}
+
+	if (OldestKey)
+	{
+		// 先复制键，Remove会使指针失效
+		const FEQSResultCacheKey KeyToRemove = *OldestKey;
+		Entries.Remove(KeyToRemove);
+		++Evictions;
+	}
+}
+
+bool UEQSResultCacheSubsystem::IsExpired(const FEntry& Entry, float CurrentTime)
+{
+	return CurrentTime > Entry.ExpireTime || CurrentTime < Entry.Result.CacheTimestamp;
+}
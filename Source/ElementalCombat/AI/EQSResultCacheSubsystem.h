@@ -0,0 +1,237 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "EQSResultCacheSubsystem.generated.h"
+
+class UEnvQuery;
+class ANavigationData;
+
+/**
+ * EQS查询结果缓存结构
+ */
+USTRUCT(BlueprintType)
+struct ELEMENTALCOMBAT_API FEQSQueryCache
+{
+	GENERATED_BODY()
+
+	/** 缓存的查询结果位置 */
+	UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|AI")
+	TArray<FVector> CachedLocations;
+
+	/** 最佳位置 */
+	UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|AI")
+	FVector BestLocation = FVector::ZeroVector;
+
+	/** 缓存时间戳 */
+	UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|AI")
+	float CacheTimestamp = -1.0f;
+
+	/** 查询哈希值（用于检测查询参数是否变化） */
+	UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|AI")
+	int32 QueryHash = 0;
+
+	/** 是否有效 */
+	UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|AI")
+	bool bIsValid = false;
+
+	FEQSQueryCache()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		CachedLocations.Empty();
+		BestLocation = FVector::ZeroVector;
+		CacheTimestamp = -1.0f;
+		QueryHash = 0;
+		bIsValid = false;
+	}
+
+	bool IsExpired(float CurrentTime, float MaxAge) const
+	{
+		return !bIsValid || (CurrentTime - CacheTimestamp) > MaxAge;
+	}
+};
+
+/**
+ * EQS结果缓存键
+ * 由查询模板、查询者所在网格和目标所在网格组成，同一网格内的AI共用同一条查询结果
+ */
+struct ELEMENTALCOMBAT_API FEQSResultCacheKey
+{
+	/** 查询模板 */
+	FObjectKey Query;
+
+	/** 查询者所在网格 */
+	FIntVector QuerierCell = FIntVector::ZeroValue;
+
+	/** 目标所在网格（没有目标时为零） */
+	FIntVector TargetCell = FIntVector::ZeroValue;
+
+	/** 网格大小（取整，不同网格大小的键互不命中） */
+	int32 CellSize = 0;
+
+	/** 是否有目标 */
+	bool bHasTarget = false;
+
+	/**
+	 * 构建缓存键
+	 * @param Target 目标位置，为空表示没有目标
+	 * @param InCellSize 网格大小，<=1时按1处理
+	 */
+	static FEQSResultCacheKey Make(const UEnvQuery* QueryTemplate, const FVector& QuerierLocation, const FVector* Target, float InCellSize);
+
+	/** 把位置量化到网格 */
+	static FIntVector ToCell(const FVector& Location, float InCellSize);
+
+	bool operator==(const FEQSResultCacheKey& Other) const
+	{
+		return Query == Other.Query && QuerierCell == Other.QuerierCell && TargetCell == Other.TargetCell
+			&& CellSize == Other.CellSize && bHasTarget == Other.bHasTarget;
+	}
+
+	friend uint32 GetTypeHash(const FEQSResultCacheKey& Key)
+	{
+		uint32 Hash = GetTypeHash(Key.Query);
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.QuerierCell));
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.TargetCell));
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.CellSize));
+		return HashCombineFast(Hash, GetTypeHash(Key.bHasTarget));
+	}
+};
+
+/**
+ * EQS结果缓存统计
+ */
+struct ELEMENTALCOMBAT_API FEQSResultCacheStats
+{
+	/** 命中次数 */
+	uint64 Hits = 0;
+
+	/** 未命中次数（包括已过期的条目） */
+	uint64 Misses = 0;
+
+	/** 因容量不足被替换掉的有效条目数量 */
+	uint64 Evictions = 0;
+
+	/** 因过期被清理的条目数量 */
+	uint64 Expirations = 0;
+
+	/** 整体失效次数（导航网格变化或手动失效） */
+	uint64 Invalidations = 0;
+
+	/** 当前条目数量 */
+	int32 NumEntries = 0;
+
+	/** 缓存容量 */
+	int32 Capacity = 0;
+
+	/** 占用内存（字节，包括条目和结果位置数组） */
+	SIZE_T MemoryBytes = 0;
+
+	/** 命中率 [0.0 - 1.0] */
+	float GetHitRate() const
+	{
+		const uint64 Total = Hits + Misses;
+		return Total > 0 ? static_cast<float>(static_cast<double>(Hits) / static_cast<double>(Total)) : 0.0f;
+	}
+};
+
+/**
+ * EQS结果缓存子系统
+ * 在同一世界内所有StateTree任务之间共享EQS查询结果，键按网格量化，
+ * 围在玩家周围的多个AI可以复用同一次查询的结果；导航网格重新生成时整体失效。
+ * 所有公开接口都是线程安全的，并行Tick的StateTree实例可以同时查找和写入
+ */
+UCLASS()
+class ELEMENTALCOMBAT_API UEQSResultCacheSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** 默认容量 */
+	static constexpr int32 DefaultCapacity = 256;
+
+	/** 获取当前世界的子系统 */
+	static UEQSResultCacheSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * 查找缓存结果，命中时把结果位置复制到调用方的缓冲区
+	 * 条目可能随时被其他线程替换，不返回内部引用；复制复用缓冲区已有的内存，调用方反复使用同一缓冲区时不分配内存
+	 * @param MaxAge 调用方允许的最大结果年龄（秒）
+	 * @param OutLocations 命中时写入的结果位置（按评分降序，至少一个），未命中时不修改
+	 * @param OutTimestamp 命中时写入的缓存时间戳
+	 * @return 是否命中
+	 */
+	bool Find(const FEQSResultCacheKey& Key, float CurrentTime, float MaxAge, TArray<FVector>& OutLocations, float& OutTimestamp);
+
+	/**
+	 * 查找缓存结果
+	 * @param OutCache 命中时写入的结果（复用其位置数组已有的内存）
+	 * @return 是否命中
+	 */
+	bool Find(const FEQSResultCacheKey& Key, float CurrentTime, float MaxAge, FEQSQueryCache& OutCache);
+
+	/**
+	 * 写入查询结果（键已存在时覆盖）
+	 * @param TimeToLive 条目有效时间（秒），过期后在查找或写入时清理
+	 */
+	void Add(const FEQSResultCacheKey& Key, const TArray<FVector>& Locations, float CurrentTime, float TimeToLive);
+
+	/** 清空所有条目（导航网格变化时自动调用） */
+	void Invalidate();
+
+	/** 设置容量，超出的条目按时间从旧到新淘汰 */
+	void SetCapacity(int32 InCapacity);
+
+	/** 获取统计信息 */
+	FEQSResultCacheStats GetStats() const;
+
+	/** 重置统计计数 */
+	void ResetStats();
+
+private:
+	/** 缓存条目 */
+	struct FEntry
+	{
+		FEQSQueryCache Result;
+		float ExpireTime = 0.0f;
+	};
+
+	/** 导航网格生成完成回调 */
+	UFUNCTION()
+	void HandleNavigationGenerationFinished(ANavigationData* NavData);
+
+	/** 清理所有已过期的条目（调用方需持有写锁） */
+	void RemoveExpired(float CurrentTime);
+
+	/** 淘汰最旧的条目（调用方需持有写锁） */
+	void EvictOldest();
+
+	/** 条目是否已过期（时间倒退也视为过期） */
+	static bool IsExpired(const FEntry& Entry, float CurrentTime);
+
+	/** 保护条目和统计（查找也会清理过期条目，因此读写都取写锁，只有统计快照取读锁） */
+	mutable FRWLock EntriesLock;
+
+	/** 缓存条目 */
+	TMap<FEQSResultCacheKey, FEntry> Entries;
+
+	/** 容量 */
+	int32 Capacity = DefaultCapacity;
+
+	/** 统计 */
+	uint64 Hits = 0;
+	uint64 Misses = 0;
+	uint64 Evictions = 0;
+	uint64 Expirations = 0;
+	uint64 Invalidations = 0;
+};
@@ -5,6 +5,8 @@
 #include "ElementalCombatGameInstance.h"
 #include "ElementalCombatGameMode.h"
 #include "Components/StateTreeAIComponent.h"
+#include "StateTreeTasks/ElementalStateTreeTaskBase.h"
+#include "Kismet/GameplayStatics.h"
 
 AElementalCombatAIController::AElementalCombatAIController()
 {
@@ -19,22 +21,43 @@ void AElementalCombatAIController::OnPossess(APawn* InPawn)
 	// 先进行必要的初始化
 	// 缓存元素战斗敌人引用
 	ElementalCombatEnemy = Cast<AElementalCombatEnemy>(InPawn);
+	InvalidateFrameUtilityContext();
+	RequestedFrameUtilityInputs.store(0, std::memory_order_relaxed);
 
 	if (ElementalCombatEnemy)
 	{
 		UE_LOG(LogTemp, Log, TEXT("元素战斗AI控制器：已控制元素战斗敌人 %s"), *ElementalCombatEnemy->GetName());
 
-		// 从GameInstance随机获取AI配置
+		// 从GameInstance随机获取AI配置（共享句柄，查找表和编译结果由注册表统一构建）
 		if (UElementalCombatGameInstance* GameInstance = Cast<UElementalCombatGameInstance>(GetWorld()->GetGameInstance()))
 		{
-			CurrentAIProfile = GameInstance->GetRandomAIProfile();
-			UE_LOG(LogTemp, Log, TEXT("AI配置已设置: %s"), *CurrentAIProfile.ProfileName);
+			CurrentAIProfileHandle = GameInstance->GetRandomAIProfileHandle();
+			UE_LOG(LogTemp, Log, TEXT("AI配置已设置: %s"), *GetCurrentAIProfile().ProfileName);
 		}
 		else
 		{
 			// 使用默认测试配置
-			CurrentAIProfile = CreateDefaultTestProfile();
-			UE_LOG(LogTemp, Log, TEXT("使用默认测试AI配置: %s"), *CurrentAIProfile.ProfileName);
+			CurrentAIProfileHandle = GetDefaultTestProfile();
+			UE_LOG(LogTemp, Log, TEXT("使用默认测试AI配置: %s"), *GetCurrentAIProfile().ProfileName);
+		}
+
+		// 评分交由Utility AI子系统按帧预算分片执行
+		RefreshUtilityScoreRequest();
+
+		// 到玩家的距离和夹角由玩家快照子系统每帧批量计算，快照发布后预构建本帧的评分上下文
+		if (UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(this))
+		{
+			SnapshotSubsystem->UnregisterAgent(PlayerSnapshotHandle);
+			PlayerSnapshotHandle = SnapshotSubsystem->RegisterAgent(ElementalCombatEnemy);
+			SnapshotSubsystem->OnSnapshotPublished.Remove(SnapshotPublishedHandle);
+			SnapshotPublishedHandle = SnapshotSubsystem->OnSnapshotPublished.AddUObject(this, &AElementalCombatAIController::PrepareFrameUtilityContext);
+		}
+
+		// 按距离、可见性和战斗状态分级，注册时立即应用一次（依赖玩家快照句柄）
+		if (UAILODSubsystem* LODSubsystem = UAILODSubsystem::Get(this))
+		{
+			LODSubsystem->UnregisterAgent(LODHandle);
+			LODHandle = LODSubsystem->RegisterAgent(this);
 		}
 	}
 	else
@@ -69,7 +92,24 @@ void AElementalCombatAIController::OnPossess(APawn* InPawn)
 void AElementalCombatAIController::OnUnPossess()
 {
 	// 清理引用
+	if (UAILODSubsystem* LODSubsystem = UAILODSubsystem::Get(this))
+	{
+		LODSubsystem->UnregisterAgent(LODHandle);
+	}
+	LODHandle.Reset();
+	// 恢复未分级时的设置
+	ApplyLODLevel(EAILODLevel::Engaged, FAILODLevelSettings(0.0f, UtilityUpdateInterval, true, false));
+
+	ReleaseUtilityScoreRequest();
+	if (UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(this))
+	{
+		SnapshotSubsystem->UnregisterAgent(PlayerSnapshotHandle);
+		SnapshotSubsystem->OnSnapshotPublished.Remove(SnapshotPublishedHandle);
+	}
+	PlayerSnapshotHandle.Reset();
+	SnapshotPublishedHandle.Reset();
 	ElementalCombatEnemy = nullptr;
+	InvalidateFrameUtilityContext();
 
 	Super::OnUnPossess();
 }
@@ -77,11 +117,208 @@ void AElementalCombatAIController::OnUnPossess()
 #if WITH_AUTOMATION_TESTS || WITH_EDITOR
 void AElementalCombatAIController::SetAIProfileForTest(const FUtilityProfile& TestProfile)
 {
-	CurrentAIProfile = TestProfile;
-	UE_LOG(LogTemp, Log, TEXT("AI配置已通过测试方法设置: %s"), *CurrentAIProfile.ProfileName);
+	if (UUtilityProfileRegistry* ProfileRegistry = UUtilityProfileRegistry::Get(this))
+	{
+		CurrentAIProfileHandle = ProfileRegistry->RegisterProfile(TestProfile);
+	}
+	else
+	{
+		CurrentAIProfileHandle = FUtilityProfileHandle(FSharedUtilityProfile::Create(TestProfile));
+	}
+	RefreshUtilityScoreRequest();
+	UE_LOG(LogTemp, Log, TEXT("AI配置已通过测试方法设置: %s"), *GetCurrentAIProfile().ProfileName);
 }
 #endif
 
+const FUtilityProfile& AElementalCombatAIController::GetCurrentAIProfile() const
+{
+	if (CurrentAIProfileHandle.IsValid())
+	{
+		return CurrentAIProfileHandle.GetProfile();
+	}
+
+	// 尚未控制Pawn时返回空配置
+	static const FUtilityProfile EmptyProfile;
+	return EmptyProfile;
+}
+
+bool AElementalCombatAIController::BuildUtilityContext(FUtilityContext& OutContext, uint32 RequiredInputs) const
+{
+	const FUtilityContext* FrameContext = GetFrameUtilityContext(RequiredInputs);
+	if (!FrameContext)
+	{
+		return false;
+	}
+
+	OutContext = *FrameContext;
+	return true;
+}
+
+const FUtilityContext* AElementalCombatAIController::GetFrameUtilityContext(uint32 RequiredInputs) const
+{
+	if (!ElementalCombatEnemy)
+	{
+		return nullptr;
+	}
+
+	// 快照是可变成员，只在游戏线程上写入；其他线程只读取本帧已预构建且包含所需输入的快照（不解析目标，目标以预构建时为准）
+	if (!IsInGameThread())
+	{
+		if (FrameUtilityContextFrame == GFrameCounter && (RequiredInputs & ~FrameUtilityComputedInputs) == 0)
+		{
+			return &FrameUtilityContext;
+		}
+
+		// 记录缺少的输入，下一次预构建时一并采集
+		RequestedFrameUtilityInputs.fetch_or(RequiredInputs, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	// 新的一帧或焦点在帧内切换时丢弃已采集的输入
+	AActor* Target = ResolveUtilityTarget();
+	if (FrameUtilityContextFrame != GFrameCounter || FrameUtilityContext.TargetActor.Get() != Target)
+	{
+		FrameUtilityContext = FUtilityContext();
+		FrameUtilityComputedInputs = 0;
+		FrameUtilityContextFrame = GFrameCounter;
+	}
+
+	// 只采集本帧尚未采集的输入
+	if ((RequiredInputs & ~FrameUtilityComputedInputs) != 0)
+	{
+		const UWorld* World = GetWorld();
+		FElementalStateTreeTaskBase::PopulateUtilityContext(FrameUtilityContext, ElementalCombatEnemy, Target,
+			World ? World->GetTimeSeconds() : 0.0f, RequiredInputs, FrameUtilityComputedInputs);
+	}
+
+	return &FrameUtilityContext;
+}
+
+void AElementalCombatAIController::PrepareFrameUtilityContext()
+{
+	GetFrameUtilityContext(GetAIProfileRequiredInputs() | RequestedFrameUtilityInputs.load(std::memory_order_relaxed));
+}
+
+AActor* AElementalCombatAIController::ResolveUtilityTarget() const
+{
+	// 与StateTree任务的目标选择一致：优先使用焦点Actor，否则使用玩家快照中的玩家Pawn
+	AActor* Target = GetFocusActor();
+	if (!Target)
+	{
+		if (UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(this))
+		{
+			Target = SnapshotSubsystem->GetPlayerSnapshot().Player.Get();
+		}
+		else
+		{
+			Target = UGameplayStatics::GetPlayerPawn(this, 0);
+		}
+	}
+	return Target;
+}
+
+void AElementalCombatAIController::ApplyLODLevel(EAILODLevel Level, const FAILODLevelSettings& Settings)
+{
+	CurrentLODLevel = Level;
+	bEQSAllowed = Settings.bAllowEQS;
+
+	if (UStateTreeAIComponent* StateTreeComp = FindComponentByClass<UStateTreeAIComponent>())
+	{
+		StateTreeComp->SetComponentTickInterval(Settings.StateTreeTickInterval);
+	}
+
+	const bool bProfileChanged = bUseFallbackProfile != Settings.bUseFallbackProfile;
+	bUseFallbackProfile = Settings.bUseFallbackProfile;
+	ActiveUtilityUpdateInterval = Settings.UtilityUpdateInterval;
+
+	UUtilityAISubsystem* UtilitySubsystem = UUtilityAISubsystem::Get(this);
+	if (UtilitySubsystem && UtilitySubsystem->IsRequestValid(UtilityScoreRequest))
+	{
+		UtilitySubsystem->SetRequestUpdateInterval(UtilityScoreRequest, ActiveUtilityUpdateInterval);
+		if (bProfileChanged)
+		{
+			UtilitySubsystem->SetRequestProfile(UtilityScoreRequest, GetActiveUtilityProfile().GetCompiled());
+		}
+	}
+}
+
+const FUtilityProfileHandle& AElementalCombatAIController::GetActiveUtilityProfile()
+{
+	return bUseFallbackProfile ? GetFallbackAIProfile() : CurrentAIProfileHandle;
+}
+
+const FUtilityProfileHandle& AElementalCombatAIController::GetFallbackAIProfile()
+{
+	if (!CurrentAIProfileHandle.IsValid())
+	{
+		return CurrentAIProfileHandle;
+	}
+
+	// 完整配置文件变化时重建，注册表对相同的后备配置去重，使用同一完整配置的AI共享同一份
+	if (!FallbackAIProfile.IsValid() || FallbackSourceIdentity != CurrentAIProfileHandle.GetIdentity())
+	{
+		const UAILODSubsystem* LODSubsystem = UAILODSubsystem::Get(this);
+		const int32 MaxConsiderations = LODSubsystem ? LODSubsystem->GetFallbackMaxConsiderations() : 2;
+		const FUtilityProfile Fallback = UAILODSubsystem::MakeFallbackProfile(CurrentAIProfileHandle.GetProfile(), MaxConsiderations);
+
+		if (UUtilityProfileRegistry* ProfileRegistry = UUtilityProfileRegistry::Get(this))
+		{
+			FallbackAIProfile = ProfileRegistry->RegisterProfile(Fallback);
+		}
+		else
+		{
+			FallbackAIProfile = FUtilityProfileHandle(FSharedUtilityProfile::Create(Fallback));
+		}
+		FallbackSourceIdentity = CurrentAIProfileHandle.GetIdentity();
+	}
+
+	return FallbackAIProfile;
+}
+
+void AElementalCombatAIController::RefreshUtilityScoreRequest()
+{
+	TSharedPtr<const FCompiledUtilityProfile> CompiledAIProfile = GetActiveUtilityProfile().GetCompiled();
+	UUtilityAISubsystem* UtilitySubsystem = UUtilityAISubsystem::Get(this);
+	if (!UtilitySubsystem || !ElementalCombatEnemy || !CompiledAIProfile.IsValid())
+	{
+		return;
+	}
+
+	if (UtilitySubsystem->IsRequestValid(UtilityScoreRequest))
+	{
+		UtilitySubsystem->SetRequestProfile(UtilityScoreRequest, CompiledAIProfile);
+		UtilitySubsystem->EvaluateNow(UtilityScoreRequest);
+		return;
+	}
+
+	FUtilityScoreRequestDesc Desc;
+	Desc.Agent = ElementalCombatEnemy;
+	Desc.Profile = CompiledAIProfile;
+	Desc.UpdateInterval = ActiveUtilityUpdateInterval >= 0.0f ? ActiveUtilityUpdateInterval : UtilityUpdateInterval;
+	Desc.ContextProvider = [WeakController = TWeakObjectPtr<const AElementalCombatAIController>(this)](FUtilityContext& OutContext)
+	{
+		// 使用后备配置文件时输入是完整配置的子集，照常按完整配置采集即可
+		const AElementalCombatAIController* Controller = WeakController.Get();
+		return Controller && Controller->BuildUtilityContext(OutContext, Controller->GetAIProfileRequiredInputs());
+	};
+	UtilityScoreRequest = UtilitySubsystem->RegisterRequest(MoveTemp(Desc));
+}
+
+void AElementalCombatAIController::ReleaseUtilityScoreRequest()
+{
+	if (UUtilityAISubsystem* UtilitySubsystem = UUtilityAISubsystem::Get(this))
+	{
+		UtilitySubsystem->UnregisterRequest(UtilityScoreRequest);
+	}
+	UtilityScoreRequest.Reset();
+}
+
+const FUtilityProfileHandle& AElementalCombatAIController::GetDefaultTestProfile()
+{
+	static const FUtilityProfileHandle DefaultProfile(FSharedUtilityProfile::Create(CreateDefaultTestProfile()));
+	return DefaultProfile;
+}
+
 FUtilityProfile AElementalCombatAIController::CreateDefaultTestProfile()
 {
 	FUtilityProfile DefaultProfile;
@@ -5,6 +5,11 @@
 #include "CoreMinimal.h"
 #include "Variant_Combat/AI/CombatAIController.h"
 #include "AI/Utility/UtilityAITypes.h"
+#include "AI/Utility/UtilityAISubsystem.h"
+#include "AI/Utility/UtilityProfileRegistry.h"
+#include "AI/PlayerSnapshotSubsystem.h"
+#include "AI/AILODSubsystem.h"
+#include <atomic>
 #include "ElementalCombatAIController.generated.h"
 
 class AElementalCombatEnemy;
@@ -34,10 +39,17 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Category="ElementalCombat|AI")
 	TObjectPtr<AElementalCombatEnemy> ElementalCombatEnemy;
 
-	/** 当前AI的Utility配置 */
-	UPROPERTY(BlueprintReadOnly, Category="ElementalCombat|AI")
+	/**
+	 * 当前AI的Utility配置（已弃用，只为兼容读取该属性的蓝图保留）
+	 * 配置改为共享句柄后不再保存副本，蓝图读取该属性时由GetCurrentAIProfileForBlueprint解析句柄
+	 */
+	UPROPERTY(BlueprintReadOnly, BlueprintGetter = GetCurrentAIProfileForBlueprint, Category="ElementalCombat|AI", meta = (DeprecatedProperty, DeprecationMessage = "配置改为共享句柄，请使用GetCurrentAIProfile"))
 	FUtilityProfile CurrentAIProfile;
 
+	/** 基础评分请求的更新间隔（秒），实际间隔由Utility AI子系统按优先级缩放 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="ElementalCombat|AI", meta = (ClampMin = "0.0"))
+	float UtilityUpdateInterval = 0.5f;
+
 public:
 	/** Get the possessed elemental combat enemy */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="ElementalCombat|AI")
@@ -45,7 +57,67 @@ public:
 
 	/** 获取当前AI的Utility配置（供StateTree访问） */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="ElementalCombat|AI")
-	const FUtilityProfile& GetCurrentAIProfile() const { return CurrentAIProfile; }
+	const FUtilityProfile& GetCurrentAIProfile() const;
+
+	/** 蓝图读取CurrentAIProfile属性时调用，返回共享配置的副本 */
+	UFUNCTION(BlueprintGetter)
+	FUtilityProfile GetCurrentAIProfileForBlueprint() const { return GetCurrentAIProfile(); }
+
+	/** 获取当前AI的共享配置句柄 */
+	const FUtilityProfileHandle& GetAIProfileHandle() const { return CurrentAIProfileHandle; }
+
+	/** 获取编译后的Utility配置（与共享配置同生命周期） */
+	TSharedPtr<const FCompiledUtilityProfile> GetCompiledAIProfile() const { return CurrentAIProfileHandle.GetCompiled(); }
+
+	/** 获取当前配置读取的输入掩码（见UtilityInputs） */
+	uint32 GetAIProfileRequiredInputs() const { return CurrentAIProfileHandle.IsValid() ? CurrentAIProfileHandle.Get()->Compiled.GetRequiredInputs() : 0; }
+
+	/** 获取在Utility AI子系统中注册的基础评分请求 */
+	const FUtilityScoreRequestHandle& GetUtilityScoreRequest() const { return UtilityScoreRequest; }
+
+	/** 获取在玩家快照子系统中注册的句柄（按句柄读取到玩家的距离和夹角） */
+	const FPlayerSnapshotAgentHandle& GetPlayerSnapshotHandle() const { return PlayerSnapshotHandle; }
+
+	// === 细节层级（由UAILODSubsystem设置） ===
+
+	/** 获取当前的细节层级 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="ElementalCombat|AI")
+	EAILODLevel GetLODLevel() const { return CurrentLODLevel; }
+
+	/** 当前层级是否允许发起新的EQS查询 */
+	bool IsEQSAllowed() const { return bEQSAllowed; }
+
+	/** 基础评分请求当前是否使用简化的后备配置文件 */
+	bool IsUsingFallbackProfile() const { return bUseFallbackProfile; }
+
+	/** 获取在细节层级子系统中注册的句柄 */
+	const FAILODAgentHandle& GetLODHandle() const { return LODHandle; }
+
+	/** 应用细节层级：StateTree的Tick间隔、评分请求的更新间隔和配置文件、EQS许可 */
+	void ApplyLODLevel(EAILODLevel Level, const FAILODLevelSettings& Settings);
+
+	/**
+	 * 构建当前Pawn的评分上下文（复制本帧快照）
+	 * @param RequiredInputs 需要的输入掩码（见UtilityInputs）
+	 */
+	bool BuildUtilityContext(FUtilityContext& OutContext, uint32 RequiredInputs = UtilityInputs::All) const;
+
+	/**
+	 * 获取本帧的评分上下文快照
+	 * 每帧在玩家快照发布后、StateTree Tick之前于游戏线程构建一次（帧内目标变化时重建），同一帧内所有StateTree任务和Utility AI子系统读取同一份上下文
+	 * 输入按需采集：预构建时采集配置文件读取的输入和其他线程上缺少过的输入，游戏线程上读取时补充本帧尚未采集的输入
+	 * 其他线程（并行Tick的StateTree任务）只读取快照，不采集也不解析目标；快照缺少所需输入时返回nullptr，
+	 * 缺少的输入会被记录下来，从下一帧起随预构建一起采集
+	 * @param RequiredInputs 需要的输入掩码（见UtilityInputs）
+	 * @return 没有控制元素战斗敌人，或在其他线程上读取而快照缺少所需输入时返回nullptr
+	 */
+	const FUtilityContext* GetFrameUtilityContext(uint32 RequiredInputs = UtilityInputs::All) const;
+
+	/** 获取本帧快照中已采集的输入掩码 */
+	uint32 GetFrameUtilityComputedInputs() const { return FrameUtilityComputedInputs; }
+
+	/** 使评分上下文快照失效，下次读取时重建（帧内直接修改了Pawn状态时使用） */
+	void InvalidateFrameUtilityContext() const { FrameUtilityContextFrame = MAX_uint64; }
 
 #if WITH_AUTOMATION_TESTS || WITH_EDITOR
 	/** 为测试场景设置AI配置（仅在测试或编辑器构建中可用） */
@@ -53,6 +125,72 @@ public:
 #endif
 
 private:
+	/** 在Utility AI子系统中注册（或更新）基础评分请求 */
+	void RefreshUtilityScoreRequest();
+
+	/** 注销基础评分请求 */
+	void ReleaseUtilityScoreRequest();
+
+	/** 选择评分目标：优先使用焦点Actor，否则使用玩家Pawn */
+	AActor* ResolveUtilityTarget() const;
+
+	/** 玩家快照发布后在游戏线程上预构建本帧的评分上下文快照 */
+	void PrepareFrameUtilityContext();
+
+	/** 基础评分请求当前使用的配置文件（完整配置或后备配置） */
+	const FUtilityProfileHandle& GetActiveUtilityProfile();
+
+	/** 获取当前配置文件对应的简化后备配置文件（配置文件变化时重建） */
+	const FUtilityProfileHandle& GetFallbackAIProfile();
+
+	/** 当前AI的共享Utility配置（由配置注册表持有，多个AI共享同一实例） */
+	FUtilityProfileHandle CurrentAIProfileHandle;
+
+	/** 基础评分请求句柄 */
+	FUtilityScoreRequestHandle UtilityScoreRequest;
+
+	/** 玩家快照子系统中的句柄 */
+	FPlayerSnapshotAgentHandle PlayerSnapshotHandle;
+
+	/** 玩家快照发布回调的句柄 */
+	FDelegateHandle SnapshotPublishedHandle;
+
+	/** 细节层级子系统中的句柄 */
+	FAILODAgentHandle LODHandle;
+
+	/** 当前的细节层级 */
+	EAILODLevel CurrentLODLevel = EAILODLevel::Engaged;
+
+	/** 当前层级是否允许EQS查询 */
+	bool bEQSAllowed = true;
+
+	/** 基础评分请求是否使用后备配置文件 */
+	bool bUseFallbackProfile = false;
+
+	/** 基础评分请求的有效更新间隔（未注册细节层级时为UtilityUpdateInterval） */
+	float ActiveUtilityUpdateInterval = -1.0f;
+
+	/** 简化的后备配置文件 */
+	FUtilityProfileHandle FallbackAIProfile;
+
+	/** 后备配置文件对应的完整配置文件标识 */
+	uint32 FallbackSourceIdentity = 0;
+
+	/** 本帧的评分上下文快照 */
+	mutable FUtilityContext FrameUtilityContext;
+
+	/** 快照构建时的帧号（MAX_uint64表示无效） */
+	mutable uint64 FrameUtilityContextFrame = MAX_uint64;
+
+	/** 本帧快照中已采集的输入掩码 */
+	mutable uint32 FrameUtilityComputedInputs = 0;
+
+	/** 其他线程上读取时快照缺少的输入掩码（任意线程写入，预构建快照时一并采集） */
+	mutable std::atomic<uint32> RequestedFrameUtilityInputs{0};
+
 	/** 创建默认测试配置（当GameInstance不可用时的后备方案） */
 	static FUtilityProfile CreateDefaultTestProfile();
+
+	/** 获取共享的默认测试配置 */
+	static const FUtilityProfileHandle& GetDefaultTestProfile();
 };
\ No newline at end of file
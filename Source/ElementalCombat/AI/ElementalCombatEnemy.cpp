@@ -1,6 +1,8 @@
 // Copyright 2025 guigui17f. All Rights Reserved.
 
 #include "ElementalCombatEnemy.h"
+#include "ElementalCombatAIController.h"
+#include "PlayerSnapshotSubsystem.h"
 #include "Projectiles/CombatProjectile.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Animation/AnimInstance.h"
@@ -47,7 +49,7 @@ void AElementalCombatEnemy::BeginPlay()
 				ElementalComponent->SwitchElement(SelectedElement);
 
 				// 应用元素颜色到材质
-				const FElementalEffectData* ElementData = ElementalComponent->GetElementEffectDataPtr(SelectedElement);
+				const FElementalPresentationData* ElementData = ElementalComponent->GetElementPresentationPtr(SelectedElement);
 				if (ElementData)
 				{
 					UpdateMaterialColors(ElementData->ElementColor);
@@ -228,11 +230,12 @@ void AElementalCombatEnemy::LaunchProjectile()
 		float DistanceToPlayer = 800.0f; // 默认中距离
 		float HeightDifference = 0.0f;
 
-		if (UWorld* World = GetWorld())
+		if (UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(this))
 		{
-			if (ACharacter* PlayerCharacter = Cast<ACharacter>(World->GetFirstPlayerController()->GetPawn()))
+			const FPlayerSnapshot& PlayerSnapshot = SnapshotSubsystem->GetPlayerSnapshot();
+			if (PlayerSnapshot.bIsValid)
 			{
-				FVector ToPlayer = PlayerCharacter->GetActorLocation() - SpawnLocation;
+				FVector ToPlayer = PlayerSnapshot.Location - SpawnLocation;
 				// 只计算水平距离
 				DistanceToPlayer = FVector(ToPlayer.X, ToPlayer.Y, 0.0f).Size();
 				// 计算高度差
@@ -263,12 +266,18 @@ float AElementalCombatEnemy::GetDistanceToTarget() const
 	// 注意：这个方法现在主要用于兼容性
 	// StateTree任务应该使用GetPlayerInfo任务数据而不是调用这个方法
 	
-	// 尝试找到玩家角色作为备用方案
-	if (UWorld* World = GetWorld())
+	// 尝试从玩家快照获取距离作为备用方案
+	if (UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(this))
 	{
-		if (ACharacter* PlayerCharacter = Cast<ACharacter>(World->GetFirstPlayerController()->GetPawn()))
+		const FPlayerSnapshot& PlayerSnapshot = SnapshotSubsystem->GetPlayerSnapshot();
+		if (PlayerSnapshot.bIsValid)
 		{
-			float Distance = FVector::Dist(GetActorLocation(), PlayerCharacter->GetActorLocation());
+			// 已注册的AI直接读取本帧批量计算的结果
+			FPlayerRelativeInfo RelativeInfo;
+			const AElementalCombatAIController* AIController = Cast<AElementalCombatAIController>(GetController());
+			const float Distance = AIController && SnapshotSubsystem->GetRelativeInfo(AIController->GetPlayerSnapshotHandle(), RelativeInfo)
+				? RelativeInfo.Distance
+				: FVector::Dist(GetActorLocation(), PlayerSnapshot.Location);
 			UE_LOG(LogTemp, Verbose, TEXT("%s: 备用计算到玩家的距离：%.2f"), *GetName(), Distance);
 			return Distance;
 		}
@@ -279,6 +288,16 @@ float AElementalCombatEnemy::GetDistanceToTarget() const
 	return TNumericLimits<float>::Max();
 }
 
+float AElementalCombatEnemy::GetTimeSinceLastDamage() const
+{
+	const UWorld* World = GetWorld();
+	if (LastDamageTakenTime < 0.0f || !World)
+	{
+		return TNumericLimits<float>::Max();
+	}
+	return World->GetTimeSeconds() - LastDamageTakenTime;
+}
+
 float AElementalCombatEnemy::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, 
                                        AController* EventInstigator, AActor* DamageCauser)
 {
@@ -290,6 +309,7 @@ float AElementalCombatEnemy::TakeDamage(float Damage, struct FDamageEvent const&
 
 	// 减少当前HP
 	CurrentHP -= Damage;
+	LastDamageTakenTime = GetWorld()->GetTimeSeconds();
 
 	// HP耗尽？
 	if (CurrentHP <= 0.0f)
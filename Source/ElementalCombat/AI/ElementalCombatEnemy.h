@@ -60,6 +60,9 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="ElementalCombat|AI")
 	UAnimMontage* RangedAttackMontage;
 
+	// 上次受到伤害的世界时间（负数表示从未受伤）
+	float LastDamageTakenTime = -1.0f;
+
 public:
 	// 当前攻击类型
 	UPROPERTY(BlueprintReadOnly, Category="ElementalCombat|AI")
@@ -94,6 +97,10 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="ElementalCombat|AI")
 	float GetRangedAttackRange() const { return RangedAttackRange; }
 
+	// 距离上次受到伤害的时间（秒），从未受伤时返回最大值
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="ElementalCombat|AI")
+	float GetTimeSinceLastDamage() const;
+
 	// 重写受击方法，移除ragdoll效果
 	virtual float TakeDamage(float Damage, FDamageEvent const& DamageEvent,
 	                        AController* EventInstigator, AActor* DamageCauser) override;
@@ -0,0 +1,280 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "PlayerSnapshotSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "Kismet/GameplayStatics.h"
+#include "Variant_Combat/CombatCharacter.h"
+#include "Combat/Elemental/ElementalComponent.h"
+
+UPlayerSnapshotSubsystem* UPlayerSnapshotSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (!WorldContextObject)
+	{
+		return nullptr;
+	}
+
+	const UWorld* World = WorldContextObject->GetWorld();
+	return World ? World->GetSubsystem<UPlayerSnapshotSubsystem>() : nullptr;
+}
+
+void UPlayerSnapshotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &UPlayerSnapshotSubsystem::HandleWorldPreActorTick);
+}
+
+void UPlayerSnapshotSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+	PreActorTickHandle.Reset();
+	OnSnapshotPublished.Clear();
+
+	AgentActors.Empty();
+	AgentSerials.Empty();
+	FreeIndices.Empty();
+	AgentX.Empty();
+	AgentY.Empty();
+	AgentZ.Empty();
+	ForwardX.Empty();
+	ForwardY.Empty();
+	Distances.Empty();
+	HorizontalDistances.Empty();
+	HeightDifferences.Empty();
+	HorizontalAngles.Empty();
+	NumAgents = 0;
+
+	Super::Deinitialize();
+}
+
+// === AI注册 ===
+
+FPlayerSnapshotAgentHandle UPlayerSnapshotSubsystem::RegisterAgent(AActor* Agent)
+{
+	FPlayerSnapshotAgentHandle Handle;
+	if (!Agent)
+	{
+		return Handle;
+	}
+
+	int32 Index = INDEX_NONE;
+	if (FreeIndices.Num() > 0)
+	{
+		Index = FreeIndices.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Index = AgentActors.Num();
+		AgentActors.AddDefaulted();
+		AgentSerials.AddZeroed();
+		AgentX.AddZeroed();
+		AgentY.AddZeroed();
+		AgentZ.AddZeroed();
+		ForwardX.AddZeroed();
+		ForwardY.AddZeroed();
+		Distances.AddZeroed();
+		HorizontalDistances.AddZeroed();
+		HeightDifferences.AddZeroed();
+		HorizontalAngles.AddZeroed();
+	}
+
+	AgentActors[Index] = Agent;
+	AgentSerials[Index] = NextSerial++;
+	++NumAgents;
+
+	// 新AI需要在本帧的结果中出现
+	Invalidate();
+
+	Handle.Index = Index;
+	Handle.Serial = AgentSerials[Index];
+	return Handle;
+}
+
+void UPlayerSnapshotSubsystem::UnregisterAgent(FPlayerSnapshotAgentHandle& Handle)
+{
+	if (IsAgentValid(Handle))
+	{
+		AgentActors[Handle.Index].Reset();
+		AgentSerials[Handle.Index] = 0;
+		FreeIndices.Add(Handle.Index);
+		--NumAgents;
+	}
+	Handle.Reset();
+}
+
+bool UPlayerSnapshotSubsystem::IsAgentValid(const FPlayerSnapshotAgentHandle& Handle) const
+{
+	return AgentSerials.IsValidIndex(Handle.Index) && Handle.Serial != 0 && AgentSerials[Handle.Index] == Handle.Serial;
+}
+
+void UPlayerSnapshotSubsystem::SetTrackedPlayer(APawn* InPlayer)
+{
+	TrackedPlayer = InPlayer;
+	Invalidate();
+}
+
+void UPlayerSnapshotSubsystem::PrepareFrame()
+{
+	check(IsInGameThread());
+
+	Refresh();
+	OnSnapshotPublished.Broadcast();
+}
+
+void UPlayerSnapshotSubsystem::HandleWorldPreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld == GetWorld())
+	{
+		PrepareFrame();
+	}
+}
+
+// === 读取 ===
+
+const FPlayerSnapshot& UPlayerSnapshotSubsystem::GetPlayerSnapshot()
+{
+	Refresh();
+	return Snapshot;
+}
+
+bool UPlayerSnapshotSubsystem::GetRelativeInfo(const FPlayerSnapshotAgentHandle& Handle, FPlayerRelativeInfo& OutInfo)
+{
+	if (!IsAgentValid(Handle))
+	{
+		return false;
+	}
+
+	Refresh();
+
+	// 其他线程不采集，本帧快照尚未发布时没有可用的结果
+	if (SnapshotFrame.load(std::memory_order_acquire) != GFrameCounter)
+	{
+		return false;
+	}
+
+	const int32 Index = Handle.Index;
+	OutInfo.Distance = Distances[Index];
+	OutInfo.HorizontalDistance = HorizontalDistances[Index];
+	OutInfo.HeightDifference = HeightDifferences[Index];
+	OutInfo.HorizontalAngle = HorizontalAngles[Index];
+	return true;
+}
+
+// === 采集和批量计算 ===
+
+void UPlayerSnapshotSubsystem::Refresh()
+{
+	// 采集会查找玩家Pawn和组件，只能在游戏线程上进行；其他线程只读取已发布的结果
+	if (!IsInGameThread())
+	{
+		return;
+	}
+
+	const uint64 FrameNumber = GFrameCounter;
+	if (SnapshotFrame.load(std::memory_order_relaxed) == FrameNumber)
+	{
+		return;
+	}
+
+	++NumRefreshes;
+
+	GatherPlayer();
+
+	// 采集AI的位置和水平正方向（已失效的槽位保持原值，结果不会被读取）
+	const int32 Num = AgentActors.Num();
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		if (const AActor* Agent = AgentActors[Index].Get())
+		{
+			const FVector Location = Agent->GetActorLocation();
+			const FVector Forward = Agent->GetActorForwardVector();
+			AgentX[Index] = Location.X;
+			AgentY[Index] = Location.Y;
+			AgentZ[Index] = Location.Z;
+			ForwardX[Index] = Forward.X;
+			ForwardY[Index] = Forward.Y;
+		}
+	}
+
+	ComputeRelativeInfo(Num);
+
+	// 结果全部写入后才发布帧号，其他线程看到本帧的帧号时才读取结果
+	SnapshotFrame.store(FrameNumber, std::memory_order_release);
+}
+
+void UPlayerSnapshotSubsystem::GatherPlayer()
+{
+	APawn* Player = TrackedPlayer.Get();
+	if (!Player)
+	{
+		Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	}
+
+	Snapshot.FrameNumber = GFrameCounter;
+	Snapshot.Player = Player;
+	Snapshot.bIsValid = Player != nullptr;
+	if (!Player)
+	{
+		// 保留最后已知位置，与GetPlayerInfo任务的行为一致
+		Snapshot.Velocity = FVector::ZeroVector;
+		return;
+	}
+
+	Snapshot.Location = Player->GetActorLocation();
+	Snapshot.Velocity = Player->GetVelocity();
+
+	if (const ACombatCharacter* CombatCharacter = Cast<ACombatCharacter>(Player))
+	{
+		Snapshot.CurrentHP = CombatCharacter->GetCurrentHP();
+		Snapshot.MaxHP = CombatCharacter->GetMaxHP();
+	}
+
+	// 元素组件只在玩家变化时查找
+	if (PlayerElementalComponentOwner.Get() != Player)
+	{
+		PlayerElementalComponentOwner = Player;
+		PlayerElementalComponent = Player->FindComponentByClass<UElementalComponent>();
+	}
+	const UElementalComponent* ElementalComponent = PlayerElementalComponent.Get();
+	Snapshot.Element = ElementalComponent ? ElementalComponent->GetCurrentElement() : EElementalType::None;
+}
+
+void UPlayerSnapshotSubsystem::ComputeRelativeInfo(int32 Num)
+{
+	const float PlayerX = static_cast<float>(Snapshot.Location.X);
+	const float PlayerY = static_cast<float>(Snapshot.Location.Y);
+	const float PlayerZ = static_cast<float>(Snapshot.Location.Z);
+
+	const float* RESTRICT InX = AgentX.GetData();
+	const float* RESTRICT InY = AgentY.GetData();
+	const float* RESTRICT InZ = AgentZ.GetData();
+	const float* RESTRICT InForwardX = ForwardX.GetData();
+	const float* RESTRICT InForwardY = ForwardY.GetData();
+	float* RESTRICT OutDistance = Distances.GetData();
+	float* RESTRICT OutHorizontalDistance = HorizontalDistances.GetData();
+	float* RESTRICT OutHeight = HeightDifferences.GetData();
+	float* RESTRICT OutAngle = HorizontalAngles.GetData();
+
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const float DeltaX = PlayerX - InX[i];
+		const float DeltaY = PlayerY - InY[i];
+		const float DeltaZ = PlayerZ - InZ[i];
+
+		const float HorizontalSquared = DeltaX * DeltaX + DeltaY * DeltaY;
+		const float HorizontalDistance = FMath::Sqrt(HorizontalSquared);
+		OutHorizontalDistance[i] = HorizontalDistance;
+		OutDistance[i] = FMath::Sqrt(HorizontalSquared + DeltaZ * DeltaZ);
+		OutHeight[i] = DeltaZ;
+
+		// 与FVector::Normalize一致：长度过小的向量视为零向量，此时点积为0（90度）
+		const float ForwardSquared = InForwardX[i] * InForwardX[i] + InForwardY[i] * InForwardY[i];
+		const float ForwardLength = FMath::Sqrt(ForwardSquared);
+		const float DirectionScale = HorizontalSquared > UE_SMALL_NUMBER ? 1.0f / HorizontalDistance : 0.0f;
+		const float ForwardScale = ForwardSquared > UE_SMALL_NUMBER ? 1.0f / ForwardLength : 0.0f;
+
+		const float Dot = (DeltaX * InForwardX[i] + DeltaY * InForwardY[i]) * DirectionScale * ForwardScale;
+		OutAngle[i] = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Dot, -1.0f, 1.0f)));
+	}
+}
@@ -0,0 +1,214 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Combat/Elemental/ElementalTypes.h"
+#include "Engine/EngineBaseTypes.h"
+#include <atomic>
+#include "PlayerSnapshotSubsystem.generated.h"
+
+class APawn;
+class UElementalComponent;
+
+/**
+ * 玩家状态快照
+ * 每帧只采集一次，所有AI共享
+ */
+struct ELEMENTALCOMBAT_API FPlayerSnapshot
+{
+	/** 玩家Pawn（玩家不存在时为空） */
+	TWeakObjectPtr<APawn> Player;
+
+	/** 玩家位置（玩家消失后保留最后已知位置） */
+	FVector Location = FVector::ZeroVector;
+
+	/** 玩家速度 */
+	FVector Velocity = FVector::ZeroVector;
+
+	/** 玩家当前元素 */
+	EElementalType Element = EElementalType::None;
+
+	/** 玩家当前生命值 */
+	float CurrentHP = 0.0f;
+
+	/** 玩家最大生命值 */
+	float MaxHP = 0.0f;
+
+	/** 采集时的帧号 */
+	uint64 FrameNumber = 0;
+
+	/** 本帧玩家是否存在 */
+	bool bIsValid = false;
+
+	/** 生命值百分比 [0.0 - 1.0] */
+	float GetHealthPercent() const { return MaxHP > 0.0f ? FMath::Clamp(CurrentHP / MaxHP, 0.0f, 1.0f) : 1.0f; }
+};
+
+/**
+ * AI相对于玩家的几何信息
+ */
+struct ELEMENTALCOMBAT_API FPlayerRelativeInfo
+{
+	/** 到玩家（最后已知位置）的距离 */
+	float Distance = 0.0f;
+
+	/** 到玩家的水平距离 */
+	float HorizontalDistance = 0.0f;
+
+	/** 玩家相对AI的高度差（玩家Z - AI Z） */
+	float HeightDifference = 0.0f;
+
+	/** AI正方向与玩家方向的水平夹角（0-180度） */
+	float HorizontalAngle = 0.0f;
+};
+
+/**
+ * 玩家快照中的AI句柄
+ * 由UPlayerSnapshotSubsystem分配，槽位复用后旧句柄自动失效
+ */
+struct ELEMENTALCOMBAT_API FPlayerSnapshotAgentHandle
+{
+	/** 槽位下标 */
+	int32 Index = INDEX_NONE;
+
+	/** 分配序号（用于检测槽位复用） */
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	void Reset()
+	{
+		Index = INDEX_NONE;
+		Serial = 0;
+	}
+};
+
+/** 本帧快照发布后广播（游戏线程，所有Actor Tick之前） */
+DECLARE_MULTICAST_DELEGATE(FOnPlayerSnapshotPublished);
+
+/**
+ * 玩家快照子系统
+ * 每帧在Actor Tick之前于游戏线程采集一次玩家状态（位置、速度、元素、生命值），并在一次批量计算中
+ * 得到所有已注册AI到玩家的距离、水平夹角和高度差，StateTree任务按句柄读取结果
+ * 替代每个AI每次Tick各自查找玩家Pawn并计算距离和Acos夹角
+ * 采集只在游戏线程进行：并行Tick的StateTree任务只读取已发布的结果，不会触发采集
+ */
+UCLASS()
+class ELEMENTALCOMBAT_API UPlayerSnapshotSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** 获取当前世界的子系统 */
+	static UPlayerSnapshotSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * 采集本帧快照并广播OnSnapshotPublished（只能在游戏线程调用）
+	 * 每帧Actor Tick之前自动调用；不经过世界Tick直接执行StateTree的场景（例如测试）需要手动调用
+	 */
+	void PrepareFrame();
+
+	/** 本帧快照发布后广播，AI控制器在此构建本帧的评分上下文 */
+	FOnPlayerSnapshotPublished OnSnapshotPublished;
+
+	// === AI注册 ===
+
+	/** 注册AI，返回的句柄用于读取相对信息 */
+	FPlayerSnapshotAgentHandle RegisterAgent(AActor* Agent);
+
+	/** 注销AI并重置句柄 */
+	void UnregisterAgent(FPlayerSnapshotAgentHandle& Handle);
+
+	/** 句柄是否仍然有效 */
+	bool IsAgentValid(const FPlayerSnapshotAgentHandle& Handle) const;
+
+	/** 已注册的AI数量 */
+	int32 GetNumAgents() const { return NumAgents; }
+
+	// === 读取（游戏线程上本帧尚未采集时先采集；其他线程只读取已发布的结果，可以在并行Tick的StateTree任务中调用） ===
+
+	/** 获取本帧的玩家快照（其他线程上读取到的是最近一次发布的快照，可用FrameNumber判断是否属于本帧） */
+	const FPlayerSnapshot& GetPlayerSnapshot();
+
+	/**
+	 * 获取AI相对于玩家的信息
+	 * @return 句柄无效，或在其他线程上读取而本帧快照尚未发布时返回false
+	 */
+	bool GetRelativeInfo(const FPlayerSnapshotAgentHandle& Handle, FPlayerRelativeInfo& OutInfo);
+
+	/** 强制在本帧重新采集（玩家或AI在帧内被传送后使用；不要在StateTree并行Tick期间调用） */
+	void Invalidate() { SnapshotFrame.store(MAX_uint64, std::memory_order_release); }
+
+	/**
+	 * 指定跟踪的玩家Pawn（默认跟踪0号本地玩家）
+	 * @param InPlayer 为空时恢复默认
+	 */
+	void SetTrackedPlayer(APawn* InPlayer);
+
+	/** 累计采集次数 */
+	uint64 GetNumRefreshes() const { return NumRefreshes; }
+
+private:
+	/** 本帧尚未采集时采集玩家状态并批量计算所有AI的相对信息（只在游戏线程上执行，其他线程调用时直接返回） */
+	void Refresh();
+
+	/** 世界Tick开始、Actor Tick之前发布本帧快照 */
+	void HandleWorldPreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	/** 采集玩家状态 */
+	void GatherPlayer();
+
+	/** 对连续数组批量计算相对信息（无分支，便于编译器向量化） */
+	void ComputeRelativeInfo(int32 Num);
+
+	/** 本帧的玩家快照 */
+	FPlayerSnapshot Snapshot;
+
+	/** 采集快照时的帧号（MAX_uint64表示需要重新采集；采集完成后才写入） */
+	std::atomic<uint64> SnapshotFrame{MAX_uint64};
+
+	/** 世界Tick前回调的句柄 */
+	FDelegateHandle PreActorTickHandle;
+
+	/** 指定跟踪的玩家 */
+	TWeakObjectPtr<APawn> TrackedPlayer;
+
+	/** 缓存的玩家元素组件（玩家变化时重新查找） */
+	TWeakObjectPtr<UElementalComponent> PlayerElementalComponent;
+
+	/** 元素组件对应的玩家 */
+	TWeakObjectPtr<APawn> PlayerElementalComponentOwner;
+
+	// === 按槽位排列的AI数据（结构数组布局） ===
+
+	TArray<TWeakObjectPtr<AActor>> AgentActors;
+	TArray<uint32> AgentSerials;
+	TArray<int32> FreeIndices;
+
+	/** AI位置和水平正方向（采集时写入） */
+	TArray<float> AgentX;
+	TArray<float> AgentY;
+	TArray<float> AgentZ;
+	TArray<float> ForwardX;
+	TArray<float> ForwardY;
+
+	/** 计算结果 */
+	TArray<float> Distances;
+	TArray<float> HorizontalDistances;
+	TArray<float> HeightDifferences;
+	TArray<float> HorizontalAngles;
+
+	/** 下一个分配序号 */
+	uint32 NextSerial = 1;
+
+	/** 当前注册的AI数量 */
+	int32 NumAgents = 0;
+
+	/** 累计采集次数 */
+	uint64 NumRefreshes = 0;
+};
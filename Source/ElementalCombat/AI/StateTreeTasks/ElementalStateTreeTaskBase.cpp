@@ -8,68 +8,188 @@
 #include "Engine/Engine.h"
 #include "DrawDebugHelpers.h"
 #include "AI/ElementalCombatEnemy.h"
+#include "AI/ElementalCombatAIController.h"
+#include "AI/Utility/UtilityAISubsystem.h"
+#include "AI/Utility/UtilityProfileRegistry.h"
+#include "AI/Utility/UtilityInputProviders.h"
 #include "EnvironmentQuery/EnvQuery.h"
 #include "EnvironmentQuery/EnvQueryManager.h"
 #include "Kismet/GameplayStatics.h"
+#include "Async/Async.h"
 
-// === Utility AI辅助函数实现 ===
+// === FElementalEQSRequestState 实现 ===
 
-FUtilityContext FElementalStateTreeTaskBase::CreateUtilityContext(const FStateTreeExecutionContext& Context) const
+FQueryFinishedSignature FElementalEQSRequestState::MakeCompletionDelegate(int32 QueryHash)
 {
-    FUtilityContext UtilityContext;
-    UtilityContext.CurrentTime = GetCurrentWorldTime(Context);
+    Completion = MakeShared<FElementalEQSQueryCompletion>();
+    PendingQueryHash = QueryHash;
 
-    // 获取基本对象
-    AElementalCombatEnemy* SelfEnemy = GetElementalCombatEnemy(Context);
-    AActor* Target = GetTargetActor(Context);
-
-    if (SelfEnemy)
+    // 只持有完成槽的弱引用：请求被替换或实例数据被释放后，迟到的回调自动失效
+    TWeakPtr<FElementalEQSQueryCompletion> WeakCompletion = Completion;
+    return FQueryFinishedSignature::CreateLambda([WeakCompletion](TSharedPtr<FEnvQueryResult> QueryResult)
     {
-        UtilityContext.SelfActor = SelfEnemy;
-        UtilityContext.HealthPercent = CalculateHealthPercent(SelfEnemy);
+        TSharedPtr<FElementalEQSQueryCompletion> PinnedCompletion = WeakCompletion.Pin();
+        if (!PinnedCompletion.IsValid())
+        {
+            return;
+        }
 
-        if (Target)
+        if (QueryResult.IsValid() && QueryResult->IsSuccessful())
         {
-            UtilityContext.TargetActor = Target;
-            UtilityContext.TargetHealthPercent = CalculateHealthPercent(Target);
-            UtilityContext.DistanceToTarget = CalculateDistance(SelfEnemy, Target);
-            UtilityContext.ElementAdvantage = CalculateElementAdvantage(SelfEnemy, Target);
-            UtilityContext.ThreatLevel = CalculateThreatLevel(SelfEnemy, Target);
+            QueryResult->GetAllAsLocations(PinnedCompletion->Locations);
+            PinnedCompletion->bSucceeded = PinnedCompletion->Locations.Num() > 0;
         }
+
+        // 结果写完后才发布结束标记
+        PinnedCompletion->bFinished.store(true, std::memory_order_release);
+    });
+}
+
+bool FElementalEQSRequestState::ConsumeCompletedQuery(float CurrentTime)
+{
+    if (!Completion.IsValid() || !Completion->bFinished.load(std::memory_order_acquire))
+    {
+        return false;
     }
 
+    const bool bSucceeded = Completion->bSucceeded;
+    if (bSucceeded)
+    {
+        Locations = MoveTemp(Completion->Locations);
+        BestLocation = Locations[0];
+        ResultTime = CurrentTime;
+        ResultQueryHash = PendingQueryHash;
+    }
+
+    ClearPendingQuery();
+    return bSucceeded;
+}
+
+void FElementalEQSRequestState::ClearPendingQuery()
+{
+    Completion.Reset();
+    RequestID = INDEX_NONE;
+    PendingQueryHash = 0;
+}
+
+TSharedPtr<FElementalEQSQueryCompletion> FElementalEQSRequestState::DetachPendingQuery()
+{
+    TSharedPtr<FElementalEQSQueryCompletion> Detached = Completion;
+    if (Detached.IsValid())
+    {
+        Detached->bCancelled.store(true, std::memory_order_relaxed);
+    }
+
+    ClearPendingQuery();
+    return Detached;
+}
+
+void FElementalEQSRequestState::Reset()
+{
+    ClearPendingQuery();
+    Locations.Empty();
+    BestLocation = FVector::ZeroVector;
+    ResultTime = -1.0f;
+    ResultQueryHash = 0;
+}
+
+// === FElementalTaskStatus 实现 ===
+
+FString FElementalTaskStatus::ToString() const
+{
+    switch (Code)
+    {
+    case EElementalTaskStatus::None:
+        return FString();
+    case EElementalTaskStatus::MeleeTooClose:
+        return FString::Printf(TEXT("近战AI - 距离过近 (%.1f <= %.1f)，等待移动"), Value0, Value1);
+    case EElementalTaskStatus::MeleeUsesRanged:
+        return FString::Printf(TEXT("近战AI - 在距离 %.1f 使用远程攻击"), Value0);
+    default:
+        return StaticEnum<EElementalTaskStatus>()->GetDisplayNameTextByValue(static_cast<int64>(Code)).ToString();
+    }
+}
+
+// === Utility AI辅助函数实现 ===
+
+FUtilityContext FElementalStateTreeTaskBase::CreateUtilityContext(const FStateTreeExecutionContext& Context) const
+{
+    return BuildUtilityContext(GetElementalCombatEnemy(Context), GetTargetActor(Context), GetCurrentWorldTime(Context));
+}
+
+const FUtilityContext* FElementalStateTreeTaskBase::GetFrameUtilityContext(const FStateTreeExecutionContext& Context, uint32 RequiredInputs) const
+{
+    if (const AElementalCombatAIController* AIController = Cast<AElementalCombatAIController>(GetAIController(Context)))
+    {
+        return AIController->GetFrameUtilityContext(RequiredInputs);
+    }
+
+    // 其他控制器没有快照，只在游戏线程上按旧方式采集
+    if (!IsInGameThread())
+    {
+        return nullptr;
+    }
+
+    static FUtilityContext FallbackContext;
+    FallbackContext = CreateUtilityContext(Context);
+    return &FallbackContext;
+}
+
+FUtilityContext FElementalStateTreeTaskBase::BuildUtilityContext(AElementalCombatEnemy* SelfEnemy, AActor* Target, float CurrentTime)
+{
+    FUtilityContext UtilityContext;
+    uint32 ComputedInputs = 0;
+    PopulateUtilityContext(UtilityContext, SelfEnemy, Target, CurrentTime, UtilityInputs::All, ComputedInputs);
     return UtilityContext;
 }
 
-float FElementalStateTreeTaskBase::CalculateUtilityScoreWithCache(const FUtilityProfile& Profile, const FUtilityContext& UtilityContext) const
+void FElementalStateTreeTaskBase::PopulateUtilityContext(FUtilityContext& InOutContext, AElementalCombatEnemy* SelfEnemy, AActor* Target, float CurrentTime,
+                                                         uint32 RequiredInputs, uint32& InOutComputedInputs)
 {
+    InOutContext.CurrentTime = CurrentTime;
+    InOutContext.SelfActor = SelfEnemy;
+    InOutContext.TargetActor = SelfEnemy ? Target : nullptr;
+
+    FUtilityInputQuery Query;
+    Query.Self = SelfEnemy;
+    Query.Target = Target;
+    Query.CurrentTime = CurrentTime;
+    FUtilityInputProviderRegistry::Get().Populate(Query, RequiredInputs, InOutContext, InOutComputedInputs);
+}
+
+float FElementalStateTreeTaskBase::CalculateUtilityScoreWithCache(FElementalStateTreeInstanceDataBase& InstanceData, const FUtilityProfileHandle& ProfileHandle, const FUtilityContext& UtilityContext) const
+{
+    if (!ProfileHandle.IsValid())
+    {
+        return 0.0f;
+    }
+
+    const FUtilityProfile& Profile = ProfileHandle.GetProfile();
     if (!bUseUtilityCache)
     {
         return CalculateUtilityScoreDirect(Profile, UtilityContext);
     }
 
-    int32 ContextHash = CalculateUtilityContextHash(UtilityContext);
+    FUtilityScoreCache& UtilityScoreCache = InstanceData.UtilityScoreCache;
+    ConfigureUtilityCache(UtilityScoreCache);
 
-    // 检查缓存
-    const float* CachedScore = UtilityCache.Find(ContextHash);
-    const float* CachedTimestamp = UtilityCacheTimestamps.Find(ContextHash);
+    // 标识在创建共享配置时已计算，查找时不再逐项哈希配置文件
+    const uint32 ProfileIdentity = ProfileHandle.GetIdentity();
 
-    if (CachedScore && CachedTimestamp)
+    // 检查缓存
+    float CachedScore = 0.0f;
+    if (UtilityScoreCache.Find(ProfileIdentity, UtilityContext, CachedScore))
     {
-        if ((UtilityContext.CurrentTime - *CachedTimestamp) <= UtilityCacheValidDuration)
+        if (bEnableDebugOutput)
         {
-            if (bEnableDebugOutput)
-            {
-                LogDebug(FString::Printf(TEXT("使用缓存的效用评分：%.3f"), *CachedScore));
-            }
-            return *CachedScore;
+            LogDebug(FString::Printf(TEXT("使用缓存的效用评分：%.3f"), CachedScore));
         }
+        return CachedScore;
     }
 
     // 计算新评分并缓存
     float NewScore = CalculateUtilityScoreDirect(Profile, UtilityContext);
-    UtilityCache.Add(ContextHash, NewScore);
-    UtilityCacheTimestamps.Add(ContextHash, UtilityContext.CurrentTime);
+    UtilityScoreCache.Add(ProfileIdentity, UtilityContext, NewScore);
 
     if (bEnableDebugOutput)
     {
@@ -79,6 +199,69 @@ float FElementalStateTreeTaskBase::CalculateUtilityScoreWithCache(const FUtility
     return NewScore;
 }
 
+float FElementalStateTreeTaskBase::CalculateUtilityScoreWithCache(FElementalStateTreeInstanceDataBase& InstanceData, const FUtilityWeightOverlay& Overlay, const FUtilityContext& UtilityContext) const
+{
+    if (!bUseUtilityCache)
+    {
+        return Overlay.CalculateScore(UtilityContext);
+    }
+
+    FUtilityScoreCache& UtilityScoreCache = InstanceData.UtilityScoreCache;
+    ConfigureUtilityCache(UtilityScoreCache);
+
+    float CachedScore = 0.0f;
+    if (UtilityScoreCache.Find(Overlay.Identity, UtilityContext, CachedScore))
+    {
+        return CachedScore;
+    }
+
+    const float NewScore = Overlay.CalculateScore(UtilityContext);
+    UtilityScoreCache.Add(Overlay.Identity, UtilityContext, NewScore);
+    return NewScore;
+}
+
+void FElementalStateTreeTaskBase::CalculateUtilityScoresWithCache(FElementalStateTreeInstanceDataBase& InstanceData, TConstArrayView<const FUtilityWeightOverlay*> Overlays,
+                                                                  const FUtilityContext& UtilityContext, TArrayView<float> OutScores) const
+{
+    check(OutScores.Num() == Overlays.Num());
+
+    if (!bUseUtilityCache)
+    {
+        FUtilityWeightOverlay::CalculateScores(Overlays, UtilityContext, OutScores);
+        return;
+    }
+
+    FUtilityScoreCache& UtilityScoreCache = InstanceData.UtilityScoreCache;
+    ConfigureUtilityCache(UtilityScoreCache);
+
+    // 只对未命中的视图评分
+    TArray<const FUtilityWeightOverlay*, TInlineAllocator<4>> Misses;
+    TArray<int32, TInlineAllocator<4>> MissIndices;
+    for (int32 i = 0; i < Overlays.Num(); ++i)
+    {
+        if (!UtilityScoreCache.Find(Overlays[i]->Identity, UtilityContext, OutScores[i]))
+        {
+            Misses.Add(Overlays[i]);
+            MissIndices.Add(i);
+        }
+    }
+
+    if (Misses.Num() == 0)
+    {
+        return;
+    }
+
+    TArray<float, TInlineAllocator<4>> MissScores;
+    MissScores.SetNumUninitialized(Misses.Num());
+    FUtilityWeightOverlay::CalculateScores(Misses, UtilityContext, MissScores);
+
+    for (int32 i = 0; i < Misses.Num(); ++i)
+    {
+        OutScores[MissIndices[i]] = MissScores[i];
+        UtilityScoreCache.Add(Misses[i]->Identity, UtilityContext, MissScores[i]);
+    }
+}
+
 float FElementalStateTreeTaskBase::CalculateUtilityScoreDirect(const FUtilityProfile& Profile, const FUtilityContext& UtilityContext) const
 {
     return Profile.CalculateScore(UtilityContext);
@@ -89,205 +272,271 @@ float FElementalStateTreeTaskBase::GetBetterUtilityScore(const float& ScoreA, co
     return FMath::Max(ScoreA, ScoreB);
 }
 
+const FUtilityScoreResult* FElementalStateTreeTaskBase::GetSubsystemUtilityResult(AElementalCombatAIController* AIController, float MaxResultAge) const
+{
+    // 子系统只能在游戏线程访问，并行Tick时由调用方在本地评分
+    if (!AIController || !IsInGameThread())
+    {
+        return nullptr;
+    }
+
+    UUtilityAISubsystem* UtilitySubsystem = UUtilityAISubsystem::Get(AIController);
+    const FUtilityScoreRequestHandle& Request = AIController->GetUtilityScoreRequest();
+    if (!UtilitySubsystem || !UtilitySubsystem->IsRequestValid(Request))
+    {
+        return nullptr;
+    }
+
+    // 结果过旧或尚未评分时同步评分一次，否则直接读取分片调度的结果
+    const double ResultAge = UtilitySubsystem->GetResultAge(Request);
+    if (ResultAge < 0.0 || (MaxResultAge >= 0.0f && ResultAge > MaxResultAge))
+    {
+        if (bEnableDebugOutput)
+        {
+            LogDebug(FString::Printf(TEXT("子系统评分结果已过期（%.3f秒），立即重新评分"), ResultAge));
+        }
+        return UtilitySubsystem->EvaluateNow(Request);
+    }
+
+    return UtilitySubsystem->GetResult(Request);
+}
+
 // === EQS查询辅助函数实现 ===
 
-void FElementalStateTreeTaskBase::ExecuteEQSQuery(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context, 
-                                                  FOnEQSRequestComplete OnComplete) const
+int32 FElementalStateTreeTaskBase::ExecuteEQSQuery(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context,
+                                                   FElementalEQSRequestState& RequestState) const
 {
     if (!QueryTemplate)
     {
         LogDebug(TEXT("执行EQS查询：查询模板为空"));
-        return;
+        return INDEX_NONE;
     }
 
     AAIController* Controller = GetAIController(Context);
     if (!Controller)
     {
         LogDebug(TEXT("执行EQS查询：未找到AI控制器"));
-        return;
+        return INDEX_NONE;
     }
 
-    UWorld* World = Controller->GetWorld();
-    if (!World)
+    APawn* QueryPawn = Controller->GetPawn();
+    if (!QueryPawn)
     {
-        LogDebug(TEXT("执行EQS查询：未找到世界"));
-        return;
+        LogDebug(TEXT("执行EQS查询：未找到Pawn"));
+        return INDEX_NONE;
     }
 
-    // 获取环境查询管理器
-    UEnvQueryManager* EQSManager = UEnvQueryManager::GetCurrent(World);
-    if (!EQSManager)
+    if (bEnableDebugOutput)
     {
-        LogDebug(TEXT("执行EQS查询：未找到EQS管理器"));
-        return;
+        LogDebug(FString::Printf(TEXT("正在执行EQS查询：%s"), *QueryTemplate->GetName()));
     }
 
-    APawn* QueryPawn = Controller->GetPawn();
-    if (!QueryPawn)
+    // 替换旧请求前先中止它，避免两个查询同时占用EQS预算
+    CancelEQSQuery(Context, RequestState);
+
+    const int32 QueryHash = static_cast<int32>(GetTypeHash(MakeEQSCacheKey(QueryTemplate, Context)));
+    FQueryFinishedSignature OnQueryFinished = RequestState.MakeCompletionDelegate(QueryHash);
+
+    // EQS管理器只能在游戏线程访问，并行Tick时交给游戏线程启动，结果照常写入完成槽
+    if (!IsInGameThread())
     {
-        LogDebug(TEXT("执行EQS查询：未找到Pawn"));
-        return;
+        RequestState.RequestID = FElementalEQSRequestState::QueuedRequestID;
+        AsyncTask(ENamedThreads::GameThread, [WeakTemplate = TWeakObjectPtr<UEnvQuery>(QueryTemplate), WeakPawn = TWeakObjectPtr<APawn>(QueryPawn),
+                                              WeakCompletion = RequestState.GetPendingCompletion(), OnQueryFinished = MoveTemp(OnQueryFinished)]() mutable
+        {
+            const TSharedPtr<FElementalEQSQueryCompletion> PinnedCompletion = WeakCompletion.Pin();
+            if (!PinnedCompletion.IsValid() || PinnedCompletion->bCancelled.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            UEnvQuery* Template = WeakTemplate.Get();
+            APawn* Pawn = WeakPawn.Get();
+            const int32 QueuedQueryID = Template && Pawn && UEnvQueryManager::GetCurrent(Pawn)
+                ? FEnvQueryRequest(Template, Pawn).Execute(EEnvQueryRunMode::AllMatching, OnQueryFinished)
+                : INDEX_NONE;
+
+            // 启动失败时按失败的查询结束，任务在下一次Tick时取走
+            if (QueuedQueryID == INDEX_NONE)
+            {
+                PinnedCompletion->bFinished.store(true, std::memory_order_release);
+                return;
+            }
+            PinnedCompletion->QueryID.store(QueuedQueryID, std::memory_order_relaxed);
+        });
+        return FElementalEQSRequestState::QueuedRequestID;
     }
 
-    if (bEnableDebugOutput)
+    // 获取环境查询管理器
+    if (!UEnvQueryManager::GetCurrent(QueryPawn))
     {
-        LogDebug(FString::Printf(TEXT("正在执行EQS查询：%s"), *QueryTemplate->GetName()));
+        RequestState.ClearPendingQuery();
+        LogDebug(TEXT("执行EQS查询：未找到EQS管理器"));
+        return INDEX_NONE;
     }
 
-    // 创建并执行EQS查询
+    // 创建并执行异步EQS查询，由EQS管理器在每帧时间预算内分片执行
     FEnvQueryRequest QueryRequest(QueryTemplate, QueryPawn);
-
-    // 使用委托方式执行异步查询
-    FQueryFinishedSignature QueryFinishedDelegate;
-    QueryFinishedDelegate.BindLambda([this](TSharedPtr<FEnvQueryResult> QueryResult)
+    const int32 QueryID = QueryRequest.Execute(EEnvQueryRunMode::AllMatching, OnQueryFinished);
+    if (QueryID == INDEX_NONE)
     {
-        OnEQSQueryCompleted(QueryResult);
-    });
+        RequestState.ClearPendingQuery();
+        LogDebug(TEXT("执行EQS查询：启动失败"));
+        return INDEX_NONE;
+    }
 
-    int32 QueryID = QueryRequest.Execute(EEnvQueryRunMode::AllMatching, QueryFinishedDelegate);
+    RequestState.RequestID = QueryID;
 
     if (bEnableDebugOutput)
     {
         LogDebug(FString::Printf(TEXT("EQS查询已启动，ID：%d"), QueryID));
     }
+
+    return QueryID;
 }
 
-bool FElementalStateTreeTaskBase::ExecuteEQSQueryWithCache(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context,
-                                                          TArray<FVector>& OutLocations, FVector& OutBestLocation) const
+bool FElementalStateTreeTaskBase::RequestEQSQueryAsync(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context,
+                                                       FElementalEQSRequestState& RequestState, bool bAllowNewQuery) const
 {
     if (!QueryTemplate)
     {
         return false;
     }
 
-    int32 QueryHash = CalculateEQSQueryHash(QueryTemplate, Context);
-    float CurrentTime = GetCurrentWorldTime(Context);
+    const float CurrentTime = GetCurrentWorldTime(Context);
+    const FEQSResultCacheKey CacheKey = MakeEQSCacheKey(QueryTemplate, Context);
+    const int32 QueryHash = static_cast<int32>(GetTypeHash(CacheKey));
 
-    // 检查缓存
-    if (bUseEQSCache && IsEQSCacheValid(QueryHash, CurrentTime))
+    // 取走已结束的查询结果
+    if (RequestState.ConsumeCompletedQuery(CurrentTime))
     {
-        const FEQSQueryCache& Cache = EQSCache[QueryHash];
-        OutLocations = Cache.CachedLocations;
-        OutBestLocation = Cache.BestLocation;
+        // 查询期间仍在同一网格内时才共享给附近的AI
+        if (RequestState.ResultQueryHash == QueryHash)
+        {
+            UpdateEQSCache(Context, CacheKey, RequestState.Locations, CurrentTime);
+        }
 
         if (bEnableDebugOutput)
         {
-            LogDebug(FString::Printf(TEXT("使用缓存的EQS结果：%d 个位置"), OutLocations.Num()));
+            LogDebug(FString::Printf(TEXT("EQS查询完成：找到 %d 个位置"), RequestState.Locations.Num()));
         }
-
-        return Cache.bIsValid;
     }
 
-    // 执行同步EQS查询
-    AAIController* Controller = GetAIController(Context);
-    if (!Controller)
+    if (!RequestState.IsResultFresh(QueryHash, CurrentTime, EQSCacheValidDuration))
     {
-        LogDebug(TEXT("执行EQS查询缓存：未找到AI控制器"));
-        return false;
+        // 附近的AI刚查询过相同的条件时直接复制到请求状态的位置数组（复用其内存）
+        float CacheTimestamp = 0.0f;
+        if (FindEQSCache(Context, CacheKey, CurrentTime, RequestState.Locations, CacheTimestamp))
+        {
+            RequestState.BestLocation = RequestState.Locations[0];
+            RequestState.ResultTime = CacheTimestamp;
+            RequestState.ResultQueryHash = QueryHash;
+        }
+        else if (bAllowNewQuery && !RequestState.IsInFlight() && IsEQSAllowedByLOD(Context))
+        {
+            ExecuteEQSQuery(QueryTemplate, Context, RequestState);
+        }
     }
 
-    UWorld* World = Controller->GetWorld();
-    if (!World)
+    // 新查询进行期间返回上次的结果
+    return RequestState.HasResult();
+}
+
+bool FElementalStateTreeTaskBase::RequestEQSQueryAsync(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context,
+                                                       FElementalEQSRequestState& RequestState,
+                                                       TArray<FVector>& OutLocations, FVector& OutBestLocation) const
+{
+    if (!RequestEQSQueryAsync(QueryTemplate, Context, RequestState))
     {
-        LogDebug(TEXT("执行EQS查询缓存：未找到世界"));
         return false;
     }
 
-    UEnvQueryManager* EQSManager = UEnvQueryManager::GetCurrent(World);
-    if (!EQSManager)
+    OutLocations = RequestState.Locations;
+    OutBestLocation = RequestState.BestLocation;
+    return true;
+}
+
+bool FElementalStateTreeTaskBase::IsEQSAllowedByLOD(const FStateTreeExecutionContext& Context) const
+{
+    const AElementalCombatAIController* AIController = Cast<AElementalCombatAIController>(GetAIController(Context));
+    return !AIController || AIController->IsEQSAllowed();
+}
+
+void FElementalStateTreeTaskBase::CancelEQSQuery(const FStateTreeExecutionContext& Context, FElementalEQSRequestState& RequestState) const
+{
+    if (!RequestState.IsInFlight())
     {
-        LogDebug(TEXT("执行EQS查询缓存：未找到EQS管理器"));
-        return false;
+        return;
     }
 
-    APawn* QueryPawn = Controller->GetPawn();
-    if (!QueryPawn)
+    if (bEnableDebugOutput)
     {
-        LogDebug(TEXT("执行EQS查询缓存：未找到Pawn"));
-        return false;
+        LogDebug(FString::Printf(TEXT("EQS查询已中止，ID：%d"), RequestState.RequestID));
     }
 
-    // 创建并执行同步EQS查询
-    FEnvQueryRequest QueryRequest(QueryTemplate, QueryPawn);
-    TSharedPtr<FEnvQueryResult> QueryResult = EQSManager->RunInstantQuery(QueryRequest, EEnvQueryRunMode::AllMatching);
-
-    OutLocations.Empty();
-    bool bQuerySuccessful = false;
-
-    if (QueryResult.IsValid() && QueryResult->IsSuccessful())
+    // 排队中的查询不再启动；已由游戏线程启动的查询ID记录在完成槽中
+    const int32 RequestID = RequestState.RequestID;
+    TSharedPtr<FElementalEQSQueryCompletion> Completion = RequestState.DetachPendingQuery();
+    auto AbortQuery = [WeakOwner = TWeakObjectPtr<UObject>(Context.GetOwner()), RequestID, Completion = MoveTemp(Completion)]()
     {
-        QueryResult->GetAllAsLocations(OutLocations);
-        bQuerySuccessful = OutLocations.Num() > 0;
-
-        if (bQuerySuccessful)
+        const int32 QueryID = RequestID != FElementalEQSRequestState::QueuedRequestID ? RequestID
+            : (Completion.IsValid() ? Completion->QueryID.load(std::memory_order_relaxed) : INDEX_NONE);
+        UEnvQueryManager* EQSManager = UEnvQueryManager::GetCurrent(WeakOwner.Get());
+        if (EQSManager && QueryID != INDEX_NONE)
         {
-            OutBestLocation = OutLocations[0];
-
-            // 更新缓存
-            if (bUseEQSCache)
-            {
-                UpdateEQSCache(QueryHash, OutLocations, OutBestLocation, CurrentTime);
-            }
-
-            if (bEnableDebugOutput)
-            {
-                LogDebug(FString::Printf(TEXT("EQS查询完成：找到 %d 个位置"), OutLocations.Num()));
-            }
+            EQSManager->AbortQuery(QueryID);
         }
+    };
+
+    // EQS管理器只能在游戏线程访问，并行Tick时交给游戏线程中止
+    if (IsInGameThread())
+    {
+        AbortQuery();
     }
     else
     {
-        if (bEnableDebugOutput)
-        {
-            LogDebug(TEXT("EQS查询失败或无结果"));
-        }
+        AsyncTask(ENamedThreads::GameThread, MoveTemp(AbortQuery));
     }
-
-    return bQuerySuccessful;
 }
 
-int32 FElementalStateTreeTaskBase::CalculateEQSQueryHash(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context) const
+FEQSResultCacheKey FElementalStateTreeTaskBase::MakeEQSCacheKey(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context) const
 {
-    int32 Hash = 0;
-
-    if (QueryTemplate)
+    // 查询者和目标按网格量化，同一网格内的AI共用查询结果
+    FVector QuerierLocation = FVector::ZeroVector;
+    if (const AElementalCombatEnemy* Enemy = GetElementalCombatEnemy(Context))
     {
-        Hash = HashCombine(Hash, GetTypeHash(QueryTemplate));
+        QuerierLocation = Enemy->GetActorLocation();
     }
 
-    // 包含当前位置信息
-    AElementalCombatEnemy* Enemy = GetElementalCombatEnemy(Context);
-    if (Enemy)
+    const AActor* Target = GetTargetActor(Context);
+    const FVector TargetLocation = Target ? Target->GetActorLocation() : FVector::ZeroVector;
+
+    return FEQSResultCacheKey::Make(QueryTemplate, QuerierLocation, Target ? &TargetLocation : nullptr, EQSCacheCellSize);
+}
+
+void FElementalStateTreeTaskBase::UpdateEQSCache(const FStateTreeExecutionContext& Context, const FEQSResultCacheKey& Key, const TArray<FVector>& Locations, float CurrentTime) const
+{
+    if (!bUseEQSCache)
     {
-        FVector Location = Enemy->GetActorLocation();
-        Hash = HashCombine(Hash, GetTypeHash(Location.X));
-        Hash = HashCombine(Hash, GetTypeHash(Location.Y));
+        return;
     }
 
-    // 包含目标信息
-    AActor* Target = GetTargetActor(Context);
-    if (Target)
+    if (UEQSResultCacheSubsystem* CacheSubsystem = UEQSResultCacheSubsystem::Get(Context.GetOwner()))
     {
-        Hash = HashCombine(Hash, GetTypeHash(Target));
+        CacheSubsystem->Add(Key, Locations, CurrentTime, EQSCacheValidDuration);
     }
-
-    return Hash;
 }
 
-void FElementalStateTreeTaskBase::UpdateEQSCache(int32 QueryHash, const TArray<FVector>& Locations, FVector BestLocation, float CurrentTime) const
+bool FElementalStateTreeTaskBase::FindEQSCache(const FStateTreeExecutionContext& Context, const FEQSResultCacheKey& Key, float CurrentTime,
+                                               TArray<FVector>& OutLocations, float& OutTimestamp) const
 {
-    FEQSQueryCache& Cache = EQSCache.FindOrAdd(QueryHash);
-    Cache.CachedLocations = Locations;
-    Cache.BestLocation = BestLocation;
-    Cache.CacheTimestamp = CurrentTime;
-    Cache.QueryHash = QueryHash;
-    Cache.bIsValid = Locations.Num() > 0;
-}
+    if (!bUseEQSCache)
+    {
+        return false;
+    }
 
-bool FElementalStateTreeTaskBase::IsEQSCacheValid(int32 QueryHash, float CurrentTime) const
-{
-    const FEQSQueryCache* Cache = EQSCache.Find(QueryHash);
-    return Cache && !Cache->IsExpired(CurrentTime, EQSCacheValidDuration);
+    UEQSResultCacheSubsystem* CacheSubsystem = UEQSResultCacheSubsystem::Get(Context.GetOwner());
+    return CacheSubsystem && CacheSubsystem->Find(Key, CurrentTime, EQSCacheValidDuration, OutLocations, OutTimestamp);
 }
 
 // === 数据获取辅助函数实现 ===
@@ -344,7 +593,7 @@ float FElementalStateTreeTaskBase::GetCurrentWorldTime(const FStateTreeExecution
     return 0.0f;
 }
 
-float FElementalStateTreeTaskBase::CalculateDistance(AActor* ActorA, AActor* ActorB) const
+float FElementalStateTreeTaskBase::CalculateDistance(AActor* ActorA, AActor* ActorB)
 {
     if (!ActorA || !ActorB)
     {
@@ -354,7 +603,7 @@ float FElementalStateTreeTaskBase::CalculateDistance(AActor* ActorA, AActor* Act
     return FVector::Distance(ActorA->GetActorLocation(), ActorB->GetActorLocation());
 }
 
-float FElementalStateTreeTaskBase::CalculateHealthPercent(AActor* Actor) const
+float FElementalStateTreeTaskBase::CalculateHealthPercent(AActor* Actor)
 {
     if (!Actor)
     {
@@ -372,7 +621,7 @@ float FElementalStateTreeTaskBase::CalculateHealthPercent(AActor* Actor) const
     return 1.0f;
 }
 
-float FElementalStateTreeTaskBase::CalculateElementAdvantage(const AElementalCombatEnemy* Self, const AActor* Target) const
+float FElementalStateTreeTaskBase::CalculateElementAdvantage(const AElementalCombatEnemy* Self, const AActor* Target)
 {
     if (!Self || !Target)
     {
@@ -386,7 +635,7 @@ float FElementalStateTreeTaskBase::CalculateElementAdvantage(const AElementalCom
     return 0.0f;
 }
 
-float FElementalStateTreeTaskBase::CalculateThreatLevel(const AElementalCombatEnemy* Self, const AActor* Target) const
+float FElementalStateTreeTaskBase::CalculateThreatLevel(const AElementalCombatEnemy* Self, const AActor* Target)
 {
     if (!Self || !Target)
     {
@@ -414,6 +663,14 @@ void FElementalStateTreeTaskBase::LogDebug(const FString& Message) const
     }
 }
 
+void FElementalStateTreeTaskBase::LogDebug(const TCHAR* Message) const
+{
+    if (bEnableDebugOutput)
+    {
+        UE_LOG(LogTemp, Log, TEXT("ElementalStateTree: %s"), Message);
+    }
+}
+
 void FElementalStateTreeTaskBase::DisplayDebugMessage(const FString& Message) const
 {
     if (bEnableDebugOutput && GEngine)
@@ -443,164 +700,75 @@ void FElementalStateTreeTaskBase::DrawDebugLine(const UWorld* World, const FVect
 
 // === 缓存管理函数实现 ===
 
-void FElementalStateTreeTaskBase::ClearAllCaches() const
-{
-    ClearEQSCache();
-    ClearUtilityCache();
-}
-
-void FElementalStateTreeTaskBase::ClearEQSCache() const
+void FElementalStateTreeTaskBase::ClearAllCaches(FElementalStateTreeInstanceDataBase& InstanceData) const
 {
-    EQSCache.Empty();
-    if (bEnableDebugOutput)
-    {
-        LogDebug(TEXT("EQS缓存已清理"));
-    }
+    ClearUtilityCache(InstanceData);
 }
 
-void FElementalStateTreeTaskBase::ClearUtilityCache() const
+void FElementalStateTreeTaskBase::ClearUtilityCache(FElementalStateTreeInstanceDataBase& InstanceData) const
 {
-    UtilityCache.Empty();
-    UtilityCacheTimestamps.Empty();
+    InstanceData.UtilityScoreCache.Empty();
     if (bEnableDebugOutput)
     {
         LogDebug(TEXT("效用缓存已清理"));
     }
 }
 
-void FElementalStateTreeTaskBase::ClearExpiredCaches(float CurrentTime) const
-{
-    // 清除过期的EQS缓存
-    TArray<int32> ExpiredEQSKeys;
-    for (const auto& Pair : EQSCache)
-    {
-        if (Pair.Value.IsExpired(CurrentTime, EQSCacheValidDuration))
-        {
-            ExpiredEQSKeys.Add(Pair.Key);
-        }
-    }
-    for (int32 Key : ExpiredEQSKeys)
-    {
-        EQSCache.Remove(Key);
-    }
-
-    // 清除过期的Utility缓存
-    TArray<int32> ExpiredUtilityKeys;
-    for (const auto& Pair : UtilityCacheTimestamps)
-    {
-        if ((CurrentTime - Pair.Value) > UtilityCacheValidDuration)
-        {
-            ExpiredUtilityKeys.Add(Pair.Key);
-        }
-    }
-    for (int32 Key : ExpiredUtilityKeys)
-    {
-        UtilityCache.Remove(Key);
-        UtilityCacheTimestamps.Remove(Key);
-    }
-
-    if (bEnableDebugOutput && (ExpiredEQSKeys.Num() > 0 || ExpiredUtilityKeys.Num() > 0))
-    {
-        LogDebug(FString::Printf(TEXT("已清理 %d 个过期EQS缓存和 %d 个过期效用缓存"),
-                                ExpiredEQSKeys.Num(), ExpiredUtilityKeys.Num()));
-    }
-}
-
-int32 FElementalStateTreeTaskBase::CalculateUtilityContextHash(const FUtilityContext& Context) const
+void FElementalStateTreeTaskBase::ClearExpiredCaches(FElementalStateTreeInstanceDataBase& InstanceData, float CurrentTime) const
 {
-    int32 Hash = 0;
-    
-    Hash = HashCombine(Hash, GetTypeHash(Context.DistanceToTarget));
-    Hash = HashCombine(Hash, GetTypeHash(Context.HealthPercent));
-    Hash = HashCombine(Hash, GetTypeHash(Context.TargetHealthPercent));
-    Hash = HashCombine(Hash, GetTypeHash(Context.ThreatLevel));
-    Hash = HashCombine(Hash, GetTypeHash(Context.ElementAdvantage));
-
-    if (Context.TargetActor.IsValid())
-    {
-        Hash = HashCombine(Hash, GetTypeHash(Context.TargetActor.Get()));
-    }
+    // 清除过期的Utility缓存（共享EQS缓存在查找和写入时自行清理）
+    ConfigureUtilityCache(InstanceData.UtilityScoreCache);
+    const int32 NumExpiredUtility = InstanceData.UtilityScoreCache.RemoveExpired(CurrentTime);
 
-    // 包含自定义值
-    for (const auto& Pair : Context.CustomValues)
+    if (bEnableDebugOutput && NumExpiredUtility > 0)
     {
-        Hash = HashCombine(Hash, GetTypeHash(Pair.Key));
-        Hash = HashCombine(Hash, GetTypeHash(Pair.Value));
+        LogDebug(FString::Printf(TEXT("已清理 %d 个过期效用缓存"), NumExpiredUtility));
     }
-
-    return Hash;
 }
 
-void FElementalStateTreeTaskBase::OnEQSQueryCompleted(TSharedPtr<FEnvQueryResult> QueryResult) const
+void FElementalStateTreeTaskBase::ConfigureUtilityCache(FUtilityScoreCache& Cache) const
 {
-    if (bEnableDebugOutput)
-    {
-        if (QueryResult.IsValid())
-        {
-            if (QueryResult->IsSuccessful())
-            {
-                TArray<FVector> ResultLocations;
-                QueryResult->GetAllAsLocations(ResultLocations);
-                LogDebug(FString::Printf(TEXT("EQS查询成功完成：%d 个结果"), ResultLocations.Num()));
-            }
-            else
-            {
-                LogDebug(TEXT("EQS查询已完成但失败"));
-            }
-        }
-        else
-        {
-            LogDebug(TEXT("EQS查询完成但结果无效"));
-        }
-    }
-
-    // TODO: 处理查询结果（如果需要特殊处理）
+    FUtilityScoreCache::FConfig CacheConfig;
+    CacheConfig.Capacity = UtilityCacheCapacity;
+    CacheConfig.ValidDuration = UtilityCacheValidDuration;
+    CacheConfig.DistanceBucket = UtilityCacheDistanceBucket;
+    CacheConfig.InputBucket = UtilityCacheInputBucket;
+    Cache.Configure(CacheConfig);
 }
 
 // === 性能监控接口实现 ===
 
-FString FElementalStateTreeTaskBase::GetEQSCacheStats() const
+FString FElementalStateTreeTaskBase::GetEQSCacheStats(const UObject* WorldContextObject) const
 {
-    int32 ValidCaches = 0;
-    int32 TotalCaches = EQSCache.Num();
-    float CurrentTime = 0.0f; // 需要从某处获取当前时间
-
-    for (const auto& Pair : EQSCache)
+    const UEQSResultCacheSubsystem* CacheSubsystem = UEQSResultCacheSubsystem::Get(WorldContextObject);
+    if (!CacheSubsystem)
     {
-        if (!Pair.Value.IsExpired(CurrentTime, EQSCacheValidDuration))
-        {
-            ValidCaches++;
-        }
+        return TEXT("EQS Cache: unavailable");
     }
 
-    return FString::Printf(TEXT("EQS Cache: %d/%d valid (%.1f%%)"), 
-                          ValidCaches, TotalCaches, 
-                          TotalCaches > 0 ? (ValidCaches * 100.0f / TotalCaches) : 0.0f);
+    const FEQSResultCacheStats CacheStats = CacheSubsystem->GetStats();
+
+    return FString::Printf(TEXT("EQS Cache: %d/%d entries, %llu hits, %llu misses (%.1f%% hit rate), %llu evictions, %llu expirations, %llu invalidations, %.1f KB"),
+                          CacheStats.NumEntries, CacheStats.Capacity,
+                          CacheStats.Hits, CacheStats.Misses, CacheStats.GetHitRate() * 100.0f,
+                          CacheStats.Evictions, CacheStats.Expirations, CacheStats.Invalidations,
+                          CacheStats.MemoryBytes / 1024.0f);
 }
 
-FString FElementalStateTreeTaskBase::GetUtilityCacheStats() const
+FString FElementalStateTreeTaskBase::GetUtilityCacheStats(const FElementalStateTreeInstanceDataBase& InstanceData) const
 {
-    int32 ValidCaches = 0;
-    int32 TotalCaches = UtilityCache.Num();
-    float CurrentTime = 0.0f; // 需要从某处获取当前时间
-
-    for (const auto& Pair : UtilityCacheTimestamps)
-    {
-        if ((CurrentTime - Pair.Value) <= UtilityCacheValidDuration)
-        {
-            ValidCaches++;
-        }
-    }
+    const FUtilityScoreCacheStats CacheStats = InstanceData.UtilityScoreCache.GetStats();
 
-    return FString::Printf(TEXT("Utility Cache: %d/%d valid (%.1f%%)"), 
-                          ValidCaches, TotalCaches,
-                          TotalCaches > 0 ? (ValidCaches * 100.0f / TotalCaches) : 0.0f);
+    return FString::Printf(TEXT("Utility Cache: %d/%d entries, %llu hits, %llu misses (%.1f%% hit rate), %llu evictions, %llu expirations"),
+                          CacheStats.NumEntries, CacheStats.Capacity,
+                          CacheStats.Hits, CacheStats.Misses, CacheStats.GetHitRate() * 100.0f,
+                          CacheStats.Evictions, CacheStats.Expirations);
 }
 
-FString FElementalStateTreeTaskBase::GetPerformanceStats() const
+FString FElementalStateTreeTaskBase::GetPerformanceStats(const FElementalStateTreeInstanceDataBase& InstanceData, const UObject* WorldContextObject) const
 {
     FString Stats;
-    Stats += GetEQSCacheStats() + TEXT("\n");
-    Stats += GetUtilityCacheStats();
+    Stats += GetEQSCacheStats(WorldContextObject) + TEXT("\n");
+    Stats += GetUtilityCacheStats(InstanceData);
     return Stats;
 }
\ No newline at end of file
@@ -5,64 +5,179 @@
 #include "CoreMinimal.h"
 #include "StateTreeTaskBase.h"
 #include "StateTreeConditionBase.h"
-#include "EnvironmentQuery/EnvQueryInstanceBlueprintWrapper.h"
 #include "EnvironmentQuery/EnvQueryTypes.h"
 #include "AI/Utility/UtilityAITypes.h"
+#include "AI/Utility/UtilityScoreCache.h"
+#include "AI/EQSResultCacheSubsystem.h"
+#include <atomic>
 #include "ElementalStateTreeTaskBase.generated.h"
 
 class AElementalCombatEnemy;
 class AAIController;
-class UEnvQueryInstanceBlueprintWrapper;
+class AElementalCombatAIController;
+struct FUtilityScoreResult;
+struct FUtilityWeightOverlay;
+struct FUtilityProfileHandle;
+struct FElementalStateTreeInstanceDataBase;
+class UEnvQuery;
 
-// EQS查询完成委托
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnEQSRequestComplete, UEnvQueryInstanceBlueprintWrapper*, QueryInstance, EEnvQueryStatus::Type, QueryStatus);
+/**
+ * 异步EQS查询的完成槽
+ * 查询回调只写入这里，不访问任务节点或实例数据（两者都可能在查询期间失效）
+ * 回调和排队的启动、中止命令在游戏线程上写入，并行Tick的任务在其他线程上读取
+ */
+struct FElementalEQSQueryCompletion
+{
+    /** 查询结果位置（按评分降序，bFinished发布后才能读取） */
+    TArray<FVector> Locations;
+
+    /** 查询是否成功并得到至少一个位置（bFinished发布后才能读取） */
+    bool bSucceeded = false;
+
+    /** 查询是否已结束 */
+    std::atomic<bool> bFinished{false};
+
+    /** 交给游戏线程启动的查询ID（启动前为INDEX_NONE） */
+    std::atomic<int32> QueryID{INDEX_NONE};
+
+    /** 请求已被取消，排队中的查询不再启动 */
+    std::atomic<bool> bCancelled{false};
+};
 
 /**
- * EQS查询结果缓存结构
+ * 异步EQS请求状态（保存在StateTree实例数据中）
+ * 记录进行中的请求ID和最后一次成功的结果，新查询进行期间继续返回上次的结果
  */
-USTRUCT(BlueprintType)
-struct ELEMENTALCOMBAT_API FEQSQueryCache
+USTRUCT()
+struct ELEMENTALCOMBAT_API FElementalEQSRequestState
 {
     GENERATED_BODY()
 
-    /** 缓存的查询结果位置 */
-    UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|AI")
-    TArray<FVector> CachedLocations;
+    /** 已交给游戏线程、尚未得到EQS请求ID的查询（实际ID写入完成槽） */
+    static constexpr int32 QueuedRequestID = -2;
 
-    /** 最佳位置 */
-    UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|AI")
+    /** 进行中的请求ID（INDEX_NONE表示没有进行中的请求，QueuedRequestID表示查询排队等待游戏线程启动） */
+    int32 RequestID = INDEX_NONE;
+
+    /** 最后一次成功的查询结果位置 */
+    TArray<FVector> Locations;
+
+    /** 最后一次成功的最佳位置 */
     FVector BestLocation = FVector::ZeroVector;
 
-    /** 缓存时间戳 */
-    UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|AI")
-    float CacheTimestamp = -1.0f;
+    /** 最后一次成功结果的时间（<0表示没有结果） */
+    float ResultTime = -1.0f;
 
-    /** 查询哈希值（用于检测查询参数是否变化） */
-    UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|AI")
-    int32 QueryHash = 0;
+    /** 最后一次成功结果对应的查询哈希 */
+    int32 ResultQueryHash = 0;
 
-    /** 是否有效 */
-    UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|AI")
-    bool bIsValid = false;
+    /** 进行中请求对应的查询哈希 */
+    int32 PendingQueryHash = 0;
 
-    FEQSQueryCache()
-    {
-        Reset();
-    }
+    /** 是否有可用的结果 */
+    bool HasResult() const { return ResultTime >= 0.0f; }
+
+    /** 是否有进行中的请求 */
+    bool IsInFlight() const { return RequestID != INDEX_NONE; }
 
-    void Reset()
+    /** 结果是否对应给定查询且未过期 */
+    bool IsResultFresh(int32 QueryHash, float CurrentTime, float MaxAge) const
     {
-        CachedLocations.Empty();
-        BestLocation = FVector::ZeroVector;
-        CacheTimestamp = -1.0f;
-        QueryHash = 0;
-        bIsValid = false;
+        return HasResult() && ResultQueryHash == QueryHash && (CurrentTime - ResultTime) <= MaxAge;
     }
 
-    bool IsExpired(float CurrentTime, float MaxAge) const
+    /**
+     * 为新请求创建完成回调（旧请求的回调随之失效）
+     * @param QueryHash 新请求的查询哈希
+     */
+    FQueryFinishedSignature MakeCompletionDelegate(int32 QueryHash);
+
+    /**
+     * 取走已结束的查询结果
+     * 成功时更新最后结果，失败时保留上次的结果
+     * @return 本次取到新的成功结果时返回true
+     */
+    bool ConsumeCompletedQuery(float CurrentTime);
+
+    /** 丢弃进行中的请求（不通知EQS管理器，由调用方中止查询） */
+    void ClearPendingQuery();
+
+    /**
+     * 取走进行中请求的完成槽并标记为已取消（排队中的查询不再启动），请求状态随之清空
+     * @return 完成槽，调用方用它找到已启动查询的ID并中止
+     */
+    TSharedPtr<FElementalEQSQueryCompletion> DetachPendingQuery();
+
+    /** 进行中请求的完成槽（交给游戏线程的启动命令只持有弱引用） */
+    TWeakPtr<FElementalEQSQueryCompletion> GetPendingCompletion() const { return Completion; }
+
+    /** 清除请求和结果 */
+    void Reset();
+
+private:
+    /** 进行中请求的完成槽 */
+    TSharedPtr<FElementalEQSQueryCompletion> Completion;
+};
+
+/**
+ * 任务状态码（错误和决策原因）
+ */
+UENUM(BlueprintType)
+enum class EElementalTaskStatus : uint8
+{
+    None = 0,
+
+    // 错误
+    MissingEnemy            UMETA(DisplayName = "未找到敌人角色"),
+    MissingTarget           UMETA(DisplayName = "未找到有效目标"),
+    MissingController       UMETA(DisplayName = "未找到元素战斗AI控制器"),
+    AttackEvaluationFailed  UMETA(DisplayName = "评估攻击选项失败"),
+    NoInitialAttack         UMETA(DisplayName = "首次评估时无有效攻击决策"),
+    AttackExecutionFailed   UMETA(DisplayName = "攻击执行失败"),
+    ElementEvaluationFailed UMETA(DisplayName = "评估元素选项失败"),
+    ElementSwitchFailed     UMETA(DisplayName = "切换元素失败"),
+    MissingUtilityContext   UMETA(DisplayName = "本帧评分上下文尚未构建"),
+
+    // 攻击决策原因
+    RangedAIPrefersRanged   UMETA(DisplayName = "远程AI - 始终倾向远程攻击"),
+    MeleeTooClose           UMETA(DisplayName = "近战AI - 距离过近，等待移动"),
+    MeleeUsesRanged         UMETA(DisplayName = "近战AI - 使用远程攻击"),
+    MeleeOutOfRange         UMETA(DisplayName = "近战AI - 目标超出范围")
+};
+
+/**
+ * 任务状态（状态码加数值参数）
+ * 决策时只写入状态码和数值，调试器或日志读取时才调用ToString格式化，决策路径上不分配内存
+ */
+USTRUCT(BlueprintType)
+struct ELEMENTALCOMBAT_API FElementalTaskStatus
+{
+    GENERATED_BODY()
+
+    /** 状态码 */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Output)
+    EElementalTaskStatus Code = EElementalTaskStatus::None;
+
+    /** 数值参数（含义由状态码决定，例如距离和阈值） */
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Output)
+    float Value0 = 0.0f;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Output)
+    float Value1 = 0.0f;
+
+    void Set(EElementalTaskStatus InCode, float InValue0 = 0.0f, float InValue1 = 0.0f)
     {
-        return !bIsValid || (CurrentTime - CacheTimestamp) > MaxAge;
+        Code = InCode;
+        Value0 = InValue0;
+        Value1 = InValue1;
     }
+
+    void Reset() { Set(EElementalTaskStatus::None); }
+
+    bool IsSet() const { return Code != EElementalTaskStatus::None; }
+
+    /** 格式化为可读文本（会分配内存，只在调试和日志中调用；蓝图中使用UElementalTaskStatusLibrary） */
+    FString ToString() const;
 };
 
 /**
@@ -79,6 +194,10 @@ protected:
     UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
     float EQSCacheValidDuration = 1.0f;
 
+    /** EQS缓存键的网格大小，查询者和目标分别落在同一网格内的AI共用查询结果 */
+    UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI", meta = (EditCondition = "bUseEQSCache", ClampMin = "1.0"))
+    float EQSCacheCellSize = 200.0f;
+
     /** Utility评分缓存有效时间（秒） */
     UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
     float UtilityCacheValidDuration = 0.1f;
@@ -91,6 +210,18 @@ protected:
     UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI")
     bool bUseUtilityCache = true;
 
+    /** Utility评分缓存容量（条目数，满时按CLOCK淘汰） */
+    UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI", meta = (EditCondition = "bUseUtilityCache", ClampMin = "1", ClampMax = "4096"))
+    int32 UtilityCacheCapacity = FUtilityScoreCache::DefaultCapacity;
+
+    /** Utility缓存键的距离分桶大小，落在同一桶内的距离共用缓存（0表示精确匹配） */
+    UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI", meta = (EditCondition = "bUseUtilityCache", ClampMin = "0.0"))
+    float UtilityCacheDistanceBucket = 50.0f;
+
+    /** Utility缓存键的百分比类输入分桶大小（健康度、威胁、元素优势、自定义值，0表示精确匹配） */
+    UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI", meta = (EditCondition = "bUseUtilityCache", ClampMin = "0.0", ClampMax = "1.0"))
+    float UtilityCacheInputBucket = 0.05f;
+
     /** 是否输出调试信息 */
     UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI|Debug")
     bool bEnableDebugOutput = false;
@@ -99,24 +230,34 @@ protected:
     UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI|Debug", meta = (ClampMin = "0.0"))
     float DebugDisplayDuration = 3.0f;
 
-private:
-    /** EQS查询结果缓存 */
-    mutable TMap<int32, FEQSQueryCache> EQSCache;
-
-    /** Utility评分缓存 */
-    mutable TMap<int32, float> UtilityCache;
-
-    /** Utility评分缓存时间戳 */
-    mutable TMap<int32, float> UtilityCacheTimestamps;
-
 protected:
     // === Utility AI辅助函数 ===
 
-    /** 创建Utility评分上下文 */
+    /** 创建Utility评分上下文（每次调用都重新采集，任务中应优先使用GetFrameUtilityContext） */
     FUtilityContext CreateUtilityContext(const FStateTreeExecutionContext& Context) const;
 
-    /** 使用缓存计算Utility评分 */
-    float CalculateUtilityScoreWithCache(const FUtilityProfile& Profile, const FUtilityContext& UtilityContext) const;
+    /**
+     * 获取AI本帧的评分上下文快照
+     * 快照由AI控制器每帧在StateTree Tick之前于游戏线程构建一次，同一状态下的所有任务共享，不随任务数量重复采集
+     * 其他线程上只读取快照，快照缺少所需输入时返回nullptr，任务应跳过本次评分或失败
+     * 控制器不是元素战斗AI控制器时只在游戏线程上退化为CreateUtilityContext，返回的指针在下次调用前有效
+     * @param RequiredInputs 需要的输入掩码（见UtilityInputs），游戏线程上快照中尚未采集的输入在此时按需补充
+     */
+    const FUtilityContext* GetFrameUtilityContext(const FStateTreeExecutionContext& Context, uint32 RequiredInputs = UtilityInputs::All) const;
+
+    /** 使用实例数据中的缓存计算Utility评分（缓存键使用注册表预先计算的配置文件标识） */
+    float CalculateUtilityScoreWithCache(FElementalStateTreeInstanceDataBase& InstanceData, const FUtilityProfileHandle& ProfileHandle, const FUtilityContext& UtilityContext) const;
+
+    /** 使用实例数据中的缓存计算权重覆盖视图的Utility评分（不复制配置文件） */
+    float CalculateUtilityScoreWithCache(FElementalStateTreeInstanceDataBase& InstanceData, const FUtilityWeightOverlay& Overlay, const FUtilityContext& UtilityContext) const;
+
+    /**
+     * 使用实例数据中的缓存一次计算多个权重覆盖视图的Utility评分
+     * 未命中缓存的视图在同一遍中评分，共用各评分因素的单项输出
+     * @param OutScores 输出评分，长度必须等于Overlays.Num()
+     */
+    void CalculateUtilityScoresWithCache(FElementalStateTreeInstanceDataBase& InstanceData, TConstArrayView<const FUtilityWeightOverlay*> Overlays,
+                                         const FUtilityContext& UtilityContext, TArrayView<float> OutScores) const;
 
     /** 计算Utility评分（不使用缓存） */
     float CalculateUtilityScoreDirect(const FUtilityProfile& Profile, const FUtilityContext& UtilityContext) const;
@@ -124,24 +265,54 @@ protected:
     /** 比较两个Utility评分，返回更好的那个 */
     float GetBetterUtilityScore(const float& ScoreA, const float& ScoreB) const;
 
-    // === EQS查询辅助函数 ===
-
-    /** 异步执行EQS查询 */
-    void ExecuteEQSQuery(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context, 
-                        FOnEQSRequestComplete OnComplete) const;
-
-    /** 使用缓存执行EQS查询 */
-    bool ExecuteEQSQueryWithCache(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context,
-                                 TArray<FVector>& OutLocations, FVector& OutBestLocation) const;
-
-    /** 计算EQS查询哈希（用于缓存键） */
-    int32 CalculateEQSQueryHash(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context) const;
+    /**
+     * 从Utility AI子系统读取AI控制器基础评分请求的最新结果
+     * @param AIController 元素战斗AI控制器
+     * @param MaxResultAge 允许的最大结果陈旧时间（秒），超出时立即重新评分；<0表示接受任何已有结果
+     * @return 评分结果，子系统或请求不可用、或不在游戏线程上时返回nullptr
+     */
+    const FUtilityScoreResult* GetSubsystemUtilityResult(AElementalCombatAIController* AIController, float MaxResultAge) const;
 
-    /** 更新EQS缓存 */
-    void UpdateEQSCache(int32 QueryHash, const TArray<FVector>& Locations, FVector BestLocation, float CurrentTime) const;
+    // === EQS查询辅助函数 ===
 
-    /** 检查EQS缓存是否有效 */
-    bool IsEQSCacheValid(int32 QueryHash, float CurrentTime) const;
+    /**
+     * 异步执行EQS查询，结果写入请求状态的完成槽
+     * 查询由EQS管理器在其每帧时间预算内分片执行，不会阻塞游戏线程
+     * EQS管理器只能在游戏线程访问：并行Tick时查询交给游戏线程启动，请求状态在启动前即视为进行中
+     * @return 请求ID，交给游戏线程时返回QueuedRequestID，启动失败时返回INDEX_NONE
+     */
+    int32 ExecuteEQSQuery(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context,
+                          FElementalEQSRequestState& RequestState) const;
+
+    /**
+     * 按需发起异步EQS查询，结果保存在请求状态中（Locations、BestLocation）
+     * 先取走已结束的查询结果；结果未过期时直接使用，过期时发起新查询（已有进行中的查询时不重复发起），查询期间保留上次的结果
+     * @param bAllowNewQuery 是否允许发起新查询（轮询进行中的查询时传false，查询失败后不会立即重试）
+     * @return 有可用结果时返回true
+     */
+    bool RequestEQSQueryAsync(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context,
+                              FElementalEQSRequestState& RequestState, bool bAllowNewQuery = true) const;
+
+    /** 按需发起异步EQS查询并复制可用结果 */
+    bool RequestEQSQueryAsync(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context,
+                              FElementalEQSRequestState& RequestState,
+                              TArray<FVector>& OutLocations, FVector& OutBestLocation) const;
+
+    /** AI当前的细节层级是否允许发起新的EQS查询（不是元素战斗AI控制器时总是允许） */
+    bool IsEQSAllowedByLOD(const FStateTreeExecutionContext& Context) const;
+
+    /** 中止进行中的EQS查询（在ExitState中调用，避免过期请求继续占用EQS预算；并行Tick时交给游戏线程中止） */
+    void CancelEQSQuery(const FStateTreeExecutionContext& Context, FElementalEQSRequestState& RequestState) const;
+
+    /** 构建EQS缓存键（查询模板、查询者网格、目标网格） */
+    FEQSResultCacheKey MakeEQSCacheKey(UEnvQuery* QueryTemplate, const FStateTreeExecutionContext& Context) const;
+
+    /** 写入共享EQS缓存 */
+    void UpdateEQSCache(const FStateTreeExecutionContext& Context, const FEQSResultCacheKey& Key, const TArray<FVector>& Locations, float CurrentTime) const;
+
+    /** 查找共享EQS缓存，命中时把结果复制到调用方反复使用的缓冲区；未命中或未启用缓存时返回false且不修改输出 */
+    bool FindEQSCache(const FStateTreeExecutionContext& Context, const FEQSResultCacheKey& Key, float CurrentTime,
+                      TArray<FVector>& OutLocations, float& OutTimestamp) const;
 
     // === 数据获取辅助函数 ===
 
@@ -157,23 +328,14 @@ protected:
     /** 获取当前世界时间 */
     float GetCurrentWorldTime(const FStateTreeExecutionContext& Context) const;
 
-    /** 计算两个Actor之间的距离 */
-    float CalculateDistance(AActor* ActorA, AActor* ActorB) const;
-
-    /** 计算健康度百分比 */
-    float CalculateHealthPercent(AActor* Actor) const;
-
-    /** 计算元素优势值 */
-    float CalculateElementAdvantage(const AElementalCombatEnemy* Self, const AActor* Target) const;
-
-    /** 计算威胁等级 */
-    float CalculateThreatLevel(const AElementalCombatEnemy* Self, const AActor* Target) const;
-
     // === 调试辅助函数 ===
 
     /** 输出调试日志 */
     void LogDebug(const FString& Message) const;
 
+    /** 输出调试日志（字面量重载，关闭调试输出时不构造FString） */
+    void LogDebug(const TCHAR* Message) const;
+
     /** 在屏幕上显示调试信息 */
     void DisplayDebugMessage(const FString& Message) const;
 
@@ -186,37 +348,63 @@ protected:
                       FColor Color = FColor::Green, float Duration = 3.0f) const;
 
 public:
-    // === 缓存管理函数 ===
+    /**
+     * 根据AI和目标构建Utility评分上下文（不依赖StateTree执行上下文，供Utility AI子系统使用）
+     * @param Self 自身AI
+     * @param Target 目标，可为空
+     * @param CurrentTime 当前世界时间
+     */
+    static FUtilityContext BuildUtilityContext(AElementalCombatEnemy* Self, AActor* Target, float CurrentTime);
+
+    /**
+     * 按需构建Utility评分上下文，只采集RequiredInputs中的输入（见FUtilityInputProviderRegistry）
+     * @param RequiredInputs 需要的输入掩码（见UtilityInputs）
+     * @param InOutComputedInputs 上下文中已采集的输入掩码，调用后加入本次采集的输入
+     */
+    static void PopulateUtilityContext(FUtilityContext& InOutContext, AElementalCombatEnemy* Self, AActor* Target, float CurrentTime,
+                                       uint32 RequiredInputs, uint32& InOutComputedInputs);
+
+    // === 输入计算辅助函数（默认输入提供者使用） ===
+
+    /** 计算两个Actor之间的距离 */
+    static float CalculateDistance(AActor* ActorA, AActor* ActorB);
+
+    /** 计算健康度百分比 */
+    static float CalculateHealthPercent(AActor* Actor);
+
+    /** 计算元素优势值 */
+    static float CalculateElementAdvantage(const AElementalCombatEnemy* Self, const AActor* Target);
 
-    /** 清除所有缓存 */
-    void ClearAllCaches() const;
+    /** 计算威胁等级 */
+    static float CalculateThreatLevel(const AElementalCombatEnemy* Self, const AActor* Target);
+
+    // === 缓存管理函数 ===
+    // 任务节点由运行同一资产的所有StateTree实例共享，本身不保存可变状态；
+    // 缓存保存在各实例的实例数据中，EQS结果由线程安全的UEQSResultCacheSubsystem共享
 
-    /** 清除EQS缓存 */
-    void ClearEQSCache() const;
+    /** 清除实例的所有缓存（共享EQS缓存不在此清除） */
+    void ClearAllCaches(FElementalStateTreeInstanceDataBase& InstanceData) const;
 
-    /** 清除Utility缓存 */
-    void ClearUtilityCache() const;
+    /** 清除实例的Utility缓存 */
+    void ClearUtilityCache(FElementalStateTreeInstanceDataBase& InstanceData) const;
 
-    /** 清除过期缓存 */
-    void ClearExpiredCaches(float CurrentTime) const;
+    /** 清除实例的过期缓存 */
+    void ClearExpiredCaches(FElementalStateTreeInstanceDataBase& InstanceData, float CurrentTime) const;
 
     // === 性能监控接口 ===
 
-    /** 获取EQS缓存统计信息 */
-    FString GetEQSCacheStats() const;
+    /** 获取共享EQS缓存统计信息（命中率、淘汰和内存） */
+    FString GetEQSCacheStats(const UObject* WorldContextObject = nullptr) const;
 
-    /** 获取Utility缓存统计信息 */
-    FString GetUtilityCacheStats() const;
+    /** 获取实例的Utility缓存统计信息 */
+    FString GetUtilityCacheStats(const FElementalStateTreeInstanceDataBase& InstanceData) const;
 
     /** 获取总体性能统计 */
-    FString GetPerformanceStats() const;
-
-private:
-    /** 计算Utility上下文哈希 */
-    int32 CalculateUtilityContextHash(const FUtilityContext& Context) const;
+    FString GetPerformanceStats(const FElementalStateTreeInstanceDataBase& InstanceData, const UObject* WorldContextObject = nullptr) const;
 
-    /** EQS查询完成回调 */
-    void OnEQSQueryCompleted(TSharedPtr<FEnvQueryResult> QueryResult) const;
+protected:
+    /** 将任务属性同步到实例的Utility评分缓存配置 */
+    void ConfigureUtilityCache(FUtilityScoreCache& Cache) const;
 };
 
 /**
@@ -236,7 +424,7 @@ struct ELEMENTALCOMBAT_API FElementalStateTreeInstanceDataBase
     TObjectPtr<AAIController> AIController;
 
     /** 目标Actor（可选） */
-    UPROPERTY(EditAnywhere, Category = Input)
+    UPROPERTY(EditAnywhere, Category = Input, meta = (Optional))
     TObjectPtr<AActor> TargetActor;
 
     /** 目标位置（可选） */
@@ -251,10 +439,13 @@ struct ELEMENTALCOMBAT_API FElementalStateTreeInstanceDataBase
     UPROPERTY(VisibleAnywhere, Category = Output)
     bool bTaskCompleted = false;
 
-    /** 错误信息输出 */
+    /** 错误状态输出（需要文本时调用ToString） */
     UPROPERTY(VisibleAnywhere, Category = Output)
-    FString ErrorMessage;
-};
+    FElementalTaskStatus ErrorStatus;
 
-// 添加POD宏以支持StateTree绑定
-STATETREE_POD_INSTANCEDATA(FElementalStateTreeInstanceDataBase);
\ No newline at end of file
+    /** 异步EQS请求状态（请求ID和最后一次成功的结果） */
+    FElementalEQSRequestState EQSRequest;
+
+    /** 本实例的Utility评分缓存（定长，键包含配置文件标识；每个实例独占，可以并行Tick） */
+    FUtilityScoreCache UtilityScoreCache;
+};
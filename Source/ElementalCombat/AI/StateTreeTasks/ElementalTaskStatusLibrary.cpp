@@ -0,0 +1,13 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "ElementalTaskStatusLibrary.h"
+
+FString UElementalTaskStatusLibrary::Conv_ElementalTaskStatusToString(const FElementalTaskStatus& Status)
+{
+    return Status.ToString();
+}
+
+bool UElementalTaskStatusLibrary::IsElementalTaskStatusSet(const FElementalTaskStatus& Status)
+{
+    return Status.IsSet();
+}
@@ -0,0 +1,27 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "ElementalStateTreeTaskBase.h"
+#include "ElementalTaskStatusLibrary.generated.h"
+
+/**
+ * 任务状态的蓝图辅助函数
+ * StateTree任务的ErrorStatus和DecisionReason输出只保存状态码和数值，蓝图中需要文本时通过这里格式化
+ */
+UCLASS()
+class ELEMENTALCOMBAT_API UElementalTaskStatusLibrary : public UBlueprintFunctionLibrary
+{
+    GENERATED_BODY()
+
+public:
+    /** 把任务状态格式化为可读文本（没有状态时为空字符串） */
+    UFUNCTION(BlueprintPure, Category = "ElementalCombat|AI", meta = (DisplayName = "To String (Elemental Task Status)", CompactNodeTitle = "->", BlueprintAutocast))
+    static FString Conv_ElementalTaskStatusToString(const FElementalTaskStatus& Status);
+
+    /** 任务状态是否已设置 */
+    UFUNCTION(BlueprintPure, Category = "ElementalCombat|AI")
+    static bool IsElementalTaskStatusSet(const FElementalTaskStatus& Status);
+};
@@ -3,10 +3,39 @@
 #include "StateTreePlayerInfoTasks.h"
 #include "StateTreeExecutionContext.h"
 #include "GameFramework/Character.h"
+#include "AI/ElementalCombatAIController.h"
+#include "AI/PlayerSnapshotSubsystem.h"
 
 EStateTreeRunStatus FStateTreePlayerInfoExtendedTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
 {
-    // 首先调用父类的Tick函数来获取玩家信息
+    FInstanceDataType& SnapshotInstanceData = Context.GetInstanceData(*this);
+
+    // 已在玩家快照子系统注册的AI直接读取本帧批量计算的结果
+    if (SnapshotInstanceData.Character)
+    {
+        const AElementalCombatAIController* AIController = Cast<AElementalCombatAIController>(SnapshotInstanceData.Character->GetController());
+        UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(SnapshotInstanceData.Character);
+        FPlayerRelativeInfo RelativeInfo;
+        if (AIController && SnapshotSubsystem && SnapshotSubsystem->GetRelativeInfo(AIController->GetPlayerSnapshotHandle(), RelativeInfo))
+        {
+            const FPlayerSnapshot& Snapshot = SnapshotSubsystem->GetPlayerSnapshot();
+            SnapshotInstanceData.TargetPlayerCharacter = Cast<ACharacter>(Snapshot.Player.Get());
+            if (Snapshot.bIsValid)
+            {
+                SnapshotInstanceData.TargetPlayerLocation = Snapshot.Location;
+                SnapshotInstanceData.DistanceToTarget = RelativeInfo.Distance;
+            }
+            else
+            {
+                // 玩家不存在时保留本任务的最后已知位置
+                SnapshotInstanceData.DistanceToTarget = FVector::Distance(SnapshotInstanceData.TargetPlayerLocation, SnapshotInstanceData.Character->GetActorLocation());
+            }
+            SnapshotInstanceData.HorizontalAngleToPlayer = SnapshotInstanceData.TargetPlayerCharacter ? RelativeInfo.HorizontalAngle : 0.0f;
+            return EStateTreeRunStatus::Running;
+        }
+    }
+
+    // 未注册时回退到逐个计算：首先调用父类的Tick函数来获取玩家信息
     EStateTreeRunStatus ParentResult = Super::Tick(Context, DeltaTime);
 
     // 获取实例数据
@@ -6,6 +6,8 @@
 #include "AIController.h"
 #include "Navigation/PathFollowingComponent.h"
 #include "ElementalCombatAIController.h"
+#include "AI/Utility/UtilityAISubsystem.h"
+#include "Async/Async.h"
 
 // === FStateTreeSmartAttackTask 实现 ===
 
@@ -16,14 +18,14 @@ EStateTreeRunStatus FStateTreeSmartAttackTask::EnterState(FStateTreeExecutionCon
     if (!InstanceData.EnemyCharacter)
     {
         LogDebug(TEXT("智能攻击任务：敌人角色为空"));
-        InstanceData.ErrorMessage = TEXT("未找到敌人角色");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingEnemy);
         return EStateTreeRunStatus::Failed;
     }
 
     if (!InstanceData.TargetActor)
     {
         LogDebug(TEXT("智能攻击任务：目标角色为空"));
-        InstanceData.ErrorMessage = TEXT("未找到有效目标");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingTarget);
         return EStateTreeRunStatus::Failed;
     }
 
@@ -45,7 +47,7 @@ EStateTreeRunStatus FStateTreeSmartAttackTask::EnterState(FStateTreeExecutionCon
         // 评估攻击选项
         if (!EvaluateAttackOptions(Context))
         {
-            InstanceData.ErrorMessage = TEXT("评估攻击选项失败");
+            InstanceData.ErrorStatus.Set(EElementalTaskStatus::AttackEvaluationFailed);
             return EStateTreeRunStatus::Failed;
         }
 
@@ -59,7 +61,7 @@ EStateTreeRunStatus FStateTreeSmartAttackTask::EnterState(FStateTreeExecutionCon
         // 如果没有有效的攻击决策，但这是首次评估，则失败
         if (InstanceData.LastDecisionTime < 0.0f)
         {
-            InstanceData.ErrorMessage = TEXT("首次评估时无有效攻击决策");
+            InstanceData.ErrorStatus.Set(EElementalTaskStatus::NoInitialAttack);
             return EStateTreeRunStatus::Failed;
         }
 
@@ -68,10 +70,17 @@ EStateTreeRunStatus FStateTreeSmartAttackTask::EnterState(FStateTreeExecutionCon
         return EStateTreeRunStatus::Succeeded;
     }
 
+    // 异步查询攻击位置，查询结束前保持运行，由Tick轮询
+    if (InstanceData.AttackPositionQuery && !UpdateAttackPosition(Context, /*bAllowNewQuery*/ true))
+    {
+        InstanceData.bTaskCompleted = false;
+        return EStateTreeRunStatus::Running;
+    }
+
     // 执行选择的攻击（基于当前有效的决策）
     if (!ExecuteSelectedAttack(Context))
     {
-        InstanceData.ErrorMessage = TEXT("攻击执行失败");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::AttackExecutionFailed);
         return EStateTreeRunStatus::Failed;
     }
 
@@ -81,13 +90,34 @@ EStateTreeRunStatus FStateTreeSmartAttackTask::EnterState(FStateTreeExecutionCon
 
 EStateTreeRunStatus FStateTreeSmartAttackTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
 {
-    // 大多数情况下在EnterState完成，此处可以添加持续监控逻辑
+    FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+    // 大多数情况下在EnterState完成，只有等待攻击位置查询时才会运行到这里
+    if (InstanceData.bTaskCompleted)
+    {
+        return EStateTreeRunStatus::Succeeded;
+    }
+
+    if (!UpdateAttackPosition(Context, /*bAllowNewQuery*/ false))
+    {
+        return EStateTreeRunStatus::Running;
+    }
+
+    if (!ExecuteSelectedAttack(Context))
+    {
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::AttackExecutionFailed);
+        return EStateTreeRunStatus::Failed;
+    }
+
+    InstanceData.bTaskCompleted = true;
     return EStateTreeRunStatus::Succeeded;
 }
 
 void FStateTreeSmartAttackTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
-    // 清理逻辑
+    // 中止尚未完成的EQS查询
+    FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+    CancelEQSQuery(Context, InstanceData.EQSRequest);
 }
 
 bool FStateTreeSmartAttackTask::EvaluateAttackOptions(FStateTreeExecutionContext& Context) const
@@ -99,78 +129,37 @@ bool FStateTreeSmartAttackTask::EvaluateAttackOptions(FStateTreeExecutionContext
     if (!AIController)
     {
         LogDebug(TEXT("智能攻击任务：AI控制器为空或不是元素战斗AI控制器"));
-        InstanceData.ErrorMessage = TEXT("未找到元素战斗AI控制器");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingController);
         return false;
     }
 
     const FUtilityProfile& AIProfile = AIController->GetCurrentAIProfile();
 
-    // 清除之前的评分
-    InstanceData.AttackTypeScores.Empty();
-
-    // 创建评分上下文
-    FUtilityContext UtilityContext = CreateUtilityContext(Context);
-    float DistanceToTarget = UtilityContext.DistanceToTarget;
-
-    // 检查AI类型标签
-    bool bIsRangedAI = AIProfile.AITypeTags.Contains(TEXT("Ranged"));
-    // 无标签或有Melee标签都视为近战AI
-    bool bIsMeleeAI = !bIsRangedAI; // 默认为近战AI
-
-    // 根据AI类型决定攻击策略
-    if (bIsRangedAI)
+    // 优先使用Utility AI子系统中缓存有效期内的上下文快照，避免每次决策重复采集
+    float DistanceToTarget = 0.0f;
+    if (const FUtilityScoreResult* Result = GetSubsystemUtilityResult(AIController, UtilityCacheValidDuration))
     {
-        // 远程AI：总是倾向于远程攻击
-        InstanceData.SelectedAttackType = EAIAttackType::Ranged;
-        InstanceData.FinalScore = 1.0f;
-        InstanceData.bShouldAttack = true;
-        InstanceData.AttackTypeScores.Add(EAIAttackType::Ranged, 1.0f);
-        InstanceData.DecisionReason = TEXT("远程AI - 始终倾向远程攻击");
+        DistanceToTarget = Result->Context.DistanceToTarget;
     }
-    else // 默认近战AI逻辑（包括无标签和Melee标签）
+    else if (const FUtilityContext* UtilityContext = GetFrameUtilityContext(Context, UtilityInputs::Distance))
     {
-        // 近战AI的决策逻辑
-        float SwitchDistance = AIProfile.MeleeToRangedSwitchDistance;
-
-        if (DistanceToTarget <= SwitchDistance)
-        {
-            // 近距离：不攻击，交由后续位移逻辑处理
-            InstanceData.bShouldAttack = false;
-            InstanceData.SelectedAttackType = EAIAttackType::None;
-            InstanceData.FinalScore = 0.0f;
-            InstanceData.DecisionReason = FString::Printf(
-                TEXT("近战AI - 距离过近 (%.1f <= %.1f)，等待移动"),
-                DistanceToTarget, SwitchDistance);
-        }
-        else
-        {
-            // 检查是否在远程攻击范围内
-            float RangedRange = InstanceData.EnemyCharacter->GetRangedAttackRange();
-            if (DistanceToTarget <= RangedRange)
-            {
-                // 远距离但在射程内：使用远程攻击
-                InstanceData.SelectedAttackType = EAIAttackType::Ranged;
-                InstanceData.FinalScore = 0.8f;
-                InstanceData.bShouldAttack = true;
-                InstanceData.AttackTypeScores.Add(EAIAttackType::Ranged, 0.8f);
-                InstanceData.DecisionReason = FString::Printf(
-                    TEXT("近战AI - 在距离 %.1f 使用远程攻击"),
-                    DistanceToTarget);
-            }
-            else
-            {
-                // 超出范围：不攻击
-                InstanceData.bShouldAttack = false;
-                InstanceData.SelectedAttackType = EAIAttackType::None;
-                InstanceData.FinalScore = 0.0f;
-                InstanceData.DecisionReason = TEXT("近战AI - 目标超出范围");
-            }
-        }
+        DistanceToTarget = UtilityContext->DistanceToTarget;
     }
+    else
+    {
+        // 并行Tick时本帧快照尚未包含距离，本次不做决策
+        return false;
+    }
+
+    // 检查AI类型标签，无标签或有Melee标签都视为近战AI
+    const bool bIsRangedAI = AIProfile.AITypeTags.Contains(TEXT("Ranged"));
+
+    SelectAttack(InstanceData, bIsRangedAI, DistanceToTarget, AIProfile.MeleeToRangedSwitchDistance,
+                 InstanceData.EnemyCharacter->GetRangedAttackRange());
 
     if (bEnableDebugOutput)
     {
-        LogDebug(FString::Printf(TEXT("智能攻击：%s"), *InstanceData.DecisionReason));
+        LogDebug(FString::Printf(TEXT("智能攻击：%s"), *InstanceData.DecisionReason.ToString()));
     }
 
     return true;
@@ -185,6 +174,12 @@ bool FStateTreeSmartAttackTask::ExecuteSelectedAttack(FStateTreeExecutionContext
         return false;
     }
 
+    const EAIAttackType AttackType = InstanceData.SelectedAttackType;
+    if (AttackType != EAIAttackType::Melee && AttackType != EAIAttackType::Ranged)
+    {
+        return false;
+    }
+
     // 检查是否正在攻击，避免重复攻击
     if (InstanceData.EnemyCharacter->IsAttacking())
     {
@@ -192,27 +187,66 @@ bool FStateTreeSmartAttackTask::ExecuteSelectedAttack(FStateTreeExecutionContext
         return true; // 返回true避免任务失败
     }
 
+    // 并行Tick时交给游戏线程执行，攻击在游戏线程处理排队命令时发起
+    if (!IsInGameThread())
+    {
+        AsyncTask(ENamedThreads::GameThread, [WeakEnemy = TWeakObjectPtr<AElementalCombatEnemy>(InstanceData.EnemyCharacter), AttackType]()
+        {
+            if (AElementalCombatEnemy* Enemy = WeakEnemy.Get())
+            {
+                PerformAttack(*Enemy, AttackType);
+            }
+        });
+        return true;
+    }
+
+    PerformAttack(*InstanceData.EnemyCharacter, AttackType);
+    return true;
+}
+
+void FStateTreeSmartAttackTask::PerformAttack(AElementalCombatEnemy& Enemy, EAIAttackType AttackType)
+{
+    check(IsInGameThread());
+
+    // 排队期间可能已经发起了攻击
+    if (Enemy.IsAttacking())
+    {
+        return;
+    }
+
     // 设置敌人的攻击类型
-    InstanceData.EnemyCharacter->CurrentAttackType = InstanceData.SelectedAttackType;
-    
+    Enemy.CurrentAttackType = AttackType;
+
     // 根据攻击类型执行相应的攻击逻辑
-    switch (InstanceData.SelectedAttackType)
+    switch (AttackType)
     {
     case EAIAttackType::Melee:
         // 执行近战攻击（调用基类方法）
-        InstanceData.EnemyCharacter->DoAttackTrace(TEXT("hand_r"));
+        Enemy.DoAttackTrace(TEXT("hand_r"));
         break;
-        
+
     case EAIAttackType::Ranged:
         // 执行远程攻击
-        InstanceData.EnemyCharacter->DoAIRangedAttack();
+        Enemy.DoAIRangedAttack();
         break;
-        
+
     default:
-        return false;
+        break;
     }
-    
-    return true;
+}
+
+bool FStateTreeSmartAttackTask::UpdateAttackPosition(FStateTreeExecutionContext& Context, bool bAllowNewQuery) const
+{
+    FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+    if (RequestEQSQueryAsync(InstanceData.AttackPositionQuery, Context, InstanceData.EQSRequest, bAllowNewQuery))
+    {
+        InstanceData.AttackPosition = InstanceData.EQSRequest.BestLocation;
+        InstanceData.bHasAttackPosition = true;
+    }
+
+    // 查询进行期间继续等待（输出沿用上次的位置）；查询结束、失败或细节层级不允许查询时不再等待
+    return !InstanceData.EQSRequest.IsInFlight();
 }
 
 bool FStateTreeSmartAttackTask::ShouldReevaluate(const FInstanceDataType& InstanceData, float CurrentTime) const
@@ -220,16 +254,50 @@ bool FStateTreeSmartAttackTask::ShouldReevaluate(const FInstanceDataType& Instan
     return (CurrentTime - InstanceData.LastDecisionTime) >= InstanceData.MinDecisionInterval;
 }
 
-FString FStateTreeSmartAttackTask::GenerateDecisionReason(const FInstanceDataType& InstanceData) const
+void FStateTreeSmartAttackTask::SelectAttack(FInstanceDataType& InstanceData, bool bIsRangedAI, float DistanceToTarget, float SwitchDistance, float RangedRange)
 {
-    if (!InstanceData.bShouldAttack)
+    static_assert(static_cast<int32>(EAIAttackType::Ranged) < FInstanceDataType::NumAttackTypes, "AttackTypeScores必须覆盖所有攻击类型");
+
+    // 清除之前的评分
+    FMemory::Memzero(InstanceData.AttackTypeScores);
+
+    if (bIsRangedAI)
     {
-        return TEXT("无有效攻击选项");
+        // 远程AI：总是倾向于远程攻击
+        InstanceData.SelectedAttackType = EAIAttackType::Ranged;
+        InstanceData.FinalScore = 1.0f;
+        InstanceData.bShouldAttack = true;
+        InstanceData.DecisionReason.Set(EElementalTaskStatus::RangedAIPrefersRanged);
+    }
+    else if (DistanceToTarget <= SwitchDistance)
+    {
+        // 近战AI近距离：不攻击，交由后续位移逻辑处理
+        InstanceData.SelectedAttackType = EAIAttackType::None;
+        InstanceData.FinalScore = 0.0f;
+        InstanceData.bShouldAttack = false;
+        InstanceData.DecisionReason.Set(EElementalTaskStatus::MeleeTooClose, DistanceToTarget, SwitchDistance);
+    }
+    else if (DistanceToTarget <= RangedRange)
+    {
+        // 近战AI远距离但在射程内：使用远程攻击
+        InstanceData.SelectedAttackType = EAIAttackType::Ranged;
+        InstanceData.FinalScore = 0.8f;
+        InstanceData.bShouldAttack = true;
+        InstanceData.DecisionReason.Set(EElementalTaskStatus::MeleeUsesRanged, DistanceToTarget);
+    }
+    else
+    {
+        // 超出范围：不攻击
+        InstanceData.SelectedAttackType = EAIAttackType::None;
+        InstanceData.FinalScore = 0.0f;
+        InstanceData.bShouldAttack = false;
+        InstanceData.DecisionReason.Set(EElementalTaskStatus::MeleeOutOfRange);
+    }
+
+    if (InstanceData.bShouldAttack)
+    {
+        InstanceData.AttackTypeScores[static_cast<int32>(InstanceData.SelectedAttackType)] = InstanceData.FinalScore;
     }
-    
-    FString TypeName = UEnum::GetValueAsString(InstanceData.SelectedAttackType);
-    return FString::Printf(TEXT("选择 %s 攻击（评分：%.2f）"), 
-                          *TypeName, InstanceData.FinalScore);
 }
 
 #if WITH_EDITOR
@@ -248,14 +316,17 @@ EStateTreeRunStatus FStateTreeElementalDecisionTask::EnterState(FStateTreeExecut
     if (!InstanceData.EnemyCharacter)
     {
         LogDebug(TEXT("元素决策任务：敌人角色为空"));
-        InstanceData.ErrorMessage = TEXT("未找到敌人角色");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingEnemy);
         return EStateTreeRunStatus::Failed;
     }
 
+    // 绑定的元素配置已在进入状态前复制到实例数据，评估器只在这里按版本重建
+    RefreshElementEvaluator(InstanceData);
+
     // 评估元素选项
     if (!EvaluateElementalOptions(Context))
     {
-        InstanceData.ErrorMessage = TEXT("评估元素选项失败");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::ElementEvaluationFailed);
         return EStateTreeRunStatus::Failed;
     }
 
@@ -267,7 +338,7 @@ EStateTreeRunStatus FStateTreeElementalDecisionTask::EnterState(FStateTreeExecut
         {
             if (!SwitchToElement(InstanceData.RecommendedElement, Context))
             {
-                InstanceData.ErrorMessage = TEXT("切换元素失败");
+                InstanceData.ErrorStatus.Set(EElementalTaskStatus::ElementSwitchFailed);
                 return EStateTreeRunStatus::Failed;
             }
         }
@@ -286,34 +357,115 @@ bool FStateTreeElementalDecisionTask::EvaluateElementalOptions(FStateTreeExecuti
 {
     FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
     
-    // 清除之前的评分
-    InstanceData.ElementScores.Empty();
-    
-    // 创建评分上下文
-    FUtilityContext UtilityContext = CreateUtilityContext(Context);
+    // 读取本帧的评分上下文快照（只采集各元素配置读取的输入）
+    const FUtilityContext* UtilityContext = GetFrameUtilityContext(Context, InstanceData.ElementEvaluator.GetRequiredInputs());
+    if (!UtilityContext)
+    {
+        return false;
+    }
     
     // 获取当前元素
     InstanceData.CurrentElement = EElementalType::None; // 需要从角色获取实际元素
     
-    EElementalType BestElement = EElementalType::None;
-    float BestScore = 0.0f;
+    ScoreElements(InstanceData, *UtilityContext);
     
-    // 评估每种元素类型
+    if (bEnableDebugOutput)
+    {
+        FString ElementName = UEnum::GetValueAsString(InstanceData.RecommendedElement);
+        LogDebug(FString::Printf(TEXT("元素决策：推荐 %s，评分=%.3f，应否切换=%s（%d个配置共%d项评分因素，合并为%d项）"),
+                                *ElementName, InstanceData.ElementAdvantageValue,
+                                InstanceData.bShouldSwitchElement ? TEXT("是") : TEXT("否"),
+                                InstanceData.ElementEvaluator.GetNumProfiles(),
+                                InstanceData.ElementEvaluator.GetNumTotalConsiderations(),
+                                InstanceData.ElementEvaluator.GetNumUniqueConsiderations()));
+    }
+    
+    return true;
+}
+
+void FStateTreeElementalDecisionTask::RefreshElementEvaluator(FInstanceDataType& InstanceData)
+{
+    // 版本不变时沿用已构建的评估器，配置文件标识只在重建时计算
+    if (InstanceData.bEvaluatorBuilt && InstanceData.EvaluatorVersion == InstanceData.ElementalProfilesVersion)
+    {
+        return;
+    }
+
+    TArray<const FUtilityProfile*, TInlineAllocator<FInstanceDataType::NumElementTypes>> Profiles;
+    InstanceData.EvaluatorElements.Reset();
+    InstanceData.EvaluatorIdentities.Reset();
     for (const auto& ElementProfilePair : InstanceData.ElementalProfiles)
     {
-        EElementalType ElementType = ElementProfilePair.Key;
-        const FUtilityProfile& Profile = ElementProfilePair.Value;
-        
-        float ElementScore = CalculateUtilityScoreWithCache(Profile, UtilityContext);
-        InstanceData.ElementScores.Add(ElementType, ElementScore);
-        
-        if (ElementScore > BestScore)
+        const int32 ElementIndex = static_cast<int32>(ElementProfilePair.Key);
+        if (ElementIndex < 0 || ElementIndex >= FInstanceDataType::NumElementTypes)
         {
-            BestScore = ElementScore;
-            BestElement = ElementType;
+            continue;
         }
+
+        Profiles.Add(&ElementProfilePair.Value);
+        InstanceData.EvaluatorElements.Add(ElementProfilePair.Key);
+        InstanceData.EvaluatorIdentities.Add(FUtilityScoreCache::ComputeProfileIdentity(ElementProfilePair.Value));
     }
-    
+
+    InstanceData.ElementEvaluator.Build(Profiles);
+    InstanceData.EvaluatorVersion = InstanceData.ElementalProfilesVersion;
+    InstanceData.bEvaluatorBuilt = true;
+}
+
+void FStateTreeElementalDecisionTask::ScoreElements(FInstanceDataType& InstanceData, const FUtilityContext& UtilityContext) const
+{
+    static_assert(static_cast<int32>(EElementalType::Earth) < FInstanceDataType::NumElementTypes, "ElementScores必须覆盖所有元素类型");
+
+    // 清除之前的评分
+    FMemory::Memzero(InstanceData.ElementScores);
+
+    const int32 NumProfiles = InstanceData.ElementEvaluator.GetNumProfiles();
+    check(NumProfiles <= FInstanceDataType::NumElementTypes);
+    FUtilityRankedScore RankedStorage[FInstanceDataType::NumElementTypes];
+    const TArrayView<FUtilityRankedScore> Ranked = MakeArrayView(RankedStorage, NumProfiles);
+
+    // 所有元素都命中缓存时直接排序，否则一次评估所有元素（共用评分因素只求值一次）
+    bool bAllCached = bUseUtilityCache;
+    if (bUseUtilityCache)
+    {
+        ConfigureUtilityCache(InstanceData.UtilityScoreCache);
+        for (int32 i = 0; i < NumProfiles && bAllCached; ++i)
+        {
+            Ranked[i].ProfileIndex = i;
+            bAllCached = InstanceData.UtilityScoreCache.Find(InstanceData.EvaluatorIdentities[i], UtilityContext, Ranked[i].Score);
+        }
+    }
+
+    if (bAllCached)
+    {
+        FUtilityProfileSetEvaluator::SortRanked(Ranked);
+    }
+    else
+    {
+        InstanceData.ElementEvaluator.Evaluate(UtilityContext, Ranked);
+        if (bUseUtilityCache)
+        {
+            for (const FUtilityRankedScore& Result : Ranked)
+            {
+                InstanceData.UtilityScoreCache.Add(InstanceData.EvaluatorIdentities[Result.ProfileIndex], UtilityContext, Result.Score);
+            }
+        }
+    }
+
+    for (const FUtilityRankedScore& Result : Ranked)
+    {
+        InstanceData.ElementScores[static_cast<int32>(InstanceData.EvaluatorElements[Result.ProfileIndex])] = Result.Score;
+    }
+
+    // 排名第一且评分为正的元素为推荐元素（评分相同时取配置中靠前的元素）
+    EElementalType BestElement = EElementalType::None;
+    float BestScore = 0.0f;
+    if (NumProfiles > 0 && Ranked[0].Score > 0.0f)
+    {
+        BestElement = InstanceData.EvaluatorElements[Ranked[0].ProfileIndex];
+        BestScore = Ranked[0].Score;
+    }
+
     // 更新推荐元素
     InstanceData.RecommendedElement = BestElement;
     InstanceData.ElementAdvantageValue = BestScore;
@@ -321,16 +473,6 @@ bool FStateTreeElementalDecisionTask::EvaluateElementalOptions(FStateTreeExecuti
     // 检查是否应该切换元素
     InstanceData.bShouldSwitchElement = (BestElement != InstanceData.CurrentElement) && 
                                        (BestScore > InstanceData.MinElementAdvantageThreshold);
-    
-    if (bEnableDebugOutput)
-    {
-        FString ElementName = UEnum::GetValueAsString(BestElement);
-        LogDebug(FString::Printf(TEXT("元素决策：推荐 %s，评分=%.3f，应否切换=%s"),
-                                *ElementName, BestScore,
-                                InstanceData.bShouldSwitchElement ? TEXT("是") : TEXT("否")));
-    }
-    
-    return true;
 }
 
 bool FStateTreeElementalDecisionTask::CanSwitchElement(const FInstanceDataType& InstanceData, float CurrentTime) const
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "ElementalStateTreeTaskBase.h"
 #include "AI/Utility/UtilityAITypes.h"
+#include "AI/Utility/UtilityProfileSetEvaluator.h"
 #include "EnvironmentQuery/EnvQuery.h"
 #include "Combat/Elemental/ElementalTypes.h"
 #include "AI/ElementalCombatEnemy.h"
@@ -22,6 +23,14 @@ struct FStateTreeSmartAttackInstanceData : public FElementalStateTreeInstanceDat
 {
     GENERATED_BODY()
 
+    /** 攻击类型数量（评分数组按EAIAttackType下标） */
+    static constexpr int32 NumAttackTypes = 3;
+
+    FStateTreeSmartAttackInstanceData()
+    {
+        FMemory::Memzero(AttackTypeScores);
+    }
+
     // 移除DataTable配置，改为从AIController获取配置
 
     // 技能攻击功能已移除，因为EAIAttackType中没有Skill类型
@@ -30,28 +39,47 @@ struct FStateTreeSmartAttackInstanceData : public FElementalStateTreeInstanceDat
     UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.1"))
     float MinDecisionInterval = 1.0f;
 
+    /** 攻击位置EQS查询（可选，设置后在攻击前异步查询攻击位置，查询结束前任务保持运行） */
+    UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI")
+    TObjectPtr<UEnvQuery> AttackPositionQuery = nullptr;
+
     // === 输出结果 ===
 
     /** 选择的攻击类型（输出） */
     UPROPERTY(VisibleAnywhere, Category = "Output")
     EAIAttackType SelectedAttackType = EAIAttackType::None;
 
-    /** 各攻击类型的评分（输出） */
+    /** 各攻击类型的评分（输出，按EAIAttackType下标） */
     UPROPERTY(VisibleAnywhere, Category = "Output")
-    TMap<EAIAttackType, float> AttackTypeScores;
+    float AttackTypeScores[NumAttackTypes];
 
     /** 最佳攻击评分（输出） */
     UPROPERTY(VisibleAnywhere, Category = "Output")
     float FinalScore = 0.0f;
 
-    /** 攻击决策原因（输出，调试用） */
+    /** 攻击决策原因（输出，调试用；需要文本时调用ToString） */
     UPROPERTY(VisibleAnywhere, Category = "Output")
-    FString DecisionReason;
+    FElementalTaskStatus DecisionReason;
 
     /** 是否执行攻击（输出） */
     UPROPERTY(VisibleAnywhere, Category = "Output")
     bool bShouldAttack = false;
 
+    /** 攻击位置（输出，AttackPositionQuery的最佳结果，新查询进行期间沿用上次的位置） */
+    UPROPERTY(VisibleAnywhere, Category = "Output")
+    FVector AttackPosition = FVector::ZeroVector;
+
+    /** 是否有可用的攻击位置（输出） */
+    UPROPERTY(VisibleAnywhere, Category = "Output")
+    bool bHasAttackPosition = false;
+
+    /** 获取攻击类型的评分 */
+    float GetAttackTypeScore(EAIAttackType AttackType) const
+    {
+        const int32 Index = static_cast<int32>(AttackType);
+        return Index >= 0 && Index < NumAttackTypes ? AttackTypeScores[Index] : 0.0f;
+    }
+
 private:
     /** 上次决策时间（内部使用） */
     float LastDecisionTime = -1.0f;
@@ -59,8 +87,6 @@ private:
     friend struct FStateTreeSmartAttackTask;
 };
 
-STATETREE_POD_INSTANCEDATA(FStateTreeSmartAttackInstanceData);
-
 /**
  * 智能攻击选择任务
  * 结合Utility评分系统智能选择最佳攻击方式
@@ -87,14 +113,31 @@ protected:
     /** 评估所有攻击类型并选择最佳的 */
     bool EvaluateAttackOptions(FStateTreeExecutionContext& Context) const;
 
-    /** 执行选择的攻击 */
+    /**
+     * 执行选择的攻击
+     * 攻击会修改角色状态并发起射线检测或发射投射物，并行Tick时交给游戏线程执行
+     */
     bool ExecuteSelectedAttack(FStateTreeExecutionContext& Context) const;
 
+    /** 在游戏线程上让敌人发起攻击（正在攻击时忽略） */
+    static void PerformAttack(AElementalCombatEnemy& Enemy, EAIAttackType AttackType);
+
     /** 检查是否应该重新评估 */
     bool ShouldReevaluate(const FInstanceDataType& InstanceData, float CurrentTime) const;
 
-    /** 生成决策原因字符串 */
-    FString GenerateDecisionReason(const FInstanceDataType& InstanceData) const;
+    /**
+     * 轮询攻击位置查询并更新输出位置
+     * @param bAllowNewQuery 是否允许发起新查询（Tick中轮询时传false，查询失败后不重试）
+     * @return 不需要继续等待查询时返回true
+     */
+    bool UpdateAttackPosition(FStateTreeExecutionContext& Context, bool bAllowNewQuery) const;
+
+    /**
+     * 根据AI类型和距离选择攻击方式，写入评分、决策和决策原因（不分配内存）
+     * @param SwitchDistance 近战AI的近距离阈值
+     * @param RangedRange 远程攻击射程
+     */
+    static void SelectAttack(FInstanceDataType& InstanceData, bool bIsRangedAI, float DistanceToTarget, float SwitchDistance, float RangedRange);
 };
 
 /**
@@ -105,10 +148,22 @@ struct FStateTreeElementalDecisionInstanceData : public FElementalStateTreeInsta
 {
     GENERATED_BODY()
 
-    /** 各元素类型的评分配置 */
+    /** 元素类型数量（评分数组按EElementalType下标） */
+    static constexpr int32 NumElementTypes = 6;
+
+    FStateTreeElementalDecisionInstanceData()
+    {
+        FMemory::Memzero(ElementScores);
+    }
+
+    /** 各元素类型的评分配置（进入状态时构建评估器，运行中修改需递增ElementalProfilesVersion） */
     UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI")
     TMap<EElementalType, FUtilityProfile> ElementalProfiles;
 
+    /** 元素配置版本（运行时修改或通过绑定更新ElementalProfiles时一并递增，下次进入状态时重建评估器） */
+    UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI")
+    int32 ElementalProfilesVersion = 0;
+
     /** 是否允许动态切换元素 */
     UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI")
     bool bAllowElementSwitching = true;
@@ -131,9 +186,9 @@ struct FStateTreeElementalDecisionInstanceData : public FElementalStateTreeInsta
     UPROPERTY(VisibleAnywhere, Category = "Output")
     EElementalType CurrentElement = EElementalType::None;
 
-    /** 各元素的评分（输出） */
+    /** 各元素的评分（输出，按EElementalType下标，没有配置的元素为0） */
     UPROPERTY(VisibleAnywhere, Category = "Output")
-    TMap<EElementalType, float> ElementScores;
+    float ElementScores[NumElementTypes];
 
     /** 是否应该切换元素（输出） */
     UPROPERTY(VisibleAnywhere, Category = "Output")
@@ -143,15 +198,35 @@ struct FStateTreeElementalDecisionInstanceData : public FElementalStateTreeInsta
     UPROPERTY(VisibleAnywhere, Category = "Output")
     float ElementAdvantageValue = 0.0f;
 
+    /** 获取元素的评分 */
+    float GetElementScore(EElementalType ElementType) const
+    {
+        const int32 Index = static_cast<int32>(ElementType);
+        return Index >= 0 && Index < NumElementTypes ? ElementScores[Index] : 0.0f;
+    }
+
 private:
     /** 上次切换元素时间（内部使用） */
     float LastSwitchTime = -1.0f;
 
+    /** 所有元素配置共用的评估器（进入状态时按需重建，内部使用） */
+    FUtilityProfileSetEvaluator ElementEvaluator;
+
+    /** 评估器中各配置文件对应的元素 */
+    TArray<EElementalType, TInlineAllocator<NumElementTypes>> EvaluatorElements;
+
+    /** 评估器中各配置文件的标识（用于评分缓存） */
+    TArray<uint32, TInlineAllocator<NumElementTypes>> EvaluatorIdentities;
+
+    /** 构建评估器时的元素配置版本 */
+    int32 EvaluatorVersion = 0;
+
+    /** 评估器是否已构建 */
+    bool bEvaluatorBuilt = false;
+
     friend struct FStateTreeElementalDecisionTask;
 };
 
-STATETREE_POD_INSTANCEDATA(FStateTreeElementalDecisionInstanceData);
-
 /**
  * 元素决策任务
  * 基于当前战斗情况智能选择最佳元素类型
@@ -177,6 +252,18 @@ protected:
     /** 评估所有元素类型 */
     bool EvaluateElementalOptions(FStateTreeExecutionContext& Context) const;
 
+    /**
+     * 评估器尚未构建或元素配置版本变化时重建共享输入评估器
+     * 只在进入状态时调用，不逐项哈希配置文件；版本不变时对ElementalProfiles的修改不会生效
+     */
+    static void RefreshElementEvaluator(FInstanceDataType& InstanceData);
+
+    /**
+     * 用给定的上下文为各元素评分并更新推荐元素（不分配内存）
+     * 评估器需已通过RefreshElementEvaluator更新
+     */
+    void ScoreElements(FInstanceDataType& InstanceData, const FUtilityContext& UtilityContext) const;
+
     /** 检查是否可以切换元素 */
     bool CanSwitchElement(const FInstanceDataType& InstanceData, float CurrentTime) const;
 
@@ -4,6 +4,13 @@
 #include "StateTreeExecutionContext.h"
 #include "ElementalCombatAIController.h"
 #include "ElementalCombatEnemy.h"
+#include "Async/Async.h"
+
+namespace
+{
+    /** 动态权重调整读取的输入（见FStateTreeDynamicUtilityTask::CalculateDynamicWeights） */
+    constexpr uint32 DynamicWeightInputs = UtilityInputs::Health | UtilityInputs::ElementAdvantage | UtilityInputs::ThreatLevel;
+}
 
 // === FStateTreeUniversalUtilityTask 实现 ===
 
@@ -14,7 +21,7 @@ EStateTreeRunStatus FStateTreeUniversalUtilityTask::EnterState(FStateTreeExecuti
     if (!InstanceData.EnemyCharacter)
     {
         LogDebug(TEXT("通用效用任务：敌人角色为空"));
-        InstanceData.ErrorMessage = TEXT("未找到敌人角色");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingEnemy);
         return EStateTreeRunStatus::Failed;
     }
 
@@ -26,12 +33,11 @@ EStateTreeRunStatus FStateTreeUniversalUtilityTask::EnterState(FStateTreeExecuti
     // 初始化评分计算
     if (InstanceData.bRecalculateOnEnter || !InstanceData.bScoreValid)
     {
-        if (!UpdateScore(Context))
+        // 进入状态时只接受缓存有效期内的子系统结果
+        if (!UpdateScore(Context, UtilityCacheValidDuration))
         {
             return EStateTreeRunStatus::Failed;
         }
-        // 初始化LastUpdateTime
-        InstanceData.LastUpdateTime = GetCurrentWorldTime(Context);
     }
 
     // 如果不需要持续更新，根据评分有效性决定结果
@@ -59,12 +65,11 @@ EStateTreeRunStatus FStateTreeUniversalUtilityTask::Tick(FStateTreeExecutionCont
     // 检查是否需要更新
     if (ShouldUpdate(InstanceData, CurrentTime))
     {
-        if (!UpdateScore(Context))
+        // 持续更新时直接读取子系统按帧预算刷新的最新结果
+        if (!UpdateScore(Context, -1.0f))
         {
             return EStateTreeRunStatus::Failed;
         }
-
-        InstanceData.LastUpdateTime = CurrentTime;
     }
 
     return EStateTreeRunStatus::Running;
@@ -72,15 +77,17 @@ EStateTreeRunStatus FStateTreeUniversalUtilityTask::Tick(FStateTreeExecutionCont
 
 void FStateTreeUniversalUtilityTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+    FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+    CancelEQSQuery(Context, InstanceData.EQSRequest);
+
     if (bEnableDebugOutput)
     {
-        const FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
         LogDebug(FString::Printf(TEXT("通用效用任务：以最终评分 %.3f 退出"),
                                 InstanceData.FinalScore));
     }
 }
 
-bool FStateTreeUniversalUtilityTask::UpdateScore(FStateTreeExecutionContext& Context) const
+bool FStateTreeUniversalUtilityTask::UpdateScore(FStateTreeExecutionContext& Context, float MaxResultAge) const
 {
     FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
@@ -91,19 +98,35 @@ bool FStateTreeUniversalUtilityTask::UpdateScore(FStateTreeExecutionContext& Con
         UE_LOG(LogTemp, Error, TEXT("通用效用任务：AI控制器为空或不是元素战斗AI控制器"));
         return false;
     }
-    
-    const FUtilityProfile& AIProfile = AIController->GetCurrentAIProfile();
 
-    // 创建评分上下文
-    FUtilityContext UtilityContext = CreateUtilityContext(Context);
+    float NewScore = 0.0f;
+    const FUtilityContext* UtilityContext = nullptr;
 
-    // 使用从AIController获取的配置计算评分
-    float NewScore = CalculateUtilityScoreWithCache(AIProfile, UtilityContext);
+    // 优先读取Utility AI子系统的分片评分结果，子系统不可用时在本地计算
+    if (const FUtilityScoreResult* Result = GetSubsystemUtilityResult(AIController, MaxResultAge))
+    {
+        NewScore = Result->Score;
+        UtilityContext = &Result->Context;
+    }
+    else
+    {
+        // 读取本帧的评分上下文快照（并行Tick时快照缺少所需输入则跳过本次更新，沿用上次的评分，下一帧再评分）
+        UtilityContext = GetFrameUtilityContext(Context, AIController->GetAIProfileRequiredInputs());
+        if (!UtilityContext)
+        {
+            InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingUtilityContext);
+            return true;
+        }
+
+        // 使用从AIController获取的共享配置计算评分
+        NewScore = CalculateUtilityScoreWithCache(InstanceData, AIController->GetAIProfileHandle(), *UtilityContext);
+    }
 
     // 更新实例数据
     InstanceData.FinalScore = NewScore;
     InstanceData.bScoreValid = NewScore > 0.01f;
     InstanceData.bTaskCompleted = InstanceData.bScoreValid;
+    InstanceData.LastUpdateTime = GetCurrentWorldTime(Context);
 
     if (bEnableDebugOutput)
     {
@@ -112,7 +135,7 @@ bool FStateTreeUniversalUtilityTask::UpdateScore(FStateTreeExecutionContext& Con
 
         // 显示上下文信息
         LogDebug(FString::Printf(TEXT("  生命值：%.3f， 距离：%.3f， 元素：%.3f"),
-                                UtilityContext.HealthPercent, UtilityContext.DistanceToTarget, UtilityContext.ElementAdvantage));
+                                UtilityContext->HealthPercent, UtilityContext->DistanceToTarget, UtilityContext->ElementAdvantage));
     }
 
     return true;
@@ -144,12 +167,18 @@ EStateTreeRunStatus FStateTreeUtilityConsiderationTask::EnterState(FStateTreeExe
     if (!InstanceData.EnemyCharacter)
     {
         LogDebug(TEXT("效用考虑任务：敌人角色为空"));
-        InstanceData.ErrorMessage = TEXT("未找到敌人角色");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingEnemy);
         return EStateTreeRunStatus::Failed;
     }
 
-    // 创建评分上下文
-    FUtilityContext UtilityContext = CreateUtilityContext(Context);
+    // 读取本帧的评分上下文快照（只采集该评分因素读取的输入）
+    const FUtilityContext* FrameContext = GetFrameUtilityContext(Context, InstanceData.Consideration.GetRequiredInputs());
+    if (!FrameContext)
+    {
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingUtilityContext);
+        return EStateTreeRunStatus::Failed;
+    }
+    const FUtilityContext& UtilityContext = *FrameContext;
 
     // 获取输入值
     InstanceData.InputValue = UtilityContext.GetInputValue(InstanceData.Consideration.ConsiderationType);
@@ -194,7 +223,7 @@ EStateTreeRunStatus FStateTreeUtilityComparisonTask::EnterState(FStateTreeExecut
     if (!InstanceData.EnemyCharacter)
     {
         LogDebug(TEXT("效用比较任务：敌人角色为空"));
-        InstanceData.ErrorMessage = TEXT("未找到敌人角色");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingEnemy);
         return EStateTreeRunStatus::Failed;
     }
 
@@ -202,34 +231,31 @@ EStateTreeRunStatus FStateTreeUtilityComparisonTask::EnterState(FStateTreeExecut
     AElementalCombatAIController* AIController = Cast<AElementalCombatAIController>(InstanceData.AIController);
     if (!AIController)
     {
-        InstanceData.ErrorMessage = TEXT("未找到元素战斗AI控制器");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingController);
         return EStateTreeRunStatus::Failed;
     }
 
-    // 创建评分上下文
-    FUtilityContext UtilityContext = CreateUtilityContext(Context);
+    // 读取本帧的评分上下文快照（权重视图共享基础配置的评分因素）
+    const FUtilityContext* FrameContext = GetFrameUtilityContext(Context, AIController->GetAIProfileRequiredInputs());
+    if (!FrameContext)
+    {
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingUtilityContext);
+        return EStateTreeRunStatus::Failed;
+    }
+    const FUtilityContext& UtilityContext = *FrameContext;
 
     if (InstanceData.bUseWeightVariations)
     {
-        // 使用权重变化模式：基于AIController配置进行两种不同的权重调整
-        FUtilityProfile ProfileA = AIController->GetCurrentAIProfile();
-        FUtilityProfile ProfileB = AIController->GetCurrentAIProfile();
+        // 使用权重变化模式：在共享配置之上叠加两组权重视图，不复制配置文件
+        const FUtilityWeightOverlay OverlayA = FUtilityWeightOverlay::FromMultipliers(AIController->GetAIProfileHandle(), InstanceData.WeightVariationA);
+        const FUtilityWeightOverlay OverlayB = FUtilityWeightOverlay::FromMultipliers(AIController->GetAIProfileHandle(), InstanceData.WeightVariationB);
 
-        // 应用权重变化A
-        for (const auto& WeightPair : InstanceData.WeightVariationA)
-        {
-            ProfileA.SetWeight(WeightPair.Key, ProfileA.GetWeight(WeightPair.Key) * WeightPair.Value);
-        }
-
-        // 应用权重变化B
-        for (const auto& WeightPair : InstanceData.WeightVariationB)
-        {
-            ProfileB.SetWeight(WeightPair.Key, ProfileB.GetWeight(WeightPair.Key) * WeightPair.Value);
-        }
-
-        // 计算两个配置的评分
-        InstanceData.ScoreA = CalculateUtilityScoreWithCache(ProfileA, UtilityContext);
-        InstanceData.ScoreB = CalculateUtilityScoreWithCache(ProfileB, UtilityContext);
+        // 两个视图只有权重不同，一遍评分共用各评分因素的单项输出
+        const FUtilityWeightOverlay* Overlays[] = { &OverlayA, &OverlayB };
+        float Scores[UE_ARRAY_COUNT(Overlays)];
+        CalculateUtilityScoresWithCache(InstanceData, Overlays, UtilityContext, Scores);
+        InstanceData.ScoreA = Scores[0];
+        InstanceData.ScoreB = Scores[1];
 
         // 比较评分
         InstanceData.bIsABetter = InstanceData.ScoreA > InstanceData.ScoreB;
@@ -250,7 +276,7 @@ EStateTreeRunStatus FStateTreeUtilityComparisonTask::EnterState(FStateTreeExecut
     {
         // 降级模式：只使用基础配置
         const FUtilityProfile& BaseProfile = AIController->GetCurrentAIProfile();
-        InstanceData.ScoreA = CalculateUtilityScoreWithCache(BaseProfile, UtilityContext);
+        InstanceData.ScoreA = CalculateUtilityScoreWithCache(InstanceData, AIController->GetAIProfileHandle(), UtilityContext);
         InstanceData.ScoreB = InstanceData.ScoreA; // 相同配置
         InstanceData.bIsABetter = true;
         InstanceData.FinalScore = InstanceData.ScoreA;
@@ -289,43 +315,73 @@ EStateTreeRunStatus FStateTreeDynamicUtilityTask::EnterState(FStateTreeExecution
     if (!InstanceData.EnemyCharacter)
     {
         LogDebug(TEXT("动态效用任务：敌人角色为空"));
-        InstanceData.ErrorMessage = TEXT("未找到敌人角色");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingEnemy);
         return EStateTreeRunStatus::Failed;
     }
 
-    // 创建评分上下文
-    FUtilityContext UtilityContext = CreateUtilityContext(Context);
-
     // 获取AIController配置
     AElementalCombatAIController* AIController = Cast<AElementalCombatAIController>(InstanceData.AIController);
     if (!AIController)
     {
-        InstanceData.ErrorMessage = TEXT("未找到元素战斗AI控制器");
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingController);
         return EStateTreeRunStatus::Failed;
     }
 
+    // 读取本帧的评分上下文快照（配置读取的输入加上动态权重读取的输入）
+    // 并行Tick时快照缺少所需输入则保持运行，由Tick在下一帧评分
+    const FUtilityContext* UtilityContext = GetFrameUtilityContext(Context, AIController->GetAIProfileRequiredInputs() | DynamicWeightInputs);
+    if (!UtilityContext)
+    {
+        InstanceData.ErrorStatus.Set(EElementalTaskStatus::MissingUtilityContext);
+        return EStateTreeRunStatus::Running;
+    }
+
     // 计算动态权重调整
-    CalculateDynamicWeights(UtilityContext, InstanceData);
+    CalculateDynamicWeights(*UtilityContext, InstanceData);
+
+    // 在Utility AI子系统中注册带权重覆盖的评分请求，后续评分按帧预算分片执行（子系统只能在游戏线程访问，并行Tick时在本地评分）
+    UUtilityAISubsystem* UtilitySubsystem = IsInGameThread() ? UUtilityAISubsystem::Get(AIController) : nullptr;
+    TSharedPtr<const FCompiledUtilityProfile> CompiledProfile = AIController->GetCompiledAIProfile();
+    if (UtilitySubsystem && CompiledProfile.IsValid())
+    {
+        UtilitySubsystem->UnregisterRequest(InstanceData.ScoreRequest);
+
+        FUtilityScoreRequestDesc Desc;
+        Desc.Agent = InstanceData.EnemyCharacter.Get();
+        Desc.Profile = CompiledProfile;
+        Desc.UpdateInterval = InstanceData.UpdateInterval;
+        Desc.bEvaluateImmediately = false;
+        Desc.ContextProvider = [WeakController = TWeakObjectPtr<const AElementalCombatAIController>(AIController)](FUtilityContext& OutContext)
+        {
+            const AElementalCombatAIController* Controller = WeakController.Get();
+            return Controller && Controller->BuildUtilityContext(OutContext, Controller->GetAIProfileRequiredInputs() | DynamicWeightInputs);
+        };
+        InstanceData.ScoreRequest = UtilitySubsystem->RegisterRequest(MoveTemp(Desc));
 
-    // 应用调整后的权重计算评分
-    FUtilityProfile AdjustedProfile = AIController->GetCurrentAIProfile();
-    for (const auto& Pair : InstanceData.CurrentWeights)
+        PushWeightsToRequest(*UtilitySubsystem, InstanceData);
+        if (const FUtilityScoreResult* Result = UtilitySubsystem->EvaluateNow(InstanceData.ScoreRequest))
+        {
+            InstanceData.FinalScore = Result->Score;
+        }
+    }
+    else
     {
-        AdjustedProfile.SetWeight(Pair.Key, Pair.Value);
+        // 在共享配置之上叠加调整后的权重计算评分，不复制配置文件
+        const FUtilityWeightOverlay Overlay = FUtilityWeightOverlay::FromWeights(AIController->GetAIProfileHandle(), InstanceData.CurrentWeights);
+        InstanceData.FinalScore = CalculateUtilityScoreWithCache(InstanceData, Overlay, *UtilityContext);
     }
 
-    InstanceData.FinalScore = CalculateUtilityScoreWithCache(AdjustedProfile, UtilityContext);
     InstanceData.bTaskCompleted = InstanceData.FinalScore > 0.01f;
 
     if (bEnableDebugOutput)
     {
         LogDebug(FString::Printf(TEXT("DynamicUtility[%s]: Adjusted score %.3f"),
-                                *AdjustedProfile.ProfileName, InstanceData.FinalScore));
+                                *AIController->GetCurrentAIProfile().ProfileName, InstanceData.FinalScore));
         
-        for (const auto& Pair : InstanceData.CurrentWeights)
+        for (const auto& WeightPair : AIController->GetCurrentAIProfile().Weights)
         {
-            FString TypeName = UEnum::GetValueAsString(Pair.Key);
-            LogDebug(FString::Printf(TEXT("  Weight[%s]: %.3f"), *TypeName, Pair.Value));
+            FString TypeName = UEnum::GetValueAsString(WeightPair.Key);
+            LogDebug(FString::Printf(TEXT("  Weight[%s]: %.3f"), *TypeName, InstanceData.GetCurrentWeight(WeightPair.Key)));
         }
     }
 
@@ -348,22 +404,67 @@ EStateTreeRunStatus FStateTreeDynamicUtilityTask::Tick(FStateTreeExecutionContex
         return EStateTreeRunStatus::Failed;
     }
 
-    // 持续更新动态权重
-    FUtilityContext UtilityContext = CreateUtilityContext(Context);
-    CalculateDynamicWeights(UtilityContext, InstanceData);
+    // 读取子系统的最新结果，并用结果中的上下文快照更新下一次评分的权重（只在游戏线程上访问子系统）
+    UUtilityAISubsystem* UtilitySubsystem = IsInGameThread() ? UUtilityAISubsystem::Get(AIController) : nullptr;
+    TSharedPtr<const FCompiledUtilityProfile> CompiledProfile = AIController->GetCompiledAIProfile();
+    if (UtilitySubsystem && CompiledProfile.IsValid() && UtilitySubsystem->IsRequestValid(InstanceData.ScoreRequest))
+    {
+        if (const FUtilityScoreResult* Result = UtilitySubsystem->GetResult(InstanceData.ScoreRequest))
+        {
+            InstanceData.FinalScore = Result->Score;
+            CalculateDynamicWeights(Result->Context, InstanceData);
+            PushWeightsToRequest(*UtilitySubsystem, InstanceData);
+        }
+        return EStateTreeRunStatus::Running;
+    }
 
-    // 重新计算评分
-    FUtilityProfile AdjustedProfile = AIController->GetCurrentAIProfile();
-    for (const auto& Pair : InstanceData.CurrentWeights)
+    // 持续更新动态权重（快照缺少所需输入时跳过本帧）
+    const FUtilityContext* UtilityContext = GetFrameUtilityContext(Context, AIController->GetAIProfileRequiredInputs() | DynamicWeightInputs);
+    if (!UtilityContext)
     {
-        AdjustedProfile.SetWeight(Pair.Key, Pair.Value);
+        return EStateTreeRunStatus::Running;
     }
+    CalculateDynamicWeights(*UtilityContext, InstanceData);
 
-    InstanceData.FinalScore = CalculateUtilityScoreWithCache(AdjustedProfile, UtilityContext);
+    // 重新计算评分（权重视图叠加在共享配置之上，不复制配置文件）
+    const FUtilityWeightOverlay Overlay = FUtilityWeightOverlay::FromWeights(AIController->GetAIProfileHandle(), InstanceData.CurrentWeights);
+    InstanceData.FinalScore = CalculateUtilityScoreWithCache(InstanceData, Overlay, *UtilityContext);
 
     return EStateTreeRunStatus::Running;
 }
 
+void FStateTreeDynamicUtilityTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+    FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+    if (UUtilityAISubsystem* UtilitySubsystem = UUtilityAISubsystem::Get(InstanceData.AIController))
+    {
+        if (IsInGameThread())
+        {
+            UtilitySubsystem->UnregisterRequest(InstanceData.ScoreRequest);
+        }
+        else if (InstanceData.ScoreRequest.IsValid())
+        {
+            // 并行Tick中退出状态时交给游戏线程注销
+            AsyncTask(ENamedThreads::GameThread, [WeakSubsystem = TWeakObjectPtr<UUtilityAISubsystem>(UtilitySubsystem), Request = InstanceData.ScoreRequest]() mutable
+            {
+                if (UUtilityAISubsystem* Subsystem = WeakSubsystem.Get())
+                {
+                    Subsystem->UnregisterRequest(Request);
+                }
+            });
+        }
+    }
+    InstanceData.ScoreRequest.Reset();
+
+    CancelEQSQuery(Context, InstanceData.EQSRequest);
+}
+
+void FStateTreeDynamicUtilityTask::PushWeightsToRequest(UUtilityAISubsystem& UtilitySubsystem, const FInstanceDataType& InstanceData) const
+{
+    UtilitySubsystem.SetRequestWeights(InstanceData.ScoreRequest, MakeArrayView(InstanceData.CurrentWeights));
+}
+
 void FStateTreeDynamicUtilityTask::CalculateDynamicWeights(const FUtilityContext& UtilityContext, FInstanceDataType& InstanceData) const
 {
     // 获取AIController配置作为基础权重
@@ -373,18 +474,21 @@ void FStateTreeDynamicUtilityTask::CalculateDynamicWeights(const FUtilityContext
         return;
     }
     const FUtilityProfile& AIProfile = AIController->GetCurrentAIProfile();
-    InstanceData.CurrentWeights = AIProfile.Weights;
+    for (int32 i = 0; i < FCompiledUtilityProfile::NumConsiderationTypes; ++i)
+    {
+        InstanceData.CurrentWeights[i] = AIProfile.GetWeight(static_cast<EConsiderationType>(i));
+    }
 
     if (!InstanceData.bUseDynamicAdjustment)
     {
         return;
     }
 
-    // 应用动态调整
-    for (auto& WeightPair : InstanceData.CurrentWeights)
+    // 应用动态调整（只调整配置文件中显式设置的权重）
+    for (const auto& WeightPair : AIProfile.Weights)
     {
         EConsiderationType Type = WeightPair.Key;
-        float& CurrentWeight = WeightPair.Value;
+        float& CurrentWeight = InstanceData.CurrentWeights[static_cast<int32>(Type)];
 
         // 查找是否有预设的调整
         if (const float* Adjustment = InstanceData.WeightAdjustments.Find(Type))
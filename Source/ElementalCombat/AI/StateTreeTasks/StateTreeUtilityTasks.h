@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "ElementalStateTreeTaskBase.h"
 #include "AI/Utility/UtilityAITypes.h"
+#include "AI/Utility/UtilityAISubsystem.h"
 #include "Engine/DataTable.h"
 #include "StateTreeUtilityTasks.generated.h"
 
@@ -44,8 +45,6 @@ private:
     friend struct FStateTreeUniversalUtilityTask;
 };
 
-STATETREE_POD_INSTANCEDATA(FStateTreeUniversalUtilityInstanceData);
-
 /**
  * 通用Utility评分任务
  * 根据配置的评分配置文件计算综合评分
@@ -69,8 +68,11 @@ struct ELEMENTALCOMBAT_API FStateTreeUniversalUtilityTask : public FElementalSta
 #endif
 
 protected:
-    /** 更新评分计算 */
-    bool UpdateScore(FStateTreeExecutionContext& Context) const;
+    /**
+     * 更新评分计算（并行Tick时本帧快照缺少所需输入则跳过本次更新，返回true并沿用上次的评分）
+     * @param MaxResultAge 允许读取的子系统结果最大陈旧时间（秒），<0表示接受最新结果
+     */
+    bool UpdateScore(FStateTreeExecutionContext& Context, float MaxResultAge) const;
 
     /** 检查是否需要更新 */
     bool ShouldUpdate(const FInstanceDataType& InstanceData, float CurrentTime) const;
@@ -105,8 +107,6 @@ struct FStateTreeUtilityConsiderationInstanceData : public FElementalStateTreeIn
     float ValidScoreThreshold = 0.1f;
 };
 
-STATETREE_POD_INSTANCEDATA(FStateTreeUtilityConsiderationInstanceData);
-
 /**
  * 单项Utility评分任务
  * 计算单一评分因素的值，用于调试或特定条件判断
@@ -173,8 +173,6 @@ struct FStateTreeUtilityComparisonInstanceData : public FElementalStateTreeInsta
     float ScoreDifference = 0.0f;
 };
 
-STATETREE_POD_INSTANCEDATA(FStateTreeUtilityComparisonInstanceData);
-
 /**
  * Utility评分比较任务
  * 比较两个不同的评分配置，选择更好的那个
@@ -204,6 +202,10 @@ struct FStateTreeDynamicUtilityInstanceData : public FElementalStateTreeInstance
 {
     GENERATED_BODY()
 
+    FStateTreeDynamicUtilityInstanceData()
+    {
+        FMemory::Memzero(CurrentWeights);
+    }
 
     /** 权重调整映射 */
     UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI")
@@ -217,12 +219,30 @@ struct FStateTreeDynamicUtilityInstanceData : public FElementalStateTreeInstance
     UPROPERTY(VisibleAnywhere, Category = "Output")
     float FinalScore = 0.0f;    /** 基础评分（调整前，输出） */    UPROPERTY(EditAnywhere, Category = "Output")    float BaseScore = 0.0f;    /** 评分是否有效（输出） */    UPROPERTY(EditAnywhere, Category = "Output")    bool bScoreValid = false;
 
-    /** 当前应用的权重（输出，调试用） */
+    /**
+     * 当前应用的权重（输出，调试用；按EConsiderationType下标，每次调整原地覆盖）
+     * 旧版本为TMap，类型变化后原有绑定需要重新连接，C++中通过GetCurrentWeight读取
+     */
     UPROPERTY(VisibleAnywhere, Category = "Output")
-    TMap<EConsiderationType, float> CurrentWeights;
-};
+    float CurrentWeights[FCompiledUtilityProfile::NumConsiderationTypes];
+
+    /** 获取当前应用的权重 */
+    float GetCurrentWeight(EConsiderationType Type) const
+    {
+        const int32 Index = static_cast<int32>(Type);
+        return Index >= 0 && Index < FCompiledUtilityProfile::NumConsiderationTypes ? CurrentWeights[Index] : 0.0f;
+    }
 
-STATETREE_POD_INSTANCEDATA(FStateTreeDynamicUtilityInstanceData);
+    /** 子系统中评分请求的更新间隔（秒） */
+    UPROPERTY(EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+    float UpdateInterval = 0.2f;
+
+private:
+    /** Utility AI子系统中的评分请求（内部使用） */
+    FUtilityScoreRequestHandle ScoreRequest;
+
+    friend struct FStateTreeDynamicUtilityTask;
+};
 
 /**
  * 动态Utility权重调整任务
@@ -240,6 +260,7 @@ struct ELEMENTALCOMBAT_API FStateTreeDynamicUtilityTask : public FElementalState
 
     virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
     virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+    virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
 
 #if WITH_EDITOR
     virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
@@ -248,4 +269,7 @@ struct ELEMENTALCOMBAT_API FStateTreeDynamicUtilityTask : public FElementalState
 protected:
     /** 计算动态权重调整 */
     void CalculateDynamicWeights(const FUtilityContext& UtilityContext, FInstanceDataType& InstanceData) const;
+
+    /** 将当前权重推送到子系统中的评分请求 */
+    void PushWeightsToRequest(UUtilityAISubsystem& UtilitySubsystem, const FInstanceDataType& InstanceData) const;
 };
\ No newline at end of file
@@ -0,0 +1,548 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "CompiledUtilityProfile.h"
+#include "Curves/RichCurve.h"
+#include <atomic>
+
+namespace
+{
+    /** 下一个编译版本（0保留给未编译和未评分的状态） */
+    std::atomic<uint64> NextCompileVersion{1};
+}
+
+FCompiledUtilityProfile::FCompiledUtilityProfile()
+{
+    Reset();
+}
+
+void FCompiledUtilityProfile::Reset()
+{
+    Considerations.Reset();
+    for (int32 i = 0; i < NumConsiderationTypes; ++i)
+    {
+        Weights[i] = 0.0f;
+    }
+    ProfileName.Reset();
+    bUseMultiplicativeCombination = false;
+    MinScoreThreshold = 0.01f;
+    bHasSourceConsiderations = false;
+    RequiredInputs = 0;
+    bCompiled = false;
+    Version = 0;
+}
+
+bool FCompiledUtilityProfile::Compile(const FUtilityProfile& Profile, float MaxError)
+{
+    Reset();
+
+    ProfileName = Profile.ProfileName;
+    bUseMultiplicativeCombination = Profile.bUseMultiplicativeCombination;
+    MinScoreThreshold = Profile.MinScoreThreshold;
+    bHasSourceConsiderations = Profile.Considerations.Num() > 0;
+
+    for (int32 i = 0; i < NumConsiderationTypes; ++i)
+    {
+        Weights[i] = Profile.GetWeight(static_cast<EConsiderationType>(i));
+    }
+
+    // 统计有效权重，权重<=0的评分因素不参与组合，直接剔除
+    float TotalWeight = 0.0f;
+    for (const FUtilityConsideration& Source : Profile.Considerations)
+    {
+        const float Weight = Weights[static_cast<int32>(Source.ConsiderationType)];
+        if (Weight > 0.0f)
+        {
+            TotalWeight += Weight;
+        }
+    }
+
+    bool bAllWithinError = true;
+    if (TotalWeight > 0.0f)
+    {
+        Considerations.Reserve(Profile.Considerations.Num());
+
+        for (const FUtilityConsideration& Source : Profile.Considerations)
+        {
+            const float Weight = Weights[static_cast<int32>(Source.ConsiderationType)];
+            if (Weight <= 0.0f)
+            {
+                continue;
+            }
+
+            FCompiledConsideration& Compiled = Considerations.AddDefaulted_GetRef();
+            Compiled.ConsiderationType = Source.ConsiderationType;
+            Compiled.CustomSlot = ResolveCustomSlot(Source);
+            Compiled.InputMultiplier = Source.InputMultiplier;
+            Compiled.bInvertInput = Source.bInvertInput;
+            Compiled.NormalizedWeight = Weight / TotalWeight;
+            Compiled.RescoreInputEpsilon = FMath::Max(0.0f, Source.RescoreInputEpsilon);
+            RequiredInputs |= UtilityInputs::ForConsideration(Compiled.ConsiderationType, Compiled.CustomSlot);
+
+            // 响应曲线 + 输出偏移 + 限制，与FUtilityConsideration::CalculateScore保持一致
+            const FRichCurve* RichCurve = Source.ResponseCurve.GetRichCurveConst();
+            const float OutputOffset = Source.OutputOffset;
+            auto ScoreSampler = [RichCurve, OutputOffset](float ProcessedInput)
+            {
+                const float RawOutput = RichCurve ? RichCurve->Eval(ProcessedInput) : ProcessedInput;
+                return FMath::Clamp(RawOutput + OutputOffset, 0.0f, 1.0f);
+            };
+
+            const int32 SampleCount = Source.BakedCurveSampleCount;
+            if (bUseMultiplicativeCombination)
+            {
+                bAllWithinError &= BakeLogScoreLUT(Compiled.LogScoreLUT, ScoreSampler, SampleCount, MaxError);
+            }
+            else
+            {
+                bAllWithinError &= Compiled.ScoreLUT.Bake(ScoreSampler, SampleCount, MaxError);
+            }
+        }
+    }
+
+    bCompiled = true;
+    Version = NextCompileVersion.fetch_add(1, std::memory_order_relaxed);
+    return bAllWithinError;
+}
+
+bool FCompiledUtilityProfile::BakeLogScoreLUT(FUtilityCurveLUT& OutLUT, TFunctionRef<float(float)> ScoreSampler, int32 InitialSampleCount, float MaxError)
+{
+    auto LogSampler = [&ScoreSampler](float ProcessedInput)
+    {
+        const float Score = ScoreSampler(ProcessedInput);
+        return Score > 0.0f ? FMath::Loge(Score) : LogZeroScore;
+    };
+
+    // 对数域的插值误差在评分接近0时会被放大，因此在线性域中度量并按需加密采样
+    int32 SampleCount = FMath::Clamp(InitialSampleCount, 2, FUtilityCurveLUT::MaxSampleCount);
+    for (;;)
+    {
+        OutLUT.Bake(LogSampler, SampleCount, 0.0f);
+
+        const int32 NumChecks = (SampleCount - 1) * FUtilityCurveLUT::ValidationSubSteps + 1;
+        float MaxDeviation = 0.0f;
+        for (int32 i = 0; i < NumChecks; ++i)
+        {
+            const float Input = static_cast<float>(i) / static_cast<float>(NumChecks - 1);
+            MaxDeviation = FMath::Max(MaxDeviation, FMath::Abs(FMath::Exp(OutLUT.Eval(Input)) - ScoreSampler(Input)));
+        }
+
+        if (MaxError <= 0.0f || MaxDeviation <= MaxError)
+        {
+            return true;
+        }
+
+        if (SampleCount >= FUtilityCurveLUT::MaxSampleCount)
+        {
+            return false;
+        }
+
+        SampleCount = FMath::Min(SampleCount * 2, FUtilityCurveLUT::MaxSampleCount);
+    }
+}
+
+int32 FCompiledUtilityProfile::ResolveCustomSlot(const FUtilityConsideration& Source)
+{
+    switch (Source.ConsiderationType)
+    {
+    case EConsiderationType::Cooldown:
+        return UtilityCustomSlots::Cooldown;
+    case EConsiderationType::TeamStatus:
+        return UtilityCustomSlots::TeamStatus;
+    case EConsiderationType::Custom:
+        return Source.CustomKey.IsEmpty() ? INDEX_NONE : FUtilityCustomSlotRegistry::Get().FindOrAddSlot(FName(*Source.CustomKey));
+    default:
+        return INDEX_NONE;
+    }
+}
+
+float FCompiledUtilityProfile::GetProcessedInput(const FCompiledConsideration& Consideration, const FUtilityContext& Context)
+{
+    float Input = Consideration.ConsiderationType == EConsiderationType::Custom
+        ? Context.GetCustomValue(Consideration.CustomSlot, 0.0f)
+        : Context.GetInputValue(Consideration.ConsiderationType);
+
+    Input *= Consideration.InputMultiplier;
+    if (Consideration.bInvertInput)
+    {
+        Input = 1.0f - Input;
+    }
+
+    return FMath::Clamp(Input, 0.0f, 1.0f);
+}
+
+float FCompiledUtilityProfile::CalculateScore(const FUtilityContext& Context, bool* bOutIsValid) const
+{
+    if (!bHasSourceConsiderations)
+    {
+        if (bOutIsValid) *bOutIsValid = false;
+        return 0.0f;
+    }
+
+    // 所有评分因素权重为0时Considerations为空，结果为0
+    float FinalScore = 0.0f;
+    if (Considerations.Num() > 0)
+    {
+        if (bUseMultiplicativeCombination)
+        {
+            // Π(Score^Weight)^(1/TotalWeight) = Exp(Σ NormalizedWeight * ln(Score))
+            float LogSum = 0.0f;
+            for (const FCompiledConsideration& Consideration : Considerations)
+            {
+                LogSum += Consideration.NormalizedWeight * Consideration.LogScoreLUT.Eval(GetProcessedInput(Consideration, Context));
+            }
+            FinalScore = FMath::Exp(LogSum);
+        }
+        else
+        {
+            for (const FCompiledConsideration& Consideration : Considerations)
+            {
+                FinalScore += Consideration.NormalizedWeight * Consideration.ScoreLUT.Eval(GetProcessedInput(Consideration, Context));
+            }
+        }
+    }
+
+    if (bOutIsValid) *bOutIsValid = FinalScore >= MinScoreThreshold;
+    return FinalScore;
+}
+
+float FCompiledUtilityProfile::CalculateScoreWithWeights(const FUtilityContext& Context, const float* WeightsByType, bool* bOutIsValid) const
+{
+    check(WeightsByType);
+
+    if (!bHasSourceConsiderations)
+    {
+        if (bOutIsValid) *bOutIsValid = false;
+        return 0.0f;
+    }
+
+    float TotalWeight = 0.0f;
+    for (const FCompiledConsideration& Consideration : Considerations)
+    {
+        TotalWeight += FMath::Max(0.0f, WeightsByType[static_cast<int32>(Consideration.ConsiderationType)]);
+    }
+
+    float FinalScore = 0.0f;
+    if (TotalWeight > 0.0f)
+    {
+        const float InvTotalWeight = 1.0f / TotalWeight;
+        if (bUseMultiplicativeCombination)
+        {
+            float LogSum = 0.0f;
+            for (const FCompiledConsideration& Consideration : Considerations)
+            {
+                const float Weight = FMath::Max(0.0f, WeightsByType[static_cast<int32>(Consideration.ConsiderationType)]) * InvTotalWeight;
+                LogSum += Weight * Consideration.LogScoreLUT.Eval(GetProcessedInput(Consideration, Context));
+            }
+            FinalScore = FMath::Exp(LogSum);
+        }
+        else
+        {
+            for (const FCompiledConsideration& Consideration : Considerations)
+            {
+                const float Weight = FMath::Max(0.0f, WeightsByType[static_cast<int32>(Consideration.ConsiderationType)]) * InvTotalWeight;
+                FinalScore += Weight * Consideration.ScoreLUT.Eval(GetProcessedInput(Consideration, Context));
+            }
+        }
+    }
+
+    if (bOutIsValid) *bOutIsValid = FinalScore >= MinScoreThreshold;
+    return FinalScore;
+}
+
+void FCompiledUtilityProfile::CalculateScoresWithWeightSets(const FUtilityContext& Context, TConstArrayView<const float*> WeightSets,
+                                                           TArrayView<float> OutScores, TArrayView<bool> OutIsValid) const
+{
+    check(OutScores.Num() == WeightSets.Num());
+    check(OutIsValid.Num() == 0 || OutIsValid.Num() == WeightSets.Num());
+
+    if (!bHasSourceConsiderations)
+    {
+        for (int32 SetIndex = 0; SetIndex < WeightSets.Num(); ++SetIndex)
+        {
+            OutScores[SetIndex] = 0.0f;
+            if (OutIsValid.Num() > 0) OutIsValid[SetIndex] = false;
+        }
+        return;
+    }
+
+    // 单项输出只和输入有关，各组权重共用
+    const int32 NumConsiderations = Considerations.Num();
+    TArray<float, TInlineAllocator<16>> Terms;
+    Terms.SetNumUninitialized(NumConsiderations);
+    for (int32 i = 0; i < NumConsiderations; ++i)
+    {
+        const FCompiledConsideration& Consideration = Considerations[i];
+        const float Input = GetProcessedInput(Consideration, Context);
+        Terms[i] = bUseMultiplicativeCombination ? Consideration.LogScoreLUT.Eval(Input) : Consideration.ScoreLUT.Eval(Input);
+    }
+
+    // 按与CalculateScoreWithWeights相同的顺序组合
+    for (int32 SetIndex = 0; SetIndex < WeightSets.Num(); ++SetIndex)
+    {
+        const float* WeightsByType = WeightSets[SetIndex];
+        check(WeightsByType);
+
+        float TotalWeight = 0.0f;
+        for (const FCompiledConsideration& Consideration : Considerations)
+        {
+            TotalWeight += FMath::Max(0.0f, WeightsByType[static_cast<int32>(Consideration.ConsiderationType)]);
+        }
+
+        float FinalScore = 0.0f;
+        if (TotalWeight > 0.0f)
+        {
+            const float InvTotalWeight = 1.0f / TotalWeight;
+            float Sum = 0.0f;
+            for (int32 i = 0; i < NumConsiderations; ++i)
+            {
+                const float Weight = FMath::Max(0.0f, WeightsByType[static_cast<int32>(Considerations[i].ConsiderationType)]) * InvTotalWeight;
+                Sum += Weight * Terms[i];
+            }
+            FinalScore = bUseMultiplicativeCombination ? FMath::Exp(Sum) : Sum;
+        }
+
+        OutScores[SetIndex] = FinalScore;
+        if (OutIsValid.Num() > 0) OutIsValid[SetIndex] = FinalScore >= MinScoreThreshold;
+    }
+}
+
+float FCompiledUtilityProfile::CalculateScoreIncremental(const FUtilityContext& Context, FUtilityIncrementalScoreState& State,
+                                                         const float* WeightsByType, bool* bOutIsValid) const
+{
+    if (!bHasSourceConsiderations)
+    {
+        State.LastRescoredCount = 0;
+        if (bOutIsValid) *bOutIsValid = false;
+        return 0.0f;
+    }
+
+    const int32 NumConsiderations = Considerations.Num();
+    // 按编译版本校验，地址相同但内容不同的配置文件（释放后复用或原地重新编译）不会沿用旧状态
+    if (State.ProfileVersion != Version || State.Inputs.Num() != NumConsiderations)
+    {
+        State.Reset();
+        State.ProfileVersion = Version;
+        State.Inputs.SetNumUninitialized(NumConsiderations);
+        State.Terms.SetNumUninitialized(NumConsiderations);
+    }
+
+    // 权重覆盖变化时需要重新组合，但单项输出仍然可以复用
+    bool bWeightsChanged = State.bHasWeightOverrides != (WeightsByType != nullptr);
+    if (WeightsByType && !bWeightsChanged)
+    {
+        bWeightsChanged = FMemory::Memcmp(State.WeightOverrides, WeightsByType, sizeof(State.WeightOverrides)) != 0;
+    }
+    if (bWeightsChanged)
+    {
+        State.bHasWeightOverrides = WeightsByType != nullptr;
+        if (WeightsByType)
+        {
+            FMemory::Memcpy(State.WeightOverrides, WeightsByType, sizeof(State.WeightOverrides));
+        }
+    }
+
+    // 只重新求值输入变化超过阈值的评分因素
+    int32 RescoredCount = 0;
+    for (int32 i = 0; i < NumConsiderations; ++i)
+    {
+        const FCompiledConsideration& Consideration = Considerations[i];
+        const float Input = GetProcessedInput(Consideration, Context);
+        if (State.bInitialized && FMath::Abs(Input - State.Inputs[i]) <= Consideration.RescoreInputEpsilon)
+        {
+            continue;
+        }
+
+        State.Inputs[i] = Input;
+        State.Terms[i] = bUseMultiplicativeCombination ? Consideration.LogScoreLUT.Eval(Input) : Consideration.ScoreLUT.Eval(Input);
+        ++RescoredCount;
+    }
+    State.LastRescoredCount = RescoredCount;
+
+    if (State.bInitialized && RescoredCount == 0 && !bWeightsChanged)
+    {
+        if (bOutIsValid) *bOutIsValid = State.bIsValid;
+        return State.CombinedScore;
+    }
+
+    // 按与完整评分相同的顺序组合，保证阈值为0时结果逐位一致
+    float FinalScore = 0.0f;
+    if (WeightsByType)
+    {
+        float TotalWeight = 0.0f;
+        for (const FCompiledConsideration& Consideration : Considerations)
+        {
+            TotalWeight += FMath::Max(0.0f, WeightsByType[static_cast<int32>(Consideration.ConsiderationType)]);
+        }
+
+        if (TotalWeight > 0.0f)
+        {
+            const float InvTotalWeight = 1.0f / TotalWeight;
+            float Sum = 0.0f;
+            for (int32 i = 0; i < NumConsiderations; ++i)
+            {
+                const float Weight = FMath::Max(0.0f, WeightsByType[static_cast<int32>(Considerations[i].ConsiderationType)]) * InvTotalWeight;
+                Sum += Weight * State.Terms[i];
+            }
+            FinalScore = bUseMultiplicativeCombination ? FMath::Exp(Sum) : Sum;
+        }
+    }
+    else if (NumConsiderations > 0)
+    {
+        float Sum = 0.0f;
+        for (int32 i = 0; i < NumConsiderations; ++i)
+        {
+            Sum += Considerations[i].NormalizedWeight * State.Terms[i];
+        }
+        FinalScore = bUseMultiplicativeCombination ? FMath::Exp(Sum) : Sum;
+    }
+
+    State.CombinedScore = FinalScore;
+    State.bIsValid = FinalScore >= MinScoreThreshold;
+    State.bInitialized = true;
+
+    if (bOutIsValid) *bOutIsValid = State.bIsValid;
+    return FinalScore;
+}
+
+TArrayView<const float> FCompiledUtilityProfile::GetInputColumn(const FCompiledConsideration& Consideration, const FUtilityBatchInputs& Inputs)
+{
+    switch (Consideration.ConsiderationType)
+    {
+    case EConsiderationType::Health:
+        return Inputs.HealthPercent;
+    case EConsiderationType::Distance:
+        return Inputs.DistanceToTarget;
+    case EConsiderationType::ElementAdvantage:
+        return Inputs.ElementAdvantage;
+    case EConsiderationType::ThreatLevel:
+        return Inputs.ThreatLevel;
+    case EConsiderationType::Cooldown:
+    case EConsiderationType::TeamStatus:
+    case EConsiderationType::Custom:
+        return Inputs.GetCustomColumn(Consideration.CustomSlot);
+    default:
+        return TArrayView<const float>();
+    }
+}
+
+void FCompiledUtilityProfile::GatherProcessedInputs(const FCompiledConsideration& Consideration, TArrayView<const float> Column, int32 Start, int32 Num, float* OutProcessed)
+{
+    // 与FUtilityContext::GetInputValue保持一致的标准化，列缺失时使用FUtilityContext的默认值
+    float Scale = 1.0f;
+    float Bias = 0.0f;
+    float DefaultValue = 0.0f;
+    switch (Consideration.ConsiderationType)
+    {
+    case EConsiderationType::Health:
+        DefaultValue = 1.0f;
+        break;
+    case EConsiderationType::Distance:
+        Scale = 1.0f / 1000.0f;
+        break;
+    case EConsiderationType::ElementAdvantage:
+        Scale = 0.5f;
+        Bias = 0.5f;
+        DefaultValue = 0.5f;
+        break;
+    case EConsiderationType::Cooldown:
+        DefaultValue = 1.0f;
+        break;
+    case EConsiderationType::TeamStatus:
+        DefaultValue = 0.5f;
+        break;
+    default:
+        break;
+    }
+
+    // 标准化后的反转和乘数合并为一次乘加：Input * M 或 1 - Input * M
+    const bool bNormalizeClamp = Consideration.ConsiderationType == EConsiderationType::Distance
+        || Consideration.ConsiderationType == EConsiderationType::ElementAdvantage;
+    const float Multiplier = Consideration.bInvertInput ? -Consideration.InputMultiplier : Consideration.InputMultiplier;
+    const float Offset = Consideration.bInvertInput ? 1.0f : 0.0f;
+
+    if (Column.Num() == 0)
+    {
+        const float DefaultProcessed = FMath::Clamp(DefaultValue * Multiplier + Offset, 0.0f, 1.0f);
+        for (int32 i = 0; i < Num; ++i)
+        {
+            OutProcessed[i] = DefaultProcessed;
+        }
+        return;
+    }
+
+    check(Column.Num() >= Start + Num);
+    const float* RESTRICT Raw = Column.GetData() + Start;
+    float* RESTRICT Processed = OutProcessed;
+
+    if (bNormalizeClamp)
+    {
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const float Normalized = FMath::Clamp(Raw[i] * Scale + Bias, 0.0f, 1.0f);
+            Processed[i] = FMath::Clamp(Normalized * Multiplier + Offset, 0.0f, 1.0f);
+        }
+    }
+    else
+    {
+        for (int32 i = 0; i < Num; ++i)
+        {
+            Processed[i] = FMath::Clamp(Raw[i] * Multiplier + Offset, 0.0f, 1.0f);
+        }
+    }
+}
+
+void FCompiledUtilityProfile::CalculateScores(const FUtilityBatchInputs& Inputs, TArrayView<float> OutScores) const
+{
+    check(OutScores.Num() >= Inputs.Count);
+
+    float* RESTRICT Scores = OutScores.GetData();
+    const int32 Count = Inputs.Count;
+
+    if (!bHasSourceConsiderations || Considerations.Num() == 0)
+    {
+        for (int32 i = 0; i < Count; ++i)
+        {
+            Scores[i] = 0.0f;
+        }
+        return;
+    }
+
+    alignas(16) float ProcessedInputs[BatchChunkSize];
+    alignas(16) float ConsiderationScores[BatchChunkSize];
+
+    for (int32 ChunkStart = 0; ChunkStart < Count; ChunkStart += BatchChunkSize)
+    {
+        const int32 ChunkNum = FMath::Min(BatchChunkSize, Count - ChunkStart);
+        float* RESTRICT ChunkScores = Scores + ChunkStart;
+
+        for (int32 i = 0; i < ChunkNum; ++i)
+        {
+            ChunkScores[i] = 0.0f;
+        }
+
+        for (int32 Index = 0; Index < Considerations.Num(); ++Index)
+        {
+            const FCompiledConsideration& Consideration = Considerations[Index];
+            // 输入列每块解析一次（只是一次分支），评分因素数量不受限制，也不需要额外的缓冲区
+            GatherProcessedInputs(Consideration, GetInputColumn(Consideration, Inputs), ChunkStart, ChunkNum, ProcessedInputs);
+
+            // 乘法组合在对数域中累加，加法组合直接累加加权评分
+            const FUtilityCurveLUT& LUT = bUseMultiplicativeCombination ? Consideration.LogScoreLUT : Consideration.ScoreLUT;
+            LUT.EvalBatch(ProcessedInputs, ConsiderationScores, ChunkNum);
+
+            const float Weight = Consideration.NormalizedWeight;
+            for (int32 i = 0; i < ChunkNum; ++i)
+            {
+                ChunkScores[i] += Weight * ConsiderationScores[i];
+            }
+        }
+
+        if (bUseMultiplicativeCombination)
+        {
+            for (int32 i = 0; i < ChunkNum; ++i)
+            {
+                ChunkScores[i] = FMath::Exp(ChunkScores[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,297 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UtilityAITypes.h"
+#include "UtilityCurveLUT.h"
+
+/**
+ * 批量评分输入（结构数组布局）
+ * 每一列保存N个AI的同一项原始输入，未提供的列使用与FUtilityContext相同的默认值
+ */
+struct ELEMENTALCOMBAT_API FUtilityBatchInputs
+{
+    /** AI数量 */
+    int32 Count = 0;
+
+    /** 自身健康度百分比 [0.0 - 1.0] */
+    TArrayView<const float> HealthPercent;
+
+    /** 距离目标的距离（原始单位） */
+    TArrayView<const float> DistanceToTarget;
+
+    /** 元素优势值 [-1.0, 1.0] */
+    TArrayView<const float> ElementAdvantage;
+
+    /** 威胁等级 [0.0 - 1.0] */
+    TArrayView<const float> ThreatLevel;
+
+    /**
+     * 按槽位设置自定义输入列
+     * @param Slot 自定义槽位（见UtilityCustomSlots和FUtilityCustomSlotRegistry）
+     * @param Values 每个AI的值，长度必须等于Count
+     */
+    void SetCustomColumn(int32 Slot, TArrayView<const float> Values)
+    {
+        if (Slot >= 0 && Slot < UtilityCustomSlots::MaxSlots)
+        {
+            CustomColumns[Slot] = Values;
+        }
+    }
+
+    /** 按名称设置自定义输入列（便捷接口） */
+    void SetCustomColumn(const FString& Key, TArrayView<const float> Values)
+    {
+        SetCustomColumn(FUtilityCustomSlotRegistry::Get().FindOrAddSlot(FName(*Key)), Values);
+    }
+
+    /** 获取自定义输入列，未设置时为空 */
+    TArrayView<const float> GetCustomColumn(int32 Slot) const
+    {
+        return (Slot >= 0 && Slot < UtilityCustomSlots::MaxSlots) ? CustomColumns[Slot] : TArrayView<const float>();
+    }
+
+private:
+    /** 按槽位索引的自定义输入列 */
+    TArrayView<const float> CustomColumns[UtilityCustomSlots::MaxSlots];
+};
+
+/**
+ * 增量评分状态（每个AI一份）
+ * 缓存每项评分因素上次使用的处理后输入和单项输出，输入变化超过该评分因素的阈值时才重新求值；
+ * 没有评分因素变化且权重不变时直接返回上次的综合评分
+ */
+struct ELEMENTALCOMBAT_API FUtilityIncrementalScoreState
+{
+    /** 生成该状态的配置文件编译版本（见FCompiledUtilityProfile::GetVersion，0表示尚未评分） */
+    uint64 ProfileVersion = 0;
+
+    /** 每项评分因素上次求值时的处理后输入 */
+    TArray<float, TInlineAllocator<8>> Inputs;
+
+    /** 每项评分因素上次的输出（加法组合为单项评分，乘法组合为其对数） */
+    TArray<float, TInlineAllocator<8>> Terms;
+
+    /** 上次组合使用的覆盖权重 */
+    float WeightOverrides[static_cast<int32>(EConsiderationType::Custom) + 1];
+
+    /** 上次组合是否使用了覆盖权重 */
+    bool bHasWeightOverrides = false;
+
+    /** 上次的综合评分 */
+    float CombinedScore = 0.0f;
+
+    /** 上次的综合评分是否达到阈值 */
+    bool bIsValid = false;
+
+    /** 上次评分重新求值的评分因素数量（统计用） */
+    int32 LastRescoredCount = 0;
+
+    /** 是否已有缓存结果 */
+    bool bInitialized = false;
+
+    /** 清空缓存，下次评分时重新求值所有评分因素 */
+    void Reset()
+    {
+        ProfileVersion = 0;
+        Inputs.Reset();
+        Terms.Reset();
+        bHasWeightOverrides = false;
+        CombinedScore = 0.0f;
+        bIsValid = false;
+        LastRescoredCount = 0;
+        bInitialized = false;
+    }
+};
+
+/**
+ * 编译后的Utility配置文件
+ * 由FUtilityProfile一次性构建的扁平表示：
+ * - 权重存放在按EConsiderationType索引的定长数组中，并预先归一化
+ * - 权重为0的评分因素在编译期剔除
+ * - 响应曲线、输出偏移和限制合并烘焙为单个查找表
+ * - 乘法组合在对数域中累加，每次评分只调用一次Exp
+ * 评分过程不分配内存，可在多线程中对同一实例并发调用
+ */
+struct ELEMENTALCOMBAT_API FCompiledUtilityProfile
+{
+    /** 评分类型数量（用于定长权重数组） */
+    static constexpr int32 NumConsiderationTypes = static_cast<int32>(EConsiderationType::Custom) + 1;
+
+    /** 评分为0时在对数域中使用的值，避免插值时出现NaN */
+    static constexpr float LogZeroScore = -1.0e30f;
+
+    /** 默认的查找表最大误差 */
+    static constexpr float DefaultMaxError = 0.001f;
+
+    FCompiledUtilityProfile();
+
+    /**
+     * 从配置文件编译
+     * @param Profile 源配置文件
+     * @param MaxError 查找表允许的最大偏差
+     * @return 是否所有查找表都满足误差上限
+     */
+    bool Compile(const FUtilityProfile& Profile, float MaxError = DefaultMaxError);
+
+    /** 清空编译结果 */
+    void Reset();
+
+    /**
+     * 计算综合评分
+     * @param Context 评分上下文
+     * @param bOutIsValid 是否达到最小分数阈值
+     * @return 最终评分
+     */
+    float CalculateScore(const FUtilityContext& Context, bool* bOutIsValid = nullptr) const;
+
+    /**
+     * 使用覆盖权重计算综合评分（动态权重场景，无需重新编译）
+     * 只能调整编译时保留的评分因素，编译期因权重为0被剔除的评分因素不参与计算
+     * @param Context 评分上下文
+     * @param WeightsByType 按EConsiderationType索引的权重，长度为NumConsiderationTypes
+     * @param bOutIsValid 是否达到最小分数阈值
+     * @return 最终评分
+     */
+    float CalculateScoreWithWeights(const FUtilityContext& Context, const float* WeightsByType, bool* bOutIsValid = nullptr) const;
+
+    /**
+     * 用多组覆盖权重一次计算多个综合评分（A/B比较等只有权重不同的场景）
+     * 每项评分因素只求值一次，各组权重复用同一组单项输出；结果与逐组调用CalculateScoreWithWeights逐位一致
+     * @param Context 评分上下文
+     * @param WeightSets 每组按EConsiderationType索引的权重，长度为NumConsiderationTypes
+     * @param OutScores 输出评分，长度必须等于WeightSets.Num()
+     * @param OutIsValid 每组是否达到最小分数阈值（可为空，否则长度必须等于WeightSets.Num()）
+     */
+    void CalculateScoresWithWeightSets(const FUtilityContext& Context, TConstArrayView<const float*> WeightSets,
+                                       TArrayView<float> OutScores, TArrayView<bool> OutIsValid = TArrayView<bool>()) const;
+
+    /**
+     * 增量计算综合评分
+     * 只重新求值输入变化超过阈值的评分因素，阈值为0时结果与CalculateScore/CalculateScoreWithWeights逐位一致
+     * @param Context 评分上下文
+     * @param State 该AI的增量评分状态，配置文件不匹配时自动重建
+     * @param WeightsByType 覆盖权重（可为空），长度为NumConsiderationTypes
+     * @param bOutIsValid 是否达到最小分数阈值
+     * @return 最终评分
+     */
+    float CalculateScoreIncremental(const FUtilityContext& Context, FUtilityIncrementalScoreState& State,
+                                    const float* WeightsByType = nullptr, bool* bOutIsValid = nullptr) const;
+
+    /**
+     * 批量计算N个AI的综合评分
+     * 按评分因素逐列处理，内层循环为连续数组上的无分支运算，便于编译器向量化
+     * @param Inputs 结构数组布局的输入
+     * @param OutScores 输出评分，长度必须等于Inputs.Count
+     */
+    void CalculateScores(const FUtilityBatchInputs& Inputs, TArrayView<float> OutScores) const;
+
+    /** 是否已编译 */
+    bool IsCompiled() const { return bCompiled; }
+
+    /**
+     * 编译版本，每次编译分配一个全局唯一的值，拷贝时保留
+     * 增量评分状态按版本而不是地址校验，配置文件被释放后同一地址上的新配置文件不会沿用旧状态
+     */
+    uint64 GetVersion() const { return Version; }
+
+    /** 获取源配置文件名称 */
+    const FString& GetProfileName() const { return ProfileName; }
+
+    /** 获取编译后保留的评分因素数量 */
+    int32 GetNumActiveConsiderations() const { return Considerations.Num(); }
+
+    /** 获取指定类型的原始权重 */
+    float GetWeight(EConsiderationType Type) const { return Weights[static_cast<int32>(Type)]; }
+
+    /** 是否使用乘法组合 */
+    bool UsesMultiplicativeCombination() const { return bUseMultiplicativeCombination; }
+
+    /** 获取最小分数阈值 */
+    float GetMinScoreThreshold() const { return MinScoreThreshold; }
+
+    /** 获取保留的评分因素读取的输入掩码（见UtilityInputs），覆盖权重不会引入新的输入 */
+    uint32 GetRequiredInputs() const { return RequiredInputs; }
+
+private:
+    /** 编译后的单项评分因素 */
+    struct FCompiledConsideration
+    {
+        /** 评分类型 */
+        EConsiderationType ConsiderationType = EConsiderationType::None;
+
+        /** 自定义输入槽位（Cooldown、TeamStatus和Custom类型使用） */
+        int32 CustomSlot = INDEX_NONE;
+
+        /** 输入值乘数 */
+        float InputMultiplier = 1.0f;
+
+        /** 是否反转输入值 */
+        bool bInvertInput = false;
+
+        /** 归一化后的权重（权重 / 总权重） */
+        float NormalizedWeight = 0.0f;
+
+        /** 增量评分时的输入变化阈值 */
+        float RescoreInputEpsilon = 0.0f;
+
+        /** 处理后输入 -> 最终单项评分（已包含输出偏移和限制） */
+        FUtilityCurveLUT ScoreLUT;
+
+        /** 处理后输入 -> ln(最终单项评分)，仅乘法组合使用 */
+        FUtilityCurveLUT LogScoreLUT;
+    };
+
+    /** 解析评分因素读取的自定义槽位 */
+    static int32 ResolveCustomSlot(const FUtilityConsideration& Source);
+
+    /** 读取并处理输入值（与FUtilityConsideration::ProcessInputValue一致） */
+    static float GetProcessedInput(const FCompiledConsideration& Consideration, const FUtilityContext& Context);
+
+    /** 批量处理时每块的AI数量（栈上缓冲区大小） */
+    static constexpr int32 BatchChunkSize = 256;
+
+    /**
+     * 批量读取并处理某项评分因素的输入值
+     * @param Consideration 评分因素
+     * @param Column 原始输入列（为空时使用默认值）
+     * @param Start 起始下标
+     * @param Num 数量
+     * @param OutProcessed 处理后的输入值
+     */
+    static void GatherProcessedInputs(const FCompiledConsideration& Consideration, TArrayView<const float> Column, int32 Start, int32 Num, float* OutProcessed);
+
+    /** 获取某项评分因素在批量输入中对应的列 */
+    static TArrayView<const float> GetInputColumn(const FCompiledConsideration& Consideration, const FUtilityBatchInputs& Inputs);
+
+    /** 烘焙对数域查找表，误差在线性域中度量 */
+    static bool BakeLogScoreLUT(FUtilityCurveLUT& OutLUT, TFunctionRef<float(float)> ScoreSampler, int32 InitialSampleCount, float MaxError);
+
+    /** 保留的评分因素 */
+    TArray<FCompiledConsideration> Considerations;
+
+    /** 按评分类型索引的原始权重 */
+    float Weights[NumConsiderationTypes];
+
+    /** 源配置文件名称 */
+    FString ProfileName;
+
+    /** 组合方式 */
+    bool bUseMultiplicativeCombination = false;
+
+    /** 最小分数阈值 */
+    float MinScoreThreshold = 0.01f;
+
+    /** 源配置文件是否包含评分因素（为空时评分无效） */
+    bool bHasSourceConsiderations = false;
+
+    /** 保留的评分因素读取的输入掩码 */
+    uint32 RequiredInputs = 0;
+
+    /** 是否已编译 */
+    bool bCompiled = false;
+
+    /** 编译版本（0表示未编译） */
+    uint64 Version = 0;
+};
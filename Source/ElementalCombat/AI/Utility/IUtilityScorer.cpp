@@ -48,12 +48,27 @@ bool UUtilityScorerComponent::IsScoreValid_Implementation(const FUtilityContext&
 void UUtilityScorerComponent::SetScoringProfile(const FUtilityProfile& NewProfile)
 {
     ScoringProfile = NewProfile;
+    ScoringProfile.BakeResponseCurves();
     
     // 清除缓存
     CachedScore = 0.0f;
     LastContextHash = 0;
 }
 
+#if WITH_EDITOR
+void UUtilityScorerComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    // 曲线或烘焙设置修改后重新烘焙，避免继续使用旧的查找表
+    if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(UUtilityScorerComponent, ScoringProfile))
+    {
+        ScoringProfile.BakeResponseCurves();
+        ClearCache();
+    }
+}
+#endif
+
 void UUtilityScorerComponent::ClearCache()
 {
     CachedScore = 0.0f;
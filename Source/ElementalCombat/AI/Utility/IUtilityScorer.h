@@ -63,6 +63,10 @@ class ELEMENTALCOMBAT_API UUtilityScorerComponent : public UActorComponent, publ
 public:
     UUtilityScorerComponent();
 
+#if WITH_EDITOR
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 protected:
     /** 评分配置文件 */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|AI")
@@ -0,0 +1,488 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "UtilityAISubsystem.h"
+#include "AI/ElementalCombatEnemy.h"
+#include "AI/PlayerSnapshotSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Async/ParallelFor.h"
+#include "Tasks/Task.h"
+
+static TAutoConsoleVariable<bool> CVarUtilityAIForceSerial(
+    TEXT("ElementalCombat.AI.Utility.ForceSerial"),
+    false,
+    TEXT("强制Utility AI子系统在游戏线程上串行评分（用于调试，结果与并行评分逐位一致）"),
+    ECVF_Default);
+
+UUtilityAISubsystem* UUtilityAISubsystem::Get(const UObject* WorldContextObject)
+{
+    if (!WorldContextObject)
+    {
+        return nullptr;
+    }
+
+    const UWorld* World = WorldContextObject->GetWorld();
+    return World ? World->GetSubsystem<UUtilityAISubsystem>() : nullptr;
+}
+
+void UUtilityAISubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    Requests.Empty();
+    NextSerial = 1;
+    Cursor = 0;
+    SchedulerTime = 0.0;
+    SchedulerFrame = 0;
+}
+
+void UUtilityAISubsystem::Deinitialize()
+{
+    // 工作线程可能仍在读取快照缓冲
+    ScoringTask.Wait();
+    ScoringTask = UE::Tasks::FTask();
+    bHasInFlightBuffer = false;
+    SnapshotBuffer.Empty();
+
+    Requests.Empty();
+    DueRequests.Empty();
+    StaleRequests.Empty();
+
+    Super::Deinitialize();
+}
+
+TStatId UUtilityAISubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UUtilityAISubsystem, STATGROUP_Tickables);
+}
+
+// === 请求管理 ===
+
+FUtilityScoreRequestHandle UUtilityAISubsystem::RegisterRequest(FUtilityScoreRequestDesc&& Desc)
+{
+    check(IsInGameThread());
+
+    FUtilityScoreRequestHandle Handle;
+    if (!Desc.Profile.IsValid() || !Desc.ContextProvider)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Utility AI子系统：注册请求失败，配置文件或上下文构建函数为空"));
+        return Handle;
+    }
+
+    FRequest NewRequest;
+    NewRequest.Serial = NextSerial++;
+    NewRequest.Agent = Desc.Agent;
+    NewRequest.bHasAgent = Desc.Agent.IsValid();
+    NewRequest.Profile = MoveTemp(Desc.Profile);
+    NewRequest.ContextProvider = MoveTemp(Desc.ContextProvider);
+    NewRequest.UpdateInterval = FMath::Max(0.0f, Desc.UpdateInterval);
+    NewRequest.BasePriority = Desc.Priority;
+    NewRequest.RegisteredTime = SchedulerTime;
+
+    Handle.Index = Requests.Add(MoveTemp(NewRequest));
+    Handle.Serial = Requests[Handle.Index].Serial;
+
+    if (Desc.bEvaluateImmediately)
+    {
+        EvaluateRequest(Handle.Index);
+    }
+
+    return Handle;
+}
+
+void UUtilityAISubsystem::UnregisterRequest(FUtilityScoreRequestHandle& Handle)
+{
+    check(IsInGameThread());
+
+    if (FindRequest(Handle))
+    {
+        Requests.RemoveAt(Handle.Index);
+    }
+    Handle.Reset();
+}
+
+bool UUtilityAISubsystem::IsRequestValid(const FUtilityScoreRequestHandle& Handle) const
+{
+    return FindRequest(Handle) != nullptr;
+}
+
+void UUtilityAISubsystem::SetRequestProfile(const FUtilityScoreRequestHandle& Handle, TSharedPtr<const FCompiledUtilityProfile> Profile)
+{
+    check(IsInGameThread());
+
+    if (FRequest* Request = FindRequest(Handle))
+    {
+        if (Profile.IsValid())
+        {
+            Request->Profile = MoveTemp(Profile);
+            Request->bHasWeightOverrides = false;
+            Request->ScoreState.Reset();
+        }
+    }
+}
+
+void UUtilityAISubsystem::SetRequestUpdateInterval(const FUtilityScoreRequestHandle& Handle, float UpdateInterval)
+{
+    check(IsInGameThread());
+
+    if (FRequest* Request = FindRequest(Handle))
+    {
+        Request->UpdateInterval = FMath::Max(0.0f, UpdateInterval);
+    }
+}
+
+void UUtilityAISubsystem::SetRequestWeights(const FUtilityScoreRequestHandle& Handle, TConstArrayView<float> WeightsByType)
+{
+    check(IsInGameThread());
+
+    FRequest* Request = FindRequest(Handle);
+    if (!Request || WeightsByType.Num() != FCompiledUtilityProfile::NumConsiderationTypes)
+    {
+        return;
+    }
+
+    FMemory::Memcpy(Request->WeightOverrides, WeightsByType.GetData(), sizeof(Request->WeightOverrides));
+    Request->bHasWeightOverrides = true;
+}
+
+void UUtilityAISubsystem::ClearRequestWeights(const FUtilityScoreRequestHandle& Handle)
+{
+    check(IsInGameThread());
+
+    if (FRequest* Request = FindRequest(Handle))
+    {
+        Request->bHasWeightOverrides = false;
+    }
+}
+
+const FUtilityScoreResult* UUtilityAISubsystem::EvaluateNow(const FUtilityScoreRequestHandle& Handle)
+{
+    check(IsInGameThread());
+
+    FRequest* Request = FindRequest(Handle);
+    if (!Request)
+    {
+        return nullptr;
+    }
+
+    EvaluateRequest(Handle.Index);
+    return &Request->Result;
+}
+
+void UUtilityAISubsystem::FlushPendingEvaluations()
+{
+    check(IsInGameThread());
+
+    PublishInFlightBuffer();
+}
+
+bool UUtilityAISubsystem::IsParallelEvaluationEnabled()
+{
+    return !CVarUtilityAIForceSerial.GetValueOnGameThread() && FApp::ShouldUseThreadingForPerformance();
+}
+
+// === 结果读取 ===
+
+const FUtilityScoreResult* UUtilityAISubsystem::GetResult(const FUtilityScoreRequestHandle& Handle) const
+{
+    const FRequest* Request = FindRequest(Handle);
+    return Request ? &Request->Result : nullptr;
+}
+
+double UUtilityAISubsystem::GetResultAge(const FUtilityScoreRequestHandle& Handle) const
+{
+    const FRequest* Request = FindRequest(Handle);
+    if (!Request || !Request->Result.HasResult())
+    {
+        return -1.0;
+    }
+    return SchedulerTime - Request->Result.Timestamp;
+}
+
+uint64 UUtilityAISubsystem::GetResultFrameAge(const FUtilityScoreRequestHandle& Handle) const
+{
+    const FRequest* Request = FindRequest(Handle);
+    if (!Request || !Request->Result.HasResult())
+    {
+        return MAX_uint64;
+    }
+    return SchedulerFrame - Request->Result.FrameNumber;
+}
+
+// === 调度 ===
+
+void UUtilityAISubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    SchedulerTime += DeltaTime;
+    ++SchedulerFrame;
+
+    // 发布上一帧在工作线程上完成的评分
+    PublishInFlightBuffer();
+
+    LastFrameEvaluationCount = 0;
+    LastFrameDeferredCount = 0;
+    LastFrameTimeMicroseconds = 0.0;
+
+    const int32 MaxIndex = Requests.GetMaxIndex();
+    if (Requests.Num() == 0 || MaxIndex == 0)
+    {
+        return;
+    }
+
+    // 玩家位置每帧只获取一次（与StateTree任务共享同一份玩家快照）
+    FVector PlayerLocation = FVector::ZeroVector;
+    const FVector* PlayerLocationPtr = nullptr;
+    if (UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(this))
+    {
+        const FPlayerSnapshot& PlayerSnapshot = SnapshotSubsystem->GetPlayerSnapshot();
+        if (PlayerSnapshot.bIsValid)
+        {
+            PlayerLocation = PlayerSnapshot.Location;
+            PlayerLocationPtr = &PlayerLocation;
+        }
+    }
+
+    // 从轮询起点开始收集到期请求，保证同优先级内按轮询顺序处理
+    DueRequests.Reset();
+    StaleRequests.Reset();
+    Cursor = Cursor < MaxIndex ? Cursor : 0;
+    for (int32 Step = 0; Step < MaxIndex; ++Step)
+    {
+        const int32 Index = (Cursor + Step) % MaxIndex;
+        if (!Requests.IsAllocated(Index))
+        {
+            continue;
+        }
+
+        const FRequest& Request = Requests[Index];
+        if (Request.bHasAgent && !Request.Agent.IsValid())
+        {
+            StaleRequests.Add(Index);
+            continue;
+        }
+
+        float EffectiveInterval = Request.UpdateInterval;
+        const int32 Priority = GetPriority(Request, PlayerLocationPtr, EffectiveInterval);
+        const double DueTime = Request.Result.HasResult() ? Request.Result.Timestamp + EffectiveInterval : Request.RegisteredTime;
+        if (SchedulerTime >= DueTime)
+        {
+            DueRequests.Add({ Index, GetAgedPriority(Priority, SchedulerTime - DueTime) });
+        }
+    }
+
+    // AI已销毁的请求自动清理
+    for (const int32 Index : StaleRequests)
+    {
+        Requests.RemoveAt(Index);
+    }
+
+    // 高优先级请求先评分，同优先级保持轮询顺序（等待过久的请求已提升优先级）
+    DueRequests.StableSort([](const FDueRequest& A, const FDueRequest& B) { return A.Priority > B.Priority; });
+
+    // 游戏线程只采集上下文快照，串行模式下同时在此评分
+    const bool bParallel = IsParallelEvaluationEnabled();
+    SnapshotBuffer.Reset();
+
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+    int32 NextCursor = INDEX_NONE;
+    for (int32 DueIndex = 0; DueIndex < DueRequests.Num(); ++DueIndex)
+    {
+        const double ElapsedMicroseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0;
+        if (LastFrameEvaluationCount >= MinEvaluationsPerFrame && ElapsedMicroseconds >= TimeBudgetMicroseconds)
+        {
+            LastFrameDeferredCount = DueRequests.Num() - DueIndex;
+
+            // 下一帧从第一个被顺延的请求开始轮询（顺延的请求下一帧等待更久，优先级不会低于本帧）
+            NextCursor = DueRequests[DueIndex].Index;
+            break;
+        }
+
+        const int32 Index = DueRequests[DueIndex].Index;
+        FEvaluationSnapshot& Snapshot = SnapshotBuffer.AddDefaulted_GetRef();
+        GatherSnapshot(Index, Requests[Index], Snapshot);
+        if (!bParallel)
+        {
+            ScoreSnapshot(Snapshot);
+        }
+        ++LastFrameEvaluationCount;
+    }
+
+    if (NextCursor != INDEX_NONE)
+    {
+        Cursor = NextCursor;
+    }
+
+    // 提交后台缓冲，下一帧Tick开始时发布
+    if (SnapshotBuffer.Num() > 0)
+    {
+        if (bParallel)
+        {
+            // 每个快照独立评分，不存在跨元素的归约，因此与串行路径结果逐位一致
+            const int32 MinBatchSize = FMath::Max(1, ParallelMinBatchSize);
+            ScoringTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, MinBatchSize]()
+            {
+                ParallelFor(TEXT("UtilityAIScoring"), SnapshotBuffer.Num(), MinBatchSize, [this](int32 SnapshotIndex)
+                {
+                    ScoreSnapshot(SnapshotBuffer[SnapshotIndex]);
+                });
+            });
+        }
+
+        bHasInFlightBuffer = true;
+    }
+
+    LastFrameTimeMicroseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0;
+}
+
+int32 UUtilityAISubsystem::GetPriority(const FRequest& Request, const FVector* PlayerLocation, float& OutInterval) const
+{
+    int32 Priority = Request.BasePriority;
+    OutInterval = Request.UpdateInterval;
+
+    const AElementalCombatEnemy* Agent = Request.Agent.Get();
+    if (!Agent)
+    {
+        return Priority;
+    }
+
+    if (PlayerLocation && FVector::DistSquared(Agent->GetActorLocation(), *PlayerLocation) <= FMath::Square(NearPlayerDistance))
+    {
+        OutInterval *= NearPlayerIntervalScale;
+        ++Priority;
+    }
+
+    if (Agent->IsAttacking())
+    {
+        OutInterval *= CombatIntervalScale;
+        ++Priority;
+    }
+
+    return Priority;
+}
+
+int32 UUtilityAISubsystem::GetAgedPriority(int32 Priority, double OverdueSeconds) const
+{
+    if (PriorityAgingSeconds <= 0.0f || OverdueSeconds <= 0.0)
+    {
+        return Priority;
+    }
+
+    // 提升量有上限，避免长时间暂停后数值溢出
+    const double Boost = FMath::Min(OverdueSeconds / PriorityAgingSeconds, 1000.0);
+    return Priority + FMath::FloorToInt32(Boost);
+}
+
+void UUtilityAISubsystem::EvaluateRequest(int32 Index)
+{
+    // 与分片路径使用同一套快照和评分函数，只是立即发布
+    FEvaluationSnapshot Snapshot;
+    GatherSnapshot(Index, Requests[Index], Snapshot);
+    ScoreSnapshot(Snapshot);
+    PublishSnapshot(Snapshot);
+}
+
+void UUtilityAISubsystem::GatherSnapshot(int32 Index, FRequest& Request, FEvaluationSnapshot& OutSnapshot)
+{
+    OutSnapshot.Index = Index;
+    OutSnapshot.Serial = Request.Serial;
+    OutSnapshot.Sequence = ++Request.Sequence;
+    OutSnapshot.Profile = Request.Profile;
+    OutSnapshot.bHasWeightOverrides = Request.bHasWeightOverrides;
+    if (Request.bHasWeightOverrides)
+    {
+        FMemory::Memcpy(OutSnapshot.WeightOverrides, Request.WeightOverrides, sizeof(OutSnapshot.WeightOverrides));
+    }
+    OutSnapshot.ScoreState = Request.ScoreState;
+    OutSnapshot.Timestamp = SchedulerTime;
+    OutSnapshot.FrameNumber = SchedulerFrame;
+    OutSnapshot.bHasContext = Request.ContextProvider(OutSnapshot.Context);
+}
+
+void UUtilityAISubsystem::ScoreSnapshot(FEvaluationSnapshot& Snapshot)
+{
+    if (!Snapshot.bHasContext)
+    {
+        Snapshot.Score = 0.0f;
+        Snapshot.bIsValid = false;
+        return;
+    }
+
+    bool bIsValid = false;
+    Snapshot.Score = Snapshot.Profile->CalculateScoreIncremental(Snapshot.Context, Snapshot.ScoreState,
+        Snapshot.bHasWeightOverrides ? Snapshot.WeightOverrides : nullptr, &bIsValid);
+    Snapshot.bIsValid = bIsValid;
+}
+
+void UUtilityAISubsystem::PublishSnapshot(const FEvaluationSnapshot& Snapshot)
+{
+    FUtilityScoreRequestHandle Handle;
+    Handle.Index = Snapshot.Index;
+    Handle.Serial = Snapshot.Serial;
+
+    // 请求已注销或槽位被复用时丢弃
+    FRequest* Request = FindRequest(Handle);
+    if (!Request)
+    {
+        return;
+    }
+
+    // 被更新的评分（例如EvaluateNow）取代的快照不再发布
+    if (Snapshot.Sequence != Request->Sequence)
+    {
+        return;
+    }
+
+    if (Snapshot.bHasContext)
+    {
+        Request->ScoreState = Snapshot.ScoreState;
+    }
+
+    FUtilityScoreResult& Result = Request->Result;
+    Result.Score = Snapshot.Score;
+    Result.bIsValid = Snapshot.bIsValid;
+    Result.RescoredConsiderations = Snapshot.bHasContext ? Snapshot.ScoreState.LastRescoredCount : 0;
+    Result.Timestamp = Snapshot.Timestamp;
+    Result.FrameNumber = Snapshot.FrameNumber;
+    Result.Context = Snapshot.Context;
+    ++Result.EvaluationCount;
+}
+
+void UUtilityAISubsystem::PublishInFlightBuffer()
+{
+    if (!bHasInFlightBuffer)
+    {
+        return;
+    }
+
+    ScoringTask.Wait();
+    ScoringTask = UE::Tasks::FTask();
+
+    for (const FEvaluationSnapshot& Snapshot : SnapshotBuffer)
+    {
+        PublishSnapshot(Snapshot);
+    }
+    SnapshotBuffer.Reset();
+    bHasInFlightBuffer = false;
+}
+
+UUtilityAISubsystem::FRequest* UUtilityAISubsystem::FindRequest(const FUtilityScoreRequestHandle& Handle)
+{
+    if (Handle.Index >= 0 && Handle.Index < Requests.GetMaxIndex() && Requests.IsAllocated(Handle.Index))
+    {
+        FRequest& Request = Requests[Handle.Index];
+        if (Request.Serial == Handle.Serial)
+        {
+            return &Request;
+        }
+    }
+    return nullptr;
+}
+
+const UUtilityAISubsystem::FRequest* UUtilityAISubsystem::FindRequest(const FUtilityScoreRequestHandle& Handle) const
+{
+    return const_cast<UUtilityAISubsystem*>(this)->FindRequest(Handle);
+}
@@ -0,0 +1,339 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Containers/SparseArray.h"
+#include "Tasks/Task.h"
+#include "UtilityAITypes.h"
+#include "CompiledUtilityProfile.h"
+#include "UtilityAISubsystem.generated.h"
+
+class AElementalCombatEnemy;
+
+/**
+ * 评分请求句柄
+ * 由UUtilityAISubsystem分配，槽位复用后旧句柄自动失效
+ */
+struct ELEMENTALCOMBAT_API FUtilityScoreRequestHandle
+{
+    /** 请求槽位下标 */
+    int32 Index = INDEX_NONE;
+
+    /** 分配序号（用于检测槽位复用） */
+    uint32 Serial = 0;
+
+    bool IsValid() const { return Index != INDEX_NONE; }
+
+    void Reset()
+    {
+        Index = INDEX_NONE;
+        Serial = 0;
+    }
+};
+
+/**
+ * 评分结果
+ */
+struct ELEMENTALCOMBAT_API FUtilityScoreResult
+{
+    /** 最终评分 */
+    float Score = 0.0f;
+
+    /** 是否达到配置文件的最小分数阈值 */
+    bool bIsValid = false;
+
+    /** 评分时的调度时间（秒） */
+    double Timestamp = -1.0;
+
+    /** 评分时的调度帧号 */
+    uint64 FrameNumber = 0;
+
+    /** 累计评分次数（0表示尚无结果） */
+    uint32 EvaluationCount = 0;
+
+    /** 最近一次评分重新求值的评分因素数量（输入未变化的评分因素沿用缓存输出） */
+    int32 RescoredConsiderations = 0;
+
+    /** 评分使用的上下文快照 */
+    FUtilityContext Context;
+
+    bool HasResult() const { return EvaluationCount > 0; }
+};
+
+/** 构建评分上下文，返回false表示当前无法评分（例如角色已失效） */
+using FUtilityContextProvider = TFunction<bool(FUtilityContext& OutContext)>;
+
+/**
+ * 评分请求描述
+ */
+struct ELEMENTALCOMBAT_API FUtilityScoreRequestDesc
+{
+    /** 发起请求的AI（用于优先级计算和自动清理，可为空） */
+    TWeakObjectPtr<AElementalCombatEnemy> Agent;
+
+    /** 编译后的配置文件 */
+    TSharedPtr<const FCompiledUtilityProfile> Profile;
+
+    /** 上下文构建函数 */
+    FUtilityContextProvider ContextProvider;
+
+    /** 基础更新间隔（秒） */
+    float UpdateInterval = 0.5f;
+
+    /** 基础优先级（与靠近玩家、战斗中的加成累加） */
+    int32 Priority = 0;
+
+    /** 注册时是否立即评分一次 */
+    bool bEvaluateImmediately = true;
+};
+
+/**
+ * Utility AI子系统
+ * 统一管理所有评分请求，按轮询顺序在每帧的微秒预算内分片评分，避免大量AI在同一帧集中评分造成卡顿
+ * - 靠近玩家或正在战斗的AI缩短更新间隔并优先评分
+ * - 到期后等待越久优先级越高，预算紧张时低优先级请求也不会被一直顺延
+ * - StateTree任务只读取最新结果，并可查询结果的陈旧程度
+ * - 请求管理、EvaluateNow和FlushPendingEvaluations只能在游戏线程调用，并行Tick的StateTree任务在其他线程上不访问子系统
+ * - 游戏线程只采集上下文快照，评分在工作线程上并行执行，结果经双缓冲在下一帧发布
+ * - 每个请求保存增量评分状态，只重新求值输入变化超过阈值的评分因素，静止的AI几乎没有评分开销
+ * 调度时钟由Tick累加，暂停期间不前进
+ * 控制台变量ElementalCombat.AI.Utility.ForceSerial可强制在游戏线程上串行评分（结果逐位一致）
+ */
+UCLASS(Config = Game)
+class ELEMENTALCOMBAT_API UUtilityAISubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    /** 获取当前世界的子系统 */
+    static UUtilityAISubsystem* Get(const UObject* WorldContextObject);
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // === 请求管理 ===
+
+    /** 注册评分请求 */
+    FUtilityScoreRequestHandle RegisterRequest(FUtilityScoreRequestDesc&& Desc);
+
+    /** 注销评分请求并重置句柄 */
+    void UnregisterRequest(FUtilityScoreRequestHandle& Handle);
+
+    /** 句柄是否仍然有效 */
+    bool IsRequestValid(const FUtilityScoreRequestHandle& Handle) const;
+
+    /** 更换请求使用的配置文件（权重覆盖会被清除） */
+    void SetRequestProfile(const FUtilityScoreRequestHandle& Handle, TSharedPtr<const FCompiledUtilityProfile> Profile);
+
+    /** 设置请求的基础更新间隔 */
+    void SetRequestUpdateInterval(const FUtilityScoreRequestHandle& Handle, float UpdateInterval);
+
+    /**
+     * 设置权重覆盖（按EConsiderationType索引），下一次评分时生效
+     * @param WeightsByType 长度必须为FCompiledUtilityProfile::NumConsiderationTypes
+     */
+    void SetRequestWeights(const FUtilityScoreRequestHandle& Handle, TConstArrayView<float> WeightsByType);
+
+    /** 清除权重覆盖 */
+    void ClearRequestWeights(const FUtilityScoreRequestHandle& Handle);
+
+    /** 立即评分（不受预算限制，用于状态进入等需要同步结果的场合） */
+    const FUtilityScoreResult* EvaluateNow(const FUtilityScoreRequestHandle& Handle);
+
+    /** 等待进行中的评分完成并立即发布结果（正常情况下在下一帧Tick开始时发布） */
+    void FlushPendingEvaluations();
+
+    /** 当前是否使用并行评分（受ElementalCombat.AI.Utility.ForceSerial控制） */
+    static bool IsParallelEvaluationEnabled();
+
+    // === 结果读取 ===
+
+    /** 获取最新结果，句柄无效时返回nullptr */
+    const FUtilityScoreResult* GetResult(const FUtilityScoreRequestHandle& Handle) const;
+
+    /** 结果距今的时间（秒），无结果时返回-1 */
+    double GetResultAge(const FUtilityScoreRequestHandle& Handle) const;
+
+    /** 结果距今的帧数，无结果时返回MAX_uint64 */
+    uint64 GetResultFrameAge(const FUtilityScoreRequestHandle& Handle) const;
+
+    // === 预算和统计 ===
+
+    /** 设置每帧评分预算（微秒） */
+    void SetTimeBudgetMicroseconds(float InBudget) { TimeBudgetMicroseconds = FMath::Max(0.0f, InBudget); }
+
+    /** 获取每帧评分预算（微秒） */
+    float GetTimeBudgetMicroseconds() const { return TimeBudgetMicroseconds; }
+
+    /** 当前注册的请求数量 */
+    int32 GetNumRequests() const { return Requests.Num(); }
+
+    /** 上一帧采集并提交评分的请求数量 */
+    int32 GetLastFrameEvaluationCount() const { return LastFrameEvaluationCount; }
+
+    /** 上一帧到期但因预算不足顺延的请求数量 */
+    int32 GetLastFrameDeferredCount() const { return LastFrameDeferredCount; }
+
+    /** 上一帧游戏线程上的调度耗时（微秒，并行模式下不含工作线程评分） */
+    double GetLastFrameTimeMicroseconds() const { return LastFrameTimeMicroseconds; }
+
+    /** 调度时钟（秒） */
+    double GetSchedulerTime() const { return SchedulerTime; }
+
+    /** 调度帧号 */
+    uint64 GetSchedulerFrame() const { return SchedulerFrame; }
+
+protected:
+    /** 每帧评分预算（微秒） */
+    UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+    float TimeBudgetMicroseconds = 500.0f;
+
+    /** 每帧至少评分的请求数量（预算耗尽时保证推进） */
+    UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0"))
+    int32 MinEvaluationsPerFrame = 1;
+
+    /** 视为靠近玩家的距离 */
+    UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+    float NearPlayerDistance = 1500.0f;
+
+    /** 靠近玩家时的更新间隔缩放 */
+    UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float NearPlayerIntervalScale = 0.5f;
+
+    /** 战斗中（正在攻击）时的更新间隔缩放 */
+    UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float CombatIntervalScale = 0.5f;
+
+    /** 到期后每等待该时长（秒）优先级加1，0表示不随等待时间提升 */
+    UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0"))
+    float PriorityAgingSeconds = 0.5f;
+
+    /** 并行评分时每个工作线程批次的最小请求数量 */
+    UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|AI", meta = (ClampMin = "1"))
+    int32 ParallelMinBatchSize = 16;
+
+private:
+    /** 评分请求 */
+    struct FRequest
+    {
+        uint32 Serial = 0;
+        TWeakObjectPtr<AElementalCombatEnemy> Agent;
+        bool bHasAgent = false;
+        TSharedPtr<const FCompiledUtilityProfile> Profile;
+        FUtilityContextProvider ContextProvider;
+        float UpdateInterval = 0.5f;
+        int32 BasePriority = 0;
+
+        /** 注册时的调度时间（尚无结果时按此计算等待时长） */
+        double RegisteredTime = 0.0;
+
+        float WeightOverrides[FCompiledUtilityProfile::NumConsiderationTypes];
+        bool bHasWeightOverrides = false;
+
+        /** 增量评分状态，随快照复制到工作线程，发布时写回 */
+        FUtilityIncrementalScoreState ScoreState;
+
+        /** 最近一次提交评分的序号，发布时用于丢弃被EvaluateNow取代的旧快照 */
+        uint32 Sequence = 0;
+
+        /** 已发布的结果（前台缓冲） */
+        FUtilityScoreResult Result;
+    };
+
+    /**
+     * 评分快照
+     * 在游戏线程上采集，评分只读取快照内的数据，可安全地在工作线程上执行
+     */
+    struct FEvaluationSnapshot
+    {
+        int32 Index = INDEX_NONE;
+        uint32 Serial = 0;
+        uint32 Sequence = 0;
+        TSharedPtr<const FCompiledUtilityProfile> Profile;
+        float WeightOverrides[FCompiledUtilityProfile::NumConsiderationTypes];
+        bool bHasWeightOverrides = false;
+        bool bHasContext = false;
+        FUtilityContext Context;
+        FUtilityIncrementalScoreState ScoreState;
+        double Timestamp = 0.0;
+        uint64 FrameNumber = 0;
+        float Score = 0.0f;
+        bool bIsValid = false;
+    };
+
+    /** 本帧到期的请求 */
+    struct FDueRequest
+    {
+        int32 Index = INDEX_NONE;
+        int32 Priority = 0;
+    };
+
+    FRequest* FindRequest(const FUtilityScoreRequestHandle& Handle);
+    const FRequest* FindRequest(const FUtilityScoreRequestHandle& Handle) const;
+
+    /** 立即评分并发布（游戏线程） */
+    void EvaluateRequest(int32 Index);
+
+    /** 采集评分快照（游戏线程） */
+    void GatherSnapshot(int32 Index, FRequest& Request, FEvaluationSnapshot& OutSnapshot);
+
+    /** 对快照评分，串行和并行路径共用，保证结果逐位一致 */
+    static void ScoreSnapshot(FEvaluationSnapshot& Snapshot);
+
+    /** 将快照结果发布到请求的前台缓冲 */
+    void PublishSnapshot(const FEvaluationSnapshot& Snapshot);
+
+    /** 等待进行中的评分并将后台缓冲发布到前台 */
+    void PublishInFlightBuffer();
+
+    /**
+     * 计算请求的优先级和有效更新间隔
+     * @return 优先级（基础优先级，靠近玩家和战斗中各加1）
+     */
+    int32 GetPriority(const FRequest& Request, const FVector* PlayerLocation, float& OutInterval) const;
+
+    /** 按到期后的等待时长提升优先级 */
+    int32 GetAgedPriority(int32 Priority, double OverdueSeconds) const;
+
+    /** 所有请求 */
+    TSparseArray<FRequest> Requests;
+
+    /** 下一个分配序号 */
+    uint32 NextSerial = 1;
+
+    /** 轮询起点 */
+    int32 Cursor = 0;
+
+    /** 调度时钟（秒） */
+    double SchedulerTime = 0.0;
+
+    /** 调度帧号 */
+    uint64 SchedulerFrame = 0;
+
+    /** 每帧复用的到期列表 */
+    TArray<FDueRequest> DueRequests;
+
+    /** 每帧复用的待清理列表 */
+    TArray<int32> StaleRequests;
+
+    /**
+     * 后台缓冲：本帧采集的快照，由工作线程评分后在下一帧发布到各请求的Result（前台缓冲）
+     * 评分进行期间游戏线程只读取前台缓冲，两者互不干扰
+     */
+    TArray<FEvaluationSnapshot> SnapshotBuffer;
+
+    /** 后台缓冲是否有待发布的快照 */
+    bool bHasInFlightBuffer = false;
+
+    /** 工作线程评分任务 */
+    UE::Tasks::FTask ScoringTask;
+
+    /** 统计 */
+    int32 LastFrameEvaluationCount = 0;
+    int32 LastFrameDeferredCount = 0;
+    double LastFrameTimeMicroseconds = 0.0;
+};
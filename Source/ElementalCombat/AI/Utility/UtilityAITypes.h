@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Curves/CurveFloat.h"
 #include "Engine/DataTable.h"
+#include "HAL/CriticalSection.h"
+#include "UtilityCurveLUT.h"
 #include "UtilityAITypes.generated.h"
 
 class AActor;
@@ -26,6 +28,122 @@ enum class EConsiderationType : uint8
     Custom            // 自定义评分
 };
 
+/**
+ * 自定义输入槽位
+ * 内置槽位固定下标，其余槽位通过FUtilityCustomSlotRegistry按名称注册
+ */
+namespace UtilityCustomSlots
+{
+    /** 冷却进度（CooldownPercent） */
+    constexpr int32 Cooldown = 0;
+
+    /** 队伍状态（TeamStatusPercent） */
+    constexpr int32 TeamStatus = 1;
+
+    /** 槽位总数上限（受输入掩码位数限制：CustomSlotShift + MaxSlots <= 32） */
+    constexpr int32 MaxSlots = 24;
+}
+
+/**
+ * 评分输入掩码
+ * 每一位对应上下文中的一项输入，低位为内置输入，自定义槽位从CustomSlotShift开始
+ * 用于只采集配置文件实际引用的输入（见FUtilityInputProviderRegistry）
+ */
+namespace UtilityInputs
+{
+    constexpr uint32 Health = 1u << 0;
+    constexpr uint32 TargetHealth = 1u << 1;
+    constexpr uint32 Distance = 1u << 2;
+    constexpr uint32 ElementAdvantage = 1u << 3;
+    constexpr uint32 ThreatLevel = 1u << 4;
+
+    /** 内置输入数量 */
+    constexpr int32 NumBuiltIn = 5;
+
+    /** 自定义槽位在掩码中的起始位 */
+    constexpr int32 CustomSlotShift = 8;
+
+    /** 掩码总位数 */
+    constexpr int32 NumBits = CustomSlotShift + UtilityCustomSlots::MaxSlots;
+
+    constexpr uint32 AllBuiltIn = (1u << NumBuiltIn) - 1;
+    constexpr uint32 AllCustom = ((1u << UtilityCustomSlots::MaxSlots) - 1) << CustomSlotShift;
+    constexpr uint32 All = AllBuiltIn | AllCustom;
+
+    static_assert(NumBits <= 32, "输入掩码按uint32存储");
+
+    /** 自定义槽位对应的输入位 */
+    constexpr uint32 ForCustomSlot(int32 Slot)
+    {
+        return (Slot >= 0 && Slot < UtilityCustomSlots::MaxSlots) ? (1u << (CustomSlotShift + Slot)) : 0u;
+    }
+
+    /**
+     * 评分类型读取的输入位
+     * @param CustomSlot Custom类型读取的槽位（其他类型忽略）
+     */
+    constexpr uint32 ForConsideration(EConsiderationType Type, int32 CustomSlot = INDEX_NONE)
+    {
+        switch (Type)
+        {
+        case EConsiderationType::Health:
+            return Health;
+        case EConsiderationType::Distance:
+            return Distance;
+        case EConsiderationType::ElementAdvantage:
+            return ElementAdvantage;
+        case EConsiderationType::ThreatLevel:
+            return ThreatLevel;
+        case EConsiderationType::Cooldown:
+            return ForCustomSlot(UtilityCustomSlots::Cooldown);
+        case EConsiderationType::TeamStatus:
+            return ForCustomSlot(UtilityCustomSlots::TeamStatus);
+        case EConsiderationType::Custom:
+            return ForCustomSlot(CustomSlot);
+        default:
+            return 0u;
+        }
+    }
+}
+
+/**
+ * 自定义输入槽位注册表
+ * 自定义输入名称只在加载或编译配置时注册一次，评分时通过整数下标读写
+ * 槽位只追加不注销：编译后的配置文件和FUtilityConsideration::CustomSlot会长期保存下标，
+ * 测试和基准也通过FindOrAddSlot查找各自固定名称的槽位，重复运行得到同一个下标
+ */
+class ELEMENTALCOMBAT_API FUtilityCustomSlotRegistry
+{
+public:
+    /** 获取全局注册表 */
+    static FUtilityCustomSlotRegistry& Get();
+
+    /**
+     * 查找或注册槽位
+     * @param Name 自定义输入名称
+     * @return 槽位下标，槽位已满时报错并返回INDEX_NONE（槽位数量受输入掩码位数限制，不能扩展）
+     */
+    int32 FindOrAddSlot(FName Name);
+
+    /** 查找已注册的槽位，未注册时返回INDEX_NONE */
+    int32 FindSlot(FName Name) const;
+
+    /** 获取槽位名称 */
+    FName GetSlotName(int32 Slot) const;
+
+    /** 获取已注册的槽位数量 */
+    int32 GetNumSlots() const;
+
+private:
+    FUtilityCustomSlotRegistry();
+
+    /** 注册锁（读取槽位值不需要加锁） */
+    mutable FRWLock Lock;
+
+    /** 按下标排列的槽位名称 */
+    TArray<FName> SlotNames;
+};
+
 /**
  * Utility评分上下文 - 提供评分计算所需的所有信息
  */
@@ -66,14 +184,17 @@ struct ELEMENTALCOMBAT_API FUtilityContext
     UPROPERTY(BlueprintReadWrite, Category = "ElementalCombat|AI")
     float ElementAdvantage = 0.0f;
 
-    /** 自定义数据映射 */
-    UPROPERTY(BlueprintReadWrite, Category = "ElementalCombat|AI")
-    TMap<FString, float> CustomValues;
+    /** 自定义输入值，按槽位下标索引（见FUtilityCustomSlotRegistry） */
+    float CustomSlotValues[UtilityCustomSlots::MaxSlots];
+
+    /** 已设置的自定义槽位掩码 */
+    uint32 CustomSlotMask = 0;
 
     FUtilityContext()
     {
         SelfActor = nullptr;
         TargetActor = nullptr;
+        FMemory::Memzero(CustomSlotValues);
     }
 
     /** 从上下文获取指定类型的评分输入值 */
@@ -90,9 +211,9 @@ struct ELEMENTALCOMBAT_API FUtilityContext
         case EConsiderationType::ThreatLevel:
             return ThreatLevel;
         case EConsiderationType::Cooldown:
-            return GetCustomValue(TEXT("CooldownPercent"), 1.0f);
+            return GetCustomValue(UtilityCustomSlots::Cooldown, 1.0f);
         case EConsiderationType::TeamStatus:
-            return GetCustomValue(TEXT("TeamStatusPercent"), 0.5f);
+            return GetCustomValue(UtilityCustomSlots::TeamStatus, 0.5f);
         case EConsiderationType::Custom:
             return 0.0f; // 需要通过GetCustomValue单独获取
         default:
@@ -100,17 +221,39 @@ struct ELEMENTALCOMBAT_API FUtilityContext
         }
     }
 
-    /** 设置自定义值 */
+    /** 按槽位设置自定义值 */
+    FORCEINLINE void SetCustomValue(int32 Slot, float Value)
+    {
+        if (Slot >= 0 && Slot < UtilityCustomSlots::MaxSlots)
+        {
+            CustomSlotValues[Slot] = Value;
+            CustomSlotMask |= (1u << Slot);
+        }
+    }
+
+    /** 按槽位获取自定义值 */
+    FORCEINLINE float GetCustomValue(int32 Slot, float DefaultValue = 0.0f) const
+    {
+        return (Slot >= 0 && Slot < UtilityCustomSlots::MaxSlots && (CustomSlotMask & (1u << Slot)))
+            ? CustomSlotValues[Slot] : DefaultValue;
+    }
+
+    /** 指定槽位是否已设置 */
+    FORCEINLINE bool HasCustomValue(int32 Slot) const
+    {
+        return Slot >= 0 && Slot < UtilityCustomSlots::MaxSlots && (CustomSlotMask & (1u << Slot)) != 0;
+    }
+
+    /** 设置自定义值（按名称，供编辑器和蓝图使用，热路径请使用槽位版本） */
     void SetCustomValue(const FString& Key, float Value)
     {
-        CustomValues.Add(Key, Value);
+        SetCustomValue(FUtilityCustomSlotRegistry::Get().FindOrAddSlot(FName(*Key)), Value);
     }
 
-    /** 获取自定义值 */
+    /** 获取自定义值（按名称，供编辑器和蓝图使用，热路径请使用槽位版本） */
     float GetCustomValue(const FString& Key, float DefaultValue = 0.0f) const
     {
-        const float* Value = CustomValues.Find(Key);
-        return Value ? *Value : DefaultValue;
+        return GetCustomValue(FUtilityCustomSlotRegistry::Get().FindSlot(FName(*Key)), DefaultValue);
     }
 };
 
@@ -148,6 +291,24 @@ struct ELEMENTALCOMBAT_API FUtilityConsideration
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|AI", meta = (ClampMin = "-1.0", ClampMax = "1.0"))
     float OutputOffset = 0.0f;
 
+    /** 增量评分时的输入变化阈值，处理后输入的变化不超过该值时沿用上次的单项评分（0表示任何变化都重新评分） */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|AI", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float RescoreInputEpsilon = 0.0f;
+
+    /** 是否使用烘焙后的查找表求值响应曲线 */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|AI")
+    bool bUseBakedCurve = true;
+
+    /** 查找表初始采样数量 */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|AI",
+              meta = (EditCondition = "bUseBakedCurve", ClampMin = "2", ClampMax = "4096"))
+    int32 BakedCurveSampleCount = FUtilityCurveLUT::DefaultSampleCount;
+
+    /** 查找表允许的最大偏差，超出时自动加密采样（<=0表示不限制） */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|AI",
+              meta = (EditCondition = "bUseBakedCurve", ClampMin = "0.0"))
+    float BakedCurveMaxError = 0.001f;
+
     FUtilityConsideration()
     {
         // 默认线性曲线
@@ -158,7 +319,74 @@ struct ELEMENTALCOMBAT_API FUtilityConsideration
     /** 根据上下文计算此项评分 [0.0 - 1.0] */
     float CalculateScore(const FUtilityContext& Context) const;
 
+    /**
+     * 将响应曲线烘焙为查找表
+     * 修改ResponseCurve后需要重新调用，否则会继续使用旧的查找表
+     * @return 烘焙结果是否满足误差上限
+     */
+    bool BakeResponseCurve();
+
+    /** 丢弃已烘焙的查找表，回退到直接求值曲线 */
+    void InvalidateBakedCurve() { BakedCurve.Reset(); }
+
+    /** 替换响应曲线并重新烘焙查找表 */
+    bool SetResponseCurve(const FRichCurve& InCurve);
+
+    /** 修改查找表设置并重新烘焙（关闭时丢弃查找表） */
+    bool SetBakedCurveSettings(bool bInUseBakedCurve, int32 InSampleCount, float InMaxError);
+
+    /** 是否存在可用的查找表 */
+    bool HasBakedCurve() const { return BakedCurve.IsValid(); }
+
+    /** 获取已烘焙的查找表（未烘焙时返回nullptr） */
+    const FUtilityCurveLUT* GetBakedCurve() const { return BakedCurve.Get(); }
+
+    /** 获取已烘焙查找表的共享引用（用于在配置文件之间共享） */
+    const TSharedPtr<const FUtilityCurveLUT>& GetSharedBakedCurve() const { return BakedCurve; }
+
+    /** 使用共享的查找表，调用方需保证查找表由相同的曲线和采样参数烘焙 */
+    void SetSharedBakedCurve(TSharedPtr<const FUtilityCurveLUT> InBakedCurve) { BakedCurve = MoveTemp(InBakedCurve); }
+
+    /**
+     * 校验查找表与原始曲线的偏差
+     * @param OutMaxDeviation 最大绝对偏差
+     * @param CheckPointCount 检查点数量，<=0时按采样数量自动计算
+     * @return 是否满足BakedCurveMaxError
+     */
+    bool ValidateBakedCurve(float& OutMaxDeviation, int32 CheckPointCount = 0) const;
+
+    /** 将CustomKey解析为自定义槽位（类型为Custom时） */
+    void ResolveCustomSlot();
+
+    /** 获取已解析的自定义槽位 */
+    int32 GetCustomSlot() const { return CustomSlot; }
+
+    /** 获取此项评分读取的输入掩码（见UtilityInputs） */
+    uint32 GetRequiredInputs() const;
+
+    /** 加载后自动烘焙查找表并解析自定义槽位 */
+    void PostSerialize(const FArchive& Ar);
+
+    /** 求值响应曲线（启用bUseBakedCurve且已烘焙时使用查找表） */
+    FORCEINLINE float EvaluateCurve(float ProcessedInput) const
+    {
+        const FUtilityCurveLUT* LUT = BakedCurve.Get();
+        if (bUseBakedCurve && LUT)
+        {
+            return LUT->Eval(ProcessedInput);
+        }
+
+        const FRichCurve* RichCurve = ResponseCurve.GetRichCurveConst();
+        return RichCurve ? RichCurve->Eval(ProcessedInput) : ProcessedInput;
+    }
+
 private:
+    /** 烘焙后的查找表（烘焙后不可变，拷贝配置时共享） */
+    TSharedPtr<const FUtilityCurveLUT> BakedCurve;
+
+    /** CustomKey对应的自定义槽位 */
+    int32 CustomSlot = INDEX_NONE;
+
     /** 处理输入值（应用反转和乘数） */
     float ProcessInputValue(float RawInput) const;
 
@@ -166,6 +394,15 @@ private:
     float ProcessOutputValue(float RawOutput) const;
 };
 
+template<>
+struct TStructOpsTypeTraits<FUtilityConsideration> : public TStructOpsTypeTraitsBase2<FUtilityConsideration>
+{
+    enum
+    {
+        WithPostSerialize = true,
+    };
+};
+
 /**
  * Utility评分配置文件
  * 定义一组评分因素及其权重
@@ -232,9 +469,28 @@ struct ELEMENTALCOMBAT_API FUtilityProfile
         Weights.Add(Type, FMath::Max(0.0f, Weight));
     }
 
+    /**
+     * 烘焙所有评分因素的响应曲线并解析自定义槽位
+     * @param bValidate 是否输出超出误差上限的评分因素
+     * @return 所有查找表是否都满足误差上限
+     */
+    bool BakeResponseCurves(bool bValidate = false);
+
+    /** 获取所有评分因素读取的输入掩码（见UtilityInputs） */
+    uint32 GetRequiredInputs() const;
+
+    /**
+     * 按组合方式把多个单项评分组合为最终结果（CalculateScore使用的组合规则）
+     * @param bMultiplicative 是否使用乘法组合
+     */
+    static float CombineWeightedScores(TArrayView<const float> Scores, TArrayView<const float> WeightArray, bool bMultiplicative);
+
 private:
     /** 组合多个评分为最终结果 */
-    float CombineScores(const TArray<float>& Scores, const TArray<float>& WeightArray) const;
+    float CombineScores(TArrayView<const float> Scores, TArrayView<const float> WeightArray) const
+    {
+        return CombineWeightedScores(Scores, WeightArray, bUseMultiplicativeCombination);
+    }
 };
 
 /**
@@ -252,4 +508,10 @@ struct ELEMENTALCOMBAT_API FUtilityProfileTableRow : public FTableRowBase
     /** 描述信息 */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|AI")
     FString Description;
+
+    /** 导入后重新烘焙查找表 */
+    virtual void OnPostDataImport(const UDataTable* InDataTable, const FName InRowName, TArray<FString>& OutCollectedImportProblems) override;
+
+    /** 在编辑器中修改行后重新烘焙查找表 */
+    virtual void OnDataTableChanged(const UDataTable* InDataTable, const FName InRowName) override;
 };
\ No newline at end of file
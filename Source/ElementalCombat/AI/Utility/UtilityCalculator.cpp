@@ -7,6 +7,72 @@
 
 // FUtilityContext implementations are now in the header file
 
+// FUtilityCustomSlotRegistry 实现
+FUtilityCustomSlotRegistry& FUtilityCustomSlotRegistry::Get()
+{
+    static FUtilityCustomSlotRegistry Registry;
+    return Registry;
+}
+
+FUtilityCustomSlotRegistry::FUtilityCustomSlotRegistry()
+{
+    // 内置槽位下标必须与UtilityCustomSlots中的常量一致
+    SlotNames.Reserve(UtilityCustomSlots::MaxSlots);
+    SlotNames.Add(TEXT("CooldownPercent"));
+    SlotNames.Add(TEXT("TeamStatusPercent"));
+}
+
+int32 FUtilityCustomSlotRegistry::FindOrAddSlot(FName Name)
+{
+    if (Name.IsNone())
+    {
+        return INDEX_NONE;
+    }
+
+    {
+        FReadScopeLock ReadLock(Lock);
+        const int32 Existing = SlotNames.IndexOfByKey(Name);
+        if (Existing != INDEX_NONE)
+        {
+            return Existing;
+        }
+    }
+
+    FWriteScopeLock WriteLock(Lock);
+    const int32 Existing = SlotNames.IndexOfByKey(Name);
+    if (Existing != INDEX_NONE)
+    {
+        return Existing;
+    }
+
+    // 槽位对应上下文中的固定数组和输入掩码位，满了之后不能静默丢弃，否则该输入永远读到默认值
+    if (!ensureMsgf(SlotNames.Num() < UtilityCustomSlots::MaxSlots, TEXT("自定义输入槽位已满（%d），无法注册: %s"), UtilityCustomSlots::MaxSlots, *Name.ToString()))
+    {
+        UE_LOG(LogTemp, Error, TEXT("自定义输入槽位已满（%d），无法注册: %s"), UtilityCustomSlots::MaxSlots, *Name.ToString());
+        return INDEX_NONE;
+    }
+
+    return SlotNames.Add(Name);
+}
+
+int32 FUtilityCustomSlotRegistry::FindSlot(FName Name) const
+{
+    FReadScopeLock ReadLock(Lock);
+    return SlotNames.IndexOfByKey(Name);
+}
+
+FName FUtilityCustomSlotRegistry::GetSlotName(int32 Slot) const
+{
+    FReadScopeLock ReadLock(Lock);
+    return SlotNames.IsValidIndex(Slot) ? SlotNames[Slot] : NAME_None;
+}
+
+int32 FUtilityCustomSlotRegistry::GetNumSlots() const
+{
+    FReadScopeLock ReadLock(Lock);
+    return SlotNames.Num();
+}
+
 // FUtilityConsideration 实现
 float FUtilityConsideration::CalculateScore(const FUtilityContext& Context) const
 {
@@ -15,7 +81,8 @@ float FUtilityConsideration::CalculateScore(const FUtilityContext& Context) cons
     
     if (ConsiderationType == EConsiderationType::Custom)
     {
-        RawInput = Context.GetCustomValue(CustomKey, 0.0f);
+        // 未解析槽位时回退到按名称查找
+        RawInput = CustomSlot != INDEX_NONE ? Context.GetCustomValue(CustomSlot, 0.0f) : Context.GetCustomValue(CustomKey, 0.0f);
     }
     else
     {
@@ -25,9 +92,8 @@ float FUtilityConsideration::CalculateScore(const FUtilityContext& Context) cons
     // 处理输入值
     float ProcessedInput = ProcessInputValue(RawInput);
 
-    // 通过响应曲线计算输出值
-    const FRichCurve* RichCurve = ResponseCurve.GetRichCurveConst();
-    float RawOutput = RichCurve ? RichCurve->Eval(ProcessedInput) : ProcessedInput;
+    // 通过响应曲线计算输出值（已烘焙时走查找表）
+    float RawOutput = EvaluateCurve(ProcessedInput);
 
     // 处理输出值
     float FinalOutput = ProcessOutputValue(RawOutput);
@@ -35,6 +101,80 @@ float FUtilityConsideration::CalculateScore(const FUtilityContext& Context) cons
     return FinalOutput;
 }
 
+bool FUtilityConsideration::BakeResponseCurve()
+{
+    const FRichCurve* RichCurve = ResponseCurve.GetRichCurveConst();
+    if (!bUseBakedCurve || !RichCurve || RichCurve->GetNumKeys() == 0)
+    {
+        BakedCurve.Reset();
+        return true;
+    }
+
+    TSharedRef<FUtilityCurveLUT> NewLUT = MakeShared<FUtilityCurveLUT>();
+    const bool bWithinError = NewLUT->Bake(*RichCurve, BakedCurveSampleCount, BakedCurveMaxError);
+    BakedCurve = NewLUT;
+
+    return bWithinError;
+}
+
+bool FUtilityConsideration::SetResponseCurve(const FRichCurve& InCurve)
+{
+    ResponseCurve.EditorCurveData = InCurve;
+    ResponseCurve.ExternalCurve = nullptr;
+    return BakeResponseCurve();
+}
+
+bool FUtilityConsideration::SetBakedCurveSettings(bool bInUseBakedCurve, int32 InSampleCount, float InMaxError)
+{
+    bUseBakedCurve = bInUseBakedCurve;
+    BakedCurveSampleCount = FMath::Clamp(InSampleCount, 2, 4096);
+    BakedCurveMaxError = FMath::Max(0.0f, InMaxError);
+    return BakeResponseCurve();
+}
+
+bool FUtilityConsideration::ValidateBakedCurve(float& OutMaxDeviation, int32 CheckPointCount) const
+{
+    OutMaxDeviation = 0.0f;
+
+    const FRichCurve* RichCurve = ResponseCurve.GetRichCurveConst();
+    if (!BakedCurve.IsValid() || !RichCurve)
+    {
+        return true;
+    }
+
+    OutMaxDeviation = BakedCurve->ComputeMaxDeviation(*RichCurve, CheckPointCount);
+    return BakedCurveMaxError <= 0.0f || OutMaxDeviation <= BakedCurveMaxError;
+}
+
+void FUtilityConsideration::ResolveCustomSlot()
+{
+    CustomSlot = (ConsiderationType == EConsiderationType::Custom && !CustomKey.IsEmpty())
+        ? FUtilityCustomSlotRegistry::Get().FindOrAddSlot(FName(*CustomKey))
+        : INDEX_NONE;
+}
+
+uint32 FUtilityConsideration::GetRequiredInputs() const
+{
+    if (ConsiderationType != EConsiderationType::Custom)
+    {
+        return UtilityInputs::ForConsideration(ConsiderationType);
+    }
+
+    // 未解析槽位时按名称查找，名称未注册说明没有任何输入提供者写入该槽位
+    const int32 Slot = CustomSlot != INDEX_NONE ? CustomSlot
+        : (CustomKey.IsEmpty() ? INDEX_NONE : FUtilityCustomSlotRegistry::Get().FindSlot(FName(*CustomKey)));
+    return UtilityInputs::ForConsideration(ConsiderationType, Slot);
+}
+
+void FUtilityConsideration::PostSerialize(const FArchive& Ar)
+{
+    if (Ar.IsLoading())
+    {
+        ResolveCustomSlot();
+        BakeResponseCurve();
+    }
+}
+
 float FUtilityConsideration::ProcessInputValue(float RawInput) const
 {
     float ProcessedInput = RawInput;
@@ -76,8 +216,9 @@ float FUtilityProfile::CalculateScore(const FUtilityContext& Context, TMap<ECons
         return 0.0f;
     }
 
-    TArray<float> Scores;
-    TArray<float> WeightArray;
+    // 常见配置的评分因素不超过内联容量，评分时不分配堆内存
+    TArray<float, TInlineAllocator<16>> Scores;
+    TArray<float, TInlineAllocator<16>> WeightArray;
     Scores.Reserve(Considerations.Num());
     WeightArray.Reserve(Considerations.Num());
 
@@ -121,14 +262,47 @@ float FUtilityProfile::CalculateScore(const FUtilityContext& Context, TMap<ECons
     return FinalScore;
 }
 
-float FUtilityProfile::CombineScores(const TArray<float>& Scores, const TArray<float>& WeightArray) const
+bool FUtilityProfile::BakeResponseCurves(bool bValidate)
+{
+    bool bAllWithinError = true;
+
+    for (FUtilityConsideration& Consideration : Considerations)
+    {
+        Consideration.ResolveCustomSlot();
+
+        const bool bWithinError = Consideration.BakeResponseCurve();
+        bAllWithinError &= bWithinError;
+
+        if (bValidate && !bWithinError)
+        {
+            const FUtilityCurveLUT* LUT = Consideration.GetBakedCurve();
+            UE_LOG(LogTemp, Warning, TEXT("效用配置[%s]: %s 曲线烘焙超出误差上限 采样数 = %d，最大偏差 = %.6f（上限: %.6f）"),
+                   *ProfileName, *UEnum::GetValueAsString(Consideration.ConsiderationType),
+                   LUT->GetSampleCount(), LUT->GetMaxDeviation(), Consideration.BakedCurveMaxError);
+        }
+    }
+
+    return bAllWithinError;
+}
+
+uint32 FUtilityProfile::GetRequiredInputs() const
+{
+    uint32 RequiredInputs = 0;
+    for (const FUtilityConsideration& Consideration : Considerations)
+    {
+        RequiredInputs |= Consideration.GetRequiredInputs();
+    }
+    return RequiredInputs;
+}
+
+float FUtilityProfile::CombineWeightedScores(TArrayView<const float> Scores, TArrayView<const float> WeightArray, bool bMultiplicative)
 {
     if (Scores.Num() == 0)
     {
         return 0.0f;
     }
 
-    if (bUseMultiplicativeCombination)
+    if (bMultiplicative)
     {
         // 乘法组合：所有评分相乘，权重作为指数
         float Product = 1.0f;
@@ -179,6 +353,20 @@ float FUtilityProfile::CombineScores(const TArray<float>& Scores, const TArray<f
     }
 }
 
+// === FUtilityProfileTableRow 实现 ===
+
+void FUtilityProfileTableRow::OnPostDataImport(const UDataTable* InDataTable, const FName InRowName, TArray<FString>& OutCollectedImportProblems)
+{
+    Super::OnPostDataImport(InDataTable, InRowName, OutCollectedImportProblems);
+    Profile.BakeResponseCurves(/*bValidate*/ true);
+}
+
+void FUtilityProfileTableRow::OnDataTableChanged(const UDataTable* InDataTable, const FName InRowName)
+{
+    Super::OnDataTableChanged(InDataTable, InRowName);
+    Profile.BakeResponseCurves();
+}
+
 // === UUtilityCalculator 静态函数实现 ===
 
 float UUtilityCalculator::CalculateUtilityScore(const FUtilityProfile& Profile, const FUtilityContext& Context)
@@ -186,6 +374,16 @@ float UUtilityCalculator::CalculateUtilityScore(const FUtilityProfile& Profile,
     return Profile.CalculateScore(Context);
 }
 
+float UUtilityCalculator::CalculateUtilityScore(const FCompiledUtilityProfile& Profile, const FUtilityContext& Context, bool* bOutIsValid)
+{
+    return Profile.CalculateScore(Context, bOutIsValid);
+}
+
+void UUtilityCalculator::CalculateUtilityScores(const FCompiledUtilityProfile& Profile, const FUtilityBatchInputs& Inputs, TArrayView<float> OutScores)
+{
+    Profile.CalculateScores(Inputs, OutScores);
+}
+
 float UUtilityCalculator::CalculateConsiderationScore(const FUtilityConsideration& Consideration, const FUtilityContext& Context)
 {
     return Consideration.CalculateScore(Context);
@@ -197,6 +395,34 @@ float UUtilityCalculator::EvaluateResponseCurve(const FRuntimeFloatCurve& Curve,
     return RichCurve ? RichCurve->Eval(InputValue) : InputValue;
 }
 
+void UUtilityCalculator::SetContextCustomValue(FUtilityContext& Context, const FString& Key, float Value)
+{
+    Context.SetCustomValue(Key, Value);
+}
+
+float UUtilityCalculator::GetContextCustomValue(const FUtilityContext& Context, const FString& Key, float DefaultValue)
+{
+    return Context.GetCustomValue(Key, DefaultValue);
+}
+
+bool UUtilityCalculator::ValidateBakedResponseCurve(const FRuntimeFloatCurve& Curve, int32 SampleCount, float& OutMaxDeviation)
+{
+    OutMaxDeviation = 0.0f;
+
+    const FRichCurve* RichCurve = Curve.GetRichCurveConst();
+    if (!RichCurve || RichCurve->GetNumKeys() == 0)
+    {
+        return false;
+    }
+
+    // 固定采样数量烘焙，不做自动加密，直接报告该分辨率下的偏差
+    FUtilityCurveLUT LUT;
+    LUT.Bake(*RichCurve, SampleCount, 0.0f);
+    OutMaxDeviation = LUT.GetMaxDeviation();
+
+    return true;
+}
+
 float UUtilityCalculator::CombineScores(const TArray<float>& Scores, const TArray<float>& Weights, bool bUseMultiplicative)
 {
     if (Scores.Num() == 0 || Scores.Num() != Weights.Num())
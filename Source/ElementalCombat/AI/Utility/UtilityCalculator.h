@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "UtilityAITypes.h"
+#include "CompiledUtilityProfile.h"
 #include "UtilityCalculator.generated.h"
 
 /**
@@ -25,6 +26,23 @@ public:
     UFUNCTION(BlueprintCallable, Category = "ElementalCombat|AI", CallInEditor)
     static float CalculateUtilityScore(const FUtilityProfile& Profile, const FUtilityContext& Context);
 
+    /**
+     * 使用编译后的配置文件计算Utility评分（仅C++，热路径不分配内存）
+     * @param Profile 编译后的评分配置文件
+     * @param Context 评分上下文
+     * @param bOutIsValid 是否达到最小分数阈值
+     * @return 计算出的评分结果
+     */
+    static float CalculateUtilityScore(const FCompiledUtilityProfile& Profile, const FUtilityContext& Context, bool* bOutIsValid = nullptr);
+
+    /**
+     * 批量计算多个AI的Utility评分（仅C++，结构数组布局输入）
+     * @param Profile 编译后的评分配置文件
+     * @param Inputs N个AI的输入列
+     * @param OutScores 输出评分，长度必须不小于Inputs.Count
+     */
+    static void CalculateUtilityScores(const FCompiledUtilityProfile& Profile, const FUtilityBatchInputs& Inputs, TArrayView<float> OutScores);
+
     /**
      * 计算单项评分
      * @param Consideration 评分因素配置
@@ -43,6 +61,35 @@ public:
     UFUNCTION(BlueprintCallable, Category = "ElementalCombat|AI", CallInEditor)
     static float EvaluateResponseCurve(const FRuntimeFloatCurve& Curve, float InputValue);
 
+    /**
+     * 按名称设置上下文的自定义值（蓝图便捷接口）
+     * @param Context 评分上下文
+     * @param Key 自定义值名称
+     * @param Value 自定义值
+     */
+    UFUNCTION(BlueprintCallable, Category = "ElementalCombat|AI")
+    static void SetContextCustomValue(UPARAM(ref) FUtilityContext& Context, const FString& Key, float Value);
+
+    /**
+     * 按名称获取上下文的自定义值（蓝图便捷接口）
+     * @param Context 评分上下文
+     * @param Key 自定义值名称
+     * @param DefaultValue 未设置时的默认值
+     * @return 自定义值
+     */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|AI")
+    static float GetContextCustomValue(const FUtilityContext& Context, const FString& Key, float DefaultValue = 0.0f);
+
+    /**
+     * 校验响应曲线烘焙为查找表后的精度
+     * @param Curve 响应曲线
+     * @param SampleCount 查找表采样数量
+     * @param OutMaxDeviation 查找表相对原始曲线的最大偏差
+     * @return 是否成功烘焙（曲线为空时返回false）
+     */
+    UFUNCTION(BlueprintCallable, Category = "ElementalCombat|AI", CallInEditor)
+    static bool ValidateBakedResponseCurve(const FRuntimeFloatCurve& Curve, int32 SampleCount, float& OutMaxDeviation);
+
     /**
      * 组合多个评分为最终结果
      * @param Scores 各项评分
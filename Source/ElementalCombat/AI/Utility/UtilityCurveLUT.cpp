@@ -0,0 +1,120 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "UtilityCurveLUT.h"
+#include "Curves/RichCurve.h"
+#include "Math/VectorRegister.h"
+
+bool FUtilityCurveLUT::Bake(const FRichCurve& Curve, int32 InSampleCount, float MaxError)
+{
+    return Bake([&Curve](float Input) { return Curve.Eval(Input); }, InSampleCount, MaxError);
+}
+
+bool FUtilityCurveLUT::Bake(TFunctionRef<float(float)> Sampler, int32 InSampleCount, float MaxError)
+{
+    int32 CurrentSampleCount = FMath::Clamp(InSampleCount, 2, MaxSampleCount);
+
+    FillSamples(Sampler, CurrentSampleCount);
+    MaxDeviation = ComputeMaxDeviation(Sampler);
+
+    // 误差超限时加密采样
+    while (MaxError > 0.0f && MaxDeviation > MaxError && CurrentSampleCount < MaxSampleCount)
+    {
+        CurrentSampleCount = FMath::Min(CurrentSampleCount * 2, MaxSampleCount);
+        FillSamples(Sampler, CurrentSampleCount);
+        MaxDeviation = ComputeMaxDeviation(Sampler);
+    }
+
+    return MaxError <= 0.0f || MaxDeviation <= MaxError;
+}
+
+void FUtilityCurveLUT::Reset()
+{
+    Samples.Empty();
+    SampleCount = 0;
+    LastIndex = 0.0f;
+    MaxDeviation = 0.0f;
+}
+
+void FUtilityCurveLUT::FillSamples(TFunctionRef<float(float)> Sampler, int32 InSampleCount)
+{
+    SampleCount = InSampleCount;
+    LastIndex = static_cast<float>(SampleCount - 1);
+
+    Samples.SetNumUninitialized(SampleCount + 1);
+    for (int32 i = 0; i < SampleCount; ++i)
+    {
+        Samples[i] = Sampler(static_cast<float>(i) / LastIndex);
+    }
+
+    // 末尾补一个重复采样，插值时无需边界判断
+    Samples[SampleCount] = Samples[SampleCount - 1];
+}
+
+void FUtilityCurveLUT::EvalBatch(const float* Inputs, float* Outputs, int32 Count) const
+{
+    check(IsValid());
+
+    const float* RESTRICT Data = Samples.GetData();
+    const VectorRegister4Float Zero = VectorZeroFloat();
+    const VectorRegister4Float One = VectorOneFloat();
+    const VectorRegister4Float Scale = VectorSetFloat1(LastIndex);
+
+    alignas(16) float IndexLanes[4];
+    alignas(16) float LowLanes[4];
+    alignas(16) float HighLanes[4];
+
+    int32 i = 0;
+    for (; i + 4 <= Count; i += 4)
+    {
+        // 限制输入范围并映射到采样坐标
+        const VectorRegister4Float Input = VectorMin(VectorMax(VectorLoad(Inputs + i), Zero), One);
+        const VectorRegister4Float Scaled = VectorMultiply(Input, Scale);
+        const VectorRegister4Float Floored = VectorFloor(Scaled);
+        const VectorRegister4Float Alpha = VectorSubtract(Scaled, Floored);
+        VectorStoreAligned(Floored, IndexLanes);
+
+        // 采样读取仍为标量（SSE没有gather），插值部分向量化
+        for (int32 Lane = 0; Lane < 4; ++Lane)
+        {
+            const int32 Index = FMath::Min(static_cast<int32>(IndexLanes[Lane]), SampleCount - 1);
+            LowLanes[Lane] = Data[Index];
+            HighLanes[Lane] = Data[Index + 1];
+        }
+
+        const VectorRegister4Float Low = VectorLoadAligned(LowLanes);
+        const VectorRegister4Float High = VectorLoadAligned(HighLanes);
+        VectorStore(VectorMultiplyAdd(VectorSubtract(High, Low), Alpha, Low), Outputs + i);
+    }
+
+    // 处理剩余元素
+    for (; i < Count; ++i)
+    {
+        Outputs[i] = Eval(Inputs[i]);
+    }
+}
+
+float FUtilityCurveLUT::ComputeMaxDeviation(const FRichCurve& Curve, int32 CheckPointCount) const
+{
+    return ComputeMaxDeviation([&Curve](float Input) { return Curve.Eval(Input); }, CheckPointCount);
+}
+
+float FUtilityCurveLUT::ComputeMaxDeviation(TFunctionRef<float(float)> Sampler, int32 CheckPointCount) const
+{
+    if (!IsValid())
+    {
+        return 0.0f;
+    }
+
+    // 默认在每个采样区间内检查多个点，覆盖插值误差最大的区间中部
+    const int32 NumChecks = CheckPointCount > 0 ? CheckPointCount : (SampleCount - 1) * ValidationSubSteps + 1;
+    const float InvChecks = NumChecks > 1 ? 1.0f / static_cast<float>(NumChecks - 1) : 0.0f;
+
+    float MaxError = 0.0f;
+    for (int32 i = 0; i < NumChecks; ++i)
+    {
+        const float Input = static_cast<float>(i) * InvChecks;
+        MaxError = FMath::Max(MaxError, FMath::Abs(Eval(Input) - Sampler(Input)));
+    }
+
+    return MaxError;
+}
@@ -0,0 +1,105 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+
+struct FRichCurve;
+
+/**
+ * 响应曲线烘焙查找表
+ * 将FRichCurve在[0.0, 1.0]区间内按固定分辨率采样，运行时通过线性插值求值，
+ * 避免每次评分都进行关键帧搜索和曲线插值
+ */
+struct ELEMENTALCOMBAT_API FUtilityCurveLUT
+{
+    /** 默认采样数量 */
+    static constexpr int32 DefaultSampleCount = 64;
+
+    /** 误差不满足时自动加密的最大采样数量 */
+    static constexpr int32 MaxSampleCount = 4096;
+
+    /** 误差校验时每个采样区间内的检查点数量 */
+    static constexpr int32 ValidationSubSteps = 4;
+
+    /**
+     * 从曲线烘焙查找表
+     * 如果最大偏差超过误差上限，会将采样数量翻倍直到满足要求或达到MaxSampleCount
+     * @param Curve 原始曲线
+     * @param InSampleCount 初始采样数量（至少为2）
+     * @param MaxError 允许的最大偏差，<=0表示不做误差约束
+     * @return 烘焙结果是否满足误差上限
+     */
+    bool Bake(const FRichCurve& Curve, int32 InSampleCount, float MaxError);
+
+    /**
+     * 从任意[0.0, 1.0]区间上的函数烘焙查找表
+     * @param Sampler 采样函数
+     * @param InSampleCount 初始采样数量（至少为2）
+     * @param MaxError 允许的最大偏差，<=0表示不做误差约束
+     * @return 烘焙结果是否满足误差上限
+     */
+    bool Bake(TFunctionRef<float(float)> Sampler, int32 InSampleCount, float MaxError);
+
+    /** 查找表是否已烘焙 */
+    bool IsValid() const { return SampleCount >= 2; }
+
+    /** 清空查找表 */
+    void Reset();
+
+    /**
+     * 查表求值（输入会被限制到[0.0, 1.0]）
+     */
+    FORCEINLINE float Eval(float Input) const
+    {
+        const float Scaled = FMath::Clamp(Input, 0.0f, 1.0f) * LastIndex;
+        const int32 Index = FMath::Min(static_cast<int32>(Scaled), SampleCount - 1);
+        const float Alpha = Scaled - static_cast<float>(Index);
+
+        // Samples末尾额外复制了一个采样点，Index + 1始终有效
+        const float* RESTRICT Data = Samples.GetData();
+        return Data[Index] + (Data[Index + 1] - Data[Index]) * Alpha;
+    }
+
+    /**
+     * 批量查表求值（向量化路径）
+     * @param Inputs 输入数组
+     * @param Outputs 输出数组（可以与Inputs相同）
+     * @param Count 元素数量
+     */
+    void EvalBatch(const float* Inputs, float* Outputs, int32 Count) const;
+
+    /**
+     * 计算查找表相对原始曲线的最大偏差
+     * @param Curve 原始曲线
+     * @param CheckPointCount 均匀分布的检查点数量，<=0时按采样数量自动计算
+     * @return 最大绝对偏差
+     */
+    float ComputeMaxDeviation(const FRichCurve& Curve, int32 CheckPointCount = 0) const;
+
+    /** 计算查找表相对任意采样函数的最大偏差 */
+    float ComputeMaxDeviation(TFunctionRef<float(float)> Sampler, int32 CheckPointCount = 0) const;
+
+    /** 获取采样数量 */
+    int32 GetSampleCount() const { return SampleCount; }
+
+    /** 获取烘焙时测得的最大偏差 */
+    float GetMaxDeviation() const { return MaxDeviation; }
+
+private:
+    /** 按指定采样数量填充采样点 */
+    void FillSamples(TFunctionRef<float(float)> Sampler, int32 InSampleCount);
+
+    /** 采样数据（SampleCount + 1个元素，最后一个为重复的末尾采样） */
+    TArray<float> Samples;
+
+    /** 有效采样数量 */
+    int32 SampleCount = 0;
+
+    /** SampleCount - 1，用于将输入映射到采样下标 */
+    float LastIndex = 0.0f;
+
+    /** 烘焙时测得的最大偏差 */
+    float MaxDeviation = 0.0f;
+};
@@ -0,0 +1,132 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "UtilityInputProviders.h"
+#include "AI/ElementalCombatEnemy.h"
+#include "AI/StateTreeTasks/ElementalStateTreeTaskBase.h"
+
+FUtilityInputProviderRegistry& FUtilityInputProviderRegistry::Get()
+{
+    static FUtilityInputProviderRegistry Registry;
+    return Registry;
+}
+
+FUtilityInputProviderRegistry::FUtilityInputProviderRegistry()
+{
+    // 内置输入的默认提供者，计算方式与FElementalStateTreeTaskBase的辅助函数一致
+    RegisterProvider(UtilityInputs::Health, [](const FUtilityInputQuery& Query, FUtilityContext& OutContext)
+    {
+        if (Query.Self)
+        {
+            OutContext.HealthPercent = FElementalStateTreeTaskBase::CalculateHealthPercent(Query.Self);
+        }
+    });
+
+    RegisterProvider(UtilityInputs::TargetHealth, [](const FUtilityInputQuery& Query, FUtilityContext& OutContext)
+    {
+        if (Query.Self && Query.Target)
+        {
+            OutContext.TargetHealthPercent = FElementalStateTreeTaskBase::CalculateHealthPercent(Query.Target);
+        }
+    });
+
+    RegisterProvider(UtilityInputs::Distance, [](const FUtilityInputQuery& Query, FUtilityContext& OutContext)
+    {
+        if (Query.Self && Query.Target)
+        {
+            OutContext.DistanceToTarget = FElementalStateTreeTaskBase::CalculateDistance(Query.Self, Query.Target);
+        }
+    });
+
+    RegisterProvider(UtilityInputs::ElementAdvantage, [](const FUtilityInputQuery& Query, FUtilityContext& OutContext)
+    {
+        if (Query.Self && Query.Target)
+        {
+            OutContext.ElementAdvantage = FElementalStateTreeTaskBase::CalculateElementAdvantage(Query.Self, Query.Target);
+        }
+    });
+
+    RegisterProvider(UtilityInputs::ThreatLevel, [](const FUtilityInputQuery& Query, FUtilityContext& OutContext)
+    {
+        if (Query.Self && Query.Target)
+        {
+            OutContext.ThreatLevel = FElementalStateTreeTaskBase::CalculateThreatLevel(Query.Self, Query.Target);
+        }
+    });
+}
+
+int32 FUtilityInputProviderRegistry::GetProviderIndex(uint32 InputBit)
+{
+    if (InputBit == 0 || (InputBit & (InputBit - 1)) != 0 || (InputBit & UtilityInputs::All) == 0)
+    {
+        return INDEX_NONE;
+    }
+    return FMath::CountTrailingZeros(InputBit);
+}
+
+bool FUtilityInputProviderRegistry::RegisterProvider(uint32 InputBit, FUtilityInputProvider Provider)
+{
+    const int32 Index = GetProviderIndex(InputBit);
+    if (Index == INDEX_NONE)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("无效的评分输入位: 0x%08x"), InputBit);
+        return false;
+    }
+
+    FWriteScopeLock WriteLock(Lock);
+    Providers[Index] = MoveTemp(Provider);
+    if (Providers[Index])
+    {
+        ProvidedInputs |= InputBit;
+    }
+    else
+    {
+        ProvidedInputs &= ~InputBit;
+    }
+    return true;
+}
+
+int32 FUtilityInputProviderRegistry::RegisterCustomProvider(FName CustomKey, FUtilityInputProvider Provider)
+{
+    const int32 Slot = FUtilityCustomSlotRegistry::Get().FindOrAddSlot(CustomKey);
+    if (Slot == INDEX_NONE)
+    {
+        return INDEX_NONE;
+    }
+
+    RegisterProvider(UtilityInputs::ForCustomSlot(Slot), MoveTemp(Provider));
+    return Slot;
+}
+
+void FUtilityInputProviderRegistry::UnregisterProvider(uint32 InputBit)
+{
+    RegisterProvider(InputBit, FUtilityInputProvider());
+}
+
+uint32 FUtilityInputProviderRegistry::GetProvidedInputs() const
+{
+    FReadScopeLock ReadLock(Lock);
+    return ProvidedInputs;
+}
+
+int32 FUtilityInputProviderRegistry::Populate(const FUtilityInputQuery& Query, uint32 RequiredInputs, FUtilityContext& InOutContext, uint32& InOutComputedInputs) const
+{
+    uint32 Pending = RequiredInputs & UtilityInputs::All & ~InOutComputedInputs;
+    if (Pending == 0)
+    {
+        return 0;
+    }
+
+    int32 NumInvoked = 0;
+    {
+        FReadScopeLock ReadLock(Lock);
+        for (uint32 Mask = Pending & ProvidedInputs; Mask != 0; Mask &= Mask - 1)
+        {
+            Providers[FMath::CountTrailingZeros(Mask)](Query, InOutContext);
+            ++NumInvoked;
+        }
+    }
+
+    // 没有提供者的输入同样标记为已采集，保持默认值，避免重复检查
+    InOutComputedInputs |= Pending;
+    return NumInvoked;
+}
@@ -0,0 +1,83 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "UtilityAITypes.h"
+
+class AActor;
+class AElementalCombatEnemy;
+
+/**
+ * 输入采集参数
+ */
+struct ELEMENTALCOMBAT_API FUtilityInputQuery
+{
+    /** 自身AI */
+    AElementalCombatEnemy* Self = nullptr;
+
+    /** 目标，可为空 */
+    AActor* Target = nullptr;
+
+    /** 当前世界时间 */
+    float CurrentTime = 0.0f;
+};
+
+/** 输入提供者：计算一项输入并写入上下文，无法计算时保持上下文默认值 */
+using FUtilityInputProvider = TFunction<void(const FUtilityInputQuery& Query, FUtilityContext& OutContext)>;
+
+/**
+ * 评分输入提供者注册表
+ * 每项输入（UtilityInputs中的一位）对应一个提供者，只在配置文件引用该输入时调用
+ * 新增的昂贵输入（视线、导航路径长度等）注册为自定义输入后，不会拖慢未引用它们的配置文件
+ * 注册应在启动时完成，采集只在游戏线程进行
+ */
+class ELEMENTALCOMBAT_API FUtilityInputProviderRegistry
+{
+public:
+    /** 获取全局注册表（已注册内置输入的默认提供者） */
+    static FUtilityInputProviderRegistry& Get();
+
+    /**
+     * 注册内置输入或自定义槽位的提供者，替换已有的提供者
+     * @param InputBit UtilityInputs中的单个输入位
+     * @return 输入位是否有效
+     */
+    bool RegisterProvider(uint32 InputBit, FUtilityInputProvider Provider);
+
+    /**
+     * 按名称注册自定义输入的提供者
+     * @return 自定义槽位，槽位已满时返回INDEX_NONE
+     */
+    int32 RegisterCustomProvider(FName CustomKey, FUtilityInputProvider Provider);
+
+    /** 移除提供者（内置输入移除后保持上下文默认值） */
+    void UnregisterProvider(uint32 InputBit);
+
+    /** 获取已注册提供者的输入掩码 */
+    uint32 GetProvidedInputs() const;
+
+    /**
+     * 按需采集输入
+     * 只调用RequiredInputs中尚未采集（不在InOutComputedInputs中）的提供者，完成后将这些位加入InOutComputedInputs
+     * 提供者内部不能再注册或移除提供者
+     * @return 本次调用的提供者数量
+     */
+    int32 Populate(const FUtilityInputQuery& Query, uint32 RequiredInputs, FUtilityContext& InOutContext, uint32& InOutComputedInputs) const;
+
+private:
+    FUtilityInputProviderRegistry();
+
+    /** 输入位 -> 下标，无效时返回INDEX_NONE */
+    static int32 GetProviderIndex(uint32 InputBit);
+
+    /** 注册锁 */
+    mutable FRWLock Lock;
+
+    /** 按输入位下标排列的提供者 */
+    FUtilityInputProvider Providers[UtilityInputs::NumBits];
+
+    /** 已注册提供者的输入掩码 */
+    uint32 ProvidedInputs = 0;
+};
@@ -0,0 +1,307 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "UtilityProfileRegistry.h"
+#include "UtilityScoreCache.h"
+#include "Engine/DataTable.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+
+// === FSharedUtilityProfile 实现 ===
+
+TSharedRef<const FSharedUtilityProfile> FSharedUtilityProfile::Create(FUtilityProfile Source)
+{
+    TSharedRef<FSharedUtilityProfile> Shared = MakeShared<FSharedUtilityProfile>();
+    Shared->Profile = MoveTemp(Source);
+
+    // 只烘焙缺失的查找表，已经共享的查找表保持不变
+    for (FUtilityConsideration& Consideration : Shared->Profile.Considerations)
+    {
+        Consideration.ResolveCustomSlot();
+        if (Consideration.bUseBakedCurve && !Consideration.HasBakedCurve())
+        {
+            Consideration.BakeResponseCurve();
+        }
+    }
+
+    Shared->Compiled.Compile(Shared->Profile);
+    Shared->Identity = FUtilityScoreCache::ComputeProfileIdentity(Shared->Profile);
+    return Shared;
+}
+
+// === FUtilityWeightOverlay 实现 ===
+
+FUtilityWeightOverlay FUtilityWeightOverlay::FromMultipliers(const FUtilityProfileHandle& InBase, const TMap<EConsiderationType, float>& Multipliers)
+{
+    FUtilityWeightOverlay Overlay;
+    Overlay.Base = InBase;
+    if (!InBase.IsValid())
+    {
+        return Overlay;
+    }
+
+    const FCompiledUtilityProfile& Compiled = InBase.Get()->Compiled;
+    for (int32 i = 0; i < FCompiledUtilityProfile::NumConsiderationTypes; ++i)
+    {
+        Overlay.Weights[i] = Compiled.GetWeight(static_cast<EConsiderationType>(i));
+    }
+    for (const auto& Pair : Multipliers)
+    {
+        float& Weight = Overlay.Weights[static_cast<int32>(Pair.Key)];
+        Weight = FMath::Max(0.0f, Weight * Pair.Value);
+    }
+
+    Overlay.UpdateIdentity();
+    return Overlay;
+}
+
+FUtilityWeightOverlay FUtilityWeightOverlay::FromWeights(const FUtilityProfileHandle& InBase, TConstArrayView<float> WeightsByType)
+{
+    check(WeightsByType.Num() == FCompiledUtilityProfile::NumConsiderationTypes);
+
+    FUtilityWeightOverlay Overlay;
+    Overlay.Base = InBase;
+    if (!InBase.IsValid())
+    {
+        return Overlay;
+    }
+
+    for (int32 i = 0; i < FCompiledUtilityProfile::NumConsiderationTypes; ++i)
+    {
+        Overlay.Weights[i] = FMath::Max(0.0f, WeightsByType[i]);
+    }
+
+    Overlay.UpdateIdentity();
+    return Overlay;
+}
+
+float FUtilityWeightOverlay::CalculateScore(const FUtilityContext& Context, bool* bOutIsValid) const
+{
+    if (!Base.IsValid())
+    {
+        if (bOutIsValid) *bOutIsValid = false;
+        return 0.0f;
+    }
+
+    return Base.Get()->Compiled.CalculateScoreWithWeights(Context, Weights, bOutIsValid);
+}
+
+void FUtilityWeightOverlay::CalculateScores(TConstArrayView<const FUtilityWeightOverlay*> Overlays, const FUtilityContext& Context, TArrayView<float> OutScores)
+{
+    check(OutScores.Num() == Overlays.Num());
+    if (Overlays.Num() == 0)
+    {
+        return;
+    }
+
+    bool bSharedBase = Overlays[0]->IsValid();
+    for (const FUtilityWeightOverlay* Overlay : Overlays)
+    {
+        bSharedBase &= Overlay->Base == Overlays[0]->Base;
+    }
+
+    if (!bSharedBase)
+    {
+        for (int32 i = 0; i < Overlays.Num(); ++i)
+        {
+            OutScores[i] = Overlays[i]->CalculateScore(Context);
+        }
+        return;
+    }
+
+    TArray<const float*, TInlineAllocator<4>> WeightSets;
+    for (const FUtilityWeightOverlay* Overlay : Overlays)
+    {
+        WeightSets.Add(Overlay->Weights);
+    }
+    Overlays[0]->Base.Get()->Compiled.CalculateScoresWithWeightSets(Context, WeightSets, OutScores);
+}
+
+void FUtilityWeightOverlay::UpdateIdentity()
+{
+    uint32 Hash = Base.GetIdentity();
+    for (const float Weight : Weights)
+    {
+        Hash = HashCombineFast(Hash, GetTypeHash(Weight));
+    }
+    Identity = Hash;
+}
+
+// === UUtilityProfileRegistry 实现 ===
+
+UUtilityProfileRegistry* UUtilityProfileRegistry::Get(const UObject* WorldContextObject)
+{
+    if (!WorldContextObject)
+    {
+        return nullptr;
+    }
+
+    if (const UWorld* World = WorldContextObject->GetWorld())
+    {
+        if (UGameInstance* GameInstance = World->GetGameInstance())
+        {
+            return GameInstance->GetSubsystem<UUtilityProfileRegistry>();
+        }
+    }
+
+    return nullptr;
+}
+
+void UUtilityProfileRegistry::Deinitialize()
+{
+    // 控制器持有的句柄仍然有效，这里只释放注册表自身的引用
+    UniqueProfiles.Empty();
+    UniqueProfileLookup.Empty();
+    RowProfiles.Empty();
+    RowLookup.Empty();
+    InternedCurves.Empty();
+
+    Super::Deinitialize();
+}
+
+int32 UUtilityProfileRegistry::LoadFromDataTable(const UDataTable* DataTable)
+{
+    RowProfiles.Reset();
+    RowLookup.Reset();
+
+    if (!DataTable)
+    {
+        return 0;
+    }
+
+    if (DataTable->GetRowStruct() == nullptr || !DataTable->GetRowStruct()->IsChildOf(FUtilityProfileTableRow::StaticStruct()))
+    {
+        UE_LOG(LogTemp, Error, TEXT("AI配置数据表 %s 的行结构不是FUtilityProfileTableRow"), *DataTable->GetName());
+        return 0;
+    }
+
+    const TMap<FName, uint8*>& RowMap = DataTable->GetRowMap();
+    RowProfiles.Reserve(RowMap.Num());
+    RowLookup.Reserve(RowMap.Num());
+
+    for (const TPair<FName, uint8*>& Row : RowMap)
+    {
+        const FUtilityProfileTableRow* ProfileRow = reinterpret_cast<const FUtilityProfileTableRow*>(Row.Value);
+        if (!ProfileRow)
+        {
+            continue;
+        }
+
+        RowLookup.Add(Row.Key, RowProfiles.Num());
+        RowProfiles.Add(FindOrAddUnique(ProfileRow->Profile));
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("AI配置注册表已加载 %s: %d 行，%d 个共享配置，%d 条共享曲线"),
+           *DataTable->GetName(), RowProfiles.Num(), UniqueProfiles.Num(), InternedCurves.Num());
+
+    return RowProfiles.Num();
+}
+
+FUtilityProfileHandle UUtilityProfileRegistry::RegisterProfile(const FUtilityProfile& Profile)
+{
+    return FindOrAddUnique(Profile);
+}
+
+FUtilityProfileHandle UUtilityProfileRegistry::FindProfile(FName RowName) const
+{
+    const int32* Index = RowLookup.Find(RowName);
+    return Index ? RowProfiles[*Index] : FUtilityProfileHandle();
+}
+
+FUtilityProfileHandle UUtilityProfileRegistry::GetRandomProfile() const
+{
+    if (RowProfiles.Num() == 0)
+    {
+        return FUtilityProfileHandle();
+    }
+
+    return RowProfiles[FMath::RandRange(0, RowProfiles.Num() - 1)];
+}
+
+FUtilityProfileHandle UUtilityProfileRegistry::FindOrAddUnique(const FUtilityProfile& Source)
+{
+    const uint32 Identity = FUtilityScoreCache::ComputeProfileIdentity(Source);
+
+    TArray<int32, TInlineAllocator<4>> Candidates;
+    UniqueProfileLookup.MultiFind(Identity, Candidates);
+    for (const int32 Index : Candidates)
+    {
+        const FUtilityProfile& Existing = UniqueProfiles[Index].GetProfile();
+        if (FUtilityProfile::StaticStruct()->CompareScriptStruct(&Existing, &Source, PPF_None))
+        {
+            return UniqueProfiles[Index];
+        }
+    }
+
+    FUtilityProfile Profile = Source;
+    InternCurves(Profile);
+
+    FUtilityProfileHandle Handle(FSharedUtilityProfile::Create(MoveTemp(Profile)));
+    UniqueProfileLookup.Add(Identity, UniqueProfiles.Num());
+    UniqueProfiles.Add(Handle);
+    return Handle;
+}
+
+void UUtilityProfileRegistry::InternCurves(FUtilityProfile& Profile)
+{
+    for (FUtilityConsideration& Consideration : Profile.Considerations)
+    {
+        const FRichCurve* RichCurve = Consideration.ResponseCurve.GetRichCurveConst();
+        if (!Consideration.bUseBakedCurve || !RichCurve || RichCurve->GetNumKeys() == 0)
+        {
+            continue;
+        }
+
+        const uint32 Hash = HashCurve(*RichCurve);
+        const FInternedCurve* Match = InternedCurves.FindByPredicate([&](const FInternedCurve& Interned)
+        {
+            return Interned.Hash == Hash
+                && Interned.SampleCount == Consideration.BakedCurveSampleCount
+                && Interned.MaxError == Consideration.BakedCurveMaxError
+                && CurvesEqual(Interned.Curve, *RichCurve);
+        });
+
+        if (Match)
+        {
+            Consideration.SetSharedBakedCurve(Match->LUT);
+            continue;
+        }
+
+        if (!Consideration.HasBakedCurve())
+        {
+            Consideration.BakeResponseCurve();
+        }
+
+        FInternedCurve& Interned = InternedCurves.AddDefaulted_GetRef();
+        Interned.Hash = Hash;
+        Interned.Curve = *RichCurve;
+        Interned.SampleCount = Consideration.BakedCurveSampleCount;
+        Interned.MaxError = Consideration.BakedCurveMaxError;
+        Interned.LUT = Consideration.GetSharedBakedCurve();
+    }
+}
+
+uint32 UUtilityProfileRegistry::HashCurve(const FRichCurve& Curve)
+{
+    uint32 Hash = GetTypeHash(Curve.DefaultValue);
+    Hash = HashCombineFast(Hash, GetTypeHash(static_cast<uint8>(Curve.PreInfinityExtrap)));
+    Hash = HashCombineFast(Hash, GetTypeHash(static_cast<uint8>(Curve.PostInfinityExtrap)));
+
+    for (const FRichCurveKey& Key : Curve.GetConstRefOfKeys())
+    {
+        Hash = HashCombineFast(Hash, GetTypeHash(Key.Time));
+        Hash = HashCombineFast(Hash, GetTypeHash(Key.Value));
+        Hash = HashCombineFast(Hash, GetTypeHash(Key.ArriveTangent));
+        Hash = HashCombineFast(Hash, GetTypeHash(Key.LeaveTangent));
+        Hash = HashCombineFast(Hash, GetTypeHash(static_cast<uint8>(Key.InterpMode)));
+    }
+
+    return Hash;
+}
+
+bool UUtilityProfileRegistry::CurvesEqual(const FRichCurve& A, const FRichCurve& B)
+{
+    return A.DefaultValue == B.DefaultValue
+        && A.PreInfinityExtrap == B.PreInfinityExtrap
+        && A.PostInfinityExtrap == B.PostInfinityExtrap
+        && A.GetConstRefOfKeys() == B.GetConstRefOfKeys();
+}
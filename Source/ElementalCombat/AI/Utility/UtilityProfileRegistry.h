@@ -0,0 +1,203 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Curves/RichCurve.h"
+#include "UtilityAITypes.h"
+#include "CompiledUtilityProfile.h"
+#include "UtilityProfileRegistry.generated.h"
+
+class UDataTable;
+
+/**
+ * 共享的不可变Utility配置文件
+ * 创建时一次性烘焙查找表、编译扁平表示并计算配置文件标识，之后只读，可被任意数量的AI和线程共享
+ */
+struct ELEMENTALCOMBAT_API FSharedUtilityProfile
+{
+    /** 源配置文件（查找表已烘焙） */
+    FUtilityProfile Profile;
+
+    /** 编译后的配置文件 */
+    FCompiledUtilityProfile Compiled;
+
+    /** 配置文件标识（见FUtilityScoreCache::ComputeProfileIdentity） */
+    uint32 Identity = 0;
+
+    /** 从配置文件创建共享实例（尚未烘焙的查找表会在此烘焙，已有的查找表保持共享） */
+    static TSharedRef<const FSharedUtilityProfile> Create(FUtilityProfile Source);
+};
+
+/**
+ * 共享配置文件句柄
+ * 拷贝句柄只增加引用计数，不会复制配置文件
+ */
+struct ELEMENTALCOMBAT_API FUtilityProfileHandle
+{
+    FUtilityProfileHandle() = default;
+
+    explicit FUtilityProfileHandle(TSharedRef<const FSharedUtilityProfile> InShared)
+        : Shared(MoveTemp(InShared))
+    {
+    }
+
+    bool IsValid() const { return Shared.IsValid(); }
+
+    void Reset() { Shared.Reset(); }
+
+    /** 获取共享配置文件（句柄无效时返回nullptr） */
+    const FSharedUtilityProfile* Get() const { return Shared.Get(); }
+
+    /** 获取源配置文件（句柄必须有效） */
+    const FUtilityProfile& GetProfile() const { check(Shared.IsValid()); return Shared->Profile; }
+
+    /** 获取编译后的配置文件，与句柄共享同一引用计数 */
+    TSharedPtr<const FCompiledUtilityProfile> GetCompiled() const
+    {
+        return Shared.IsValid() ? TSharedPtr<const FCompiledUtilityProfile>(Shared, &Shared->Compiled) : nullptr;
+    }
+
+    /** 获取配置文件标识（句柄无效时为0） */
+    uint32 GetIdentity() const { return Shared.IsValid() ? Shared->Identity : 0; }
+
+    bool operator==(const FUtilityProfileHandle& Other) const { return Shared == Other.Shared; }
+    bool operator!=(const FUtilityProfileHandle& Other) const { return Shared != Other.Shared; }
+
+private:
+    TSharedPtr<const FSharedUtilityProfile> Shared;
+};
+
+/**
+ * 权重覆盖视图
+ * 在共享配置文件之上叠加一组权重，不复制配置文件；评分使用编译后的配置文件
+ */
+struct ELEMENTALCOMBAT_API FUtilityWeightOverlay
+{
+    /** 基础配置文件 */
+    FUtilityProfileHandle Base;
+
+    /** 按EConsiderationType索引的权重 */
+    float Weights[FCompiledUtilityProfile::NumConsiderationTypes];
+
+    /** 配置文件标识与权重的组合，用于评分缓存 */
+    uint32 Identity = 0;
+
+    FUtilityWeightOverlay()
+    {
+        FMemory::Memzero(Weights);
+    }
+
+    /**
+     * 以基础配置文件的权重乘以倍率创建视图
+     * @param InBase 基础配置文件
+     * @param Multipliers 按类型的权重倍率，未列出的类型保持原权重
+     */
+    static FUtilityWeightOverlay FromMultipliers(const FUtilityProfileHandle& InBase, const TMap<EConsiderationType, float>& Multipliers);
+
+    /**
+     * 以给定的权重创建视图
+     * @param InBase 基础配置文件
+     * @param WeightsByType 按EConsiderationType索引的权重，长度为NumConsiderationTypes
+     */
+    static FUtilityWeightOverlay FromWeights(const FUtilityProfileHandle& InBase, TConstArrayView<float> WeightsByType);
+
+    bool IsValid() const { return Base.IsValid(); }
+
+    /** 计算综合评分 */
+    float CalculateScore(const FUtilityContext& Context, bool* bOutIsValid = nullptr) const;
+
+    /**
+     * 一次计算多个视图的综合评分
+     * 基础配置文件相同的视图共用单项输出，只按各自的权重组合；基础不同时逐个评分
+     * @param OutScores 输出评分，长度必须等于Overlays.Num()
+     */
+    static void CalculateScores(TConstArrayView<const FUtilityWeightOverlay*> Overlays, const FUtilityContext& Context, TArrayView<float> OutScores);
+
+private:
+    /** 根据基础标识和权重更新Identity */
+    void UpdateIdentity();
+};
+
+/**
+ * Utility配置文件注册表
+ * 从AI配置数据表一次性加载所有行，内容相同的行共享同一个不可变实例，不同配置文件间相同的响应曲线共享同一个查找表
+ * AI控制器只持有句柄，生成时不再复制配置文件或按行名查表
+ */
+UCLASS()
+class ELEMENTALCOMBAT_API UUtilityProfileRegistry : public UGameInstanceSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    /** 获取当前游戏实例的注册表 */
+    static UUtilityProfileRegistry* Get(const UObject* WorldContextObject);
+
+    virtual void Deinitialize() override;
+
+    /**
+     * 加载AI配置数据表（FUtilityProfileTableRow结构），替换之前加载的内容
+     * @return 加载的行数
+     */
+    int32 LoadFromDataTable(const UDataTable* DataTable);
+
+    /** 注册单个配置文件（与已注册的相同配置文件去重） */
+    FUtilityProfileHandle RegisterProfile(const FUtilityProfile& Profile);
+
+    /** 按行名查找配置文件 */
+    FUtilityProfileHandle FindProfile(FName RowName) const;
+
+    /** 随机选择一行配置文件（按行均匀分布），表为空时返回无效句柄 */
+    FUtilityProfileHandle GetRandomProfile() const;
+
+    /** 已加载的行数 */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|AI")
+    int32 GetNumRows() const { return RowProfiles.Num(); }
+
+    /** 去重后的共享配置文件数量 */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|AI")
+    int32 GetNumUniqueProfiles() const { return UniqueProfiles.Num(); }
+
+    /** 去重后的响应曲线查找表数量 */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|AI")
+    int32 GetNumInternedCurves() const { return InternedCurves.Num(); }
+
+private:
+    /** 共享的响应曲线查找表 */
+    struct FInternedCurve
+    {
+        uint32 Hash = 0;
+        FRichCurve Curve;
+        int32 SampleCount = 0;
+        float MaxError = 0.0f;
+        TSharedPtr<const FUtilityCurveLUT> LUT;
+    };
+
+    /** 查找或创建去重后的共享配置文件 */
+    FUtilityProfileHandle FindOrAddUnique(const FUtilityProfile& Source);
+
+    /** 让配置文件的查找表指向已去重的实例 */
+    void InternCurves(FUtilityProfile& Profile);
+
+    /** 计算响应曲线哈希 */
+    static uint32 HashCurve(const FRichCurve& Curve);
+
+    /** 两条曲线是否求值结果相同 */
+    static bool CurvesEqual(const FRichCurve& A, const FRichCurve& B);
+
+    /** 去重后的配置文件 */
+    TArray<FUtilityProfileHandle> UniqueProfiles;
+
+    /** 配置文件标识 -> UniqueProfiles下标（标识相同时再逐个比较内容） */
+    TMultiMap<uint32, int32> UniqueProfileLookup;
+
+    /** 按数据表行顺序的配置文件（随机选择时保持行的均匀分布） */
+    TArray<FUtilityProfileHandle> RowProfiles;
+
+    /** 行名 -> RowProfiles下标 */
+    TMap<FName, int32> RowLookup;
+
+    /** 去重后的响应曲线 */
+    TArray<FInternedCurve> InternedCurves;
+};
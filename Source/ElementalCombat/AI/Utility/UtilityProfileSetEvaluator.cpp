@@ -0,0 +1,145 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "UtilityProfileSetEvaluator.h"
+
+void FUtilityProfileSetEvaluator::Build(TConstArrayView<const FUtilityProfile*> InProfiles)
+{
+    Reset();
+    Profiles.Reserve(InProfiles.Num());
+
+    for (const FUtilityProfile* Profile : InProfiles)
+    {
+        check(Profile);
+
+        FProfileEntry& Entry = Profiles.AddDefaulted_GetRef();
+        Entry.FirstTerm = Terms.Num();
+        Entry.NumTerms = Profile->Considerations.Num();
+        Entry.bUseMultiplicativeCombination = Profile->bUseMultiplicativeCombination;
+        Entry.MinScoreThreshold = Profile->MinScoreThreshold;
+
+        for (const FUtilityConsideration& Consideration : Profile->Considerations)
+        {
+            // 数量很少，线性查找等价项即可
+            int32 UniqueIndex = UniqueConsiderations.IndexOfByPredicate([&Consideration](const FUtilityConsideration& Existing)
+            {
+                return AreEquivalent(Existing, Consideration);
+            });
+            if (UniqueIndex == INDEX_NONE)
+            {
+                UniqueIndex = UniqueConsiderations.Add(Consideration);
+                RequiredInputs |= Consideration.GetRequiredInputs();
+            }
+
+            FTerm& Term = Terms.AddDefaulted_GetRef();
+            Term.UniqueIndex = UniqueIndex;
+            Term.Weight = Profile->GetWeight(Consideration.ConsiderationType);
+        }
+    }
+}
+
+void FUtilityProfileSetEvaluator::Reset()
+{
+    UniqueConsiderations.Reset();
+    Terms.Reset();
+    Profiles.Reset();
+    RequiredInputs = 0;
+}
+
+void FUtilityProfileSetEvaluator::Evaluate(const FUtilityContext& Context, TArrayView<FUtilityRankedScore> OutRanked) const
+{
+    check(OutRanked.Num() == Profiles.Num());
+
+    // 每项评分因素只求值一次
+    TArray<float, TInlineAllocator<32>> Outputs;
+    Outputs.SetNumUninitialized(UniqueConsiderations.Num());
+    for (int32 i = 0; i < UniqueConsiderations.Num(); ++i)
+    {
+        Outputs[i] = UniqueConsiderations[i].CalculateScore(Context);
+    }
+
+    // 按配置文件内的原顺序收集单项评分，组合结果与FUtilityProfile::CalculateScore一致
+    TArray<float, TInlineAllocator<16>> Scores;
+    TArray<float, TInlineAllocator<16>> Weights;
+    for (int32 ProfileIndex = 0; ProfileIndex < Profiles.Num(); ++ProfileIndex)
+    {
+        const FProfileEntry& Entry = Profiles[ProfileIndex];
+        FUtilityRankedScore& Result = OutRanked[ProfileIndex];
+        Result.ProfileIndex = ProfileIndex;
+        Result.Score = 0.0f;
+        Result.bIsValid = false;
+
+        if (Entry.NumTerms == 0)
+        {
+            continue;
+        }
+
+        Scores.Reset();
+        Weights.Reset();
+        for (int32 TermIndex = Entry.FirstTerm; TermIndex < Entry.FirstTerm + Entry.NumTerms; ++TermIndex)
+        {
+            Scores.Add(Outputs[Terms[TermIndex].UniqueIndex]);
+            Weights.Add(Terms[TermIndex].Weight);
+        }
+
+        Result.Score = FUtilityProfile::CombineWeightedScores(Scores, Weights, Entry.bUseMultiplicativeCombination);
+        Result.bIsValid = Result.Score >= Entry.MinScoreThreshold;
+    }
+
+    SortRanked(OutRanked);
+}
+
+void FUtilityProfileSetEvaluator::SortRanked(TArrayView<FUtilityRankedScore> Ranked)
+{
+    // 配置文件数量很少，插入排序保持稳定且不分配内存
+    for (int32 i = 1; i < Ranked.Num(); ++i)
+    {
+        const FUtilityRankedScore Current = Ranked[i];
+        int32 j = i - 1;
+        while (j >= 0 && Ranked[j].Score < Current.Score)
+        {
+            Ranked[j + 1] = Ranked[j];
+            --j;
+        }
+        Ranked[j + 1] = Current;
+    }
+}
+
+bool FUtilityProfileSetEvaluator::AreEquivalent(const FUtilityConsideration& A, const FUtilityConsideration& B)
+{
+    if (A.ConsiderationType != B.ConsiderationType
+        || A.bInvertInput != B.bInvertInput
+        || A.InputMultiplier != B.InputMultiplier
+        || A.OutputOffset != B.OutputOffset
+        || A.GetCustomSlot() != B.GetCustomSlot()
+        || A.HasBakedCurve() != B.HasBakedCurve())
+    {
+        return false;
+    }
+
+    // 未解析槽位时按名称读取自定义输入
+    if (A.ConsiderationType == EConsiderationType::Custom && A.GetCustomSlot() == INDEX_NONE && A.CustomKey != B.CustomKey)
+    {
+        return false;
+    }
+
+    // 共享同一个查找表时必然相同
+    if (A.HasBakedCurve() && A.GetBakedCurve() == B.GetBakedCurve())
+    {
+        return true;
+    }
+
+    // 查找表由曲线和采样参数确定
+    if (A.HasBakedCurve() && (A.BakedCurveSampleCount != B.BakedCurveSampleCount || A.BakedCurveMaxError != B.BakedCurveMaxError))
+    {
+        return false;
+    }
+
+    const FRichCurve* CurveA = A.ResponseCurve.GetRichCurveConst();
+    const FRichCurve* CurveB = B.ResponseCurve.GetRichCurveConst();
+    if (!CurveA || !CurveB)
+    {
+        return CurveA == CurveB;
+    }
+
+    return *CurveA == *CurveB;
+}
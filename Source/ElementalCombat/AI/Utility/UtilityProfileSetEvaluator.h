@@ -0,0 +1,101 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UtilityAITypes.h"
+
+/**
+ * 配置文件集合中单个配置文件的评分结果
+ */
+struct ELEMENTALCOMBAT_API FUtilityRankedScore
+{
+    /** 配置文件在构建时的序号 */
+    int32 ProfileIndex = INDEX_NONE;
+
+    /** 综合评分 */
+    float Score = 0.0f;
+
+    /** 是否达到最小分数阈值 */
+    bool bIsValid = false;
+};
+
+/**
+ * 多配置文件共享输入评估器
+ * 由一组配置文件构建，把所有配置文件中等价的评分因素（类型、自定义槽位、输入修饰、响应曲线和输出偏移都相同）合并为一项，
+ * 评分时每项只求值一次，再按各配置文件自己的权重组合并排序；
+ * 开销随不同评分因素的数量增长，而不是配置文件数量×评分因素数量
+ * - 组合方式与FUtilityProfile::CalculateScore相同，每个配置文件的评分与单独评分逐位一致
+ * - 构建时复制评分因素（查找表共享），之后只读，评分过程不分配内存，可在多线程中并发调用
+ */
+struct ELEMENTALCOMBAT_API FUtilityProfileSetEvaluator
+{
+    /**
+     * 从一组配置文件构建，替换之前的内容
+     * @param Profiles 配置文件，评分结果中的ProfileIndex为其在此数组中的下标
+     */
+    void Build(TConstArrayView<const FUtilityProfile*> Profiles);
+
+    /** 清空 */
+    void Reset();
+
+    /** 配置文件数量 */
+    int32 GetNumProfiles() const { return Profiles.Num(); }
+
+    /** 合并后的评分因素数量 */
+    int32 GetNumUniqueConsiderations() const { return UniqueConsiderations.Num(); }
+
+    /** 合并前所有配置文件的评分因素总数 */
+    int32 GetNumTotalConsiderations() const { return Terms.Num(); }
+
+    /** 所有评分因素读取的输入掩码（见UtilityInputs） */
+    uint32 GetRequiredInputs() const { return RequiredInputs; }
+
+    /**
+     * 计算所有配置文件的评分，按评分从高到低排序（评分相同时保持构建顺序）
+     * @param OutRanked 输出，长度必须等于GetNumProfiles()
+     */
+    void Evaluate(const FUtilityContext& Context, TArrayView<FUtilityRankedScore> OutRanked) const;
+
+    /** 按评分从高到低稳定排序（不分配内存） */
+    static void SortRanked(TArrayView<FUtilityRankedScore> Ranked);
+
+    /** 两个评分因素对相同的上下文是否总是给出相同的单项评分 */
+    static bool AreEquivalent(const FUtilityConsideration& A, const FUtilityConsideration& B);
+
+private:
+    /** 配置文件中的一项：合并后的评分因素下标和该配置文件中的权重 */
+    struct FTerm
+    {
+        int32 UniqueIndex = INDEX_NONE;
+        float Weight = 0.0f;
+    };
+
+    /** 单个配置文件的组合参数 */
+    struct FProfileEntry
+    {
+        /** 在Terms中的起始下标 */
+        int32 FirstTerm = 0;
+
+        /** 评分因素数量（为0时评分无效） */
+        int32 NumTerms = 0;
+
+        /** 组合方式 */
+        bool bUseMultiplicativeCombination = false;
+
+        /** 最小分数阈值 */
+        float MinScoreThreshold = 0.0f;
+    };
+
+    /** 合并后的评分因素 */
+    TArray<FUtilityConsideration> UniqueConsiderations;
+
+    /** 各配置文件的项（按配置文件连续存放，保持配置文件内的原顺序） */
+    TArray<FTerm> Terms;
+
+    /** 各配置文件 */
+    TArray<FProfileEntry> Profiles;
+
+    /** 输入掩码 */
+    uint32 RequiredInputs = 0;
+};
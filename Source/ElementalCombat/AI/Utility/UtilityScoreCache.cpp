@@ -0,0 +1,344 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "UtilityScoreCache.h"
+#include "Curves/RichCurve.h"
+#include "Hash/CityHash.h"
+
+void FUtilityScoreCache::Configure(const FConfig& InConfig)
+{
+    const int32 NewCapacity = FMath::Clamp(InConfig.Capacity, 1, MaxCapacity);
+    const bool bLayoutChanged = Entries.Num() != NewCapacity
+        || Config.DistanceBucket != InConfig.DistanceBucket
+        || Config.InputBucket != InConfig.InputBucket;
+
+    Config = InConfig;
+    Config.Capacity = NewCapacity;
+    Config.ValidDuration = FMath::Max(0.0f, InConfig.ValidDuration);
+
+    if (bLayoutChanged)
+    {
+        Entries.Reset();
+        Entries.SetNum(NewCapacity);
+        Buckets.Reset();
+        Buckets.Init(INDEX_NONE, static_cast<int32>(FMath::RoundUpToPowerOfTwo(static_cast<uint32>(NewCapacity) * 2)));
+        FreeEntries.Reset(NewCapacity);
+        Empty();
+    }
+}
+
+bool FUtilityScoreCache::Find(uint32 ProfileIdentity, const FUtilityContext& Context, float& OutScore)
+{
+    if (Entries.Num() == 0)
+    {
+        ++Misses;
+        return false;
+    }
+
+    const FKey Key = MakeKey(ProfileIdentity, Context);
+    const int32 Index = FindEntryIndex(Key, HashKey(Key));
+    if (Index == INDEX_NONE)
+    {
+        ++Misses;
+        return false;
+    }
+
+    FEntry& Entry = Entries[Index];
+    if (IsExpired(Entry, Context.CurrentTime))
+    {
+        ReleaseEntry(Index);
+        ++Expirations;
+        ++Misses;
+        return false;
+    }
+
+    Entry.bReferenced = true;
+    OutScore = Entry.Score;
+    ++Hits;
+    return true;
+}
+
+void FUtilityScoreCache::Add(uint32 ProfileIdentity, const FUtilityContext& Context, float Score)
+{
+    if (Entries.Num() == 0)
+    {
+        return;
+    }
+
+    const FKey Key = MakeKey(ProfileIdentity, Context);
+    const uint64 KeyHash = HashKey(Key);
+
+    int32 Index = FindEntryIndex(Key, KeyHash);
+    if (Index == INDEX_NONE)
+    {
+        Index = AllocateEntry(Context.CurrentTime);
+    }
+
+    FEntry& Entry = Entries[Index];
+    Entry.Score = Score;
+    Entry.Timestamp = Context.CurrentTime;
+    Entry.bReferenced = true;
+    if (!Entry.bOccupied)
+    {
+        Entry.Key = Key;
+        Entry.KeyHash = KeyHash;
+        Entry.bOccupied = true;
+        ++NumOccupied;
+        LinkEntry(Index);
+    }
+}
+
+int32 FUtilityScoreCache::RemoveExpired(float CurrentTime)
+{
+    int32 NumRemoved = 0;
+    for (int32 Index = 0; Index < Entries.Num(); ++Index)
+    {
+        if (Entries[Index].bOccupied && IsExpired(Entries[Index], CurrentTime))
+        {
+            ReleaseEntry(Index);
+            ++NumRemoved;
+        }
+    }
+
+    Expirations += NumRemoved;
+    return NumRemoved;
+}
+
+void FUtilityScoreCache::Empty()
+{
+    for (FEntry& Entry : Entries)
+    {
+        Entry = FEntry();
+    }
+    for (int32& Bucket : Buckets)
+    {
+        Bucket = INDEX_NONE;
+    }
+
+    // 倒序放入，先分配下标小的条目
+    FreeEntries.Reset();
+    for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+    {
+        FreeEntries.Add(Index);
+    }
+    ClockHand = 0;
+    NumOccupied = 0;
+}
+
+void FUtilityScoreCache::ResetStats()
+{
+    Hits = 0;
+    Misses = 0;
+    Evictions = 0;
+    Expirations = 0;
+}
+
+FUtilityScoreCacheStats FUtilityScoreCache::GetStats() const
+{
+    FUtilityScoreCacheStats Stats;
+    Stats.Hits = Hits;
+    Stats.Misses = Misses;
+    Stats.Evictions = Evictions;
+    Stats.Expirations = Expirations;
+    Stats.NumEntries = NumOccupied;
+    Stats.Capacity = Entries.Num();
+    return Stats;
+}
+
+uint32 FUtilityScoreCache::ComputeProfileIdentity(const FUtilityProfile& Profile)
+{
+    uint32 Hash = GetTypeHash(Profile.ProfileName);
+    Hash = HashCombineFast(Hash, GetTypeHash(Profile.bUseMultiplicativeCombination));
+    Hash = HashCombineFast(Hash, GetTypeHash(Profile.MinScoreThreshold));
+
+    for (const FUtilityConsideration& Consideration : Profile.Considerations)
+    {
+        Hash = HashCombineFast(Hash, GetTypeHash(Consideration.ConsiderationType));
+        Hash = HashCombineFast(Hash, GetTypeHash(Profile.GetWeight(Consideration.ConsiderationType)));
+        Hash = HashCombineFast(Hash, GetTypeHash(Consideration.CustomKey));
+        Hash = HashCombineFast(Hash, GetTypeHash(Consideration.bInvertInput));
+        Hash = HashCombineFast(Hash, GetTypeHash(Consideration.InputMultiplier));
+        Hash = HashCombineFast(Hash, GetTypeHash(Consideration.OutputOffset));
+        Hash = HashCombineFast(Hash, GetTypeHash(Consideration.bUseBakedCurve));
+        Hash = HashCombineFast(Hash, GetTypeHash(Consideration.BakedCurveSampleCount));
+
+        if (const FRichCurve* Curve = Consideration.ResponseCurve.GetRichCurveConst())
+        {
+            for (const FRichCurveKey& CurveKey : Curve->GetConstRefOfKeys())
+            {
+                Hash = HashCombineFast(Hash, GetTypeHash(CurveKey.Time));
+                Hash = HashCombineFast(Hash, GetTypeHash(CurveKey.Value));
+                Hash = HashCombineFast(Hash, GetTypeHash(CurveKey.ArriveTangent));
+                Hash = HashCombineFast(Hash, GetTypeHash(CurveKey.LeaveTangent));
+                Hash = HashCombineFast(Hash, GetTypeHash(static_cast<uint8>(CurveKey.InterpMode)));
+            }
+        }
+    }
+
+    return Hash;
+}
+
+FUtilityScoreCache::FKey FUtilityScoreCache::MakeKey(uint32 ProfileIdentity, const FUtilityContext& Context) const
+{
+    FKey Key;
+    Key.ProfileIdentity = ProfileIdentity;
+    Key.Distance = Quantize(Context.DistanceToTarget, Config.DistanceBucket);
+    Key.Health = Quantize(Context.HealthPercent, Config.InputBucket);
+    Key.TargetHealth = Quantize(Context.TargetHealthPercent, Config.InputBucket);
+    Key.Threat = Quantize(Context.ThreatLevel, Config.InputBucket);
+    Key.Advantage = Quantize(Context.ElementAdvantage, Config.InputBucket);
+    Key.CustomMask = Context.CustomSlotMask;
+    Key.TargetId = Context.TargetActor.IsValid() ? GetTypeHash(Context.TargetActor) : 0;
+
+    // 自定义槽位按掩码逐个量化，未设置的槽位不参与
+    uint32 CustomHash = 0;
+    for (uint32 Mask = Context.CustomSlotMask; Mask != 0; Mask &= Mask - 1)
+    {
+        const int32 Slot = FMath::CountTrailingZeros(Mask);
+        CustomHash = HashCombineFast(CustomHash, static_cast<uint32>(Quantize(Context.CustomSlotValues[Slot], Config.InputBucket)));
+    }
+    Key.CustomHash = CustomHash;
+
+    return Key;
+}
+
+uint64 FUtilityScoreCache::HashKey(const FKey& Key)
+{
+    static_assert(sizeof(FKey) == 9 * sizeof(uint32), "FKey不应包含填充字节");
+    return CityHash64(reinterpret_cast<const char*>(&Key), sizeof(FKey));
+}
+
+int32 FUtilityScoreCache::Quantize(float Value, float Bucket)
+{
+    if (Bucket <= 0.0f)
+    {
+        // 不量化时按位比较
+        int32 Bits;
+        FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+        return Bits;
+    }
+
+    const float Scaled = FMath::Clamp(Value / Bucket, -2.0e9f, 2.0e9f);
+    return FMath::FloorToInt32(Scaled);
+}
+
+int32 FUtilityScoreCache::FindBucket(const FKey& Key, uint64 KeyHash) const
+{
+    const uint32 BucketMask = static_cast<uint32>(Buckets.Num() - 1);
+    for (uint32 Bucket = static_cast<uint32>(KeyHash) & BucketMask; ; Bucket = (Bucket + 1) & BucketMask)
+    {
+        const int32 EntryIndex = Buckets[Bucket];
+        if (EntryIndex == INDEX_NONE)
+        {
+            return INDEX_NONE;
+        }
+
+        const FEntry& Entry = Entries[EntryIndex];
+        if (Entry.KeyHash == KeyHash && Entry.Key == Key)
+        {
+            return static_cast<int32>(Bucket);
+        }
+    }
+}
+
+int32 FUtilityScoreCache::FindEntryIndex(const FKey& Key, uint64 KeyHash) const
+{
+    const int32 Bucket = FindBucket(Key, KeyHash);
+    return Bucket != INDEX_NONE ? Buckets[Bucket] : INDEX_NONE;
+}
+
+void FUtilityScoreCache::LinkEntry(int32 EntryIndex)
+{
+    // 下标表大小至少是容量的两倍，一定有空位
+    const uint32 BucketMask = static_cast<uint32>(Buckets.Num() - 1);
+    uint32 Bucket = static_cast<uint32>(Entries[EntryIndex].KeyHash) & BucketMask;
+    while (Buckets[Bucket] != INDEX_NONE)
+    {
+        Bucket = (Bucket + 1) & BucketMask;
+    }
+    Buckets[Bucket] = EntryIndex;
+}
+
+void FUtilityScoreCache::UnlinkEntry(int32 EntryIndex)
+{
+    const FEntry& Entry = Entries[EntryIndex];
+    uint32 Hole = static_cast<uint32>(FindBucket(Entry.Key, Entry.KeyHash));
+    if (!ensure(Hole != static_cast<uint32>(INDEX_NONE) && Buckets[Hole] == EntryIndex))
+    {
+        return;
+    }
+
+    // 后移删除：把探测链上之后的、起始位置不在(Hole, Next]区间内的条目移入空位
+    const uint32 BucketMask = static_cast<uint32>(Buckets.Num() - 1);
+    for (uint32 Next = (Hole + 1) & BucketMask; Buckets[Next] != INDEX_NONE; Next = (Next + 1) & BucketMask)
+    {
+        const uint32 Home = static_cast<uint32>(Entries[Buckets[Next]].KeyHash) & BucketMask;
+        const uint32 DistanceFromHome = (Next - Home) & BucketMask;
+        const uint32 DistanceFromHole = (Next - Hole) & BucketMask;
+        if (DistanceFromHome >= DistanceFromHole)
+        {
+            Buckets[Hole] = Buckets[Next];
+            Hole = Next;
+        }
+    }
+    Buckets[Hole] = INDEX_NONE;
+}
+
+bool FUtilityScoreCache::IsExpired(const FEntry& Entry, float CurrentTime) const
+{
+    const float Age = CurrentTime - Entry.Timestamp;
+    return Age > Config.ValidDuration || Age < 0.0f;
+}
+
+void FUtilityScoreCache::ReleaseEntry(int32 EntryIndex)
+{
+    FEntry& Entry = Entries[EntryIndex];
+    if (Entry.bOccupied)
+    {
+        UnlinkEntry(EntryIndex);
+        Entry.bOccupied = false;
+        Entry.bReferenced = false;
+        --NumOccupied;
+        FreeEntries.Add(EntryIndex);
+    }
+}
+
+int32 FUtilityScoreCache::AllocateEntry(float CurrentTime)
+{
+    const int32 Capacity = Entries.Num();
+
+    if (FreeEntries.Num() > 0)
+    {
+        return FreeEntries.Pop(EAllowShrinking::No);
+    }
+
+    // CLOCK：跳过最近被访问的条目（清除其访问标记），遇到过期或未被访问的条目即替换
+    // 最多扫描两圈，第二圈时所有访问标记都已清除
+    for (int32 Step = 0; Step < Capacity * 2; ++Step)
+    {
+        const int32 Index = ClockHand;
+        ClockHand = (ClockHand + 1) % Capacity;
+
+        FEntry& Entry = Entries[Index];
+        if (IsExpired(Entry, CurrentTime))
+        {
+            ReleaseEntry(Index);
+            ++Expirations;
+            return FreeEntries.Pop(EAllowShrinking::No);
+        }
+
+        if (Entry.bReferenced)
+        {
+            Entry.bReferenced = false;
+            continue;
+        }
+
+        ReleaseEntry(Index);
+        ++Evictions;
+        return FreeEntries.Pop(EAllowShrinking::No);
+    }
+
+    // 不会执行到这里
+    ReleaseEntry(ClockHand);
+    ++Evictions;
+    return FreeEntries.Pop(EAllowShrinking::No);
+}
@@ -0,0 +1,198 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UtilityAITypes.h"
+
+/**
+ * 评分缓存统计
+ */
+struct ELEMENTALCOMBAT_API FUtilityScoreCacheStats
+{
+    /** 命中次数 */
+    uint64 Hits = 0;
+
+    /** 未命中次数（包括已过期的条目） */
+    uint64 Misses = 0;
+
+    /** 因容量不足被替换掉的有效条目数量 */
+    uint64 Evictions = 0;
+
+    /** 因过期被替换或清理的条目数量 */
+    uint64 Expirations = 0;
+
+    /** 当前占用的条目数量 */
+    int32 NumEntries = 0;
+
+    /** 缓存容量 */
+    int32 Capacity = 0;
+
+    /** 命中率 [0.0 - 1.0] */
+    float GetHitRate() const
+    {
+        const uint64 Total = Hits + Misses;
+        return Total > 0 ? static_cast<float>(static_cast<double>(Hits) / static_cast<double>(Total)) : 0.0f;
+    }
+};
+
+/**
+ * 定长Utility评分缓存
+ * - 键由配置文件标识和按桶量化后的输入组成，相近的输入可以命中同一条目
+ * - 容量固定，满时按CLOCK算法（近似LRU）淘汰，不会随运行时间增长
+ * - 条目按64位键哈希放入开放寻址的下标表（容量的两倍以上，线性探测），查询和插入与容量无关
+ * - 下标表和空闲列表在Configure时一次分配，查询、插入和淘汰都不分配内存
+ */
+struct ELEMENTALCOMBAT_API FUtilityScoreCache
+{
+    /** 默认容量 */
+    static constexpr int32 DefaultCapacity = 64;
+
+    /** 最大容量 */
+    static constexpr int32 MaxCapacity = 4096;
+
+    /** 缓存配置 */
+    struct FConfig
+    {
+        /** 条目数量上限 */
+        int32 Capacity = DefaultCapacity;
+
+        /** 条目有效时间（秒） */
+        float ValidDuration = 0.1f;
+
+        /** 距离分桶大小（原始单位），<=0表示不量化 */
+        float DistanceBucket = 50.0f;
+
+        /** 百分比类输入（健康度、威胁、元素优势、自定义值）的分桶大小，<=0表示不量化 */
+        float InputBucket = 0.05f;
+    };
+
+    /**
+     * 应用配置，容量或分桶变化时清空缓存（保留统计），配置不变时无开销
+     * 首次调用前缓存不分配内存，所有查询都视为未命中
+     */
+    void Configure(const FConfig& InConfig);
+
+    /** 获取当前配置 */
+    const FConfig& GetConfig() const { return Config; }
+
+    /**
+     * 查找缓存评分
+     * @param ProfileIdentity 配置文件标识（见ComputeProfileIdentity）
+     * @param Context 评分上下文
+     * @param OutScore 命中时的评分
+     * @return 是否命中
+     */
+    bool Find(uint32 ProfileIdentity, const FUtilityContext& Context, float& OutScore);
+
+    /** 写入评分（键已存在时覆盖），以Context.CurrentTime作为时间戳 */
+    void Add(uint32 ProfileIdentity, const FUtilityContext& Context, float Score);
+
+    /**
+     * 清理所有已过期的条目
+     * @return 清理的条目数量
+     */
+    int32 RemoveExpired(float CurrentTime);
+
+    /** 清空所有条目（保留统计） */
+    void Empty();
+
+    /** 重置统计计数 */
+    void ResetStats();
+
+    /** 获取统计信息 */
+    FUtilityScoreCacheStats GetStats() const;
+
+    /**
+     * 计算配置文件标识
+     * 覆盖名称、组合方式、阈值、权重和各评分因素的参数及曲线关键帧，权重不同的配置文件不会共用缓存条目
+     */
+    static uint32 ComputeProfileIdentity(const FUtilityProfile& Profile);
+
+private:
+    /** 量化后的缓存键 */
+    struct FKey
+    {
+        uint32 ProfileIdentity = 0;
+        int32 Distance = 0;
+        int32 Health = 0;
+        int32 TargetHealth = 0;
+        int32 Threat = 0;
+        int32 Advantage = 0;
+        uint32 CustomMask = 0;
+        uint32 CustomHash = 0;
+        uint32 TargetId = 0;
+
+        bool operator==(const FKey& Other) const
+        {
+            return ProfileIdentity == Other.ProfileIdentity && Distance == Other.Distance && Health == Other.Health
+                && TargetHealth == Other.TargetHealth && Threat == Other.Threat && Advantage == Other.Advantage
+                && CustomMask == Other.CustomMask && CustomHash == Other.CustomHash && TargetId == Other.TargetId;
+        }
+    };
+
+    /** 缓存条目 */
+    struct FEntry
+    {
+        FKey Key;
+        uint64 KeyHash = 0;
+        float Score = 0.0f;
+        float Timestamp = 0.0f;
+        bool bOccupied = false;
+        bool bReferenced = false;
+    };
+
+    /** 构建量化键 */
+    FKey MakeKey(uint32 ProfileIdentity, const FUtilityContext& Context) const;
+
+    /** 计算键哈希 */
+    static uint64 HashKey(const FKey& Key);
+
+    /** 量化单个值 */
+    static int32 Quantize(float Value, float Bucket);
+
+    /** 查找键在下标表中的位置，未找到时返回INDEX_NONE */
+    int32 FindBucket(const FKey& Key, uint64 KeyHash) const;
+
+    /** 查找键所在的条目下标 */
+    int32 FindEntryIndex(const FKey& Key, uint64 KeyHash) const;
+
+    /** 把条目加入下标表 */
+    void LinkEntry(int32 EntryIndex);
+
+    /** 把条目从下标表移除（后移删除，不留墓碑） */
+    void UnlinkEntry(int32 EntryIndex);
+
+    /** 条目是否已过期（时间倒退，例如切换世界后，也视为过期） */
+    bool IsExpired(const FEntry& Entry, float CurrentTime) const;
+
+    /** 释放条目并放回空闲列表 */
+    void ReleaseEntry(int32 EntryIndex);
+
+    /** 选择用于写入的条目（空位优先，其次过期条目，最后按CLOCK淘汰） */
+    int32 AllocateEntry(float CurrentTime);
+
+    /** 固定容量的条目数组 */
+    TArray<FEntry> Entries;
+
+    /** 键哈希到条目下标的开放寻址表（INDEX_NONE表示空位，大小为2的幂） */
+    TArray<int32> Buckets;
+
+    /** 空闲条目下标 */
+    TArray<int32> FreeEntries;
+
+    /** CLOCK指针 */
+    int32 ClockHand = 0;
+
+    /** 当前占用数量 */
+    int32 NumOccupied = 0;
+
+    /** 配置 */
+    FConfig Config;
+
+    /** 统计 */
+    uint64 Hits = 0;
+    uint64 Misses = 0;
+    uint64 Evictions = 0;
+    uint64 Expirations = 0;
+};
@@ -38,7 +38,7 @@ void AAdvancedCombatCharacter::BeginPlay()
 		ElementalComponent->SwitchElement(EElementalType::Earth);
 
 		// 应用初始元素颜色到材质
-		const FElementalEffectData* ElementData = ElementalComponent->GetElementEffectDataPtr(EElementalType::Earth);
+		const FElementalPresentationData* ElementData = ElementalComponent->GetElementPresentationPtr(EElementalType::Earth);
 		if (ElementData)
 		{
 			UpdateMaterialColors(ElementData->ElementColor);
@@ -162,7 +162,7 @@ void AAdvancedCombatCharacter::LaunchProjectile()
 		float DamageMultiplier = 1.0f; // 基础伤害倍率
 
 		// 获取当前元素的效果数据并应用到伤害倍率
-		const FElementalEffectData* ElementData = ElementalComponent->GetElementEffectDataPtr(CurrentElement);
+		const FElementalEffectParams* ElementData = ElementalComponent->GetElementEffectParamsPtr(CurrentElement);
 		if (ElementData)
 		{
 			// 应用元素的伤害倍率（金元素效果）
@@ -261,7 +261,7 @@ void AAdvancedCombatCharacter::SwitchToElement(EElementalType NewElement)
 	ElementalComponent->SwitchElement(NewElement);
 
 	// 应用元素颜色到材质
-	const FElementalEffectData* ElementData = ElementalComponent->GetElementEffectDataPtr(NewElement);
+	const FElementalPresentationData* ElementData = ElementalComponent->GetElementPresentationPtr(NewElement);
 	if (ElementData)
 	{
 		UpdateMaterialColors(ElementData->ElementColor);
@@ -0,0 +1,167 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "Combat/CombatDamageSubsystem.h"
+#include "Variant_Combat/Interfaces/CombatDamageable.h"
+#include "Engine/DamageEvents.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarCombatDamageImmediate(
+	TEXT("ElementalCombat.Combat.Damage.Immediate"),
+	false,
+	TEXT("命中时立即结算伤害，不进入每帧合并的伤害队列（用于调试）"),
+	ECVF_Default);
+
+UCombatDamageSubsystem* UCombatDamageSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (!WorldContextObject)
+	{
+		return nullptr;
+	}
+
+	const UWorld* World = WorldContextObject->GetWorld();
+	return World ? World->GetSubsystem<UCombatDamageSubsystem>() : nullptr;
+}
+
+void UCombatDamageSubsystem::ApplyDamage(AActor* Target, float Damage, AActor* Causer, const FVector& Location, const FVector& Impulse)
+{
+	if (!Target)
+	{
+		return;
+	}
+
+	UCombatDamageSubsystem* DamageSubsystem = IsImmediateMode() ? nullptr : Get(Target);
+	if (DamageSubsystem)
+	{
+		DamageSubsystem->QueueDamage(Target, Damage, Causer, Location, Impulse);
+	}
+	else
+	{
+		ApplyDamageImmediately(Target, Damage, Causer, Location, Impulse);
+	}
+}
+
+void UCombatDamageSubsystem::ApplyDamageImmediately(AActor* Target, float Damage, AActor* Causer, const FVector& Location, const FVector& Impulse)
+{
+	if (ICombatDamageable* Damageable = Cast<ICombatDamageable>(Target))
+	{
+		Damageable->ApplyDamage(Damage, Causer, Location, Impulse);
+	}
+	else if (Target)
+	{
+		// 使用标准伤害系统
+		FDamageEvent DamageEvent;
+		Target->TakeDamage(Damage, DamageEvent, nullptr, Causer);
+	}
+}
+
+bool UCombatDamageSubsystem::IsImmediateMode()
+{
+	return CVarCombatDamageImmediate.GetValueOnGameThread();
+}
+
+void UCombatDamageSubsystem::Deinitialize()
+{
+	QueuedEvents.Empty();
+	ResolvingEvents.Empty();
+	ResolvedTargets.Empty();
+	TargetIndices.Empty();
+	StrongestHitDamage.Empty();
+	OnDamageResolved.Clear();
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatDamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatDamageSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatDamageSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ResolveQueuedDamage();
+}
+
+void UCombatDamageSubsystem::QueueDamage(AActor* Target, float Damage, AActor* Causer, const FVector& Location, const FVector& Impulse)
+{
+	if (!Target)
+	{
+		return;
+	}
+
+	FCombatDamageEvent& Event = QueuedEvents.AddDefaulted_GetRef();
+	Event.Target = Target;
+	Event.Causer = Causer;
+	Event.Location = Location;
+	Event.Impulse = FVector3f(Impulse);
+	Event.Damage = Damage;
+	++NumEventsQueued;
+}
+
+void UCombatDamageSubsystem::ResolveQueuedDamage()
+{
+	// 伤害回调中再次结算时，新命中留到下一批
+	if (bResolving || QueuedEvents.Num() == 0)
+	{
+		return;
+	}
+
+	TGuardValue<bool> ResolvingGuard(bResolving, true);
+	Swap(QueuedEvents, ResolvingEvents);
+
+	// 按目标合并，目标顺序取第一次命中的顺序
+	ResolvedTargets.Reset();
+	TargetIndices.Reset();
+	StrongestHitDamage.Reset();
+	for (const FCombatDamageEvent& Event : ResolvingEvents)
+	{
+		AActor* Target = Event.Target.Get();
+		if (!IsValid(Target))
+		{
+			continue;
+		}
+
+		int32& ResolvedIndex = TargetIndices.FindOrAdd(FObjectKey(Target), INDEX_NONE);
+		if (ResolvedIndex == INDEX_NONE)
+		{
+			ResolvedIndex = ResolvedTargets.Emplace(Target, FCombatResolvedDamage());
+			StrongestHitDamage.Add(-TNumericLimits<float>::Max());
+		}
+
+		FCombatResolvedDamage& Resolved = ResolvedTargets[ResolvedIndex].Value;
+		Resolved.Damage += Event.Damage;
+		Resolved.Impulse += FVector(Event.Impulse);
+		++Resolved.NumHits;
+
+		if (Event.Damage > StrongestHitDamage[ResolvedIndex])
+		{
+			StrongestHitDamage[ResolvedIndex] = Event.Damage;
+			Resolved.Location = Event.Location;
+			Resolved.Causer = Event.Causer;
+		}
+	}
+	ResolvingEvents.Reset();
+
+	// 每个目标只调用一次伤害接口
+	for (const TPair<TWeakObjectPtr<AActor>, FCombatResolvedDamage>& Pair : ResolvedTargets)
+	{
+		AActor* Target = Pair.Key.Get();
+		if (!IsValid(Target))
+		{
+			continue;
+		}
+
+		// 投掷物命中后立即销毁，来源在本帧内仍可读取
+		const FCombatResolvedDamage& Resolved = Pair.Value;
+		ApplyDamageImmediately(Target, Resolved.Damage, Resolved.Causer.Get(/*bEvenIfPendingKill*/ true), Resolved.Location, Resolved.Impulse);
+		++NumTargetsResolved;
+
+		UE_LOG(LogTemp, Verbose, TEXT("CombatDamageSubsystem: %s 合并 %d 次命中，伤害 %.1f"),
+			*Target->GetName(), Resolved.NumHits, Resolved.Damage);
+
+		OnDamageResolved.Broadcast(Target, Resolved);
+	}
+}
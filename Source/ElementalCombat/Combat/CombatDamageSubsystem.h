@@ -0,0 +1,133 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "CombatDamageSubsystem.generated.h"
+
+class AActor;
+
+/**
+ * 排队中的一次命中（紧凑布局，顺序由队列下标决定）
+ */
+struct ELEMENTALCOMBAT_API FCombatDamageEvent
+{
+	/** 受击目标 */
+	TWeakObjectPtr<AActor> Target;
+
+	/** 伤害来源 */
+	TWeakObjectPtr<AActor> Causer;
+
+	/** 命中位置（世界坐标，大世界坐标下需要保持双精度） */
+	FVector Location = FVector::ZeroVector;
+
+	/** 击退冲量（只是方向和大小，单精度足够） */
+	FVector3f Impulse = FVector3f::ZeroVector;
+
+	/** 伤害值（已完成元素计算） */
+	float Damage = 0.0f;
+};
+
+/**
+ * 一个目标在一帧内合并后的伤害
+ */
+struct ELEMENTALCOMBAT_API FCombatResolvedDamage
+{
+	/** 伤害总和 */
+	float Damage = 0.0f;
+
+	/** 冲量总和 */
+	FVector Impulse = FVector::ZeroVector;
+
+	/** 伤害最大的一次命中的位置 */
+	FVector Location = FVector::ZeroVector;
+
+	/** 伤害最大的一次命中的来源（相同时取较早的一次） */
+	TWeakObjectPtr<AActor> Causer;
+
+	/** 合并的命中次数 */
+	int32 NumHits = 0;
+};
+
+/** 目标的伤害结算完成（每个目标每帧最多一次） */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnCombatDamageResolved, AActor* /*Target*/, const FCombatResolvedDamage& /*Resolved*/);
+
+/**
+ * 战斗伤害子系统
+ * 投掷物、近战攻击、岩浆地板和持续伤害的命中先写入队列，每帧统一结算一次：
+ * 同一目标在一帧内的多次命中合并为一次ApplyDamage（一次HP写入、一次生命条更新、一次冲量），
+ * 目标按第一次命中的先后顺序结算，同一目标的命中按入队顺序累加，结果与帧内事件顺序一一对应
+ * - 结算过程中产生的新命中进入下一批
+ * - 元素计算仍在命中时完成（倍率取决于攻击者），队列只保存最终伤害
+ * 控制台变量ElementalCombat.Combat.Damage.Immediate可改为命中时立即结算
+ */
+UCLASS()
+class ELEMENTALCOMBAT_API UCombatDamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** 获取当前世界的子系统 */
+	static UCombatDamageSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 * 对目标造成伤害
+	 * 子系统存在且没有要求立即结算时入队，否则立即调用目标的伤害接口
+	 */
+	static void ApplyDamage(AActor* Target, float Damage, AActor* Causer, const FVector& Location, const FVector& Impulse);
+
+	/** 立即调用目标的伤害接口（没有实现ICombatDamageable时使用标准TakeDamage） */
+	static void ApplyDamageImmediately(AActor* Target, float Damage, AActor* Causer, const FVector& Location, const FVector& Impulse);
+
+	/** 是否要求命中时立即结算（受ElementalCombat.Combat.Damage.Immediate控制） */
+	static bool IsImmediateMode();
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** 把一次命中加入队列 */
+	void QueueDamage(AActor* Target, float Damage, AActor* Causer, const FVector& Location, const FVector& Impulse);
+
+	/** 结算当前队列中的所有命中（Tick中调用，测试可直接调用） */
+	void ResolveQueuedDamage();
+
+	/** 队列中的命中数量 */
+	int32 GetNumQueuedEvents() const { return QueuedEvents.Num(); }
+
+	/** 累计入队的命中数量 */
+	uint64 GetNumEventsQueued() const { return NumEventsQueued; }
+
+	/** 累计调用伤害接口的次数 */
+	uint64 GetNumTargetsResolved() const { return NumTargetsResolved; }
+
+	/** 目标的伤害结算完成 */
+	FOnCombatDamageResolved OnDamageResolved;
+
+private:
+	/** 当前帧的命中 */
+	TArray<FCombatDamageEvent> QueuedEvents;
+
+	/** 正在结算的命中（与QueuedEvents交换，结算中产生的命中进入下一批） */
+	TArray<FCombatDamageEvent> ResolvingEvents;
+
+	/** 按目标合并的结果，按第一次命中的顺序排列（复用） */
+	TArray<TPair<TWeakObjectPtr<AActor>, FCombatResolvedDamage>> ResolvedTargets;
+
+	/** 目标到合并结果下标的映射（复用） */
+	TMap<FObjectKey, int32> TargetIndices;
+
+	/** 每个目标伤害最大的一次命中（用于取位置和来源，复用） */
+	TArray<float> StrongestHitDamage;
+
+	/** 是否正在结算 */
+	bool bResolving = false;
+
+	/** 累计入队的命中数量 */
+	uint64 NumEventsQueued = 0;
+
+	/** 累计调用伤害接口的次数 */
+	uint64 NumTargetsResolved = 0;
+};
@@ -5,59 +5,26 @@
 
 bool UElementalCalculator::IsElementAdvantage(EElementalType AttackerElement, EElementalType DefenderElement, const UObject* WorldContextObject)
 {
-	// 尝试从配置管理器获取
-	if (UElementalConfigManager* ConfigManager = UElementalConfigManager::GetInstance(WorldContextObject))
+	// 有世界上下文时使用该世界的配置管理器
+	if (const UElementalConfigManager* ConfigManager = UElementalConfigManager::GetInstance(WorldContextObject))
 	{
 		return ConfigManager->IsElementAdvantage(AttackerElement, DefenderElement);
 	}
 
-	// 如果无法获取配置管理器，使用默认硬编码逻辑
-	if (AttackerElement == EElementalType::None || DefenderElement == EElementalType::None)
-	{
-		return false;
-	}
-
-	// 五行相克：金克木、木克土、土克水、水克火、火克金
-	switch (AttackerElement)
-	{
-	case EElementalType::Metal:
-		return DefenderElement == EElementalType::Wood;
-	case EElementalType::Wood:
-		return DefenderElement == EElementalType::Earth;
-	case EElementalType::Water:
-		return DefenderElement == EElementalType::Fire;
-	case EElementalType::Fire:
-		return DefenderElement == EElementalType::Metal;
-	case EElementalType::Earth:
-		return DefenderElement == EElementalType::Water;
-	default:
-		return false;
-	}
+	// 否则使用最近发布的相克表（没有配置管理器时为默认五行相克）
+	return UElementalConfigManager::IsElementAdvantageFast(AttackerElement, DefenderElement);
 }
 
 float UElementalCalculator::CalculateCounterMultiplier(EElementalType AttackerElement, EElementalType DefenderElement, const UObject* WorldContextObject)
 {
-	// 尝试从配置管理器获取
-	if (UElementalConfigManager* ConfigManager = UElementalConfigManager::GetInstance(WorldContextObject))
+	// 有世界上下文时使用该世界的配置管理器
+	if (const UElementalConfigManager* ConfigManager = UElementalConfigManager::GetInstance(WorldContextObject))
 	{
 		return ConfigManager->GetCounterMultiplier(AttackerElement, DefenderElement);
 	}
 
-	// 如果无法获取配置管理器，使用默认逻辑
-	// 检查克制关系
-	if (IsElementAdvantage(AttackerElement, DefenderElement, WorldContextObject))
-	{
-		return ADVANTAGE_MULTIPLIER; // 1.5倍伤害
-	}
-	
-	// 检查被克制关系
-	if (IsElementAdvantage(DefenderElement, AttackerElement, WorldContextObject))
-	{
-		return DISADVANTAGE_MULTIPLIER; // 0.5倍伤害
-	}
-	
-	// 无关系或相同元素
-	return NEUTRAL_MULTIPLIER; // 1.0倍伤害
+	// 否则使用最近发布的相克表（没有配置管理器时为默认倍率）
+	return UElementalConfigManager::GetCounterMultiplierFast(AttackerElement, DefenderElement);
 }
 
 float UElementalCalculator::CalculateElementalDamageModifier(EElementalType AttackElement, EElementalType DefenseElement, const UObject* WorldContextObject)
@@ -9,7 +9,8 @@
 /**
  * 元素计算器
  * 提供五行相克关系判断和伤害修正计算的静态函数库
- * 现在使用数据驱动方式，从ElementalConfigManager获取配置数据
+ * 现在使用数据驱动方式，从ElementalConfigManager预先构建的相克表查询
+ * 不传世界上下文时使用最近发布的相克表
  */
 UCLASS()
 class ELEMENTALCOMBAT_API UElementalCalculator : public UObject
@@ -81,10 +82,4 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
 	static EElementalType GetElementCounteredBy(EElementalType Element);
-
-private:
-	// 克制关系倍率常量
-	static constexpr float ADVANTAGE_MULTIPLIER = 1.5f;
-	static constexpr float DISADVANTAGE_MULTIPLIER = 0.5f;
-	static constexpr float NEUTRAL_MULTIPLIER = 1.0f;
 };
\ No newline at end of file
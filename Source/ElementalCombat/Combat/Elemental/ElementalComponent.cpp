@@ -4,13 +4,10 @@
 #include "Combat/Elemental/ElementalDataAsset.h"
 #include "Combat/Elemental/ElementalConfigManager.h"
 #include "Combat/Elemental/DefaultElementalDataAsset.h"
-#include "Combat/Elemental/ElementalCalculator.h"
 #include "Combat/Elemental/ElementalEffectProcessor.h"
+#include "Combat/Elemental/ElementalStatusEffectSubsystem.h"
 #include "Variant_Combat/Interfaces/CombatDamageable.h"
-#include "GameFramework/Character.h"
-#include "GameFramework/CharacterMovementComponent.h"
 #include "Engine/World.h"
-#include "TimerManager.h"
 
 UElementalComponent::UElementalComponent()
 {
@@ -44,6 +41,18 @@ void UElementalComponent::BeginPlay()
 	RefreshFromDataAsset();
 }
 
+void UElementalComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// 注销时恢复移动速度并移除所有效果
+	if (UElementalStatusEffectSubsystem* StatusEffects = GetStatusEffectSubsystem(false))
+	{
+		StatusEffects->UnregisterTarget(StatusTargetHandle);
+	}
+	StatusTargetHandle.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void UElementalComponent::SwitchElement(EElementalType NewElement)
 {
 	if (CurrentElement != NewElement)
@@ -58,29 +67,61 @@ void UElementalComponent::SwitchElement(EElementalType NewElement)
 
 void UElementalComponent::SetElementEffectData(EElementalType Element, const FElementalEffectData& EffectData)
 {
-	ElementEffectDataMap.Add(Element, EffectData);
+	ElementEffectOverrides.Add(Element, FElementalEffectOverride(EffectData));
 }
 
 bool UElementalComponent::GetElementEffectData(EElementalType Element, FElementalEffectData& OutEffectData) const
 {
-	const FElementalEffectData* FoundData = GetElementEffectDataPtr(Element);
-	if (FoundData)
+	if (const FElementalEffectOverride* Override = ElementEffectOverrides.Find(Element))
 	{
-		OutEffectData = *FoundData;
+		OutEffectData = Override->ToEffectData();
 		return true;
 	}
-	
+
+	return EffectTable.IsValid() && EffectTable->GetEffectData(Element, OutEffectData);
+}
+
+bool UElementalComponent::GetElementEffectParams(EElementalType Element, FElementalEffectParams& OutParams) const
+{
+	if (const FElementalEffectParams* FoundParams = GetElementEffectParamsPtr(Element))
+	{
+		OutParams = *FoundParams;
+		return true;
+	}
+
 	return false;
 }
 
-const FElementalEffectData* UElementalComponent::GetElementEffectDataPtr(EElementalType Element) const
+const FElementalEffectParams* UElementalComponent::GetElementEffectParamsPtr(EElementalType Element) const
 {
-	return ElementEffectDataMap.Find(Element);
+	// 大多数组件没有覆盖数据，直接查共享效果表
+	if (ElementEffectOverrides.Num() > 0)
+	{
+		if (const FElementalEffectOverride* Override = ElementEffectOverrides.Find(Element))
+		{
+			return &Override->Params;
+		}
+	}
+
+	return EffectTable.IsValid() ? EffectTable->FindParams(Element) : nullptr;
+}
+
+const FElementalPresentationData* UElementalComponent::GetElementPresentationPtr(EElementalType Element) const
+{
+	if (ElementEffectOverrides.Num() > 0)
+	{
+		if (const FElementalEffectOverride* Override = ElementEffectOverrides.Find(Element))
+		{
+			return &Override->Presentation;
+		}
+	}
+
+	return EffectTable.IsValid() ? EffectTable->FindPresentation(Element) : nullptr;
 }
 
 UClass* UElementalComponent::GetCurrentProjectileClass() const
 {
-	const FElementalEffectData* CurrentData = GetElementEffectDataPtr(CurrentElement);
+	const FElementalPresentationData* CurrentData = GetElementPresentationPtr(CurrentElement);
 	if (CurrentData && CurrentData->ProjectileClass)
 	{
 		return CurrentData->ProjectileClass;
@@ -91,20 +132,20 @@ UClass* UElementalComponent::GetCurrentProjectileClass() const
 
 bool UElementalComponent::HasElementData(EElementalType Element) const
 {
-	return ElementEffectDataMap.Contains(Element);
+	return GetElementEffectParamsPtr(Element) != nullptr;
 }
 
 void UElementalComponent::RefreshFromDataAsset()
 {
 	if (ElementalDataAsset)
 	{
-		// 清空现有数据
-		ElementEffectDataMap.Empty();
+		// 清空覆盖数据
+		ElementEffectOverrides.Empty();
 		
-		// 从DataAsset复制数据到组件
+		// 引用DataAsset的共享效果表
 		ElementalDataAsset->CopyDataToComponent(this);
 		
-		UE_LOG(LogTemp, Log, TEXT("ElementalComponent: Loaded data from ElementalDataAsset"));
+		UE_LOG(LogTemp, Log, TEXT("ElementalComponent: Loaded data from ElementalDataAsset (version %u)"), EffectTable.IsValid() ? EffectTable->GetVersion() : 0u);
 	}
 	else
 	{
@@ -112,6 +153,11 @@ void UElementalComponent::RefreshFromDataAsset()
 	}
 }
 
+void UElementalComponent::SetEffectTable(TSharedPtr<const FElementalEffectTable> InEffectTable)
+{
+	EffectTable = MoveTemp(InEffectTable);
+}
+
 void UElementalComponent::BroadcastElementChanged(EElementalType NewElement)
 {
 	if (OnElementChanged.IsBound())
@@ -124,7 +170,7 @@ void UElementalComponent::BroadcastElementChanged(EElementalType NewElement)
 
 float UElementalComponent::ProcessElementalDamage(
 	float BaseDamage,
-	const FElementalEffectData& AttackerEffectData,
+	const FElementalEffectParams& AttackerEffectData,
 	AActor* DamageCauser)
 {
 	float FinalDamage = BaseDamage;
@@ -137,12 +183,11 @@ float UElementalComponent::ProcessElementalDamage(
 			AttackerEffectData.DamageMultiplier, *GetOwner()->GetName());
 	}
 
-	// 2. 计算元素相克（使用现有的Calculator）
+	// 2. 计算元素相克（查询配置管理器预先构建的相克表）
 	EElementalType AttackerElement = AttackerEffectData.Element;
 	if (AttackerElement != EElementalType::None && CurrentElement != EElementalType::None)
 	{
-		float CounterMultiplier = UElementalCalculator::CalculateCounterMultiplier(
-			AttackerElement, CurrentElement, GetOwner());
+		float CounterMultiplier = UElementalConfigManager::GetCounterMultiplierFast(AttackerElement, CurrentElement);
 		if (CounterMultiplier != 1.0f)
 		{
 			FinalDamage *= CounterMultiplier;
@@ -152,7 +197,7 @@ float UElementalComponent::ProcessElementalDamage(
 	}
 
 	// 3. 应用防御方的减伤（如果自己有减伤配置）
-	const FElementalEffectData* DefenderData = GetElementEffectDataPtr(CurrentElement);
+	const FElementalEffectParams* DefenderData = GetElementEffectParamsPtr(CurrentElement);
 	if (DefenderData && DefenderData->DamageReduction > 0.0f)
 	{
 		float ReductionRatio = FMath::Clamp(DefenderData->DamageReduction, 0.0f, 1.0f);
@@ -165,7 +210,7 @@ float UElementalComponent::ProcessElementalDamage(
 }
 
 void UElementalComponent::ApplyElementalEffects(
-	const FElementalEffectData& EffectData,
+	const FElementalEffectParams& EffectData,
 	AActor* EffectCauser,
 	float DamageDealt)
 {
@@ -192,90 +237,41 @@ void UElementalComponent::ApplyElementalEffects(
 	// 注意：DamageMultiplier和DamageReduction在ProcessElementalDamage中处理
 }
 
-void UElementalComponent::ApplySlowIfConfigured(const FElementalEffectData& EffectData)
+void UElementalComponent::ApplySlowIfConfigured(const FElementalEffectParams& EffectData)
 {
 	// 不检查元素类型，只看配置值
 	if (EffectData.SlowPercentage <= 0.0f || EffectData.SlowDuration <= 0.0f)
 		return;
 
-	if (bIsSlowed)
+	if (UElementalStatusEffectSubsystem* StatusEffects = GetStatusEffectSubsystem(true))
 	{
-		// 刷新减速效果 - 清除旧的定时器
-		GetWorld()->GetTimerManager().ClearTimer(SlowEffectTimerHandle);
-		UE_LOG(LogTemp, Log, TEXT("ElementalComponent: Refreshing slow effect on %s"), *GetOwner()->GetName());
-	}
-
-	if (ACharacter* Character = Cast<ACharacter>(GetOwner()))
-	{
-		if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
-		{
-			if (!bIsSlowed)
-			{
-				OriginalWalkSpeed = Movement->MaxWalkSpeed;
-			}
-
-			// 使用ElementalEffectProcessor计算减速后的速度
-			float SlowedSpeed = UElementalEffectProcessor::CalculateSlowedSpeed(
-				OriginalWalkSpeed, EffectData);
-			Movement->MaxWalkSpeed = SlowedSpeed;
-
-			bIsSlowed = true;
-
-			UE_LOG(LogTemp, Log, TEXT("ElementalComponent: Applied slow effect to %s (%.0f -> %.0f for %.1fs)"),
-				*GetOwner()->GetName(), OriginalWalkSpeed, SlowedSpeed, EffectData.SlowDuration);
-
-			// 设置恢复定时器
-			GetWorld()->GetTimerManager().SetTimer(
-				SlowEffectTimerHandle,
-				this,
-				&UElementalComponent::OnSlowEffectEnd,
-				EffectData.SlowDuration,
-				false
-			);
-		}
+		StatusEffects->ApplySlow(StatusTargetHandle, EffectData.SlowPercentage, EffectData.SlowDuration, nullptr);
+		UE_LOG(LogTemp, Log, TEXT("ElementalComponent: Applied slow effect to %s (%.0f%% for %.1fs)"),
+			*GetOwner()->GetName(), EffectData.SlowPercentage * 100.0f, EffectData.SlowDuration);
 	}
 }
 
-void UElementalComponent::ApplyDotIfConfigured(const FElementalEffectData& EffectData, AActor* Causer)
+void UElementalComponent::ApplyDotIfConfigured(const FElementalEffectParams& EffectData, AActor* Causer)
 {
 	// 不检查元素类型，只看配置值
 	if (EffectData.DotDamage <= 0.0f || EffectData.DotDuration <= 0.0f)
 		return;
 
-	// 如果已经在DOT，刷新效果
-	if (bIsBurning)
-	{
-		GetWorld()->GetTimerManager().ClearTimer(DotEffectTimerHandle);
-		UE_LOG(LogTemp, Log, TEXT("ElementalComponent: Refreshing DOT effect on %s"), *GetOwner()->GetName());
-	}
-
 	// 计算tick次数
 	int32 TotalTicks = UElementalEffectProcessor::CalculateDotTicks(EffectData);
 	if (TotalTicks <= 0) return;
 
-	// 设置DOT参数
-	DotDamagePerTick = EffectData.DotDamage;
-	RemainingDotTicks = TotalTicks;
-	DotCauser = Causer;
-	bIsBurning = true;
-
-	UE_LOG(LogTemp, Log, TEXT("ElementalComponent: Applied DOT effect to %s (%.1f damage x %d ticks, interval %.1fs)"),
-		*GetOwner()->GetName(), EffectData.DotDamage, TotalTicks, EffectData.DotTickInterval);
-
-	// 启动DOT定时器
-	float TickInterval = FMath::Max(EffectData.DotTickInterval, 0.1f);
-	GetWorld()->GetTimerManager().SetTimer(
-		DotEffectTimerHandle,
-		this,
-		&UElementalComponent::OnDotEffectTick,
-		TickInterval,
-		true
-	);
+	if (UElementalStatusEffectSubsystem* StatusEffects = GetStatusEffectSubsystem(true))
+	{
+		StatusEffects->ApplyBurn(StatusTargetHandle, EffectData.DotDamage, EffectData.DotTickInterval, TotalTicks, Causer);
+		UE_LOG(LogTemp, Log, TEXT("ElementalComponent: Applied DOT effect to %s (%.1f damage x %d ticks, interval %.1fs)"),
+			*GetOwner()->GetName(), EffectData.DotDamage, TotalTicks, EffectData.DotTickInterval);
+	}
 }
 
 void UElementalComponent::ApplyLifeStealIfConfigured(
 	float DamageDealt,
-	const FElementalEffectData& EffectData,
+	const FElementalEffectParams& EffectData,
 	AActor* Attacker)
 {
 	// 不检查元素类型，只看配置值
@@ -295,61 +291,41 @@ void UElementalComponent::ApplyLifeStealIfConfigured(
 	}
 }
 
-// ========== 效果结束回调 ==========
+// ========== 状态效果 ==========
 
-void UElementalComponent::OnSlowEffectEnd()
+UElementalStatusEffectSubsystem* UElementalComponent::GetStatusEffectSubsystem(bool bRegisterIfNeeded)
 {
-	if (ACharacter* Character = Cast<ACharacter>(GetOwner()))
+	UElementalStatusEffectSubsystem* StatusEffects = UElementalStatusEffectSubsystem::Get(this);
+	if (StatusEffects && bRegisterIfNeeded && !StatusEffects->IsTargetValid(StatusTargetHandle))
 	{
-		if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
-		{
-			Movement->MaxWalkSpeed = OriginalWalkSpeed;
-			UE_LOG(LogTemp, Log, TEXT("ElementalComponent: Slow effect ended on %s (restored to %.0f)"),
-				*GetOwner()->GetName(), OriginalWalkSpeed);
-		}
+		StatusTargetHandle = StatusEffects->RegisterTarget(this);
 	}
-	bIsSlowed = false;
+	return StatusEffects;
 }
 
-void UElementalComponent::OnDotEffectTick()
+void UElementalComponent::SetStatusEffectFlags(bool bSlowed, bool bBurning)
 {
-	if (RemainingDotTicks <= 0)
+	if (bIsSlowed && !bSlowed)
 	{
-		bIsBurning = false;
-		GetWorld()->GetTimerManager().ClearTimer(DotEffectTimerHandle);
-		UE_LOG(LogTemp, Log, TEXT("ElementalComponent: DOT effect ended on %s"), *GetOwner()->GetName());
-		return;
+		UE_LOG(LogTemp, Log, TEXT("ElementalComponent: Slow effect ended on %s"), *GetOwner()->GetName());
 	}
-
-	// 应用DOT伤害
-	if (ICombatDamageable* Damageable = Cast<ICombatDamageable>(GetOwner()))
+	if (bIsBurning && !bBurning)
 	{
-		Damageable->ApplyDamage(DotDamagePerTick, DotCauser.Get(),
-			GetOwner()->GetActorLocation(), FVector::ZeroVector);
-		UE_LOG(LogTemp, Verbose, TEXT("ElementalComponent: DOT tick on %s (%.1f damage, %d ticks remaining)"),
-			*GetOwner()->GetName(), DotDamagePerTick, RemainingDotTicks - 1);
+		UE_LOG(LogTemp, Log, TEXT("ElementalComponent: DOT effect ended on %s"), *GetOwner()->GetName());
 	}
 
-	RemainingDotTicks--;
+	bIsSlowed = bSlowed;
+	bIsBurning = bBurning;
 }
 
 void UElementalComponent::ClearAllEffects()
 {
-	// 清除减速效果
-	if (bIsSlowed)
-	{
-		OnSlowEffectEnd();
-		GetWorld()->GetTimerManager().ClearTimer(SlowEffectTimerHandle);
-	}
-
-	// 清除DOT效果
-	if (bIsBurning)
+	if (UElementalStatusEffectSubsystem* StatusEffects = GetStatusEffectSubsystem(false))
 	{
-		bIsBurning = false;
-		GetWorld()->GetTimerManager().ClearTimer(DotEffectTimerHandle);
-		RemainingDotTicks = 0;
-		DotCauser = nullptr;
+		StatusEffects->RemoveAllEffects(StatusTargetHandle);
 	}
+	bIsSlowed = false;
+	bIsBurning = false;
 
 	UE_LOG(LogTemp, Log, TEXT("ElementalComponent: Cleared all effects on %s"), *GetOwner()->GetName());
 }
\ No newline at end of file
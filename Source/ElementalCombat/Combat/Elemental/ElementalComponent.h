@@ -5,7 +5,8 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "ElementalTypes.h"
-#include "Engine/TimerHandle.h"
+#include "ElementalEffectTable.h"
+#include "ElementalStatusEffectSubsystem.h"
 #include "ElementalComponent.generated.h"
 
 class ACombatProjectile;
@@ -17,6 +18,8 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnElementChanged, EElementalType, N
 /**
  * 元素组件
  * 负责管理Actor的当前元素状态、元素切换、效果数据存储等功能
+ * 效果数据引用数据资产提供的共享效果表，只有通过SetElementEffectData覆盖的元素才在组件内保存副本
+ * 减速和燃烧由UElementalStatusEffectSubsystem统一推进，组件只保存状态标记
  */
 UCLASS(ClassGroup=(ElementalCombat), meta=(BlueprintSpawnableComponent))
 class ELEMENTALCOMBAT_API UElementalComponent : public UActorComponent
@@ -28,6 +31,7 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 	/**
@@ -45,7 +49,7 @@ public:
 	EElementalType GetCurrentElement() const { return CurrentElement; }
 
 	/**
-	 * 设置元素效果数据
+	 * 覆盖本组件的元素效果数据（只影响本组件，共享效果表不变）
 	 * @param Element 元素类型
 	 * @param EffectData 效果数据
 	 */
@@ -53,7 +57,7 @@ public:
 	void SetElementEffectData(EElementalType Element, const FElementalEffectData& EffectData);
 
 	/**
-	 * 获取元素效果数据
+	 * 获取元素效果数据（由数值参数和表现数据组合，C++结算路径请使用GetElementEffectParamsPtr）
 	 * @param Element 元素类型
 	 * @param OutEffectData 输出的效果数据
 	 * @return true如果找到数据
@@ -62,11 +66,27 @@ public:
 	bool GetElementEffectData(EElementalType Element, FElementalEffectData& OutEffectData) const;
 
 	/**
-	 * 获取元素效果数据（C++用）
+	 * 获取元素的数值参数（伤害结算用）
 	 * @param Element 元素类型
-	 * @return 效果数据指针，如果不存在返回nullptr
+	 * @param OutParams 输出的数值参数
+	 * @return true如果找到数据
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
+	bool GetElementEffectParams(EElementalType Element, FElementalEffectParams& OutParams) const;
+
+	/**
+	 * 获取元素的数值参数（C++用）
+	 * @param Element 元素类型
+	 * @return 数值参数指针，如果不存在返回nullptr
 	 */
-	const FElementalEffectData* GetElementEffectDataPtr(EElementalType Element) const;
+	const FElementalEffectParams* GetElementEffectParamsPtr(EElementalType Element) const;
+
+	/**
+	 * 获取元素的表现数据（界面和生成投掷物用）
+	 * @param Element 元素类型
+	 * @return 表现数据指针，如果不存在返回nullptr
+	 */
+	const FElementalPresentationData* GetElementPresentationPtr(EElementalType Element) const;
 
 	/**
 	 * 获取当前元素的投掷物类
@@ -85,10 +105,29 @@ public:
 
 	/**
 	 * 从ElementalDataAsset刷新元素数据
+	 * 重新引用数据资产的共享效果表，并清除本组件的覆盖数据
 	 */
 	UFUNCTION(BlueprintCallable, Category = "ElementalCombat|Combat|Elemental")
 	void RefreshFromDataAsset();
 
+	/**
+	 * 设置共享的元素效果表
+	 * @param InEffectTable 效果表，为空表示没有共享数据
+	 */
+	void SetEffectTable(TSharedPtr<const FElementalEffectTable> InEffectTable);
+
+	/** 获取引用的共享效果表 */
+	const TSharedPtr<const FElementalEffectTable>& GetEffectTable() const { return EffectTable; }
+
+	/** 本组件覆盖的元素数量 */
+	int32 GetNumEffectOverrides() const { return ElementEffectOverrides.Num(); }
+
+	/** 本组件私有的效果数据占用的内存（字节，不含共享效果表） */
+	SIZE_T GetEffectOverridesAllocatedSize() const
+	{
+		return ElementEffectOverrides.GetAllocatedSize();
+	}
+
 	/**
 	 * 获取当前使用的ElementalDataAsset
 	 * @return ElementalDataAsset引用
@@ -108,7 +147,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "ElementalCombat|Combat|Elemental")
 	float ProcessElementalDamage(
 		float BaseDamage,
-		const FElementalEffectData& AttackerEffectData,
+		const FElementalEffectParams& AttackerEffectData,
 		AActor* DamageCauser
 	);
 
@@ -120,7 +159,7 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "ElementalCombat|Combat|Elemental")
 	void ApplyElementalEffects(
-		const FElementalEffectData& EffectData,
+		const FElementalEffectParams& EffectData,
 		AActor* EffectCauser,
 		float DamageDealt = 0.0f
 	);
@@ -153,37 +192,39 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "ElementalCombat|Combat|Elemental")
 	EElementalType CurrentElement;
 
-	// 元素效果数据映射（运行时缓存，从DataAsset加载）
+	// 本组件覆盖的元素效果数据（优先于共享效果表）
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "ElementalCombat|Combat|Elemental")
-	TMap<EElementalType, FElementalEffectData> ElementEffectDataMap;
+	TMap<EElementalType, FElementalEffectOverride> ElementEffectOverrides;
+
+	// 共享的元素效果表（从DataAsset获取）
+	TSharedPtr<const FElementalEffectTable> EffectTable;
 
 	// ========== 效果状态管理 ==========
 	// 减速效果
 	UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|Combat|Elemental")
 	bool bIsSlowed = false;
 
-	FTimerHandle SlowEffectTimerHandle;
-	float OriginalWalkSpeed = 0.0f;
-
 	// DOT效果
 	UPROPERTY(BlueprintReadOnly, Category = "ElementalCombat|Combat|Elemental")
 	bool bIsBurning = false;
 
-	FTimerHandle DotEffectTimerHandle;
-	float DotDamagePerTick = 0.0f;
-	int32 RemainingDotTicks = 0;
-	TWeakObjectPtr<AActor> DotCauser;
+	// 状态效果子系统中的目标句柄（第一次受到效果时注册）
+	FElementalStatusTargetHandle StatusTargetHandle;
 
 private:
+	friend class UElementalStatusEffectSubsystem;
+
+	// 获取状态效果子系统，需要时注册本组件
+	UElementalStatusEffectSubsystem* GetStatusEffectSubsystem(bool bRegisterIfNeeded);
+
+	// 由状态效果子系统在效果变化时调用
+	void SetStatusEffectFlags(bool bSlowed, bool bBurning);
+
 	// 触发元素变更委托
 	void BroadcastElementChanged(EElementalType NewElement);
 
 	// 基于字段值的效果应用
-	void ApplySlowIfConfigured(const FElementalEffectData& EffectData);
-	void ApplyDotIfConfigured(const FElementalEffectData& EffectData, AActor* Causer);
-	void ApplyLifeStealIfConfigured(float DamageDealt, const FElementalEffectData& EffectData, AActor* Attacker);
-
-	// 效果结束回调
-	void OnSlowEffectEnd();
-	void OnDotEffectTick();
+	void ApplySlowIfConfigured(const FElementalEffectParams& EffectData);
+	void ApplyDotIfConfigured(const FElementalEffectParams& EffectData, AActor* Causer);
+	void ApplyLifeStealIfConfigured(float DamageDealt, const FElementalEffectParams& EffectData, AActor* Attacker);
 };
\ No newline at end of file
@@ -4,6 +4,114 @@
 #include "Engine/World.h"
 #include "Engine/GameInstance.h"
 
+namespace
+{
+	/** 没有配置管理器时使用的默认相克表 */
+	const FElementalCounterMatrix& GetDefaultCounterMatrix()
+	{
+		static const FElementalCounterMatrix DefaultMatrix = FElementalCounterMatrix::Build(nullptr);
+		return DefaultMatrix;
+	}
+
+	/** 最近发布的相克表（为空时使用默认相克表） */
+	std::atomic<const FElementalCounterMatrix*> PublishedCounterMatrix{nullptr};
+}
+
+// === FElementalCounterMatrix 实现 ===
+
+FElementalCounterMatrix::FElementalCounterMatrix()
+{
+	for (float& Multiplier : Multipliers)
+	{
+		Multiplier = NeutralMultiplier;
+	}
+	FMemory::Memzero(AdvantageMasks);
+}
+
+FElementalCounterMatrix FElementalCounterMatrix::Build(const UElementalDataAsset* DataAsset)
+{
+	FElementalCounterMatrix Matrix;
+
+	// None行和None列保持中性
+	for (int32 AttackerIndex = 1; AttackerIndex < NumElements; ++AttackerIndex)
+	{
+		const EElementalType Attacker = static_cast<EElementalType>(AttackerIndex);
+		const FElementalRelationship* AttackerRelationship = DataAsset ? DataAsset->GetElementRelationshipPtr(Attacker) : nullptr;
+
+		for (int32 DefenderIndex = 1; DefenderIndex < NumElements; ++DefenderIndex)
+		{
+			const EElementalType Defender = static_cast<EElementalType>(DefenderIndex);
+			float& Multiplier = Matrix.Multipliers[AttackerIndex * NumElements + DefenderIndex];
+			bool bAdvantage = IsDefaultAdvantage(Attacker, Defender);
+
+			if (!DataAsset)
+			{
+				if (bAdvantage)
+				{
+					Multiplier = DefaultAdvantageMultiplier;
+				}
+				else if (IsDefaultAdvantage(Defender, Attacker))
+				{
+					Multiplier = DefaultDisadvantageMultiplier;
+				}
+			}
+			else
+			{
+				// 攻击者克制防御者时使用配置的倍率（同一元素重复配置时取第一条）
+				const FElementalCounterData* Counter = AttackerRelationship
+					? AttackerRelationship->Counters.FindByPredicate([Defender](const FElementalCounterData& Data) { return Data.CounteredElement == Defender; })
+					: nullptr;
+
+				if (Counter)
+				{
+					Multiplier = Counter->EffectMultiplier;
+					bAdvantage = true;
+				}
+				else if (const FElementalRelationship* DefenderRelationship = DataAsset->GetElementRelationshipPtr(Defender))
+				{
+					// 被克制时使用对称减法：1 - (克制倍率 - 1)
+					// 例如：克制1.5倍时，被克制为0.5倍
+					const FElementalCounterData* ReverseCounter = DefenderRelationship->Counters.FindByPredicate(
+						[Attacker](const FElementalCounterData& Data) { return Data.CounteredElement == Attacker; });
+					if (ReverseCounter)
+					{
+						Multiplier = FMath::Max(1.0f - (ReverseCounter->EffectMultiplier - 1.0f), MinDisadvantageMultiplier);
+					}
+				}
+			}
+
+			if (bAdvantage)
+			{
+				Matrix.AdvantageMasks[AttackerIndex] |= static_cast<uint8>(1u << DefenderIndex);
+			}
+		}
+	}
+
+	return Matrix;
+}
+
+bool FElementalCounterMatrix::IsDefaultAdvantage(EElementalType AttackerElement, EElementalType DefenderElement)
+{
+	// 硬编码的五行相克：金克木、木克土、土克水、水克火、火克金
+	switch (AttackerElement)
+	{
+	case EElementalType::Metal:
+		return DefenderElement == EElementalType::Wood;
+	case EElementalType::Wood:
+		return DefenderElement == EElementalType::Earth;
+	case EElementalType::Water:
+		return DefenderElement == EElementalType::Fire;
+	case EElementalType::Fire:
+		return DefenderElement == EElementalType::Metal;
+	case EElementalType::Earth:
+		return DefenderElement == EElementalType::Water;
+	default:
+		return false;
+	}
+}
+
+// === UElementalConfigManager 实现 ===
+
 UElementalConfigManager* UElementalConfigManager::GetInstance(const UObject* WorldContextObject)
 {
 	if (!WorldContextObject)
@@ -22,14 +130,32 @@ UElementalConfigManager* UElementalConfigManager::GetInstance(const UObject* Wor
 	return nullptr;
 }
 
+const FElementalCounterMatrix& UElementalConfigManager::GetPublishedCounterMatrix()
+{
+	const FElementalCounterMatrix* Matrix = PublishedCounterMatrix.load(std::memory_order_acquire);
+	return Matrix ? *Matrix : GetDefaultCounterMatrix();
+}
+
 void UElementalConfigManager::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
 	CurrentDataAsset = nullptr;
+	DataAssetChangedHandle = UElementalDataAsset::OnDataChanged.AddUObject(this, &UElementalConfigManager::HandleDataAssetChanged);
+	RebuildCounterMatrix();
 }
 
 void UElementalConfigManager::Deinitialize()
 {
+	UElementalDataAsset::OnDataChanged.Remove(DataAssetChangedHandle);
+	DataAssetChangedHandle.Reset();
+
+	// 撤回本实例发布的相克表，静态查询回到默认规则
+	for (const FElementalCounterMatrix& Matrix : CounterMatrices)
+	{
+		const FElementalCounterMatrix* Expected = &Matrix;
+		PublishedCounterMatrix.compare_exchange_strong(Expected, nullptr, std::memory_order_acq_rel);
+	}
+
 	CurrentDataAsset = nullptr;
 	Super::Deinitialize();
 }
@@ -37,89 +163,28 @@ void UElementalConfigManager::Deinitialize()
 void UElementalConfigManager::SetElementalDataAsset(UElementalDataAsset* DataAsset)
 {
 	CurrentDataAsset = DataAsset;
+	RebuildCounterMatrix();
 }
 
-bool UElementalConfigManager::IsElementAdvantage(EElementalType AttackerElement, EElementalType DefenderElement) const
+void UElementalConfigManager::RebuildCounterMatrix()
 {
-	// 如果任一元素为None，则无克制关系
-	if (AttackerElement == EElementalType::None || DefenderElement == EElementalType::None)
-	{
-		return false;
-	}
+	TGuardValue<bool> RebuildGuard(bRebuildingCounterMatrix, true);
 
-	// 尝试从配置数据获取
-	if (CurrentDataAsset)
-	{
-		FElementalRelationship Relationship;
-		if (CurrentDataAsset->GetElementRelationship(AttackerElement, Relationship))
-		{
-			for (const FElementalCounterData& Counter : Relationship.Counters)
-			{
-				if (Counter.CounteredElement == DefenderElement)
-				{
-					return true;
-				}
-			}
-		}
-	}
+	const int32 NextIndex = 1 - ActiveMatrixIndex.load(std::memory_order_relaxed);
+	CounterMatrices[NextIndex] = FElementalCounterMatrix::Build(CurrentDataAsset);
 
-	// 如果没有配置数据，使用默认硬编码逻辑作为后备
-	return IsElementAdvantageDefault(AttackerElement, DefenderElement);
+	ActiveMatrixIndex.store(NextIndex, std::memory_order_release);
+	PublishedCounterMatrix.store(&CounterMatrices[NextIndex], std::memory_order_release);
 }
 
-float UElementalConfigManager::GetCounterMultiplier(EElementalType AttackerElement, EElementalType DefenderElement) const
+bool UElementalConfigManager::IsElementAdvantage(EElementalType AttackerElement, EElementalType DefenderElement) const
 {
-	// 如果任一元素为None，返回中性倍率
-	if (AttackerElement == EElementalType::None || DefenderElement == EElementalType::None)
-	{
-		return DEFAULT_NEUTRAL_MULTIPLIER;
-	}
-
-	// 检查攻击者是否克制防御者
-	if (CurrentDataAsset)
-	{
-		FElementalRelationship Relationship;
-		if (CurrentDataAsset->GetElementRelationship(AttackerElement, Relationship))
-		{
-			for (const FElementalCounterData& Counter : Relationship.Counters)
-			{
-				if (Counter.CounteredElement == DefenderElement)
-				{
-					return Counter.EffectMultiplier; // 返回配置的倍率
-				}
-			}
-		}
-
-		// 检查防御者是否克制攻击者（被克制情况）
-		if (CurrentDataAsset->GetElementRelationship(DefenderElement, Relationship))
-		{
-			for (const FElementalCounterData& Counter : Relationship.Counters)
-			{
-				if (Counter.CounteredElement == AttackerElement)
-				{
-					// 被克制时使用对称减法：1 - (克制倍率 - 1)
-					// 例如：克制1.5倍时，被克制为0.5倍
-					float DisadvantageMultiplier = 1.0f - (Counter.EffectMultiplier - 1.0f);
-					return FMath::Max(DisadvantageMultiplier, 0.1f);
-				}
-			}
-		}
-	}
-	else
-	{
-		// 没有配置数据时使用默认逻辑
-		if (IsElementAdvantageDefault(AttackerElement, DefenderElement))
-		{
-			return DEFAULT_ADVANTAGE_MULTIPLIER;
-		}
-		if (IsElementAdvantageDefault(DefenderElement, AttackerElement))
-		{
-			return DEFAULT_DISADVANTAGE_MULTIPLIER;
-		}
-	}
+	return GetCounterMatrix().IsAdvantage(AttackerElement, DefenderElement);
+}
 
-	// 无关系或相同元素
-	return DEFAULT_NEUTRAL_MULTIPLIER;
+float UElementalConfigManager::GetCounterMultiplier(EElementalType AttackerElement, EElementalType DefenderElement) const
+{
+	return GetCounterMatrix().GetMultiplier(AttackerElement, DefenderElement);
 }
 
 bool UElementalConfigManager::GetElementRelationship(EElementalType Element, FElementalRelationship& OutRelationship) const
@@ -136,22 +201,10 @@ bool UElementalConfigManager::HasValidConfiguration() const
 	return CurrentDataAsset != nullptr;
 }
 
-bool UElementalConfigManager::IsElementAdvantageDefault(EElementalType AttackerElement, EElementalType DefenderElement) const
+void UElementalConfigManager::HandleDataAssetChanged(const UElementalDataAsset* DataAsset)
 {
-	// 硬编码的五行相克：金克木、木克土、土克水、水克火、火克金
-	switch (AttackerElement)
+	if (!bRebuildingCounterMatrix && DataAsset && DataAsset == CurrentDataAsset)
 	{
-	case EElementalType::Metal:
-		return DefenderElement == EElementalType::Wood;
-	case EElementalType::Wood:
-		return DefenderElement == EElementalType::Earth;
-	case EElementalType::Water:
-		return DefenderElement == EElementalType::Fire;
-	case EElementalType::Fire:
-		return DefenderElement == EElementalType::Metal;
-	case EElementalType::Earth:
-		return DefenderElement == EElementalType::Water;
-	default:
-		return false;
+		RebuildCounterMatrix();
 	}
-}
\ No newline at end of file
+}
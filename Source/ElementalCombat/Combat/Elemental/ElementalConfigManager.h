@@ -6,12 +6,72 @@
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "ElementalTypes.h"
 #include "ElementalDataAsset.h"
+#include <atomic>
 #include "ElementalConfigManager.generated.h"
 
+/**
+ * 预计算的元素相克表
+ * 倍率按[攻击者][防御者]展开成一维数组，克制关系按攻击者存成位掩码，查询只需一次下标访问
+ */
+struct ELEMENTALCOMBAT_API FElementalCounterMatrix
+{
+	/** 元素类型数量（包括None） */
+	static constexpr int32 NumElements = static_cast<int32>(EElementalType::Earth) + 1;
+
+	static_assert(NumElements <= 8, "AdvantageMasks按uint8存储，元素数量不能超过8");
+
+	/** 没有数据资产时使用的默认倍率 */
+	static constexpr float DefaultAdvantageMultiplier = 1.5f;
+	static constexpr float DefaultDisadvantageMultiplier = 0.5f;
+	static constexpr float NeutralMultiplier = 1.0f;
+
+	/** 被克制时的最低倍率 */
+	static constexpr float MinDisadvantageMultiplier = 0.1f;
+
+	/** 相克倍率 */
+	float Multipliers[NumElements * NumElements];
+
+	/** 每个攻击者克制的防御者（第N位对应数值为N的元素） */
+	uint8 AdvantageMasks[NumElements];
+
+	/** 所有组合均为中性倍率 */
+	FElementalCounterMatrix();
+
+	float GetMultiplier(EElementalType AttackerElement, EElementalType DefenderElement) const
+	{
+		return Multipliers[ToIndex(AttackerElement) * NumElements + ToIndex(DefenderElement)];
+	}
+
+	bool IsAdvantage(EElementalType AttackerElement, EElementalType DefenderElement) const
+	{
+		return ((AdvantageMasks[ToIndex(AttackerElement)] >> ToIndex(DefenderElement)) & 1) != 0;
+	}
+
+	/**
+	 * 从数据资产构建相克表
+	 * 结果与逐项查询数据资产完全一致：配置的克制倍率、对称计算的被克制倍率，
+	 * 克制关系在配置之外仍保留默认五行相克；数据资产为空时使用默认规则
+	 */
+	static FElementalCounterMatrix Build(const UElementalDataAsset* DataAsset);
+
+	/** 硬编码的五行相克：金克木、木克土、土克水、水克火、火克金 */
+	static bool IsDefaultAdvantage(EElementalType AttackerElement, EElementalType DefenderElement);
+
+private:
+	/** 超出范围的值按None处理 */
+	static int32 ToIndex(EElementalType Element)
+	{
+		const int32 Index = static_cast<int32>(Element);
+		return Index < NumElements ? Index : 0;
+	}
+};
+
 /**
  * 元素配置管理器
  * 单例模式，管理全局的元素配置数据
  * 为ElementalCalculator提供数据驱动的相克关系查询
+ * 设置数据资产时预先构建相克表，之后的查询不再访问数据资产；
+ * 最近构建的相克表同时对外发布，没有世界上下文的调用方也能通过静态接口查询
  */
 UCLASS()
 class ELEMENTALCOMBAT_API UElementalConfigManager : public UGameInstanceSubsystem
@@ -75,26 +135,62 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
 	bool HasValidConfiguration() const;
 
+	/**
+	 * 重新构建相克表
+	 * 数据资产通过BuildElementMaps或编辑器修改时会自动调用
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ElementalCombat|Combat|Elemental")
+	void RebuildCounterMatrix();
+
+	/** 获取当前的相克表 */
+	const FElementalCounterMatrix& GetCounterMatrix() const
+	{
+		return CounterMatrices[ActiveMatrixIndex.load(std::memory_order_acquire)];
+	}
+
+	/**
+	 * 获取最近发布的相克表，不需要世界上下文
+	 * 没有配置管理器时返回默认五行相克
+	 */
+	static const FElementalCounterMatrix& GetPublishedCounterMatrix();
+
+	/** 通过最近发布的相克表查询相克倍率 */
+	static float GetCounterMultiplierFast(EElementalType AttackerElement, EElementalType DefenderElement)
+	{
+		return GetPublishedCounterMatrix().GetMultiplier(AttackerElement, DefenderElement);
+	}
+
+	/** 通过最近发布的相克表查询克制关系 */
+	static bool IsElementAdvantageFast(EElementalType AttackerElement, EElementalType DefenderElement)
+	{
+		return GetPublishedCounterMatrix().IsAdvantage(AttackerElement, DefenderElement);
+	}
+
 protected:
 	// USubsystem interface
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 	virtual void Deinitialize() override;
 
 private:
+	/** 数据资产内容变化回调 */
+	void HandleDataAssetChanged(const UElementalDataAsset* DataAsset);
+
 	// 当前使用的元素数据资产
 	UPROPERTY()
 	UElementalDataAsset* CurrentDataAsset;
 
-	// 默认相克关系倍率
-	static constexpr float DEFAULT_ADVANTAGE_MULTIPLIER = 1.5f;
-	static constexpr float DEFAULT_DISADVANTAGE_MULTIPLIER = 0.5f;
-	static constexpr float DEFAULT_NEUTRAL_MULTIPLIER = 1.0f;
-
 	/**
-	 * 使用硬编码逻辑判断元素克制关系（后备方案）
-	 * @param AttackerElement 攻击者元素
-	 * @param DefenderElement 防御者元素
-	 * @return true如果攻击者克制防御者
+	 * 双缓冲相克表
+	 * 重建时写入非活动的一份再切换下标，正在进行的查询读到的仍是完整的旧表
 	 */
-	bool IsElementAdvantageDefault(EElementalType AttackerElement, EElementalType DefenderElement) const;
+	FElementalCounterMatrix CounterMatrices[2];
+
+	/** 当前活动的相克表下标 */
+	std::atomic<int32> ActiveMatrixIndex{0};
+
+	/** 正在重建（构建时数据资产可能延迟构建缓存并再次通知） */
+	bool bRebuildingCounterMatrix = false;
+
+	/** 数据资产变化通知句柄 */
+	FDelegateHandle DataAssetChangedHandle;
 };
\ No newline at end of file
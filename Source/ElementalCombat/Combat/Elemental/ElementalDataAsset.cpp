@@ -7,6 +7,8 @@
 #include "Misc/DataValidation.h"
 #endif
 
+FOnElementalDataAssetChanged UElementalDataAsset::OnDataChanged;
+
 UElementalDataAsset::UElementalDataAsset()
 {
 	bCacheBuilt = false;
@@ -186,17 +188,23 @@ void UElementalDataAsset::CopyDataToComponent(UElementalComponent* ElementCompon
 		return;
 	}
 
+	ElementComponent->SetEffectTable(GetEffectTable());
+}
+
+TSharedRef<const FElementalEffectTable> UElementalDataAsset::GetEffectTable() const
+{
 	// 确保缓存已构建
 	if (!bCacheBuilt)
 	{
 		const_cast<UElementalDataAsset*>(this)->BuildElementMaps();
 	}
 
-	// 复制所有元素效果数据到组件
-	for (const auto& ElementPair : ElementEffectMap)
+	if (!EffectTable.IsValid() || EffectTable->GetVersion() != DataVersion)
 	{
-		ElementComponent->SetElementEffectData(ElementPair.Key, ElementPair.Value);
+		EffectTable = FElementalEffectTable::Make(ElementEffects, DataVersion);
 	}
+
+	return EffectTable.ToSharedRef();
 }
 
 void UElementalDataAsset::BuildElementMaps()
@@ -223,6 +231,9 @@ void UElementalDataAsset::BuildElementMaps()
 	}
 
 	bCacheBuilt = true;
+	++DataVersion;
+
+	OnDataChanged.Broadcast(this);
 }
 
 #if WITH_EDITOR
@@ -239,4 +250,11 @@ EDataValidationResult UElementalDataAsset::IsDataValid(FDataValidationContext& C
 
 	return Result;
 }
+
+void UElementalDataAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	BuildElementMaps();
+}
 #endif
\ No newline at end of file
@@ -5,8 +5,14 @@
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
 #include "ElementalTypes.h"
+#include "ElementalEffectTable.h"
 #include "ElementalDataAsset.generated.h"
 
+class UElementalDataAsset;
+
+/** 元素数据资产的映射缓存重建后广播 */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnElementalDataAssetChanged, const UElementalDataAsset*);
+
 /**
  * 元素配置数据资产
  * 用于在编辑器中配置元素效果和相克关系
@@ -19,6 +25,9 @@ class ELEMENTALCOMBAT_API UElementalDataAsset : public UPrimaryDataAsset
 public:
 	UElementalDataAsset();
 
+	/** 任意元素数据资产的映射缓存重建后广播（配置管理器据此重建相克表） */
+	static FOnElementalDataAssetChanged OnDataChanged;
+
 	/**
 	 * 获取指定元素的效果数据
 	 * @param Element 元素类型
@@ -74,7 +83,16 @@ public:
 	TArray<EElementalType> GetConfiguredElements() const;
 
 	/**
-	 * 复制元素数据到组件
+	 * 获取共享的元素效果表（映射缓存重建后生成新版本）
+	 * @return 效果表，所有组件共同引用
+	 */
+	TSharedRef<const FElementalEffectTable> GetEffectTable() const;
+
+	/** 当前数据版本（每次重建映射缓存后递增） */
+	uint32 GetDataVersion() const { return DataVersion; }
+
+	/**
+	 * 让组件引用共享的元素效果表（不再逐项复制）
 	 * @param ElementComponent 目标元素组件
 	 */
 	UFUNCTION(BlueprintCallable, Category = "ElementalCombat|Combat|Elemental")
@@ -83,6 +101,9 @@ public:
 #if WITH_EDITOR
 	// 编辑器中验证数据
 	virtual EDataValidationResult IsDataValid(class FDataValidationContext& Context) const override;
+
+	// 编辑器中修改配置后重建缓存
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 
 protected:
@@ -113,4 +134,10 @@ private:
 
 	// 缓存是否已构建
 	bool bCacheBuilt;
+
+	// 数据版本
+	uint32 DataVersion = 0;
+
+	// 共享的元素效果表（版本落后于DataVersion时重建）
+	mutable TSharedPtr<const FElementalEffectTable> EffectTable;
 };
\ No newline at end of file
@@ -2,13 +2,13 @@
 
 #include "Combat/Elemental/ElementalEffectProcessor.h"
 
-#include "ElementalCalculator.h"
+#include "ElementalConfigManager.h"
 
 // ===========================================
 // 通用伤害倍率应用
 // ===========================================
 
-float UElementalEffectProcessor::ApplyDamageMultiplier(float BaseDamage, const FElementalEffectData& EffectData)
+float UElementalEffectProcessor::ApplyDamageMultiplier(float BaseDamage, const FElementalEffectParams& EffectData)
 {
 	if (BaseDamage < 0.0f || EffectData.DamageMultiplier < 0.0f)
 	{
@@ -22,7 +22,7 @@ float UElementalEffectProcessor::ApplyDamageMultiplier(float BaseDamage, const F
 // 木元素 - 吸血效果
 // ===========================================
 
-float UElementalEffectProcessor::CalculateLifeSteal(float DamageDealt, const FElementalEffectData& WoodData)
+float UElementalEffectProcessor::CalculateLifeSteal(float DamageDealt, const FElementalEffectParams& WoodData)
 {
 	if (DamageDealt < 0.0f)
 	{
@@ -49,7 +49,7 @@ float UElementalEffectProcessor::ApplyLifeSteal(float CurrentHealth, float MaxHe
 // 水元素 - 减速效果
 // ===========================================
 
-float UElementalEffectProcessor::CalculateSlowedSpeed(float BaseSpeed, const FElementalEffectData& WaterData)
+float UElementalEffectProcessor::CalculateSlowedSpeed(float BaseSpeed, const FElementalEffectParams& WaterData)
 {
 	if (BaseSpeed < 0.0f)
 	{
@@ -64,7 +64,7 @@ float UElementalEffectProcessor::CalculateSlowedSpeed(float BaseSpeed, const FEl
 	return FMath::Max(SlowedSpeed, 0.0f);
 }
 
-float UElementalEffectProcessor::CalculateSlowedAttackSpeed(float BaseAttackSpeed, const FElementalEffectData& WaterData)
+float UElementalEffectProcessor::CalculateSlowedAttackSpeed(float BaseAttackSpeed, const FElementalEffectParams& WaterData)
 {
 	if (BaseAttackSpeed < 0.0f)
 	{
@@ -83,7 +83,7 @@ float UElementalEffectProcessor::CalculateSlowedAttackSpeed(float BaseAttackSpee
 // 火元素 - DOT效果
 // ===========================================
 
-int32 UElementalEffectProcessor::CalculateDotTicks(const FElementalEffectData& FireData)
+int32 UElementalEffectProcessor::CalculateDotTicks(const FElementalEffectParams& FireData)
 {
 	if (FireData.DotDuration <= 0.0f || FireData.DotTickInterval <= 0.0f)
 	{
@@ -93,7 +93,7 @@ int32 UElementalEffectProcessor::CalculateDotTicks(const FElementalEffectData& F
 	return FMath::FloorToInt(FireData.DotDuration / FireData.DotTickInterval);
 }
 
-float UElementalEffectProcessor::CalculateTotalDotDamage(const FElementalEffectData& FireData)
+float UElementalEffectProcessor::CalculateTotalDotDamage(const FElementalEffectParams& FireData)
 {
 	int32 TickCount = CalculateDotTicks(FireData);
 	if (TickCount <= 0 || FireData.DotDamage < 0.0f)
@@ -104,12 +104,12 @@ float UElementalEffectProcessor::CalculateTotalDotDamage(const FElementalEffectD
 	return FireData.DotDamage * TickCount;
 }
 
-float UElementalEffectProcessor::GetDotTickDamage(const FElementalEffectData& FireData)
+float UElementalEffectProcessor::GetDotTickDamage(const FElementalEffectParams& FireData)
 {
 	return FMath::Max(FireData.DotDamage, 0.0f);
 }
 
-float UElementalEffectProcessor::CalculateDotTickDamage(const FElementalEffectData& FireData, EElementalType AttackerElement, EElementalType DefenderElement)
+float UElementalEffectProcessor::CalculateDotTickDamage(const FElementalEffectParams& FireData, EElementalType AttackerElement, EElementalType DefenderElement)
 {
 	float BaseDotDamage = GetDotTickDamage(FireData);
 	if (BaseDotDamage <= 0.0f)
@@ -117,8 +117,8 @@ float UElementalEffectProcessor::CalculateDotTickDamage(const FElementalEffectDa
 		return MIN_DAMAGE;
 	}
 
-	// 应用元素相克修正
-	float ElementMultiplier = UElementalCalculator::CalculateCounterMultiplier(AttackerElement, DefenderElement);
+	// 应用元素相克修正（使用配置管理器发布的相克表）
+	float ElementMultiplier = UElementalConfigManager::GetCounterMultiplierFast(AttackerElement, DefenderElement);
 	return BaseDotDamage * ElementMultiplier;
 }
 
@@ -126,7 +126,7 @@ float UElementalEffectProcessor::CalculateDotTickDamage(const FElementalEffectDa
 // 土元素 - 减伤效果
 // ===========================================
 
-float UElementalEffectProcessor::ApplyDamageReduction(float IncomingDamage, const FElementalEffectData& EarthData)
+float UElementalEffectProcessor::ApplyDamageReduction(float IncomingDamage, const FElementalEffectParams& EarthData)
 {
 	if (IncomingDamage < 0.0f)
 	{
@@ -145,7 +145,7 @@ float UElementalEffectProcessor::ApplyDamageReduction(float IncomingDamage, cons
 // 综合处理函数
 // ===========================================
 
-float UElementalEffectProcessor::ProcessDamage(float BaseDamage, EElementalType AttackerElement, EElementalType DefenderElement, const FElementalEffectData& AttackerData)
+float UElementalEffectProcessor::ProcessDamage(float BaseDamage, EElementalType AttackerElement, EElementalType DefenderElement, const FElementalEffectParams& AttackerData)
 {
 	if (BaseDamage < 0.0f)
 	{
@@ -160,8 +160,8 @@ float UElementalEffectProcessor::ProcessDamage(float BaseDamage, EElementalType
 		ProcessedDamage = ApplyDamageMultiplier(BaseDamage, AttackerData);
 	}
 
-	// 然后应用元素相克修正
-	float CounterMultiplier = UElementalCalculator::CalculateCounterMultiplier(AttackerElement, DefenderElement);
+	// 然后应用元素相克修正（使用配置管理器发布的相克表）
+	float CounterMultiplier = UElementalConfigManager::GetCounterMultiplierFast(AttackerElement, DefenderElement);
 	ProcessedDamage *= CounterMultiplier;
 
 	// 确保最终伤害不为负
@@ -9,6 +9,7 @@
 /**
  * 元素效果处理器
  * 提供处理各种元素效果的静态函数库
+ * 只读取数值参数（FElementalEffectParams），传入完整的FElementalEffectData时自动转换
  */
 UCLASS()
 class ELEMENTALCOMBAT_API UElementalEffectProcessor : public UObject
@@ -27,7 +28,7 @@ public:
 	 * @return 应用倍率后的伤害
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
-	static float ApplyDamageMultiplier(float BaseDamage, const FElementalEffectData& EffectData);
+	static float ApplyDamageMultiplier(float BaseDamage, const FElementalEffectParams& EffectData);
 
 	// ===========================================
 	// 木元素 - 吸血效果
@@ -40,7 +41,7 @@ public:
 	 * @return 吸血数值
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
-	static float CalculateLifeSteal(float DamageDealt, const FElementalEffectData& WoodData);
+	static float CalculateLifeSteal(float DamageDealt, const FElementalEffectParams& WoodData);
 
 	/**
 	 * 应用吸血效果
@@ -63,7 +64,7 @@ public:
 	 * @return 减速后的移动速度
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
-	static float CalculateSlowedSpeed(float BaseSpeed, const FElementalEffectData& WaterData);
+	static float CalculateSlowedSpeed(float BaseSpeed, const FElementalEffectParams& WaterData);
 
 	/**
 	 * 计算减速后的攻击速度
@@ -72,7 +73,7 @@ public:
 	 * @return 减速后的攻击速度
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
-	static float CalculateSlowedAttackSpeed(float BaseAttackSpeed, const FElementalEffectData& WaterData);
+	static float CalculateSlowedAttackSpeed(float BaseAttackSpeed, const FElementalEffectParams& WaterData);
 
 	// ===========================================
 	// 火元素 - DOT效果
@@ -84,7 +85,7 @@ public:
 	 * @return tick次数
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
-	static int32 CalculateDotTicks(const FElementalEffectData& FireData);
+	static int32 CalculateDotTicks(const FElementalEffectParams& FireData);
 
 	/**
 	 * 计算DOT总伤害
@@ -92,7 +93,7 @@ public:
 	 * @return 总DOT伤害
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
-	static float CalculateTotalDotDamage(const FElementalEffectData& FireData);
+	static float CalculateTotalDotDamage(const FElementalEffectParams& FireData);
 
 	/**
 	 * 获取单次DOT伤害
@@ -100,7 +101,7 @@ public:
 	 * @return 单次DOT伤害
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
-	static float GetDotTickDamage(const FElementalEffectData& FireData);
+	static float GetDotTickDamage(const FElementalEffectParams& FireData);
 
 	/**
 	 * 计算考虑元素相克的DOT伤害
@@ -110,7 +111,7 @@ public:
 	 * @return 修正后的DOT伤害
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
-	static float CalculateDotTickDamage(const FElementalEffectData& FireData, EElementalType AttackerElement, EElementalType DefenderElement);
+	static float CalculateDotTickDamage(const FElementalEffectParams& FireData, EElementalType AttackerElement, EElementalType DefenderElement);
 
 	// ===========================================
 	// 土元素 - 减伤效果
@@ -123,7 +124,7 @@ public:
 	 * @return 减免后的伤害
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
-	static float ApplyDamageReduction(float IncomingDamage, const FElementalEffectData& EarthData);
+	static float ApplyDamageReduction(float IncomingDamage, const FElementalEffectParams& EarthData);
 
 	// ===========================================
 	// 综合处理函数
@@ -138,7 +139,7 @@ public:
 	 * @return 最终伤害
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ElementalCombat|Combat|Elemental")
-	static float ProcessDamage(float BaseDamage, EElementalType AttackerElement, EElementalType DefenderElement, const FElementalEffectData& AttackerData);
+	static float ProcessDamage(float BaseDamage, EElementalType AttackerElement, EElementalType DefenderElement, const FElementalEffectParams& AttackerData);
 
 private:
 	// 常量定义
@@ -0,0 +1,24 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "Combat/Elemental/ElementalEffectTable.h"
+
+TSharedRef<const FElementalEffectTable> FElementalEffectTable::Make(TConstArrayView<FElementalEffectData> Effects, uint32 InVersion)
+{
+	TSharedRef<FElementalEffectTable> Table = MakeShared<FElementalEffectTable>();
+	Table->Version = InVersion;
+
+	for (const FElementalEffectData& Effect : Effects)
+	{
+		const int32 Index = static_cast<int32>(Effect.Element);
+		if (Effect.Element == EElementalType::None || Index >= NumElements)
+		{
+			continue;
+		}
+
+		Table->Params[Index] = FElementalEffectParams(Effect);
+		Table->Presentation[Index] = FElementalPresentationData(Effect);
+		Table->ConfiguredMask |= static_cast<uint8>(1u << Index);
+	}
+
+	return Table;
+}
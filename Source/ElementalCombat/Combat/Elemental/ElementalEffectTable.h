@@ -0,0 +1,86 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ElementalTypes.h"
+
+/**
+ * 共享的元素效果表
+ * 由数据资产构建，构建后不再修改，按EElementalType下标直接索引；数值参数和表现数据分开存储。
+ * 所有使用同一数据资产的元素组件引用同一份表，数据资产重建映射缓存时生成新版本的表
+ */
+class ELEMENTALCOMBAT_API FElementalEffectTable
+{
+public:
+	/** 元素类型数量（包括None） */
+	static constexpr int32 NumElements = static_cast<int32>(EElementalType::Earth) + 1;
+
+	static_assert(NumElements <= 8, "ConfiguredMask按uint8存储，元素数量不能超过8");
+
+	/**
+	 * 构建效果表
+	 * @param Effects 效果数据，Element为None的条目被忽略，同一元素重复配置时后面的覆盖前面的
+	 * @param InVersion 数据版本
+	 */
+	static TSharedRef<const FElementalEffectTable> Make(TConstArrayView<FElementalEffectData> Effects, uint32 InVersion);
+
+	/**
+	 * 获取元素的完整效果数据（由数值参数和表现数据组合，不在表内另存一份）
+	 * @return true如果配置了该元素
+	 */
+	bool GetEffectData(EElementalType Element, FElementalEffectData& OutEffectData) const
+	{
+		const int32 Index = static_cast<int32>(Element);
+		if (!Contains(Element))
+		{
+			return false;
+		}
+
+		OutEffectData = FElementalEffectOverride::MakeEffectData(Params[Index], Presentation[Index]);
+		return true;
+	}
+
+	/** 获取元素的数值参数，未配置时返回nullptr */
+	const FElementalEffectParams* FindParams(EElementalType Element) const
+	{
+		const int32 Index = static_cast<int32>(Element);
+		return Contains(Element) ? &Params[Index] : nullptr;
+	}
+
+	/** 获取元素的表现数据，未配置时返回nullptr */
+	const FElementalPresentationData* FindPresentation(EElementalType Element) const
+	{
+		const int32 Index = static_cast<int32>(Element);
+		return Contains(Element) ? &Presentation[Index] : nullptr;
+	}
+
+	/** 是否配置了该元素 */
+	bool Contains(EElementalType Element) const
+	{
+		const int32 Index = static_cast<int32>(Element);
+		return Index < NumElements && ((ConfiguredMask >> Index) & 1) != 0;
+	}
+
+	/** 已配置的元素数量 */
+	int32 Num() const { return FMath::CountBits(ConfiguredMask); }
+
+	/** 构建时的数据版本 */
+	uint32 GetVersion() const { return Version; }
+
+	/** 占用内存（字节） */
+	SIZE_T GetAllocatedSize() const { return sizeof(FElementalEffectTable); }
+
+private:
+	/** 按元素下标存储的数值参数（伤害结算只访问这一段） */
+	FElementalEffectParams Params[NumElements];
+
+	/** 按元素下标存储的表现数据 */
+	FElementalPresentationData Presentation[NumElements];
+
+	/** 已配置的元素（第N位对应数值为N的元素） */
+	uint8 ConfiguredMask = 0;
+
+	/** 数据版本 */
+	uint32 Version = 0;
+};
@@ -0,0 +1,546 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "Combat/Elemental/ElementalStatusEffectSubsystem.h"
+#include "Combat/Elemental/ElementalComponent.h"
+#include "Combat/Elemental/ElementalEffectProcessor.h"
+#include "Combat/CombatDamageSubsystem.h"
+#include "Variant_Combat/Interfaces/CombatDamageable.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Async/ParallelFor.h"
+
+static TAutoConsoleVariable<bool> CVarStatusEffectsForceSerial(
+	TEXT("ElementalCombat.Combat.StatusEffects.ForceSerial"),
+	false,
+	TEXT("强制元素状态效果子系统在游戏线程上串行推进（用于调试，结果与并行推进一致）"),
+	ECVF_Default);
+
+namespace
+{
+	/** 燃烧的最短伤害间隔（与原先组件定时器一致） */
+	constexpr float MinBurnTickInterval = 0.1f;
+}
+
+UElementalStatusEffectSubsystem* UElementalStatusEffectSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (!WorldContextObject)
+	{
+		return nullptr;
+	}
+
+	const UWorld* World = WorldContextObject->GetWorld();
+	return World ? World->GetSubsystem<UElementalStatusEffectSubsystem>() : nullptr;
+}
+
+void UElementalStatusEffectSubsystem::Deinitialize()
+{
+	EffectTargets.Empty();
+	EffectTypes.Empty();
+	EffectMagnitudes.Empty();
+	EffectNextTickTimes.Empty();
+	EffectTickIntervals.Empty();
+	EffectRemainingTicks.Empty();
+	EffectSources.Empty();
+	EffectDueDamage.Empty();
+
+	TargetComponents.Empty();
+	TargetSerials.Empty();
+	FreeTargetIndices.Empty();
+	TargetEffects.Empty();
+	TargetAppliedSlows.Empty();
+	TargetBaseWalkSpeeds.Empty();
+	TargetPendingDamage.Empty();
+	TargetDamageSources.Empty();
+	DamagedTargets.Empty();
+	ChangedTargets.Empty();
+	PendingDamage.Empty();
+	NumTargets = 0;
+
+	Super::Deinitialize();
+}
+
+TStatId UElementalStatusEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UElementalStatusEffectSubsystem, STATGROUP_Tickables);
+}
+
+void UElementalStatusEffectSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	Advance(DeltaTime);
+}
+
+// === 目标注册 ===
+
+FElementalStatusTargetHandle UElementalStatusEffectSubsystem::RegisterTarget(UElementalComponent* Component)
+{
+	FElementalStatusTargetHandle Handle;
+	if (!Component)
+	{
+		return Handle;
+	}
+
+	int32 Index = INDEX_NONE;
+	if (FreeTargetIndices.Num() > 0)
+	{
+		Index = FreeTargetIndices.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Index = TargetComponents.Num();
+		TargetComponents.AddDefaulted();
+		TargetSerials.AddZeroed();
+		TargetEffects.AddDefaulted();
+		TargetAppliedSlows.AddZeroed();
+		TargetBaseWalkSpeeds.AddZeroed();
+		TargetPendingDamage.AddZeroed();
+		TargetDamageSources.Add(INDEX_NONE);
+	}
+
+	TargetComponents[Index] = Component;
+	TargetSerials[Index] = NextSerial++;
+	++NumTargets;
+
+	Handle.Index = Index;
+	Handle.Serial = TargetSerials[Index];
+	return Handle;
+}
+
+void UElementalStatusEffectSubsystem::UnregisterTarget(FElementalStatusTargetHandle& Handle)
+{
+	if (IsTargetValid(Handle))
+	{
+		RemoveTargetEffects(Handle.Index);
+		ApplySlowToTarget(Handle.Index);
+		SyncTargetFlags(Handle.Index);
+		ReleaseTarget(Handle.Index);
+	}
+	Handle.Reset();
+}
+
+bool UElementalStatusEffectSubsystem::IsTargetValid(const FElementalStatusTargetHandle& Handle) const
+{
+	return TargetSerials.IsValidIndex(Handle.Index) && Handle.Serial != 0 && TargetSerials[Handle.Index] == Handle.Serial;
+}
+
+// === 效果 ===
+
+void UElementalStatusEffectSubsystem::ApplySlow(const FElementalStatusTargetHandle& Handle, float SlowPercentage, float Duration, AActor* Source)
+{
+	if (!IsTargetValid(Handle) || SlowPercentage <= 0.0f || Duration <= 0.0f)
+	{
+		return;
+	}
+
+	// 减速只在到期时触发一次（不造成伤害），触发后移除
+	AddEffect(Handle.Index, EElementalStatusEffectType::Slow,
+		FMath::Clamp(SlowPercentage, 0.0f, UElementalEffectProcessor::MAX_SLOW_PERCENTAGE), Duration, 1, Source);
+	ApplySlowToTarget(Handle.Index);
+	SyncTargetFlags(Handle.Index);
+}
+
+void UElementalStatusEffectSubsystem::ApplyBurn(const FElementalStatusTargetHandle& Handle, float DamagePerTick, float TickInterval, int32 NumTicks, AActor* Source)
+{
+	if (!IsTargetValid(Handle) || DamagePerTick <= 0.0f || NumTicks <= 0)
+	{
+		return;
+	}
+
+	AddEffect(Handle.Index, EElementalStatusEffectType::Burn, DamagePerTick, FMath::Max(TickInterval, MinBurnTickInterval), NumTicks, Source);
+	SyncTargetFlags(Handle.Index);
+}
+
+void UElementalStatusEffectSubsystem::RemoveAllEffects(const FElementalStatusTargetHandle& Handle)
+{
+	if (!IsTargetValid(Handle))
+	{
+		return;
+	}
+
+	RemoveTargetEffects(Handle.Index);
+	ApplySlowToTarget(Handle.Index);
+	SyncTargetFlags(Handle.Index);
+}
+
+int32 UElementalStatusEffectSubsystem::GetNumEffects(const FElementalStatusTargetHandle& Handle, EElementalStatusEffectType Type) const
+{
+	if (!IsTargetValid(Handle))
+	{
+		return 0;
+	}
+
+	int32 Count = 0;
+	for (const int32 EffectIndex : TargetEffects[Handle.Index])
+	{
+		Count += EffectTypes[EffectIndex] == Type ? 1 : 0;
+	}
+	return Count;
+}
+
+const FElementalStatusStackingRule& UElementalStatusEffectSubsystem::GetStackingRule(EElementalStatusEffectType Type) const
+{
+	const int32 TypeIndex = static_cast<int32>(Type);
+	check(TypeIndex >= 0 && TypeIndex < static_cast<int32>(EElementalStatusEffectType::Count));
+	return StackingRules[TypeIndex];
+}
+
+void UElementalStatusEffectSubsystem::SetStackingRule(EElementalStatusEffectType Type, const FElementalStatusStackingRule& Rule)
+{
+	const int32 TypeIndex = static_cast<int32>(Type);
+	if (TypeIndex >= 0 && TypeIndex < static_cast<int32>(EElementalStatusEffectType::Count))
+	{
+		StackingRules[TypeIndex] = Rule;
+		StackingRules[TypeIndex].MaxStacks = FMath::Max(Rule.MaxStacks, 1);
+	}
+}
+
+// === 更新 ===
+
+void UElementalStatusEffectSubsystem::Advance(float DeltaTime)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	Clock += DeltaTime;
+
+	const int32 NumEffects = EffectTargets.Num();
+	if (NumEffects == 0)
+	{
+		LastAdvanceMicroseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0;
+		return;
+	}
+
+	// 第一步：每个效果独立推进，只写自己的槽位
+	EffectDueDamage.SetNumUninitialized(NumEffects, EAllowShrinking::No);
+	const int32 MinBatchSize = FMath::Max(1, ParallelMinBatchSize);
+	if (NumEffects > MinBatchSize && ShouldAdvanceInParallel())
+	{
+		ParallelFor(TEXT("ElementalStatusEffects"), NumEffects, MinBatchSize, [this](int32 EffectIndex)
+		{
+			AdvanceEffect(EffectIndex);
+		});
+	}
+	else
+	{
+		for (int32 EffectIndex = 0; EffectIndex < NumEffects; ++EffectIndex)
+		{
+			AdvanceEffect(EffectIndex);
+		}
+	}
+
+	// 第二步：按目标汇总伤害，伤害来源取贡献最大的效果
+	DamagedTargets.Reset();
+	for (int32 EffectIndex = 0; EffectIndex < NumEffects; ++EffectIndex)
+	{
+		const float Damage = EffectDueDamage[EffectIndex];
+		if (Damage <= 0.0f)
+		{
+			continue;
+		}
+
+		const int32 TargetIndex = EffectTargets[EffectIndex];
+		int32& DamageSource = TargetDamageSources[TargetIndex];
+		if (DamageSource == INDEX_NONE)
+		{
+			DamagedTargets.Add(TargetIndex);
+			DamageSource = EffectIndex;
+		}
+		else if (Damage > EffectDueDamage[DamageSource])
+		{
+			DamageSource = EffectIndex;
+		}
+		TargetPendingDamage[TargetIndex] += Damage;
+	}
+
+	// 效果移除前记录来源，移除会改变效果下标
+	PendingDamage.Reset();
+	for (const int32 TargetIndex : DamagedTargets)
+	{
+		FPendingDamage& Pending = PendingDamage.AddDefaulted_GetRef();
+		Pending.TargetIndex = TargetIndex;
+		Pending.TargetSerial = TargetSerials[TargetIndex];
+		Pending.Damage = TargetPendingDamage[TargetIndex];
+		Pending.Source = EffectSources[TargetDamageSources[TargetIndex]];
+		TotalDamageResolved += Pending.Damage;
+
+		TargetPendingDamage[TargetIndex] = 0.0f;
+		TargetDamageSources[TargetIndex] = INDEX_NONE;
+	}
+
+	// 第三步：移除已结束的效果（从后往前，交换过来的效果已经处理过）
+	ChangedTargets.Reset();
+	for (int32 EffectIndex = NumEffects - 1; EffectIndex >= 0; --EffectIndex)
+	{
+		if (EffectRemainingTicks[EffectIndex] <= 0)
+		{
+			ChangedTargets.Add(EffectTargets[EffectIndex]);
+			RemoveEffectAtSwap(EffectIndex);
+		}
+	}
+
+	for (const int32 TargetIndex : ChangedTargets)
+	{
+		if (TargetSerials[TargetIndex] == 0)
+		{
+			continue;
+		}
+
+		ApplySlowToTarget(TargetIndex);
+		SyncTargetFlags(TargetIndex);
+
+		// 组件已销毁但没有注销的目标
+		if (!TargetComponents[TargetIndex].IsValid())
+		{
+			RemoveTargetEffects(TargetIndex);
+			ReleaseTarget(TargetIndex);
+		}
+	}
+
+	// 最后结算伤害：伤害回调可能施加新效果或注销目标，此时数组已经更新完毕
+	for (const FPendingDamage& Pending : PendingDamage)
+	{
+		if (TargetSerials[Pending.TargetIndex] != Pending.TargetSerial)
+		{
+			continue;
+		}
+
+		const UElementalComponent* Component = TargetComponents[Pending.TargetIndex].Get();
+		AActor* Owner = Component ? Component->GetOwner() : nullptr;
+		if (Cast<ICombatDamageable>(Owner))
+		{
+			// 与同一帧内的其他命中一起结算
+			UCombatDamageSubsystem::ApplyDamage(Owner, Pending.Damage, Pending.Source.Get(), Owner->GetActorLocation(), FVector::ZeroVector);
+			UE_LOG(LogTemp, Verbose, TEXT("ElementalStatusEffectSubsystem: %s 受到燃烧伤害 %.1f"), *Owner->GetName(), Pending.Damage);
+		}
+	}
+
+	LastAdvanceMicroseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0;
+}
+
+// === 内部实现 ===
+
+void UElementalStatusEffectSubsystem::AddEffect(int32 TargetIndex, EElementalStatusEffectType Type, float Magnitude, float TickInterval, int32 NumTicks, AActor* Source)
+{
+	const FElementalStatusStackingRule& Rule = GetStackingRule(Type);
+
+	// 同类效果中最早结束的一层
+	int32 NumSameType = 0;
+	int32 EarliestIndex = INDEX_NONE;
+	double EarliestEndTime = TNumericLimits<double>::Max();
+	for (const int32 EffectIndex : TargetEffects[TargetIndex])
+	{
+		if (EffectTypes[EffectIndex] != Type)
+		{
+			continue;
+		}
+
+		++NumSameType;
+		const double EndTime = EffectNextTickTimes[EffectIndex] + EffectTickIntervals[EffectIndex] * (EffectRemainingTicks[EffectIndex] - 1);
+		if (EndTime < EarliestEndTime)
+		{
+			EarliestEndTime = EndTime;
+			EarliestIndex = EffectIndex;
+		}
+	}
+
+	if (NumSameType == 0 || (Rule.Stacking == EElementalStatusStacking::Stack && NumSameType < Rule.MaxStacks))
+	{
+		const int32 EffectIndex = EffectTargets.AddUninitialized();
+		EffectTypes.AddUninitialized();
+		EffectMagnitudes.AddUninitialized();
+		EffectNextTickTimes.AddUninitialized();
+		EffectTickIntervals.AddUninitialized();
+		EffectRemainingTicks.AddUninitialized();
+		EffectSources.AddDefaulted();
+		TargetEffects[TargetIndex].Add(EffectIndex);
+		WriteEffect(EffectIndex, TargetIndex, Type, Magnitude, TickInterval, NumTicks, Source);
+		return;
+	}
+
+	if (Rule.Stacking == EElementalStatusStacking::Stack)
+	{
+		// 层数已满，替换最早结束的一层
+		WriteEffect(EarliestIndex, TargetIndex, Type, Magnitude, TickInterval, NumTicks, Source);
+		return;
+	}
+
+	// Replace和KeepStrongest只保留一层（规则在运行时改变时可能有多层，合并到第一层）
+	int32 KeptIndex = INDEX_NONE;
+	float StrongestMagnitude = Magnitude;
+	for (int32 Slot = TargetEffects[TargetIndex].Num() - 1; Slot >= 0; --Slot)
+	{
+		const int32 EffectIndex = TargetEffects[TargetIndex][Slot];
+		if (EffectTypes[EffectIndex] != Type)
+		{
+			continue;
+		}
+
+		StrongestMagnitude = FMath::Max(StrongestMagnitude, EffectMagnitudes[EffectIndex]);
+		if (KeptIndex == INDEX_NONE)
+		{
+			KeptIndex = EffectIndex;
+		}
+		else
+		{
+			// 保留的下标可能被交换到被移除的位置
+			const int32 LastIndex = EffectTargets.Num() - 1;
+			RemoveEffectAtSwap(EffectIndex);
+			if (KeptIndex == LastIndex)
+			{
+				KeptIndex = EffectIndex;
+			}
+		}
+	}
+
+	const float NewMagnitude = Rule.Stacking == EElementalStatusStacking::KeepStrongest ? StrongestMagnitude : Magnitude;
+	WriteEffect(KeptIndex, TargetIndex, Type, NewMagnitude, TickInterval, NumTicks, Source);
+}
+
+void UElementalStatusEffectSubsystem::WriteEffect(int32 EffectIndex, int32 TargetIndex, EElementalStatusEffectType Type, float Magnitude, float TickInterval, int32 NumTicks, AActor* Source)
+{
+	EffectTargets[EffectIndex] = TargetIndex;
+	EffectTypes[EffectIndex] = Type;
+	EffectMagnitudes[EffectIndex] = Magnitude;
+	EffectNextTickTimes[EffectIndex] = Clock + TickInterval;
+	EffectTickIntervals[EffectIndex] = TickInterval;
+	EffectRemainingTicks[EffectIndex] = NumTicks;
+	EffectSources[EffectIndex] = Source;
+}
+
+void UElementalStatusEffectSubsystem::RemoveEffectAtSwap(int32 EffectIndex)
+{
+	const int32 LastIndex = EffectTargets.Num() - 1;
+	TargetEffects[EffectTargets[EffectIndex]].RemoveSingleSwap(EffectIndex, EAllowShrinking::No);
+
+	// 最后一个效果移到当前位置，更新其目标上记录的下标
+	if (EffectIndex != LastIndex)
+	{
+		const int32 MovedIndex = TargetEffects[EffectTargets[LastIndex]].Find(LastIndex);
+		check(MovedIndex != INDEX_NONE);
+		TargetEffects[EffectTargets[LastIndex]][MovedIndex] = EffectIndex;
+	}
+
+	EffectTargets.RemoveAtSwap(EffectIndex, EAllowShrinking::No);
+	EffectTypes.RemoveAtSwap(EffectIndex, EAllowShrinking::No);
+	EffectMagnitudes.RemoveAtSwap(EffectIndex, EAllowShrinking::No);
+	EffectNextTickTimes.RemoveAtSwap(EffectIndex, EAllowShrinking::No);
+	EffectTickIntervals.RemoveAtSwap(EffectIndex, EAllowShrinking::No);
+	EffectRemainingTicks.RemoveAtSwap(EffectIndex, EAllowShrinking::No);
+	EffectSources.RemoveAtSwap(EffectIndex, EAllowShrinking::No);
+}
+
+void UElementalStatusEffectSubsystem::RemoveTargetEffects(int32 TargetIndex)
+{
+	while (TargetEffects[TargetIndex].Num() > 0)
+	{
+		RemoveEffectAtSwap(TargetEffects[TargetIndex].Last());
+	}
+}
+
+void UElementalStatusEffectSubsystem::AdvanceEffect(int32 EffectIndex)
+{
+	float DueDamage = 0.0f;
+
+	const double NextTickTime = EffectNextTickTimes[EffectIndex];
+	const int32 RemainingTicks = EffectRemainingTicks[EffectIndex];
+	if (RemainingTicks > 0 && NextTickTime <= Clock)
+	{
+		// 一帧跨过多个间隔时一次结算
+		const float Interval = EffectTickIntervals[EffectIndex];
+		const int32 NumDue = FMath::Min(RemainingTicks, FMath::FloorToInt32((Clock - NextTickTime) / Interval) + 1);
+		EffectNextTickTimes[EffectIndex] = NextTickTime + static_cast<double>(Interval) * NumDue;
+		EffectRemainingTicks[EffectIndex] = RemainingTicks - NumDue;
+
+		if (EffectTypes[EffectIndex] == EElementalStatusEffectType::Burn)
+		{
+			DueDamage = EffectMagnitudes[EffectIndex] * NumDue;
+		}
+	}
+
+	EffectDueDamage[EffectIndex] = DueDamage;
+}
+
+void UElementalStatusEffectSubsystem::ReleaseTarget(int32 TargetIndex)
+{
+	TargetComponents[TargetIndex].Reset();
+	TargetSerials[TargetIndex] = 0;
+	TargetAppliedSlows[TargetIndex] = 0.0f;
+	TargetBaseWalkSpeeds[TargetIndex] = 0.0f;
+	TargetPendingDamage[TargetIndex] = 0.0f;
+	TargetDamageSources[TargetIndex] = INDEX_NONE;
+	FreeTargetIndices.Add(TargetIndex);
+	--NumTargets;
+}
+
+void UElementalStatusEffectSubsystem::ApplySlowToTarget(int32 TargetIndex)
+{
+	float DesiredSlow = 0.0f;
+	for (const int32 EffectIndex : TargetEffects[TargetIndex])
+	{
+		if (EffectTypes[EffectIndex] == EElementalStatusEffectType::Slow)
+		{
+			DesiredSlow = FMath::Max(DesiredSlow, EffectMagnitudes[EffectIndex]);
+		}
+	}
+
+	float& AppliedSlow = TargetAppliedSlows[TargetIndex];
+	if (DesiredSlow == AppliedSlow)
+	{
+		return;
+	}
+
+	const UElementalComponent* Component = TargetComponents[TargetIndex].Get();
+	const ACharacter* Character = Component ? Cast<ACharacter>(Component->GetOwner()) : nullptr;
+	if (UCharacterMovementComponent* Movement = Character ? Character->GetCharacterMovement() : nullptr)
+	{
+		float& BaseWalkSpeed = TargetBaseWalkSpeeds[TargetIndex];
+		if (AppliedSlow <= 0.0f)
+		{
+			BaseWalkSpeed = Movement->MaxWalkSpeed;
+		}
+
+		if (DesiredSlow > 0.0f)
+		{
+			FElementalEffectParams SlowParams;
+			SlowParams.SlowPercentage = DesiredSlow;
+			Movement->MaxWalkSpeed = UElementalEffectProcessor::CalculateSlowedSpeed(BaseWalkSpeed, SlowParams);
+		}
+		else
+		{
+			Movement->MaxWalkSpeed = BaseWalkSpeed;
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("ElementalStatusEffectSubsystem: %s 移动速度 %.0f -> %.0f"),
+			*Character->GetName(), BaseWalkSpeed, Movement->MaxWalkSpeed);
+	}
+
+	AppliedSlow = DesiredSlow;
+}
+
+void UElementalStatusEffectSubsystem::SyncTargetFlags(int32 TargetIndex)
+{
+	UElementalComponent* Component = TargetComponents[TargetIndex].Get();
+	if (!Component)
+	{
+		return;
+	}
+
+	bool bSlowed = false;
+	bool bBurning = false;
+	for (const int32 EffectIndex : TargetEffects[TargetIndex])
+	{
+		bSlowed |= EffectTypes[EffectIndex] == EElementalStatusEffectType::Slow;
+		bBurning |= EffectTypes[EffectIndex] == EElementalStatusEffectType::Burn;
+	}
+
+	Component->SetStatusEffectFlags(bSlowed, bBurning);
+}
+
+bool UElementalStatusEffectSubsystem::ShouldAdvanceInParallel() const
+{
+	return !CVarStatusEffectsForceSerial.GetValueOnGameThread() && FApp::ShouldUseThreadingForPerformance();
+}
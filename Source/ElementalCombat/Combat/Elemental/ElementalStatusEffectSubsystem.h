@@ -0,0 +1,263 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ElementalStatusEffectSubsystem.generated.h"
+
+class AActor;
+class UElementalComponent;
+
+/**
+ * 元素状态效果类型
+ */
+UENUM(BlueprintType)
+enum class EElementalStatusEffectType : uint8
+{
+	/** 减速：持续期间降低移动速度，强度为减速比例 */
+	Slow = 0	UMETA(DisplayName = "减速"),
+	/** 燃烧：按间隔造成伤害，强度为单次伤害 */
+	Burn = 1	UMETA(DisplayName = "燃烧"),
+
+	Count		UMETA(Hidden)
+};
+
+/**
+ * 同一目标重复施加同类效果时的叠加方式
+ */
+UENUM(BlueprintType)
+enum class EElementalStatusStacking : uint8
+{
+	/** 新效果替换已有效果 */
+	Replace			UMETA(DisplayName = "替换"),
+	/** 保留强度更大的一个，按新效果重新计时 */
+	KeepStrongest	UMETA(DisplayName = "保留最强"),
+	/** 独立叠加，达到上限时替换最早结束的一层 */
+	Stack			UMETA(DisplayName = "叠加")
+};
+
+/**
+ * 单个效果类型的叠加规则
+ */
+USTRUCT(BlueprintType)
+struct ELEMENTALCOMBAT_API FElementalStatusStackingRule
+{
+	GENERATED_BODY()
+
+	/** 叠加方式 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "ElementalCombat|Combat|Elemental")
+	EElementalStatusStacking Stacking = EElementalStatusStacking::Replace;
+
+	/** 最大层数（只对Stack有效） */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "ElementalCombat|Combat|Elemental", meta = (ClampMin = "1", EditCondition = "Stacking == EElementalStatusStacking::Stack"))
+	int32 MaxStacks = 1;
+};
+
+/**
+ * 状态效果目标句柄
+ * 由UElementalStatusEffectSubsystem分配，槽位复用后旧句柄自动失效
+ */
+struct ELEMENTALCOMBAT_API FElementalStatusTargetHandle
+{
+	/** 槽位下标 */
+	int32 Index = INDEX_NONE;
+
+	/** 分配序号（用于检测槽位复用） */
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	void Reset()
+	{
+		Index = INDEX_NONE;
+		Serial = 0;
+	}
+};
+
+/**
+ * 元素状态效果子系统
+ * 所有目标身上的减速和燃烧效果按结构数组存放（目标、类型、强度、下次触发时间、剩余次数、来源），
+ * 每帧一次批量推进：先并行计算每个效果本帧触发的次数和伤害，再串行按目标汇总，
+ * 每个目标每帧最多结算一次伤害、最多修改一次移动速度，替代每个组件各自的定时器回调
+ * - 减速按目标上所有减速效果的最大比例生效，全部结束后恢复原速度
+ * - 同一帧内的多次燃烧伤害合并为一次，伤害来源取贡献最大的效果
+ * 控制台变量ElementalCombat.Combat.StatusEffects.ForceSerial可关闭并行推进
+ */
+UCLASS(Config = Game)
+class ELEMENTALCOMBAT_API UElementalStatusEffectSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** 获取当前世界的子系统 */
+	static UElementalStatusEffectSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// === 目标注册 ===
+
+	/** 注册目标（组件第一次受到状态效果时自动注册） */
+	FElementalStatusTargetHandle RegisterTarget(UElementalComponent* Component);
+
+	/** 注销目标，移除其所有效果并恢复移动速度，然后重置句柄 */
+	void UnregisterTarget(FElementalStatusTargetHandle& Handle);
+
+	/** 句柄是否仍然有效 */
+	bool IsTargetValid(const FElementalStatusTargetHandle& Handle) const;
+
+	/** 已注册的目标数量 */
+	int32 GetNumTargets() const { return NumTargets; }
+
+	// === 效果 ===
+
+	/**
+	 * 施加减速
+	 * @param SlowPercentage 减速比例（限制在0-1）
+	 * @param Duration 持续时间（秒）
+	 */
+	void ApplySlow(const FElementalStatusTargetHandle& Handle, float SlowPercentage, float Duration, AActor* Source);
+
+	/**
+	 * 施加燃烧
+	 * @param DamagePerTick 单次伤害
+	 * @param TickInterval 伤害间隔（秒），第一次伤害在一个间隔后触发
+	 * @param NumTicks 伤害次数
+	 */
+	void ApplyBurn(const FElementalStatusTargetHandle& Handle, float DamagePerTick, float TickInterval, int32 NumTicks, AActor* Source);
+
+	/** 立即移除目标的所有效果并恢复移动速度 */
+	void RemoveAllEffects(const FElementalStatusTargetHandle& Handle);
+
+	/** 目标身上某类效果的层数 */
+	int32 GetNumEffects(const FElementalStatusTargetHandle& Handle, EElementalStatusEffectType Type) const;
+
+	/** 所有目标身上的效果总数 */
+	int32 GetNumActiveEffects() const { return EffectTargets.Num(); }
+
+	/** 获取效果类型的叠加规则 */
+	const FElementalStatusStackingRule& GetStackingRule(EElementalStatusEffectType Type) const;
+
+	/** 设置效果类型的叠加规则（只影响之后施加的效果） */
+	void SetStackingRule(EElementalStatusEffectType Type, const FElementalStatusStackingRule& Rule);
+
+	// === 更新 ===
+
+	/** 推进所有效果（Tick中调用，测试可直接调用） */
+	void Advance(float DeltaTime);
+
+	/** 子系统时钟（秒） */
+	double GetTime() const { return Clock; }
+
+	/** 上一次推进的耗时（微秒） */
+	double GetLastAdvanceMicroseconds() const { return LastAdvanceMicroseconds; }
+
+	/** 累计结算的燃烧伤害（包括没有实现ICombatDamageable的目标） */
+	double GetTotalDamageResolved() const { return TotalDamageResolved; }
+
+protected:
+	/** 效果数量达到该值时并行推进 */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|Combat|Elemental", meta = (ClampMin = "1"))
+	int32 ParallelMinBatchSize = 512;
+
+	/** 各效果类型的叠加规则（默认与原先组件定时器的行为一致：后施加的替换先施加的） */
+	UPROPERTY(Config, EditAnywhere, Category = "ElementalCombat|Combat|Elemental")
+	FElementalStatusStackingRule StackingRules[static_cast<int32>(EElementalStatusEffectType::Count)];
+
+private:
+	/** 一次伤害结算 */
+	struct FPendingDamage
+	{
+		int32 TargetIndex = INDEX_NONE;
+		uint32 TargetSerial = 0;
+		float Damage = 0.0f;
+		TWeakObjectPtr<AActor> Source;
+	};
+
+	/** 添加效果并按叠加规则处理已有效果 */
+	void AddEffect(int32 TargetIndex, EElementalStatusEffectType Type, float Magnitude, float TickInterval, int32 NumTicks, AActor* Source);
+
+	/** 写入效果槽位 */
+	void WriteEffect(int32 EffectIndex, int32 TargetIndex, EElementalStatusEffectType Type, float Magnitude, float TickInterval, int32 NumTicks, AActor* Source);
+
+	/** 移除效果（与最后一个交换） */
+	void RemoveEffectAtSwap(int32 EffectIndex);
+
+	/** 移除目标的所有效果 */
+	void RemoveTargetEffects(int32 TargetIndex);
+
+	/** 计算效果本帧触发的次数和伤害（只写自己的槽位，可并行） */
+	void AdvanceEffect(int32 EffectIndex);
+
+	/** 释放目标槽位（调用前需移除其所有效果） */
+	void ReleaseTarget(int32 TargetIndex);
+
+	/** 重新计算目标的减速并在变化时写入移动组件 */
+	void ApplySlowToTarget(int32 TargetIndex);
+
+	/** 目标的效果数量变化后同步组件上的状态标记 */
+	void SyncTargetFlags(int32 TargetIndex);
+
+	/** 是否并行推进 */
+	bool ShouldAdvanceInParallel() const;
+
+	// === 按效果排列的数据（结构数组布局，移除时与最后一个交换） ===
+
+	TArray<int32> EffectTargets;
+	TArray<EElementalStatusEffectType> EffectTypes;
+	TArray<float> EffectMagnitudes;
+	TArray<double> EffectNextTickTimes;
+	TArray<float> EffectTickIntervals;
+	TArray<int32> EffectRemainingTicks;
+	TArray<TWeakObjectPtr<AActor>> EffectSources;
+
+	/** 本帧触发的伤害（推进时写入，只在汇总前有效） */
+	TArray<float> EffectDueDamage;
+
+	// === 按槽位排列的目标数据 ===
+
+	TArray<TWeakObjectPtr<UElementalComponent>> TargetComponents;
+	TArray<uint32> TargetSerials;
+	TArray<int32> FreeTargetIndices;
+
+	/** 目标身上的效果下标 */
+	TArray<TArray<int32, TInlineAllocator<4>>> TargetEffects;
+
+	/** 当前写入移动组件的减速比例（0表示没有减速） */
+	TArray<float> TargetAppliedSlows;
+
+	/** 减速前的移动速度 */
+	TArray<float> TargetBaseWalkSpeeds;
+
+	/** 本帧的伤害汇总 */
+	TArray<float> TargetPendingDamage;
+
+	/** 本帧贡献最大的伤害效果下标 */
+	TArray<int32> TargetDamageSources;
+
+	/** 本帧需要结算的目标（复用） */
+	TArray<int32> DamagedTargets;
+
+	/** 本帧效果有变化的目标（复用，可能重复） */
+	TArray<int32> ChangedTargets;
+
+	/** 伤害结算列表（复用，在所有数组更新完成后才调用伤害接口） */
+	TArray<FPendingDamage> PendingDamage;
+
+	/** 下一个分配序号 */
+	uint32 NextSerial = 1;
+
+	/** 当前注册的目标数量 */
+	int32 NumTargets = 0;
+
+	/** 子系统时钟（秒），由Tick累加 */
+	double Clock = 0.0;
+
+	/** 上一次推进的耗时（微秒） */
+	double LastAdvanceMicroseconds = 0.0;
+
+	/** 累计结算的燃烧伤害 */
+	double TotalDamageResolved = 0.0;
+};
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include <type_traits>
 #include "ElementalTypes.generated.h"
 
 // Forward declaration
@@ -27,6 +28,7 @@ enum class EElementalType : uint8
 /**
  * 元素效果数据结构
  * 包含所有元素的效果参数，通过蓝图配置
+ * 运行时按用途拆分为FElementalEffectParams（数值）和FElementalPresentationData（表现）
  */
 USTRUCT(BlueprintType)
 struct ELEMENTALCOMBAT_API FElementalEffectData
@@ -95,6 +97,146 @@ struct ELEMENTALCOMBAT_API FElementalEffectData
 	FText EffectDescription;
 };
 
+/**
+ * 元素效果数值参数（热数据）
+ * 只包含伤害和状态效果计算需要的数值，可按位复制，供命中、DOT等每次结算都会访问的路径使用。
+ * 可从FElementalEffectData隐式构造，已有按完整效果数据调用的代码无需修改
+ */
+USTRUCT(BlueprintType)
+struct ELEMENTALCOMBAT_API FElementalEffectParams
+{
+	GENERATED_BODY()
+
+	FElementalEffectParams() = default;
+
+	FElementalEffectParams(const FElementalEffectData& Data)
+		: Element(Data.Element)
+		, DamageMultiplier(Data.DamageMultiplier)
+		, LifeStealPercentage(Data.LifeStealPercentage)
+		, SlowPercentage(Data.SlowPercentage)
+		, SlowDuration(Data.SlowDuration)
+		, DotDamage(Data.DotDamage)
+		, DotTickInterval(Data.DotTickInterval)
+		, DotDuration(Data.DotDuration)
+		, DamageReduction(Data.DamageReduction)
+	{
+	}
+
+	// 元素类型标识
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental")
+	EElementalType Element = EElementalType::None;
+
+	// 伤害倍率
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental", meta = (ClampMin = "0.0"))
+	float DamageMultiplier = 1.0f;
+
+	// 吸血比例
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float LifeStealPercentage = 0.0f;
+
+	// 减速比例和持续时间
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float SlowPercentage = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental", meta = (ClampMin = "0.0"))
+	float SlowDuration = 0.0f;
+
+	// DOT伤害
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental", meta = (ClampMin = "0.0"))
+	float DotDamage = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental", meta = (ClampMin = "0.1"))
+	float DotTickInterval = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental", meta = (ClampMin = "0.0"))
+	float DotDuration = 0.0f;
+
+	// 减伤比例
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float DamageReduction = 0.0f;
+};
+
+static_assert(std::is_trivially_copyable_v<FElementalEffectParams>, "FElementalEffectParams必须可按位复制");
+
+/**
+ * 元素表现数据（冷数据）
+ * 只有界面显示和生成投掷物时使用
+ */
+USTRUCT(BlueprintType)
+struct ELEMENTALCOMBAT_API FElementalPresentationData
+{
+	GENERATED_BODY()
+
+	FElementalPresentationData() = default;
+
+	explicit FElementalPresentationData(const FElementalEffectData& Data)
+		: ProjectileClass(Data.ProjectileClass)
+		, ElementColor(Data.ElementColor)
+		, EffectDescription(Data.EffectDescription)
+	{
+	}
+
+	// 投掷物类
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental")
+	UClass* ProjectileClass = nullptr;
+
+	// 元素代表颜色
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental")
+	FLinearColor ElementColor = FLinearColor::White;
+
+	// 元素伤害效果描述
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ElementalCombat|Combat|Elemental", meta = (MultiLine = "true"))
+	FText EffectDescription;
+};
+
+/**
+ * 元素效果覆盖数据
+ * 组件覆盖某个元素时保存的数值参数和表现数据，需要完整效果数据时再组合
+ */
+USTRUCT(BlueprintType)
+struct ELEMENTALCOMBAT_API FElementalEffectOverride
+{
+	GENERATED_BODY()
+
+	FElementalEffectOverride() = default;
+
+	explicit FElementalEffectOverride(const FElementalEffectData& Data)
+		: Params(Data)
+		, Presentation(Data)
+	{
+	}
+
+	/** 组合成完整的效果数据 */
+	FElementalEffectData ToEffectData() const { return MakeEffectData(Params, Presentation); }
+
+	/** 由数值参数和表现数据组合完整的效果数据（蓝图接口按需调用） */
+	static FElementalEffectData MakeEffectData(const FElementalEffectParams& InParams, const FElementalPresentationData& InPresentation)
+	{
+		FElementalEffectData Data;
+		Data.Element = InParams.Element;
+		Data.DamageMultiplier = InParams.DamageMultiplier;
+		Data.LifeStealPercentage = InParams.LifeStealPercentage;
+		Data.SlowPercentage = InParams.SlowPercentage;
+		Data.SlowDuration = InParams.SlowDuration;
+		Data.DotDamage = InParams.DotDamage;
+		Data.DotTickInterval = InParams.DotTickInterval;
+		Data.DotDuration = InParams.DotDuration;
+		Data.DamageReduction = InParams.DamageReduction;
+		Data.ProjectileClass = InPresentation.ProjectileClass;
+		Data.ElementColor = InPresentation.ElementColor;
+		Data.EffectDescription = InPresentation.EffectDescription;
+		return Data;
+	}
+
+	// 数值参数
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "ElementalCombat|Combat|Elemental")
+	FElementalEffectParams Params;
+
+	// 表现数据
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "ElementalCombat|Combat|Elemental")
+	FElementalPresentationData Presentation;
+};
+
 /**
  * 元素相克数据
  * 定义某个元素克制的目标元素和效果倍率
@@ -5,12 +5,11 @@
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Kismet/GameplayStatics.h"
-#include "Engine/DamageEvents.h"
-#include "Variant_Combat/Interfaces/CombatDamageable.h"
 #include "NiagaraFunctionLibrary.h"
 #include "NiagaraComponent.h"
 #include "Combat/Elemental/ElementalComponent.h"
 #include "Combat/Elemental/ElementalTypes.h"
+#include "Combat/CombatDamageSubsystem.h"
 
 ACombatProjectile::ACombatProjectile()
 {
@@ -174,8 +173,8 @@ void ACombatProjectile::ApplyDamageToTarget(AActor* Target, const FHitResult& Hi
 {
 	if (!Target) return;
 
-	// 获取发射者的元素组件（如果有）
-	FElementalEffectData AttackerEffectData;
+	// 获取发射者的元素组件（如果有），只复制伤害结算需要的数值参数
+	FElementalEffectParams AttackerEffectData;
 	bool bHasElementalData = false;
 
 	if (AActor* MyOwner = GetOwner())
@@ -183,7 +182,7 @@ void ACombatProjectile::ApplyDamageToTarget(AActor* Target, const FHitResult& Hi
 		if (UElementalComponent* OwnerElemental = MyOwner->FindComponentByClass<UElementalComponent>())
 		{
 			EElementalType OwnerElement = OwnerElemental->GetCurrentElement();
-			bHasElementalData = OwnerElemental->GetElementEffectData(OwnerElement, AttackerEffectData);
+			bHasElementalData = OwnerElemental->GetElementEffectParams(OwnerElement, AttackerEffectData);
 
 			if (bHasElementalData)
 			{
@@ -223,23 +222,13 @@ void ACombatProjectile::ApplyDamageToTarget(AActor* Target, const FHitResult& Hi
 			*Target->GetName());
 	}
 
-	// 应用最终伤害
-	if (ICombatDamageable* DamageableTarget = Cast<ICombatDamageable>(Target))
-	{
-		// 计算击退方向和力度
-		FVector ImpactDirection = ProjectileMovement->Velocity.GetSafeNormal();
-		float ImpactForce = 250.0f * DamageMultiplier; // 基础击退力 * 伤害倍率
-		FVector DamageImpulse = ImpactDirection * ImpactForce;
+	// 计算击退方向和力度
+	FVector ImpactDirection = ProjectileMovement->Velocity.GetSafeNormal();
+	float ImpactForce = 250.0f * DamageMultiplier; // 基础击退力 * 伤害倍率
+	FVector DamageImpulse = ImpactDirection * ImpactForce;
 
-		// 通过接口应用伤害
-		DamageableTarget->ApplyDamage(FinalDamage, this, Hit.Location, DamageImpulse);
-	}
-	else
-	{
-		// 使用标准伤害系统
-		FDamageEvent DamageEvent;
-		Target->TakeDamage(FinalDamage, DamageEvent, nullptr, this);
-	}
+	// 最终伤害进入伤害队列，同一帧内对同一目标的多次命中合并结算
+	UCombatDamageSubsystem::ApplyDamage(Target, FinalDamage, this, Hit.Location, DamageImpulse);
 }
 
 void ACombatProjectile::SetProjectileConfig(const FProjectileConfig& NewConfig)
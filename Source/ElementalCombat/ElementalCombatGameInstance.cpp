@@ -5,6 +5,7 @@
 #include "Combat/Elemental/ElementalConfigManager.h"
 #include "Combat/Elemental/DefaultElementalDataAsset.h"
 #include "AI/Utility/UtilityAITypes.h"
+#include "AI/Utility/UtilityProfileRegistry.h"
 
 UElementalCombatGameInstance::UElementalCombatGameInstance()
 {
@@ -39,6 +40,12 @@ void UElementalCombatGameInstance::Init()
 		ConfigManager->SetElementalDataAsset(DefaultElementalDataAssetInstance);
 		UE_LOG(LogTemp, Warning, TEXT("未配置DefaultElementalDataAssetClass，使用内置默认配置"));
 	}
+
+	// 一次性加载AI配置表，之后所有AI共享注册表中的不可变配置
+	if (UUtilityProfileRegistry* ProfileRegistry = GetSubsystem<UUtilityProfileRegistry>())
+	{
+		ProfileRegistry->LoadFromDataTable(AIProfileDataTable);
+	}
 }
 
 void UElementalCombatGameInstance::SetDefaultElementalDataAsset(UElementalDataAsset* NewDataAsset)
@@ -56,37 +63,32 @@ void UElementalCombatGameInstance::SetDefaultElementalDataAsset(UElementalDataAs
 
 FUtilityProfile UElementalCombatGameInstance::GetRandomAIProfile() const
 {
+	const FUtilityProfileHandle Handle = GetRandomAIProfileHandle();
+	return Handle.IsValid() ? Handle.GetProfile() : FUtilityProfile();
+}
+
+FUtilityProfileHandle UElementalCombatGameInstance::GetRandomAIProfileHandle() const
+{
+	UUtilityProfileRegistry* ProfileRegistry = GetSubsystem<UUtilityProfileRegistry>();
+	if (!ProfileRegistry)
+	{
+		return FUtilityProfileHandle(FSharedUtilityProfile::Create(FUtilityProfile()));
+	}
+
 	if (!AIProfileDataTable)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("AI配置数据表未设置，使用默认配置"));
-		return FUtilityProfile(); // 返回默认配置
+		return ProfileRegistry->RegisterProfile(FUtilityProfile()); // 返回默认配置
 	}
 
-	// 获取数据表中的所有行名
-	TArray<FName> AllRowNames = AIProfileDataTable->GetRowNames();
-	if (AllRowNames.Num() == 0)
+	if (ProfileRegistry->GetNumRows() == 0)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("AI配置数据表为空，使用默认配置"));
-		return FUtilityProfile(); // 返回默认配置
+		return ProfileRegistry->RegisterProfile(FUtilityProfile()); // 返回默认配置
 	}
 
-	// 随机选择一行
-	int32 RandomIndex = FMath::RandRange(0, AllRowNames.Num() - 1);
-	FName SelectedRowName = AllRowNames[RandomIndex];
-
-	// 获取选中行的数据
-	FUtilityProfileTableRow* ProfileRow = AIProfileDataTable->FindRow<FUtilityProfileTableRow>(
-		SelectedRowName, TEXT("GetRandomAIProfile"));
-
-	if (ProfileRow)
-	{
-		UE_LOG(LogTemp, Log, TEXT("随机选择AI配置: %s (%s)"), 
-			   *SelectedRowName.ToString(), *ProfileRow->Profile.ProfileName);
-		return ProfileRow->Profile;
-	}
-	else
-	{
-		UE_LOG(LogTemp, Error, TEXT("无法加载AI配置行: %s"), *SelectedRowName.ToString());
-		return FUtilityProfile(); // 返回默认配置
-	}
-}
\ No newline at end of file
+	// 随机选择一行（注册表中按行保存句柄，不再逐次获取行名和按名查表）
+	FUtilityProfileHandle Handle = ProfileRegistry->GetRandomProfile();
+	UE_LOG(LogTemp, Verbose, TEXT("随机选择AI配置: %s"), *Handle.GetProfile().ProfileName);
+	return Handle;
+}
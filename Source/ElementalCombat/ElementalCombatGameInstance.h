@@ -10,6 +10,7 @@
 class UElementalDataAsset;
 class UElementalConfigManager;
 struct FUtilityProfile;
+struct FUtilityProfileHandle;
 
 /**
  * 元素战斗游戏实例
@@ -60,4 +61,10 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category="AI Configuration")
 	FUtilityProfile GetRandomAIProfile() const;
+
+	/**
+	 * 从配置注册表中随机获取一个共享AI配置（不复制配置文件）
+	 * @return 随机选择的AI配置句柄，如果表为空返回共享的默认配置
+	 */
+	FUtilityProfileHandle GetRandomAIProfileHandle() const;
 };
\ No newline at end of file
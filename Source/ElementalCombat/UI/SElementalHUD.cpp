@@ -159,7 +159,7 @@ FLinearColor SElementalHUD::GetElementDisplayColor(EElementalType Element) const
 		return FLinearColor::White;
 	}
 
-	const FElementalEffectData* ElementData = ElementalComponentRef->GetElementEffectDataPtr(Element);
+	const FElementalPresentationData* ElementData = ElementalComponentRef->GetElementPresentationPtr(Element);
 	if (ElementData)
 	{
 		return ElementData->ElementColor;
@@ -191,7 +191,7 @@ FText SElementalHUD::GetCurrentElementDescription() const
 	}
 
 	EElementalType CurrentElement = ElementalComponentRef->GetCurrentElement();
-	const FElementalEffectData* ElementData = ElementalComponentRef->GetElementEffectDataPtr(CurrentElement);
+	const FElementalPresentationData* ElementData = ElementalComponentRef->GetElementPresentationPtr(CurrentElement);
 
 	if (ElementData && !ElementData->EffectDescription.IsEmpty())
 	{
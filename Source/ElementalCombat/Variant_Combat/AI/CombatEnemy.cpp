@@ -8,6 +8,7 @@
 #include "Components/WidgetComponent.h"
 #include "Engine/DamageEvents.h"
 #include "CombatLifeBar.h"
+#include "CombatDamageSubsystem.h"
 #include "TimerManager.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Animation/AnimInstance.h"
@@ -143,16 +144,13 @@ void ACombatEnemy::DoAttackTrace(FName DamageSourceBone)
 			if (CurrentHit.GetActor()->ActorHasTag(FName("Player")))
 			{
 				// check if the actor is damageable
-				ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
-
-				if (Damageable)
+				if (Cast<ICombatDamageable>(CurrentHit.GetActor()))
 				{
 					// knock upwards and away from the impact normal
 					const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
 
-					// pass the damage event to the actor
-					Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
-
+					// queue the damage event; hits on the same actor this frame are resolved together
+					UCombatDamageSubsystem::ApplyDamage(CurrentHit.GetActor(), MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
 				}
 			}
 		}
@@ -11,6 +11,7 @@
 #include "EnhancedInputSubsystems.h"
 #include "EnhancedInputComponent.h"
 #include "CombatLifeBar.h"
+#include "CombatDamageSubsystem.h"
 #include "Engine/DamageEvents.h"
 #include "TimerManager.h"
 #include "Engine/LocalPlayer.h"
@@ -268,15 +269,13 @@ void ACombatCharacter::DoAttackTrace(FName DamageSourceBone)
 		for (const FHitResult& CurrentHit : OutHits)
 		{
 			// check if we've hit a damageable actor
-			ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
-
-			if (Damageable)
+			if (Cast<ICombatDamageable>(CurrentHit.GetActor()))
 			{
 				// knock upwards and away from the impact normal
 				const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
 
-				// pass the damage event to the actor
-				Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+				// queue the damage event; hits on the same actor this frame are resolved together
+				UCombatDamageSubsystem::ApplyDamage(CurrentHit.GetActor(), MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
 
 				// call the BP handler to play effects, etc.
 				DealtDamage(MeleeDamage, CurrentHit.ImpactPoint);
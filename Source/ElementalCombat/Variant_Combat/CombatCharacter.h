@@ -306,4 +306,10 @@ public:
 
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
+
+	/** Returns the character's current HP **/
+	FORCEINLINE float GetCurrentHP() const { return CurrentHP; }
+
+	/** Returns the character's max HP **/
+	FORCEINLINE float GetMaxHP() const { return MaxHP; }
 };
@@ -22,7 +22,9 @@ public class ElementalCombatTests : ModuleRules
 
 			// 测试框架和编辑器功能私有依赖
 			PrivateDependencyModuleNames.AddRange(new string[] {
-				"UnrealEd"
+				"UnrealEd",
+				"StateTreeEditorModule",  // 在测试中编译StateTree
+				"Json"  // 基准测试结果输出和基线比较
 			});
 		}
 		
@@ -0,0 +1,40 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StateTreeSchema.h"
+#include "AIController.h"
+#include "AI/ElementalCombatEnemy.h"
+#include "ElementalStateTreeTestSchema.generated.h"
+
+/**
+ * 测试用StateTree架构
+ * 提供元素战斗任务需要的上下文（敌人角色和AI控制器），用于在测试中编译并执行包含元素战斗任务的StateTree
+ */
+UCLASS(HideDropdown)
+class UElementalStateTreeTestSchema : public UStateTreeSchema
+{
+    GENERATED_BODY()
+
+public:
+    /** 上下文数据名称 */
+    static inline const FName EnemyContextName = TEXT("Enemy");
+    static inline const FName AIControllerContextName = TEXT("AIController");
+
+    UElementalStateTreeTestSchema()
+    {
+        ContextDataDescs.Emplace(EnemyContextName, AElementalCombatEnemy::StaticClass(), FGuid(0x5A1E4C01, 0x3B7D4F22, 0x9C1A0E55, 0x71D2B301));
+        ContextDataDescs.Emplace(AIControllerContextName, AAIController::StaticClass(), FGuid(0x5A1E4C02, 0x3B7D4F22, 0x9C1A0E55, 0x71D2B302));
+    }
+
+    virtual bool IsStructAllowed(const UScriptStruct* InScriptStruct) const override { return true; }
+    virtual bool IsClassAllowed(const UClass* InClass) const override { return true; }
+    virtual bool IsExternalItemAllowed(const UStruct& InStruct) const override { return true; }
+    virtual TConstArrayView<FStateTreeExternalDataDesc> GetContextDataDescs() const override { return ContextDataDescs; }
+
+protected:
+    /** 上下文数据描述 */
+    UPROPERTY()
+    TArray<FStateTreeExternalDataDesc> ContextDataDescs;
+};
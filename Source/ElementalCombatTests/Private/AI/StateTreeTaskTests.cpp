@@ -4,13 +4,39 @@
 #include "Misc/AutomationTest.h"
 #include "AI/StateTreeTasks/ElementalStateTreeTaskBase.h"
 #include "AI/StateTreeTasks/StateTreeUtilityTasks.h"
+#include "AI/StateTreeTasks/StateTreeSmartTasks.h"
+#include "AI/StateTreeTasks/ElementalTaskStatusLibrary.h"
 #include "AI/ElementalCombatEnemy.h"
 #include "AI/ElementalCombatAIController.h"
+#include "AI/PlayerSnapshotSubsystem.h"
+#include "AI/EQSResultCacheSubsystem.h"
+#include "AI/AILODSubsystem.h"
+#include "BrainComponent.h"
+#include "EnvironmentQuery/EnvQuery.h"
+#include "EnvironmentQuery/EnvQueryTypes.h"
+#include "EnvironmentQuery/Items/EnvQueryItemType_Point.h"
+#include "EnvironmentQuery/EnvQueryOption.h"
+#include "EnvironmentQuery/EnvQueryManager.h"
+#include "EnvironmentQuery/Generators/EnvQueryGenerator_CurrentLocation.h"
 #include "Engine/World.h"
 #include "Engine/DataTable.h"
 #include "GameFramework/Pawn.h"
 #include "AI/Utility/UtilityAITypes.h"
+#include "AI/Utility/UtilityProfileRegistry.h"
 #include "StructView.h"
+#include "StructUtils/InstancedStruct.h"
+#include "StateTree.h"
+#include "StateTreeEditorData.h"
+#include "StateTreeCompiler.h"
+#include "StateTreeCompilerLog.h"
+#include "StateTreeExecutionContext.h"
+#include "StateTreeInstanceData.h"
+#include "AI/ElementalStateTreeTestSchema.h"
+#include "AI/Utility/UtilityAISubsystem.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
+#include <atomic>
 
 // === Test Helper Namespace ===
 namespace ElementalCombat::Tests
@@ -98,6 +124,16 @@ namespace ElementalCombat::Tests
 
 // === StateTree任务基础功能测试 ===
 
+namespace ElementalCombat::Tests
+{
+    /** 暴露受保护的评分接口，便于直接测试实例缓存 */
+    struct FUtilityCacheTestTask : public FElementalStateTreeTaskBase
+    {
+        using FElementalStateTreeTaskBase::CalculateUtilityScoreWithCache;
+        using FElementalStateTreeTaskBase::CalculateUtilityScoreDirect;
+    };
+}
+
 /**
  * 测试ElementalStateTreeTaskBase的缓存功能
  */
@@ -109,14 +145,31 @@ bool FStateTreeTaskCacheTest::RunTest(const FString& Parameters)
 {
     using namespace ElementalCombat::Tests;
 
-    // Arrange - 创建测试任务
-    FElementalStateTreeTaskBase TaskBase;
+    // Arrange - 创建测试任务和两个实例
+    FUtilityCacheTestTask TaskBase;
+    FElementalStateTreeInstanceDataBase InstanceA;
+    FElementalStateTreeInstanceDataBase InstanceB;
+    const FUtilityProfileHandle Profile(FSharedUtilityProfile::Create(FStateTreeTestHelpers::CreateTestUtilityProfile()));
+
+    FUtilityContext UtilityContext;
+    UtilityContext.DistanceToTarget = 500.0f;
+    UtilityContext.HealthPercent = 0.8f;
+
+    // Act - 同一实例评分两次
+    const float FirstScore = TaskBase.CalculateUtilityScoreWithCache(InstanceA, Profile, UtilityContext);
+    const float SecondScore = TaskBase.CalculateUtilityScoreWithCache(InstanceA, Profile, UtilityContext);
+
+    // Assert - 缓存保存在实例数据中，实例之间互不影响
+    TestEqual(TEXT("Cached score should match the first score"), SecondScore, FirstScore);
+    TestEqual(TEXT("Instance A should record one hit"), InstanceA.UtilityScoreCache.GetStats().Hits, static_cast<uint64>(1));
+    TestEqual(TEXT("Instance B cache should be untouched"), InstanceB.UtilityScoreCache.GetStats().NumEntries, 0);
 
     // 测试缓存清理功能
-    TaskBase.ClearAllCaches();
+    TaskBase.ClearAllCaches(InstanceA);
+    TestEqual(TEXT("ClearAllCaches should empty the instance cache"), InstanceA.UtilityScoreCache.GetStats().NumEntries, 0);
 
     // 测试性能统计功能
-    FString CacheStats = TaskBase.GetPerformanceStats();
+    FString CacheStats = TaskBase.GetPerformanceStats(InstanceA);
     TestTrue(TEXT("Performance stats should be available"), !CacheStats.IsEmpty());
 
     return true;
@@ -150,9 +203,940 @@ bool FStateTreeUtilityContextTest::RunTest(const FString& Parameters)
         const FUtilityProfile& ProfileFromController = AIController->GetCurrentAIProfile();
         TestEqual(TEXT("Profile name should match"), ProfileFromController.ProfileName, TestProfile.ProfileName);
         TestTrue(TEXT("Profile should have considerations"), ProfileFromController.Considerations.Num() > 0);
+
+        // 已弃用的CurrentAIProfile属性在蓝图中通过getter解析共享句柄
+        const FUtilityProfile BlueprintProfile = AIController->GetCurrentAIProfileForBlueprint();
+        TestEqual(TEXT("Blueprint getter should resolve the shared profile"), BlueprintProfile.ProfileName, TestProfile.ProfileName);
+        TestEqual(TEXT("Blueprint getter should copy every consideration"), BlueprintProfile.Considerations.Num(), ProfileFromController.Considerations.Num());
+    }
+
+    // Cleanup
+    FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+
+    return true;
+}
+
+/**
+ * 测试AI控制器的每帧评分上下文快照：同一帧内只构建一次，目标切换或显式失效时重建
+ * 其他线程只读取游戏线程预构建的快照，快照缺失时返回nullptr且不触发采集
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStateTreeFrameUtilityContextTest,
+    "ElementalCombat.AI.StateTree.FrameUtilityContext",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FStateTreeFrameUtilityContextTest::RunTest(const FString& Parameters)
+{
+    using namespace ElementalCombat::Tests;
+
+    // Arrange
+    UWorld* TestWorld = FStateTreeTestHelpers::CreateTestWorld();
+    AddErrorIfFalse(TestWorld != nullptr, TEXT("Failed to create test world"));
+
+    AElementalCombatEnemy* TestEnemy = FStateTreeTestHelpers::CreateTestEnemyWithAI(TestWorld, FStateTreeTestHelpers::CreateTestUtilityProfile());
+    AElementalCombatEnemy* TargetA = TestWorld->SpawnActor<AElementalCombatEnemy>(FVector(500.0f, 0.0f, 0.0f), FRotator::ZeroRotator);
+    AElementalCombatEnemy* TargetB = TestWorld->SpawnActor<AElementalCombatEnemy>(FVector(300.0f, 0.0f, 0.0f), FRotator::ZeroRotator);
+    AElementalCombatAIController* AIController = TestEnemy ? Cast<AElementalCombatAIController>(TestEnemy->GetController()) : nullptr;
+    if (!AIController || !TargetA || !TargetB)
+    {
+        AddError(TEXT("Failed to create test enemy, controller or targets"));
+        FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+        return false;
+    }
+
+    TestEnemy->SetActorLocation(FVector::ZeroVector);
+    AIController->SetFocus(TargetA);
+
+    // Act - 同一帧内多次读取
+    const FUtilityContext* First = AIController->GetFrameUtilityContext();
+    const FUtilityContext* Second = AIController->GetFrameUtilityContext();
+
+    // Assert
+    TestTrue(TEXT("Snapshot should exist for a possessed enemy"), First != nullptr);
+    TestTrue(TEXT("Reads within a frame should share one snapshot"), First == Second);
+    if (!First)
+    {
+        FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+        return false;
+    }
+
+    const float InitialDistance = First->DistanceToTarget;
+    TestTrue(TEXT("Snapshot should target the focus actor"), First->TargetActor.Get() == TargetA);
+    TestEqual(TEXT("Snapshot distance should match"), InitialDistance, 500.0f, 1.0f);
+
+    // Act - 帧内移动目标，快照保持不变，失效后重建
+    TargetA->SetActorLocation(FVector(800.0f, 0.0f, 0.0f));
+    TestEqual(TEXT("Snapshot should not be rebuilt within a frame"), AIController->GetFrameUtilityContext()->DistanceToTarget, InitialDistance);
+
+    AIController->InvalidateFrameUtilityContext();
+    TestEqual(TEXT("Invalidated snapshot should be rebuilt"), AIController->GetFrameUtilityContext()->DistanceToTarget, 800.0f, 1.0f);
+
+    // Act - 帧内切换焦点时重建
+    AIController->SetFocus(TargetB);
+    const FUtilityContext* Switched = AIController->GetFrameUtilityContext();
+    TestTrue(TEXT("Snapshot should follow the new focus actor"), Switched->TargetActor.Get() == TargetB);
+    TestEqual(TEXT("Snapshot distance should follow the new focus actor"), Switched->DistanceToTarget, 300.0f, 1.0f);
+
+    // Act - 子系统使用的副本与快照一致
+    FUtilityContext Copy;
+    TestTrue(TEXT("BuildUtilityContext should succeed"), AIController->BuildUtilityContext(Copy));
+    TestEqual(TEXT("BuildUtilityContext should copy the snapshot"), Copy.DistanceToTarget, Switched->DistanceToTarget);
+
+    // Act - 快照失效后在工作线程上读取：不采集，返回nullptr
+    UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(TestWorld);
+    if (!SnapshotSubsystem)
+    {
+        AddError(TEXT("Failed to get player snapshot subsystem"));
+        FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+        return false;
+    }
+
+    const uint32 ProfileInputs = AIController->GetAIProfileRequiredInputs();
+    const uint32 ExtraInput = UtilityInputs::ThreatLevel;
+    TestEqual(TEXT("Test profile should not read the extra input"), ProfileInputs & ExtraInput, 0u);
+
+    auto ReadOnWorker = [AIController](uint32 RequiredInputs)
+    {
+        return Async(EAsyncExecution::ThreadPool, [AIController, RequiredInputs]()
+        {
+            return AIController->GetFrameUtilityContext(RequiredInputs);
+        }).Get();
+    };
+
+    AIController->InvalidateFrameUtilityContext();
+    SnapshotSubsystem->Invalidate();
+    const uint64 RefreshesBefore = SnapshotSubsystem->GetNumRefreshes();
+    const uint32 ComputedBefore = AIController->GetFrameUtilityComputedInputs();
+    TestTrue(TEXT("Worker read without a prepared snapshot should return null"), ReadOnWorker(ProfileInputs) == nullptr);
+    TestEqual(TEXT("Worker read should not collect inputs"), AIController->GetFrameUtilityComputedInputs(), ComputedBefore);
+    TestEqual(TEXT("Worker read should not refresh the player snapshot"), SnapshotSubsystem->GetNumRefreshes(), RefreshesBefore);
+
+    // Act - 游戏线程发布本帧快照后，工作线程读取预构建的快照
+    SnapshotSubsystem->PrepareFrame();
+    TestEqual(TEXT("Publishing should refresh the player snapshot once"), SnapshotSubsystem->GetNumRefreshes(), RefreshesBefore + 1);
+    const FUtilityContext* Prepared = ReadOnWorker(ProfileInputs);
+    TestTrue(TEXT("Worker read should return the prepared snapshot"), Prepared != nullptr);
+    TestTrue(TEXT("Prepared snapshot should target the focus actor"), Prepared && Prepared->TargetActor.Get() == TargetB);
+
+    // Act - 工作线程请求预构建未包含的输入：本次返回nullptr，下一次发布时一并采集
+    TestTrue(TEXT("Worker read of an uncollected input should return null"), ReadOnWorker(ProfileInputs | ExtraInput) == nullptr);
+    TestEqual(TEXT("Worker read should not collect the missing input"), AIController->GetFrameUtilityComputedInputs() & ExtraInput, 0u);
+    SnapshotSubsystem->PrepareFrame();
+    TestTrue(TEXT("Requested input should be collected on the next publish"), ReadOnWorker(ProfileInputs | ExtraInput) != nullptr);
+
+    // Cleanup
+    FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+
+    return true;
+}
+
+/**
+ * 测试玩家快照子系统：每帧采集一次，批量结果与逐个计算一致
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayerSnapshotSubsystemTest,
+    "ElementalCombat.AI.StateTree.PlayerSnapshot",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FPlayerSnapshotSubsystemTest::RunTest(const FString& Parameters)
+{
+    using namespace ElementalCombat::Tests;
+
+    // Arrange
+    UWorld* TestWorld = FStateTreeTestHelpers::CreateTestWorld();
+    AddErrorIfFalse(TestWorld != nullptr, TEXT("Failed to create test world"));
+
+    UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(TestWorld);
+    AElementalCombatEnemy* TestEnemy = FStateTreeTestHelpers::CreateTestEnemyWithAI(TestWorld, FStateTreeTestHelpers::CreateTestUtilityProfile());
+    AElementalCombatEnemy* FakePlayer = TestWorld->SpawnActor<AElementalCombatEnemy>(FVector(300.0f, 400.0f, 100.0f), FRotator::ZeroRotator);
+    AElementalCombatEnemy* FacingAgent = TestWorld->SpawnActor<AElementalCombatEnemy>(FVector(-200.0f, 400.0f, 100.0f), FRotator::ZeroRotator);
+    AElementalCombatAIController* AIController = TestEnemy ? Cast<AElementalCombatAIController>(TestEnemy->GetController()) : nullptr;
+    if (!SnapshotSubsystem || !AIController || !FakePlayer || !FacingAgent)
+    {
+        AddError(TEXT("Failed to create snapshot subsystem, test enemy or fake player"));
+        FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+        return false;
+    }
+
+    TestEnemy->SetActorLocationAndRotation(FVector::ZeroVector, FRotator::ZeroRotator);
+    SnapshotSubsystem->SetTrackedPlayer(FakePlayer);
+    FPlayerSnapshotAgentHandle FacingHandle = SnapshotSubsystem->RegisterAgent(FacingAgent);
+
+    // Act
+    const uint64 RefreshesBefore = SnapshotSubsystem->GetNumRefreshes();
+    FPlayerRelativeInfo EnemyInfo;
+    FPlayerRelativeInfo FacingInfo;
+    const bool bEnemyFound = SnapshotSubsystem->GetRelativeInfo(AIController->GetPlayerSnapshotHandle(), EnemyInfo);
+    const bool bFacingFound = SnapshotSubsystem->GetRelativeInfo(FacingHandle, FacingInfo);
+    const FPlayerSnapshot& Snapshot = SnapshotSubsystem->GetPlayerSnapshot();
+
+    // Assert - 同一帧内只采集一次
+    TestTrue(TEXT("Possessed enemy should be registered"), bEnemyFound);
+    TestTrue(TEXT("Manually registered agent should be found"), bFacingFound);
+    TestEqual(TEXT("Reads within a frame should share one refresh"), SnapshotSubsystem->GetNumRefreshes(), RefreshesBefore + 1);
+    TestTrue(TEXT("Snapshot should track the overridden player"), Snapshot.bIsValid && Snapshot.Player.Get() == FakePlayer);
+
+    // Assert - 与逐个计算的结果一致
+    const FVector ToPlayer = FakePlayer->GetActorLocation() - TestEnemy->GetActorLocation();
+    const float ExpectedAngle = FMath::RadiansToDegrees(FMath::Acos(FVector::DotProduct(FVector::ForwardVector, FVector(ToPlayer.X, ToPlayer.Y, 0.0f).GetSafeNormal())));
+    TestEqual(TEXT("Distance should match brute force"), EnemyInfo.Distance, static_cast<float>(ToPlayer.Size()), 0.01f);
+    TestEqual(TEXT("Horizontal distance should match brute force"), EnemyInfo.HorizontalDistance, 500.0f, 0.01f);
+    TestEqual(TEXT("Height difference should match brute force"), EnemyInfo.HeightDifference, 100.0f, 0.01f);
+    TestEqual(TEXT("Horizontal angle should match brute force"), EnemyInfo.HorizontalAngle, ExpectedAngle, 0.01f);
+    TestEqual(TEXT("Agent facing the player should have zero angle"), FacingInfo.HorizontalAngle, 0.0f, 0.01f);
+    TestEqual(TEXT("Enemy distance helper should read the snapshot"), TestEnemy->GetDistanceToTarget(), EnemyInfo.Distance, 0.01f);
+
+    // Act - 帧内移动玩家，失效后重新采集
+    FakePlayer->SetActorLocation(FVector(-300.0f, 0.0f, 0.0f));
+    SnapshotSubsystem->Invalidate();
+    SnapshotSubsystem->GetRelativeInfo(AIController->GetPlayerSnapshotHandle(), EnemyInfo);
+    TestEqual(TEXT("Player behind the enemy should have 180 degree angle"), EnemyInfo.HorizontalAngle, 180.0f, 0.01f);
+    TestEqual(TEXT("Distance should follow the moved player"), EnemyInfo.Distance, 300.0f, 0.01f);
+
+    // Act - 注销后旧句柄失效，槽位复用不会混淆
+    const FPlayerSnapshotAgentHandle StaleHandle = FacingHandle;
+    SnapshotSubsystem->UnregisterAgent(FacingHandle);
+    FPlayerSnapshotAgentHandle ReusedHandle = SnapshotSubsystem->RegisterAgent(FacingAgent);
+    TestFalse(TEXT("Stale handle should be rejected"), SnapshotSubsystem->GetRelativeInfo(StaleHandle, FacingInfo));
+    TestTrue(TEXT("Reused slot should get a new handle"), SnapshotSubsystem->IsAgentValid(ReusedHandle));
+
+    // Cleanup
+    SnapshotSubsystem->UnregisterAgent(ReusedHandle);
+    SnapshotSubsystem->SetTrackedPlayer(nullptr);
+    FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+
+    return true;
+}
+
+/**
+ * 测试异步EQS请求状态：查询期间保留上次结果，失败不覆盖结果，被替换的请求回调失效
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStateTreeAsyncEQSRequestTest,
+    "ElementalCombat.AI.StateTree.AsyncEQSRequest",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FStateTreeAsyncEQSRequestTest::RunTest(const FString& Parameters)
+{
+    // 构造包含给定位置的成功查询结果
+    auto MakeLocationResult = [](const TArray<FVector>& Locations)
+    {
+        TSharedPtr<FEnvQueryResult> Result = MakeShared<FEnvQueryResult>(EEnvQueryStatus::Success);
+        Result->ItemType = UEnvQueryItemType_Point::StaticClass();
+        const int32 ValueSize = GetDefault<UEnvQueryItemType_Point>()->GetValueSize();
+        Result->RawData.AddZeroed(ValueSize * Locations.Num());
+        for (int32 i = 0; i < Locations.Num(); ++i)
+        {
+            Result->Items.Add(FEnvQueryItem(1.0f, i * ValueSize));
+            UEnvQueryItemType_Point::SetValue(Result->RawData.GetData() + i * ValueSize, FNavLocation(Locations[i]));
+        }
+        return Result;
+    };
+
+    // Arrange
+    FElementalEQSRequestState RequestState;
+    TestFalse(TEXT("New state should have no result"), RequestState.HasResult());
+    TestFalse(TEXT("New state should have no request in flight"), RequestState.IsInFlight());
+
+    // Act - 查询尚未结束
+    FQueryFinishedSignature FirstDelegate = RequestState.MakeCompletionDelegate(11);
+    RequestState.RequestID = 1;
+    TestFalse(TEXT("Unfinished query should not produce a result"), RequestState.ConsumeCompletedQuery(1.0f));
+    TestTrue(TEXT("Unfinished query should stay in flight"), RequestState.IsInFlight());
+
+    // Act - 查询成功
+    FirstDelegate.ExecuteIfBound(MakeLocationResult({ FVector(100.0f, 0.0f, 0.0f), FVector(200.0f, 0.0f, 0.0f) }));
+    TestTrue(TEXT("Finished query should produce a result"), RequestState.ConsumeCompletedQuery(1.0f));
+    TestFalse(TEXT("Finished query should leave flight"), RequestState.IsInFlight());
+    TestEqual(TEXT("All locations should be kept"), RequestState.Locations.Num(), 2);
+    TestEqual(TEXT("Best location should be the first item"), RequestState.BestLocation, FVector(100.0f, 0.0f, 0.0f));
+    TestTrue(TEXT("Result should be fresh for its own query"), RequestState.IsResultFresh(11, 1.5f, 1.0f));
+    TestFalse(TEXT("Result should not be fresh for another query"), RequestState.IsResultFresh(12, 1.5f, 1.0f));
+    TestFalse(TEXT("Result should expire"), RequestState.IsResultFresh(11, 3.0f, 1.0f));
+
+    // Act - 新查询失败时保留上次的结果
+    FQueryFinishedSignature FailedDelegate = RequestState.MakeCompletionDelegate(12);
+    RequestState.RequestID = 2;
+    TestTrue(TEXT("Last good result should stay available while in flight"), RequestState.HasResult());
+    FailedDelegate.ExecuteIfBound(MakeShared<FEnvQueryResult>(EEnvQueryStatus::Failed));
+    TestFalse(TEXT("Failed query should not produce a result"), RequestState.ConsumeCompletedQuery(2.0f));
+    TestFalse(TEXT("Failed query should leave flight"), RequestState.IsInFlight());
+    TestEqual(TEXT("Failed query should keep the last good result"), RequestState.BestLocation, FVector(100.0f, 0.0f, 0.0f));
+
+    // Act - 被替换（或中止）的请求迟到的回调不应生效
+    FQueryFinishedSignature StaleDelegate = RequestState.MakeCompletionDelegate(13);
+    RequestState.RequestID = 3;
+    RequestState.ClearPendingQuery();
+    StaleDelegate.ExecuteIfBound(MakeLocationResult({ FVector(900.0f, 0.0f, 0.0f) }));
+    TestFalse(TEXT("Stale callback should not produce a result"), RequestState.ConsumeCompletedQuery(3.0f));
+    TestEqual(TEXT("Stale callback should not overwrite the result"), RequestState.BestLocation, FVector(100.0f, 0.0f, 0.0f));
+
+    // Act - 重置
+    RequestState.Reset();
+    TestFalse(TEXT("Reset should clear the result"), RequestState.HasResult());
+
+    return true;
+}
+
+/**
+ * 测试共享EQS结果缓存：网格量化、TTL、容量淘汰和整体失效
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStateTreeEQSResultCacheTest,
+    "ElementalCombat.AI.StateTree.EQSResultCache",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FStateTreeEQSResultCacheTest::RunTest(const FString& Parameters)
+{
+    using namespace ElementalCombat::Tests;
+
+    // Arrange
+    UWorld* TestWorld = FStateTreeTestHelpers::CreateTestWorld();
+    UEQSResultCacheSubsystem* CacheSubsystem = UEQSResultCacheSubsystem::Get(TestWorld);
+    UEnvQuery* QueryA = NewObject<UEnvQuery>();
+    UEnvQuery* QueryB = NewObject<UEnvQuery>();
+    if (!CacheSubsystem)
+    {
+        AddError(TEXT("Failed to get EQS result cache subsystem"));
+        FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+        return false;
+    }
+
+    const float CellSize = 200.0f;
+    const FVector PlayerLocation(1000.0f, 0.0f, 0.0f);
+    const TArray<FVector> Locations = { FVector(800.0f, 100.0f, 0.0f), FVector(800.0f, -100.0f, 0.0f) };
+
+    // Act & Assert - 网格量化
+    const FEQSResultCacheKey KeyA = FEQSResultCacheKey::Make(QueryA, FVector(10.0f, 10.0f, 0.0f), &PlayerLocation, CellSize);
+    const FEQSResultCacheKey KeyNearby = FEQSResultCacheKey::Make(QueryA, FVector(150.0f, 190.0f, 0.0f), &PlayerLocation, CellSize);
+    const FEQSResultCacheKey KeyFar = FEQSResultCacheKey::Make(QueryA, FVector(450.0f, 10.0f, 0.0f), &PlayerLocation, CellSize);
+    const FEQSResultCacheKey KeyOtherQuery = FEQSResultCacheKey::Make(QueryB, FVector(10.0f, 10.0f, 0.0f), &PlayerLocation, CellSize);
+    const FEQSResultCacheKey KeyNoTarget = FEQSResultCacheKey::Make(QueryA, FVector(10.0f, 10.0f, 0.0f), nullptr, CellSize);
+    TestTrue(TEXT("Queriers in the same cell should share a key"), KeyA == KeyNearby);
+    TestFalse(TEXT("Queriers in different cells should not share a key"), KeyA == KeyFar);
+    TestFalse(TEXT("Different query templates should not share a key"), KeyA == KeyOtherQuery);
+    TestFalse(TEXT("Missing target should not share a key"), KeyA == KeyNoTarget);
+    TestEqual(TEXT("Negative coordinates should floor into their own cell"), FEQSResultCacheKey::ToCell(FVector(-1.0f, 0.0f, 0.0f), CellSize).X, -1);
+
+    // Act & Assert - 命中与TTL
+    CacheSubsystem->ResetStats();
+    CacheSubsystem->Add(KeyA, Locations, 1.0f, 2.0f);
+    FEQSQueryCache Hit;
+    TestTrue(TEXT("Nearby querier should reuse the cached result"), CacheSubsystem->Find(KeyNearby, 1.5f, 2.0f, Hit));
+    TestEqual(TEXT("Cached best location should be the first result"), Hit.BestLocation, Locations[0]);
+    FEQSQueryCache Miss;
+    TestFalse(TEXT("Far querier should miss"), CacheSubsystem->Find(KeyFar, 1.5f, 2.0f, Miss));
+    TestFalse(TEXT("Caller max age should be respected"), CacheSubsystem->Find(KeyA, 1.5f, 0.1f, Miss));
+    TestFalse(TEXT("Entry should expire after its TTL"), CacheSubsystem->Find(KeyA, 3.5f, 10.0f, Miss));
+
+    FEQSResultCacheStats Stats = CacheSubsystem->GetStats();
+    TestEqual(TEXT("Hits should be counted"), Stats.Hits, static_cast<uint64>(1));
+    TestEqual(TEXT("Misses should be counted"), Stats.Misses, static_cast<uint64>(3));
+    TestEqual(TEXT("Expirations should be counted"), Stats.Expirations, static_cast<uint64>(1));
+    TestEqual(TEXT("Expired entry should be removed"), Stats.NumEntries, 0);
+
+    // Act & Assert - 容量淘汰最旧的条目
+    CacheSubsystem->SetCapacity(2);
+    CacheSubsystem->Add(KeyA, Locations, 10.0f, 5.0f);
+    CacheSubsystem->Add(KeyFar, Locations, 11.0f, 5.0f);
+    CacheSubsystem->Add(KeyOtherQuery, Locations, 12.0f, 5.0f);
+    Stats = CacheSubsystem->GetStats();
+    TestEqual(TEXT("Capacity should be respected"), Stats.NumEntries, 2);
+    TestEqual(TEXT("Evictions should be counted"), Stats.Evictions, static_cast<uint64>(1));
+    TestFalse(TEXT("Oldest entry should be evicted"), CacheSubsystem->Find(KeyA, 12.0f, 5.0f, Miss));
+    TestTrue(TEXT("Newest entry should be kept"), CacheSubsystem->Find(KeyOtherQuery, 12.0f, 5.0f, Hit));
+    TestTrue(TEXT("Memory usage should be reported"), Stats.MemoryBytes > 0);
+
+    // Act & Assert - 整体失效（导航网格变化时触发）
+    CacheSubsystem->Invalidate();
+    Stats = CacheSubsystem->GetStats();
+    TestEqual(TEXT("Invalidate should clear all entries"), Stats.NumEntries, 0);
+    TestEqual(TEXT("Invalidations should be counted"), Stats.Invalidations, static_cast<uint64>(1));
+
+    // Cleanup
+    CacheSubsystem->SetCapacity(UEQSResultCacheSubsystem::DefaultCapacity);
+    FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+
+    return true;
+}
+
+/**
+ * 并行压力测试：数百个敌人的StateTree实例在工作线程上同时Tick
+ * 根状态包含通用效用和动态效用任务，子状态在元素决策和智能攻击之间轮换；游戏线程上的实例使用Utility AI子系统（注册请求、立即评分、推送权重），
+ * 其他线程上的实例不访问子系统，只读取游戏线程预构建的评分上下文快照，在实例缓存上本地评分；
+ * 工作线程上发起的EQS查询、攻击和退出状态时的请求注销都交给游戏线程执行
+ * 共享的EQS结果缓存在并发查找和写入时保持计数一致
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStateTreeConcurrentTaskTickTest,
+    "ElementalCombat.AI.StateTree.ConcurrentTaskTick",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FStateTreeConcurrentTaskTickTest::RunTest(const FString& Parameters)
+{
+    using namespace ElementalCombat::Tests;
+
+    constexpr int32 NumAgents = 512;
+    constexpr int32 NumTicks = 16;
+    constexpr float DeltaTime = 0.1f;
+    // 敌人在玩家周围的圆环上，距离在近战切换距离和远程射程之间，近战AI会选择远程攻击
+    constexpr float RingRadius = 600.0f;
+
+    UWorld* TestWorld = FStateTreeTestHelpers::CreateTestWorld();
+    UUtilityAISubsystem* UtilitySubsystem = UUtilityAISubsystem::Get(TestWorld);
+    UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(TestWorld);
+    AElementalCombatEnemy* FakePlayer = TestWorld ? TestWorld->SpawnActor<AElementalCombatEnemy>(FVector::ZeroVector, FRotator::ZeroRotator) : nullptr;
+    if (!TestWorld || !UtilitySubsystem || !SnapshotSubsystem || !FakePlayer)
+    {
+        AddError(TEXT("Failed to create test world with Utility AI and player snapshot subsystems"));
+        FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+        return false;
+    }
+    SnapshotSubsystem->SetTrackedPlayer(FakePlayer);
+
+    // 攻击位置查询：只生成查询者当前位置
+    UEnvQuery* AttackPositionQuery = NewObject<UEnvQuery>(GetTransientPackage());
+    UEnvQueryOption* QueryOption = NewObject<UEnvQueryOption>(AttackPositionQuery);
+    QueryOption->Generator = NewObject<UEnvQueryGenerator_CurrentLocation>(QueryOption);
+    AttackPositionQuery->GetOptionsMutable().Add(QueryOption);
+
+    // Arrange - 编译StateTree：根状态的通用效用和动态效用任务持续运行，子状态在元素决策和智能攻击之间轮换
+    UStateTree* StateTree = NewObject<UStateTree>(GetTransientPackage());
+    UStateTreeEditorData* EditorData = NewObject<UStateTreeEditorData>(StateTree);
+    StateTree->EditorData = EditorData;
+    EditorData->Schema = NewObject<UElementalStateTreeTestSchema>(EditorData);
+
+    UStateTreeState& Root = EditorData->AddSubTree(FName(TEXT("Root")));
+    TStateTreeEditorNode<FStateTreeUniversalUtilityTask>& UniversalTask = Root.AddTask<FStateTreeUniversalUtilityTask>(FName(TEXT("UniversalUtility")));
+    UniversalTask.GetInstanceData().bContinuousUpdate = true;
+    UniversalTask.GetInstanceData().UpdateInterval = 0.0f;
+    TStateTreeEditorNode<FStateTreeDynamicUtilityTask>& DynamicTask = Root.AddTask<FStateTreeDynamicUtilityTask>(FName(TEXT("DynamicUtility")));
+    DynamicTask.GetInstanceData().UpdateInterval = 0.0f;
+
+    UStateTreeState& ElementState = Root.AddChildState(FName(TEXT("Element")));
+    TStateTreeEditorNode<FStateTreeElementalDecisionTask>& ElementalTask = ElementState.AddTask<FStateTreeElementalDecisionTask>(FName(TEXT("ElementalDecision")));
+    ElementalTask.GetInstanceData().ElementalProfiles.Add(EElementalType::Fire, FStateTreeTestHelpers::CreateTestUtilityProfile(TEXT("FireProfile")));
+    ElementalTask.GetInstanceData().ElementalProfiles.Add(EElementalType::Water, FStateTreeTestHelpers::CreateTestUtilityProfile(TEXT("WaterProfile")));
+
+    UStateTreeState& AttackState = Root.AddChildState(FName(TEXT("Attack")));
+    TStateTreeEditorNode<FStateTreeSmartAttackTask>& AttackTask = AttackState.AddTask<FStateTreeSmartAttackTask>(FName(TEXT("SmartAttack")));
+    AttackTask.GetInstanceData().AttackPositionQuery = AttackPositionQuery;
+
+    ElementState.AddTransition(EStateTreeTransitionTrigger::OnStateCompleted, EStateTreeTransitionType::GotoState, &AttackState);
+    AttackState.AddTransition(EStateTreeTransitionTrigger::OnStateCompleted, EStateTreeTransitionType::GotoState, &ElementState);
+
+    FStateTreeCompilerLog CompilerLog;
+    FStateTreeCompiler Compiler(CompilerLog);
+    if (!Compiler.Compile(*StateTree))
+    {
+        AddError(TEXT("Failed to compile test StateTree"));
+        FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+        return false;
+    }
+
+    // Arrange - 每个敌人一个控制器和一份StateTree实例数据（控制器注册各自的基础评分请求）
+    struct FAgentTree
+    {
+        AElementalCombatEnemy* Enemy = nullptr;
+        AElementalCombatAIController* Controller = nullptr;
+        FStateTreeInstanceData InstanceData;
+        EStateTreeRunStatus Status = EStateTreeRunStatus::Unset;
+    };
+
+    const FUtilityProfile Profile = FStateTreeTestHelpers::CreateTestUtilityProfile();
+    TArray<FAgentTree> Agents;
+    Agents.SetNum(NumAgents);
+    for (int32 AgentIndex = 0; AgentIndex < NumAgents; ++AgentIndex)
+    {
+        FAgentTree& Agent = Agents[AgentIndex];
+        Agent.Enemy = FStateTreeTestHelpers::CreateTestEnemyWithAI(TestWorld, Profile);
+        Agent.Controller = Agent.Enemy ? Cast<AElementalCombatAIController>(Agent.Enemy->GetController()) : nullptr;
+        if (!Agent.Controller)
+        {
+            AddError(TEXT("Failed to create test enemy with AI controller"));
+            FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+            return false;
+        }
+        const float Angle = 2.0f * PI * AgentIndex / NumAgents;
+        Agent.Enemy->SetActorLocation(FVector(RingRadius * FMath::Cos(Angle), RingRadius * FMath::Sin(Angle), 0.0f));
+    }
+    const int32 NumBaseRequests = UtilitySubsystem->GetNumRequests();
+
+    // 在调用线程上为实例创建执行上下文并执行一步
+    enum class EAgentStep : uint8 { Start, Tick, Stop };
+    auto RunAgent = [StateTree, DeltaTime](FAgentTree& Agent, EAgentStep Step)
+    {
+        FStateTreeExecutionContext Exec(*Agent.Controller, *StateTree, Agent.InstanceData);
+        Exec.SetContextDataByName(UElementalStateTreeTestSchema::EnemyContextName, FStateTreeDataView(Agent.Enemy));
+        Exec.SetContextDataByName(UElementalStateTreeTestSchema::AIControllerContextName, FStateTreeDataView(Agent.Controller));
+        switch (Step)
+        {
+        case EAgentStep::Start:
+            Agent.Status = Exec.Start();
+            break;
+        case EAgentStep::Tick:
+            Agent.Status = Exec.Tick(DeltaTime);
+            break;
+        case EAgentStep::Stop:
+            Agent.Status = Exec.Stop();
+            break;
+        }
+    };
+
+    auto CountNotRunning = [&Agents]()
+    {
+        int32 Count = 0;
+        for (const FAgentTree& Agent : Agents)
+        {
+            Count += Agent.Status != EStateTreeRunStatus::Running ? 1 : 0;
+        }
+        return Count;
+    };
+
+    // Act - 并行进入状态（在游戏线程上执行的实例注册子系统请求）
+    // 测试不经过世界Tick，每次并行执行前手动发布本帧快照
+    SnapshotSubsystem->PrepareFrame();
+    ParallelFor(NumAgents, [&](int32 AgentIndex)
+    {
+        RunAgent(Agents[AgentIndex], EAgentStep::Start);
+    });
+    TestEqual(TEXT("Every StateTree should be running after a concurrent start"), CountNotRunning(), 0);
+
+    // 处理工作线程排队的游戏线程命令（发起EQS查询、执行攻击），再推进EQS管理器
+    UEnvQueryManager* EQSManager = UEnvQueryManager::GetCurrent(TestWorld);
+    auto RunGameThreadCommands = [EQSManager, DeltaTime]()
+    {
+        FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+        if (EQSManager)
+        {
+            EQSManager->Tick(DeltaTime);
+        }
+    };
+    RunGameThreadCommands();
+
+    // Act - 并行Tick，帧之间在游戏线程上执行排队的命令、推进子系统并发布结果
+    int32 NumFailedTicks = 0;
+    for (int32 TickIndex = 0; TickIndex < NumTicks; ++TickIndex)
+    {
+        SnapshotSubsystem->PrepareFrame();
+        ParallelFor(NumAgents, [&](int32 AgentIndex)
+        {
+            RunAgent(Agents[AgentIndex], EAgentStep::Tick);
+        });
+        NumFailedTicks += CountNotRunning();
+
+        RunGameThreadCommands();
+        UtilitySubsystem->Tick(DeltaTime);
+        UtilitySubsystem->FlushPendingEvaluations();
+    }
+    TestEqual(TEXT("Every StateTree should keep running during concurrent ticks"), NumFailedTicks, 0);
+
+    // Assert - 攻击都在游戏线程上发起（测试世界时间不推进，攻击状态不会被重置）
+    int32 NumRangedAttacks = 0;
+    for (const FAgentTree& Agent : Agents)
+    {
+        NumRangedAttacks += Agent.Enemy->IsAttacking() && Agent.Enemy->CurrentAttackType == EAIAttackType::Ranged ? 1 : 0;
+    }
+    TestEqual(TEXT("Every enemy should start a ranged attack queued from a concurrent tick"), NumRangedAttacks, NumAgents);
+
+    // Act - 游戏线程Tick一次，所有实例都走子系统路径
+    for (FAgentTree& Agent : Agents)
+    {
+        RunAgent(Agent, EAgentStep::Tick);
+    }
+    TestEqual(TEXT("Every StateTree should keep running on the game thread"), CountNotRunning(), 0);
+
+    // Act - 并行退出状态，工作线程上的注销交给游戏线程执行
+    ParallelFor(NumAgents, [&](int32 AgentIndex)
+    {
+        RunAgent(Agents[AgentIndex], EAgentStep::Stop);
+    });
+    RunGameThreadCommands();
+    TestEqual(TEXT("Dynamic utility requests should all be unregistered after a concurrent stop"), UtilitySubsystem->GetNumRequests(), NumBaseRequests);
+    SnapshotSubsystem->SetTrackedPlayer(nullptr);
+
+    // Arrange - 共享EQS结果缓存
+    UEQSResultCacheSubsystem* CacheSubsystem = UEQSResultCacheSubsystem::Get(TestWorld);
+    UEnvQuery* Query = NewObject<UEnvQuery>();
+    if (!CacheSubsystem)
+    {
+        AddError(TEXT("Failed to get EQS result cache subsystem"));
+        FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+        return false;
     }
 
+    constexpr int32 NumLookups = 4096;
+    constexpr int32 NumCells = 32;
+    const float CellSize = 200.0f;
+    const FVector PlayerLocation(5000.0f, 0.0f, 0.0f);
+    const TArray<FVector> Locations = { FVector(100.0f, 0.0f, 0.0f), FVector(-100.0f, 0.0f, 0.0f) };
+    CacheSubsystem->ResetStats();
+
+    // Act - 并发查找，未命中时写入
+    std::atomic<int32> NumBadResults{0};
+    ParallelFor(NumLookups, [&](int32 Index)
+    {
+        const FVector QuerierLocation((Index % NumCells) * CellSize, 0.0f, 0.0f);
+        const FEQSResultCacheKey Key = FEQSResultCacheKey::Make(Query, QuerierLocation, &PlayerLocation, CellSize);
+
+        FEQSQueryCache Result;
+        if (CacheSubsystem->Find(Key, 1.0f, 10.0f, Result))
+        {
+            if (Result.CachedLocations.Num() != Locations.Num() || Result.BestLocation != Locations[0])
+            {
+                ++NumBadResults;
+            }
+        }
+        else
+        {
+            CacheSubsystem->Add(Key, Locations, 1.0f, 10.0f);
+        }
+    });
+
+    // Assert
+    const FEQSResultCacheStats EQSStats = CacheSubsystem->GetStats();
+    TestEqual(TEXT("Concurrent hits should return complete results"), NumBadResults.load(), 0);
+    TestEqual(TEXT("Every lookup should be counted exactly once"), EQSStats.Hits + EQSStats.Misses, static_cast<uint64>(NumLookups));
+    TestEqual(TEXT("Each cell should end up with one entry"), EQSStats.NumEntries, NumCells);
+
+    // Cleanup
+    CacheSubsystem->Invalidate();
+    CacheSubsystem->ResetStats();
+    FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+
+    return true;
+}
+
+/**
+ * 测试AI细节层级：按距离分级、降级滞后，以及层级参数应用到控制器
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAILODSubsystemTest,
+    "ElementalCombat.AI.StateTree.AILOD",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FAILODSubsystemTest::RunTest(const FString& Parameters)
+{
+    using namespace ElementalCombat::Tests;
+
+    // Arrange
+    UWorld* TestWorld = FStateTreeTestHelpers::CreateTestWorld();
+    AddErrorIfFalse(TestWorld != nullptr, TEXT("Failed to create test world"));
+
+    UAILODSubsystem* LODSubsystem = UAILODSubsystem::Get(TestWorld);
+    UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(TestWorld);
+    AElementalCombatEnemy* TestEnemy = FStateTreeTestHelpers::CreateTestEnemyWithAI(TestWorld, FStateTreeTestHelpers::CreateTestUtilityProfile());
+    AElementalCombatEnemy* FakePlayer = TestWorld->SpawnActor<AElementalCombatEnemy>(FVector::ZeroVector, FRotator::ZeroRotator);
+    AElementalCombatAIController* AIController = TestEnemy ? Cast<AElementalCombatAIController>(TestEnemy->GetController()) : nullptr;
+    if (!LODSubsystem || !SnapshotSubsystem || !AIController || !FakePlayer)
+    {
+        AddError(TEXT("Failed to create LOD subsystem, test enemy or fake player"));
+        FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+        return false;
+    }
+
+    SnapshotSubsystem->SetTrackedPlayer(FakePlayer);
+    TestTrue(TEXT("Possessed enemy should be registered"), LODSubsystem->IsAgentValid(AIController->GetLODHandle()));
+
+    // 测试世界不渲染，AI都视为不在屏幕上
+    auto MoveEnemyAndUpdate = [&](float Distance)
+    {
+        TestEnemy->SetActorLocation(FVector(Distance, 0.0f, 0.0f));
+        SnapshotSubsystem->Invalidate();
+        LODSubsystem->UpdateLevels();
+    };
+
+    // Act & Assert - 参战距离内不受可见性影响
+    MoveEnemyAndUpdate(300.0f);
+    TestTrue(TEXT("Close enemy should be engaged"), AIController->GetLODLevel() == EAILODLevel::Engaged);
+    TestTrue(TEXT("Engaged enemy should be allowed to run EQS"), AIController->IsEQSAllowed());
+    TestFalse(TEXT("Engaged enemy should use its full profile"), AIController->IsUsingFallbackProfile());
+
+    // Act & Assert - 滞后距离内不降级
+    MoveEnemyAndUpdate(900.0f);
+    TestTrue(TEXT("Hysteresis should keep the enemy engaged"), AIController->GetLODLevel() == EAILODLevel::Engaged);
+
+    // Act & Assert - 越过滞后距离后仍需停留足够时间
+    MoveEnemyAndUpdate(1500.0f);
+    TestTrue(TEXT("Demotion should wait for the minimum time in level"), AIController->GetLODLevel() == EAILODLevel::Engaged);
+
+    LODSubsystem->Tick(1.5f);
+    TestTrue(TEXT("Offscreen near enemy should be demoted to far"), AIController->GetLODLevel() == EAILODLevel::Far);
+    TestFalse(TEXT("Far enemy should not start new EQS queries"), AIController->IsEQSAllowed());
+    TestTrue(TEXT("Far enemy should use the fallback profile"), AIController->IsUsingFallbackProfile());
+
+    const FAILODLevelSettings& FarSettings = LODSubsystem->GetLevelSettings(EAILODLevel::Far);
+    if (const UBrainComponent* BrainComponent = AIController->FindComponentByClass<UBrainComponent>())
+    {
+        TestEqual(TEXT("StateTree tick interval should follow the level"), BrainComponent->GetComponentTickInterval(), FarSettings.StateTreeTickInterval);
+    }
+
+    // Act & Assert - 升级立即生效
+    MoveEnemyAndUpdate(200.0f);
+    TestTrue(TEXT("Promotion should be immediate"), AIController->GetLODLevel() == EAILODLevel::Engaged);
+    TestFalse(TEXT("Promoted enemy should restore its full profile"), AIController->IsUsingFallbackProfile());
+
+    // Act & Assert - 人数统计
+    LODSubsystem->Tick(1.5f);
+    MoveEnemyAndUpdate(10000.0f);
+    TestTrue(TEXT("Distant enemy should be dormant"), AIController->GetLODLevel() == EAILODLevel::Dormant);
+    TestEqual(TEXT("Dormant population should be counted"), LODSubsystem->GetLevelPopulation(EAILODLevel::Dormant), 1);
+    TestEqual(TEXT("Engaged population should be updated"), LODSubsystem->GetLevelPopulation(EAILODLevel::Engaged), 0);
+    TestTrue(TEXT("Debug string should be available"), !LODSubsystem->GetDebugString().IsEmpty());
+
+    // Act & Assert - 后备配置文件只保留权重最高的评分因素
+    const FUtilityProfile Fallback = UAILODSubsystem::MakeFallbackProfile(FStateTreeTestHelpers::CreateTestUtilityProfile(), 1);
+    TestEqual(TEXT("Fallback profile should keep one consideration"), Fallback.Considerations.Num(), 1);
+    TestTrue(TEXT("Fallback profile should keep the heaviest consideration"), Fallback.Considerations[0].ConsiderationType == EConsiderationType::Health);
+
+    // Cleanup
+    FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+
+    return true;
+}
+
+namespace ElementalCombat::Tests
+{
+    /** 暴露受保护的决策接口，绕过执行上下文直接驱动决策路径 */
+    struct FSmartAttackTestTask : public FStateTreeSmartAttackTask
+    {
+        using FStateTreeSmartAttackTask::SelectAttack;
+    };
+
+    struct FElementalDecisionTestTask : public FStateTreeElementalDecisionTask
+    {
+        using FStateTreeElementalDecisionTask::RefreshElementEvaluator;
+        using FStateTreeElementalDecisionTask::ScoreElements;
+    };
+
+    /**
+     * 统计堆分配次数的FMalloc代理
+     * 作用域内替换GMalloc，只统计创建它的线程上的分配（其他线程的后台分配不计入）
+     */
+    class FScopedAllocationCounter : public FMalloc
+    {
+    public:
+        FScopedAllocationCounter()
+            : InnerMalloc(GMalloc)
+            , OwnerThreadId(FPlatformTLS::GetCurrentThreadId())
+        {
+            GMalloc = this;
+        }
+
+        virtual ~FScopedAllocationCounter() override
+        {
+            GMalloc = InnerMalloc;
+        }
+
+        virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+        {
+            CountAllocation();
+            return InnerMalloc->Malloc(Count, Alignment);
+        }
+
+        virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+        {
+            if (Count > 0)
+            {
+                CountAllocation();
+            }
+            return InnerMalloc->Realloc(Original, Count, Alignment);
+        }
+
+        virtual void Free(void* Original) override
+        {
+            InnerMalloc->Free(Original);
+        }
+
+        virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+        {
+            return InnerMalloc->GetAllocationSize(Original, SizeOut);
+        }
+
+        virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+        {
+            return InnerMalloc->QuantizeSize(Count, Alignment);
+        }
+
+        virtual const TCHAR* GetDescriptiveName() override
+        {
+            return TEXT("AllocationCounter");
+        }
+
+        int32 GetNumAllocations() const { return NumAllocations.load(); }
+
+    private:
+        void CountAllocation()
+        {
+            if (FPlatformTLS::GetCurrentThreadId() == OwnerThreadId)
+            {
+                ++NumAllocations;
+            }
+        }
+
+        FMalloc* InnerMalloc;
+        uint32 OwnerThreadId;
+        std::atomic<int32> NumAllocations{0};
+    };
+}
+
+/**
+ * 测试智能任务决策路径不分配堆内存
+ * 通过执行上下文反复进入和Tick包含智能攻击和元素决策任务的状态，统计整个执行路径上的堆分配；
+ * 决策原因和错误只记录状态码和数值，评分写入定长数组，读取时才格式化；共享EQS缓存命中时复制到调用方复用的缓冲区
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStateTreeAllocationFreeDecisionTest,
+    "ElementalCombat.AI.StateTree.AllocationFreeDecision",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FStateTreeAllocationFreeDecisionTest::RunTest(const FString& Parameters)
+{
+    using namespace ElementalCombat::Tests;
+
+    constexpr int32 NumWarmupTicks = 4;
+    constexpr int32 NumTicks = 256;
+    constexpr float DeltaTime = 0.1f;
+
+    // Arrange - 敌人在远程射程之外，每次进入状态都重新评估攻击但不发起攻击
+    UWorld* TestWorld = FStateTreeTestHelpers::CreateTestWorld();
+    UPlayerSnapshotSubsystem* SnapshotSubsystem = UPlayerSnapshotSubsystem::Get(TestWorld);
+    UEQSResultCacheSubsystem* CacheSubsystem = UEQSResultCacheSubsystem::Get(TestWorld);
+    AElementalCombatEnemy* TestEnemy = TestWorld ? FStateTreeTestHelpers::CreateTestEnemyWithAI(TestWorld, FStateTreeTestHelpers::CreateTestUtilityProfile()) : nullptr;
+    AElementalCombatEnemy* FakePlayer = TestWorld ? TestWorld->SpawnActor<AElementalCombatEnemy>(FVector::ZeroVector, FRotator::ZeroRotator) : nullptr;
+    AElementalCombatAIController* AIController = TestEnemy ? Cast<AElementalCombatAIController>(TestEnemy->GetController()) : nullptr;
+    if (!SnapshotSubsystem || !CacheSubsystem || !AIController || !FakePlayer)
+    {
+        AddError(TEXT("Failed to create subsystems, test enemy or fake player"));
+        FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+        return false;
+    }
+
+    SnapshotSubsystem->SetTrackedPlayer(FakePlayer);
+    TestEnemy->SetActorLocation(FVector(TestEnemy->GetRangedAttackRange() * 3.0f, 0.0f, 0.0f));
+
+    // Arrange - 决策状态完成后重新进入自身，每次Tick都经过两个任务的ExitState和EnterState
+    UStateTree* StateTree = NewObject<UStateTree>(GetTransientPackage());
+    UStateTreeEditorData* EditorData = NewObject<UStateTreeEditorData>(StateTree);
+    StateTree->EditorData = EditorData;
+    EditorData->Schema = NewObject<UElementalStateTreeTestSchema>(EditorData);
+
+    UStateTreeState& Root = EditorData->AddSubTree(FName(TEXT("Root")));
+    UStateTreeState& DecideState = Root.AddChildState(FName(TEXT("Decide")));
+    TStateTreeEditorNode<FStateTreeSmartAttackTask>& AttackTask = DecideState.AddTask<FStateTreeSmartAttackTask>(FName(TEXT("SmartAttack")));
+    AttackTask.GetInstanceData().MinDecisionInterval = 0.0f;
+    TStateTreeEditorNode<FStateTreeElementalDecisionTask>& ElementalTask = DecideState.AddTask<FStateTreeElementalDecisionTask>(FName(TEXT("ElementalDecision")));
+    ElementalTask.GetInstanceData().ElementalProfiles.Add(EElementalType::Fire, FStateTreeTestHelpers::CreateTestUtilityProfile(TEXT("FireProfile")));
+    ElementalTask.GetInstanceData().ElementalProfiles.Add(EElementalType::Water, FStateTreeTestHelpers::CreateTestUtilityProfile(TEXT("WaterProfile")));
+    ElementalTask.GetInstanceData().ElementalProfiles[EElementalType::Water].Weights.Add(EConsiderationType::Health, 0.9f);
+    DecideState.AddTransition(EStateTreeTransitionTrigger::OnStateCompleted, EStateTreeTransitionType::GotoState, &DecideState);
+
+    FStateTreeCompilerLog CompilerLog;
+    FStateTreeCompiler Compiler(CompilerLog);
+    if (!Compiler.Compile(*StateTree))
+    {
+        AddError(TEXT("Failed to compile test StateTree"));
+        SnapshotSubsystem->SetTrackedPlayer(nullptr);
+        FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
+        return false;
+    }
+
+    // 每一步都像运行时一样新建执行上下文
+    FStateTreeInstanceData InstanceData;
+    auto RunTree = [&](TFunctionRef<EStateTreeRunStatus(FStateTreeExecutionContext&)> Step)
+    {
+        FStateTreeExecutionContext Exec(*AIController, *StateTree, InstanceData);
+        Exec.SetContextDataByName(UElementalStateTreeTestSchema::EnemyContextName, FStateTreeDataView(TestEnemy));
+        Exec.SetContextDataByName(UElementalStateTreeTestSchema::AIControllerContextName, FStateTreeDataView(AIController));
+        return Step(Exec);
+    };
+    auto TickTree = [DeltaTime](FStateTreeExecutionContext& Exec) { return Exec.Tick(DeltaTime); };
+
+    // 预热：创建实例数据、构建评估器、评分缓存和本帧评分上下文
+    EStateTreeRunStatus Status = RunTree([](FStateTreeExecutionContext& Exec) { return Exec.Start(); });
+    for (int32 Tick = 0; Tick < NumWarmupTicks; ++Tick)
+    {
+        Status = RunTree(TickTree);
+    }
+    TestTrue(TEXT("StateTree should be running after warm-up"), Status == EStateTreeRunStatus::Running);
+
+    // Act - 统计反复进入决策状态期间的堆分配
+    int32 NumAllocations = 0;
+    int32 NumNotRunning = 0;
+    {
+        FScopedAllocationCounter AllocationCounter;
+        for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+        {
+            NumNotRunning += RunTree(TickTree) != EStateTreeRunStatus::Running ? 1 : 0;
+        }
+        NumAllocations = AllocationCounter.GetNumAllocations();
+    }
+
+    // Assert - 执行上下文驱动的决策路径不分配内存
+    TestEqual(TEXT("StateTree should keep running while re-entering the decision state"), NumNotRunning, 0);
+    TestEqual(TEXT("Decision path through the execution context should not allocate"), NumAllocations, 0);
+    TestFalse(TEXT("Out-of-range enemy should not attack"), TestEnemy->IsAttacking());
+
+    // Act & Assert - 共享EQS缓存命中时复制到复用的缓冲区
+    const FEQSResultCacheKey CacheKey = FEQSResultCacheKey::Make(NewObject<UEnvQuery>(), FVector::ZeroVector, nullptr, 200.0f);
+    CacheSubsystem->Add(CacheKey, { FVector(100.0f, 0.0f, 0.0f), FVector(-100.0f, 0.0f, 0.0f), FVector(0.0f, 100.0f, 0.0f) }, 0.0f, 10.0f);
+    TArray<FVector> CachedLocations;
+    float CacheTimestamp = -1.0f;
+    bool bAllHits = CacheSubsystem->Find(CacheKey, 1.0f, 10.0f, CachedLocations, CacheTimestamp);
+    {
+        FScopedAllocationCounter AllocationCounter;
+        for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+        {
+            bAllHits &= CacheSubsystem->Find(CacheKey, 1.0f, 10.0f, CachedLocations, CacheTimestamp);
+        }
+        NumAllocations = AllocationCounter.GetNumAllocations();
+    }
+    TestTrue(TEXT("Cached EQS result should keep hitting"), bAllHits);
+    TestEqual(TEXT("Cache hit should copy every location"), CachedLocations.Num(), 3);
+    TestEqual(TEXT("EQS cache hit into a reused buffer should not allocate"), NumAllocations, 0);
+
+    // 决策原因在读取时才格式化，数值参数完整保留
+    constexpr float SwitchDistance = 300.0f;
+    constexpr float RangedRange = 1500.0f;
+    FStateTreeSmartAttackInstanceData AttackData;
+    FSmartAttackTestTask::SelectAttack(AttackData, false, 100.0f, SwitchDistance, RangedRange);
+    TestTrue(TEXT("Too-close decision should record its code"), AttackData.DecisionReason.Code == EElementalTaskStatus::MeleeTooClose);
+    TestEqual(TEXT("Too-close decision should keep the distance"), AttackData.DecisionReason.Value0, 100.0f);
+    TestTrue(TEXT("Formatted reason should include the threshold"), AttackData.DecisionReason.ToString().Contains(TEXT("300.0")));
+    TestFalse(TEXT("Too-close decision should not attack"), AttackData.bShouldAttack);
+
+    FSmartAttackTestTask::SelectAttack(AttackData, false, 800.0f, SwitchDistance, RangedRange);
+    TestEqual(TEXT("Ranged score should be stored by attack type"), AttackData.GetAttackTypeScore(EAIAttackType::Ranged), 0.8f);
+    TestEqual(TEXT("Melee score should be cleared"), AttackData.GetAttackTypeScore(EAIAttackType::Melee), 0.0f);
+    AttackData.ErrorStatus.Set(EElementalTaskStatus::AttackExecutionFailed);
+    TestFalse(TEXT("Error status should format to text"), AttackData.ErrorStatus.ToString().IsEmpty());
+    TestEqual(TEXT("Blueprint helper should format the same text"), UElementalTaskStatusLibrary::Conv_ElementalTaskStatusToString(AttackData.ErrorStatus), AttackData.ErrorStatus.ToString());
+    TestTrue(TEXT("Blueprint helper should report a set status"), UElementalTaskStatusLibrary::IsElementalTaskStatusSet(AttackData.ErrorStatus));
+
+    // 元素评分按元素下标存放，没有配置的元素为0
+    FStateTreeElementalDecisionInstanceData ElementData;
+    ElementData.ElementalProfiles = ElementalTask.GetInstanceData().ElementalProfiles;
+    FUtilityContext UtilityContext;
+    UtilityContext.DistanceToTarget = 500.0f;
+    UtilityContext.HealthPercent = 0.6f;
+    FElementalDecisionTestTask::RefreshElementEvaluator(ElementData);
+    FElementalDecisionTestTask().ScoreElements(ElementData, UtilityContext);
+    TestTrue(TEXT("Recommended element should have a profile"),
+        ElementData.RecommendedElement == EElementalType::Fire || ElementData.RecommendedElement == EElementalType::Water);
+    TestEqual(TEXT("Recommended element score should match the advantage value"),
+        ElementData.GetElementScore(ElementData.RecommendedElement), ElementData.ElementAdvantageValue);
+    TestEqual(TEXT("Unconfigured element should score zero"), ElementData.GetElementScore(EElementalType::Metal), 0.0f);
+
+    // 评估器只在版本变化时重建
+    const float FireScore = ElementData.GetElementScore(EElementalType::Fire);
+    const float WaterScore = ElementData.GetElementScore(EElementalType::Water);
+    ElementData.ElementalProfiles.Remove(EElementalType::Water);
+    FElementalDecisionTestTask::RefreshElementEvaluator(ElementData);
+    FElementalDecisionTestTask().ScoreElements(ElementData, UtilityContext);
+    TestEqual(TEXT("Evaluator should not rebuild while the profiles version is unchanged"), ElementData.GetElementScore(EElementalType::Water), WaterScore);
+
+    ++ElementData.ElementalProfilesVersion;
+    FElementalDecisionTestTask::RefreshElementEvaluator(ElementData);
+    FElementalDecisionTestTask().ScoreElements(ElementData, UtilityContext);
+    TestEqual(TEXT("Evaluator should rebuild after the profiles version changes"), ElementData.GetElementScore(EElementalType::Water), 0.0f);
+    TestEqual(TEXT("Remaining element should keep its score"), ElementData.GetElementScore(EElementalType::Fire), FireScore);
+
     // Cleanup
+    RunTree([](FStateTreeExecutionContext& Exec) { return Exec.Stop(); });
+    SnapshotSubsystem->SetTrackedPlayer(nullptr);
     FStateTreeTestHelpers::CleanupTestWorld(TestWorld);
 
     return true;
@@ -353,6 +1337,107 @@ bool FStateTreeTaskDataBindingTest::RunTest(const FString& Parameters)
     return true;
 }
 
+namespace ElementalCombat::Tests
+{
+    /** 检查基类实例数据的默认值 */
+    static void TestInstanceDataBaseDefaults(FAutomationTestBase& Test, const TCHAR* StructName, const FElementalStateTreeInstanceDataBase& Data)
+    {
+        Test.TestEqual(FString::Printf(TEXT("%s: EQS request ID should default to INDEX_NONE"), StructName), Data.EQSRequest.RequestID, static_cast<int32>(INDEX_NONE));
+        Test.TestFalse(FString::Printf(TEXT("%s: EQS request should not be in flight"), StructName), Data.EQSRequest.IsInFlight());
+        Test.TestEqual(FString::Printf(TEXT("%s: EQS result time should default to -1"), StructName), Data.EQSRequest.ResultTime, -1.0f);
+        Test.TestFalse(FString::Printf(TEXT("%s: EQS request should have no result"), StructName), Data.EQSRequest.HasResult());
+        Test.TestEqual(FString::Printf(TEXT("%s: Utility cache capacity should keep its default"), StructName),
+            Data.UtilityScoreCache.GetConfig().Capacity, FUtilityScoreCache::DefaultCapacity);
+        Test.TestEqual(FString::Printf(TEXT("%s: Utility cache valid duration should keep its default"), StructName),
+            Data.UtilityScoreCache.GetConfig().ValidDuration, 0.1f);
+    }
+
+    /** 通过FInstancedStruct和UScriptStruct::InitializeStruct两条路径构造实例数据并检查默认值 */
+    template<typename TInstanceData, typename TCheckFunc>
+    static void TestInstanceDataConstruction(FAutomationTestBase& Test, const TCHAR* StructName, TCheckFunc&& CheckDerivedDefaults)
+    {
+        const FInstancedStruct Instanced = FInstancedStruct::Make<TInstanceData>();
+        if (Test.TestTrue(FString::Printf(TEXT("%s: FInstancedStruct should be valid"), StructName), Instanced.IsValid()))
+        {
+            const TInstanceData& Data = Instanced.Get<TInstanceData>();
+            TestInstanceDataBaseDefaults(Test, StructName, Data);
+            CheckDerivedDefaults(Data);
+        }
+
+        const UScriptStruct* ScriptStruct = TInstanceData::StaticStruct();
+        uint8* Memory = static_cast<uint8*>(FMemory::Malloc(ScriptStruct->GetStructureSize(), ScriptStruct->GetMinAlignment()));
+        // 先写入非零内容，确认默认值来自构造函数而不是恰好为零的内存
+        FMemory::Memset(Memory, 0xCD, ScriptStruct->GetStructureSize());
+        ScriptStruct->InitializeStruct(Memory);
+        {
+            const TInstanceData& Data = *reinterpret_cast<const TInstanceData*>(Memory);
+            TestInstanceDataBaseDefaults(Test, StructName, Data);
+            CheckDerivedDefaults(Data);
+            Test.TestEqual(FString::Printf(TEXT("%s: EQS locations should start empty"), StructName), Data.EQSRequest.Locations.Num(), 0);
+        }
+        ScriptStruct->DestroyStruct(Memory);
+        FMemory::Free(Memory);
+    }
+}
+
+/**
+ * 测试实例数据按UScriptStruct构造时保留默认值
+ * StateTree通过反射初始化实例数据，不能按零构造（EQS请求ID、结果时间默认不是0，且包含数组和共享指针）
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStateTreeInstanceDataDefaultsTest,
+    "ElementalCombat.AI.StateTree.InstanceDataDefaults",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FStateTreeInstanceDataDefaultsTest::RunTest(const FString& Parameters)
+{
+    using namespace ElementalCombat::Tests;
+
+    TestInstanceDataConstruction<FElementalStateTreeInstanceDataBase>(*this, TEXT("Base"),
+        [](const FElementalStateTreeInstanceDataBase&) {});
+
+    TestInstanceDataConstruction<FStateTreeUniversalUtilityInstanceData>(*this, TEXT("UniversalUtility"),
+        [this](const FStateTreeUniversalUtilityInstanceData& Data)
+        {
+            TestTrue(TEXT("UniversalUtility: should recalculate on enter by default"), Data.bRecalculateOnEnter);
+            TestEqual(TEXT("UniversalUtility: update interval should default to 1"), Data.UpdateInterval, 1.0f);
+        });
+
+    TestInstanceDataConstruction<FStateTreeUtilityConsiderationInstanceData>(*this, TEXT("UtilityConsideration"),
+        [this](const FStateTreeUtilityConsiderationInstanceData& Data)
+        {
+            TestEqual(TEXT("UtilityConsideration: valid score threshold should default to 0.1"), Data.ValidScoreThreshold, 0.1f);
+        });
+
+    TestInstanceDataConstruction<FStateTreeUtilityComparisonInstanceData>(*this, TEXT("UtilityComparison"),
+        [this](const FStateTreeUtilityComparisonInstanceData& Data)
+        {
+            TestTrue(TEXT("UtilityComparison: weight variations should be enabled by default"), Data.bUseWeightVariations);
+        });
+
+    TestInstanceDataConstruction<FStateTreeDynamicUtilityInstanceData>(*this, TEXT("DynamicUtility"),
+        [this](const FStateTreeDynamicUtilityInstanceData& Data)
+        {
+            TestTrue(TEXT("DynamicUtility: dynamic adjustment should be enabled by default"), Data.bUseDynamicAdjustment);
+            TestEqual(TEXT("DynamicUtility: update interval should default to 0.2"), Data.UpdateInterval, 0.2f);
+        });
+
+    TestInstanceDataConstruction<FStateTreeSmartAttackInstanceData>(*this, TEXT("SmartAttack"),
+        [this](const FStateTreeSmartAttackInstanceData& Data)
+        {
+            TestTrue(TEXT("SmartAttack: selected attack type should default to None"), Data.SelectedAttackType == EAIAttackType::None);
+            TestEqual(TEXT("SmartAttack: attack scores should start at 0"), Data.GetAttackTypeScore(EAIAttackType::Melee), 0.0f);
+        });
+
+    TestInstanceDataConstruction<FStateTreeElementalDecisionInstanceData>(*this, TEXT("ElementalDecision"),
+        [this](const FStateTreeElementalDecisionInstanceData& Data)
+        {
+            TestTrue(TEXT("ElementalDecision: recommended element should default to None"), Data.RecommendedElement == EElementalType::None);
+            TestEqual(TEXT("ElementalDecision: element scores should start at 0"), Data.GetElementScore(EElementalType::Fire), 0.0f);
+        });
+
+    return true;
+}
+
 /**
  * 测试StateTree任务描述功能
  */
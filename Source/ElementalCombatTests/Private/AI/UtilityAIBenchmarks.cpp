@@ -0,0 +1,583 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformTime.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "AI/Utility/UtilityAITypes.h"
+#include "AI/Utility/UtilityCalculator.h"
+#include "AI/Utility/CompiledUtilityProfile.h"
+#include "AI/Utility/UtilityScoreCache.h"
+
+// === Utility AI微基准测试 ===
+// 结果写入 Saved/Benchmarks/UtilityAIBenchmark.json 和 .csv，并与 ElementalCombatTests/Benchmarks/UtilityAIBaseline.json 比较
+// 基线 measured 为 true（参考机器实测）时，p50超出 regression_threshold_percent、内核缺少基线或基线内核不再测量都会使测试失败；
+// measured 为 false 时基线只是预算估计，比较结果只报告不判定失败
+// 命令行参数 -UpdateUtilityBenchmarkBaseline 用本次结果覆盖基线（保留阈值和说明，标记为实测并记录CPU型号）
+
+namespace ElementalCombat::Tests
+{
+    /** 单个内核的测量结果 */
+    struct FUtilityBenchmarkResult
+    {
+        /** 内核名称 */
+        FString Kernel;
+
+        /** 规模参数（评分因素数量或AI数量） */
+        int32 Size = 0;
+
+        /** 每次操作的平均耗时（纳秒） */
+        double MeanNs = 0.0;
+
+        /** 每次操作耗时的中位数（纳秒） */
+        double P50Ns = 0.0;
+
+        /** 每次操作耗时的99分位（纳秒） */
+        double P99Ns = 0.0;
+
+        /** 采样数量 */
+        int32 Samples = 0;
+
+        /** 每个采样内的操作次数 */
+        int64 OpsPerSample = 0;
+
+        FString GetKey() const { return FString::Printf(TEXT("%s/%d"), *Kernel, Size); }
+    };
+
+    /** 基线文件内容 */
+    struct FUtilityBenchmarkBaseline
+    {
+        /** 内核键 -> 基线p50（纳秒） */
+        TMap<FString, double> P50ByKey;
+
+        /** 回归阈值（百分比） */
+        double ThresholdPercent = 25.0;
+
+        /** 基线是否为参考机器上的实测值（否则只报告不判定失败） */
+        bool bMeasured = false;
+
+        /** 录制基线的CPU型号 */
+        FString RecordedOn;
+
+        /** 基线说明 */
+        FString Note;
+    };
+
+    /**
+     * 微基准测试运行器
+     * 每个内核先校准每个采样的调用次数（约SampleTargetMicroseconds），再采集固定数量的采样并统计分位数
+     */
+    class FUtilityBenchmarkRunner
+    {
+    public:
+        /** 每个内核的采样数量 */
+        static constexpr int32 NumSamples = 101;
+
+        /** 每个采样的目标耗时（微秒） */
+        static constexpr double SampleTargetMicroseconds = 50.0;
+
+        /** 默认的回归阈值（百分比，基线文件未配置时使用） */
+        static constexpr double DefaultRegressionThresholdPercent = 25.0;
+
+        /**
+         * 测量内核
+         * @param Kernel 内核名称
+         * @param Size 规模参数
+         * @param OpsPerCall 每次调用包含的操作数（批量内核按AI数量计）
+         * @param Body 执行一次调用，参数为调用序号
+         */
+        template <typename BodyType>
+        void Measure(const TCHAR* Kernel, int32 Size, int32 OpsPerCall, BodyType&& Body)
+        {
+            // 预热并校准每个采样的调用次数
+            constexpr int32 CalibrationCalls = 16;
+            const uint64 CalibrationStart = FPlatformTime::Cycles64();
+            for (int32 i = 0; i < CalibrationCalls; ++i)
+            {
+                Body(i);
+            }
+            const double CalibrationNs = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - CalibrationStart) * 1.0e9;
+            const double NsPerCall = FMath::Max(CalibrationNs / CalibrationCalls, 1.0);
+            const int32 CallsPerSample = FMath::Clamp(FMath::CeilToInt32(SampleTargetMicroseconds * 1000.0 / NsPerCall), 1, 1 << 20);
+
+            TArray<double> SampleNs;
+            SampleNs.Reserve(NumSamples);
+            double TotalNs = 0.0;
+
+            int32 CallIndex = 0;
+            for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+            {
+                const uint64 Start = FPlatformTime::Cycles64();
+                for (int32 i = 0; i < CallsPerSample; ++i)
+                {
+                    Body(CallIndex++);
+                }
+                const double ElapsedNs = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - Start) * 1.0e9;
+                const double PerOpNs = ElapsedNs / (static_cast<double>(CallsPerSample) * OpsPerCall);
+                SampleNs.Add(PerOpNs);
+                TotalNs += PerOpNs;
+            }
+
+            SampleNs.Sort();
+
+            FUtilityBenchmarkResult& Result = Results.AddDefaulted_GetRef();
+            Result.Kernel = Kernel;
+            Result.Size = Size;
+            Result.Samples = NumSamples;
+            Result.OpsPerSample = static_cast<int64>(CallsPerSample) * OpsPerCall;
+            Result.MeanNs = TotalNs / NumSamples;
+            Result.P50Ns = SampleNs[(NumSamples - 1) / 2];
+            Result.P99Ns = SampleNs[FMath::Min(NumSamples - 1, FMath::CeilToInt32((NumSamples - 1) * 0.99))];
+        }
+
+        const TArray<FUtilityBenchmarkResult>& GetResults() const { return Results; }
+
+        /**
+         * 将结果序列化为JSON（与基线文件格式相同）
+         * @param Baseline 当前基线，沿用其阈值和说明
+         */
+        FString ToJson(const FUtilityBenchmarkBaseline& Baseline) const
+        {
+            FString Output;
+            TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+            Writer->WriteObjectStart();
+            Writer->WriteValue(TEXT("version"), 1);
+            Writer->WriteValue(TEXT("regression_threshold_percent"), Baseline.ThresholdPercent);
+            Writer->WriteValue(TEXT("measured"), true);
+            Writer->WriteValue(TEXT("recorded_on"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+            if (!Baseline.Note.IsEmpty())
+            {
+                Writer->WriteValue(TEXT("note"), Baseline.Note);
+            }
+            Writer->WriteArrayStart(TEXT("kernels"));
+            for (const FUtilityBenchmarkResult& Result : Results)
+            {
+                Writer->WriteObjectStart();
+                Writer->WriteValue(TEXT("name"), Result.Kernel);
+                Writer->WriteValue(TEXT("size"), Result.Size);
+                Writer->WriteValue(TEXT("ns_per_op"), Result.MeanNs);
+                Writer->WriteValue(TEXT("p50_ns"), Result.P50Ns);
+                Writer->WriteValue(TEXT("p99_ns"), Result.P99Ns);
+                Writer->WriteValue(TEXT("samples"), Result.Samples);
+                Writer->WriteValue(TEXT("ops_per_sample"), Result.OpsPerSample);
+                Writer->WriteObjectEnd();
+            }
+            Writer->WriteArrayEnd();
+            Writer->WriteObjectEnd();
+            Writer->Close();
+            return Output;
+        }
+
+        /** 将结果序列化为CSV */
+        FString ToCsv() const
+        {
+            FString Output = TEXT("name,size,ns_per_op,p50_ns,p99_ns,samples,ops_per_sample\n");
+            for (const FUtilityBenchmarkResult& Result : Results)
+            {
+                Output += FString::Printf(TEXT("%s,%d,%.3f,%.3f,%.3f,%d,%lld\n"),
+                                          *Result.Kernel, Result.Size, Result.MeanNs, Result.P50Ns, Result.P99Ns,
+                                          Result.Samples, Result.OpsPerSample);
+            }
+            return Output;
+        }
+
+        /** 结果输出目录 */
+        static FString GetOutputDir()
+        {
+            return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"));
+        }
+
+        /** 基线文件路径 */
+        static FString GetBaselinePath()
+        {
+            return FPaths::Combine(FPaths::GameSourceDir(), TEXT("ElementalCombatTests"), TEXT("Benchmarks"), TEXT("UtilityAIBaseline.json"));
+        }
+
+        /**
+         * 读取基线
+         * @param OutBaseline 基线内容，文件缺失时保持默认值
+         * @return 基线文件是否存在且可解析
+         */
+        static bool LoadBaseline(FUtilityBenchmarkBaseline& OutBaseline)
+        {
+            OutBaseline.ThresholdPercent = DefaultRegressionThresholdPercent;
+
+            FString BaselineText;
+            if (!FFileHelper::LoadFileToString(BaselineText, *GetBaselinePath()))
+            {
+                return false;
+            }
+
+            TSharedPtr<FJsonObject> Root;
+            const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(BaselineText);
+            if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid())
+            {
+                return false;
+            }
+
+            Root->TryGetNumberField(TEXT("regression_threshold_percent"), OutBaseline.ThresholdPercent);
+            Root->TryGetBoolField(TEXT("measured"), OutBaseline.bMeasured);
+            Root->TryGetStringField(TEXT("recorded_on"), OutBaseline.RecordedOn);
+            Root->TryGetStringField(TEXT("note"), OutBaseline.Note);
+
+            const TArray<TSharedPtr<FJsonValue>>* Kernels = nullptr;
+            if (Root->TryGetArrayField(TEXT("kernels"), Kernels))
+            {
+                for (const TSharedPtr<FJsonValue>& Value : *Kernels)
+                {
+                    const TSharedPtr<FJsonObject>* Kernel = nullptr;
+                    if (!Value.IsValid() || !Value->TryGetObject(Kernel))
+                    {
+                        continue;
+                    }
+
+                    FString Name;
+                    int32 Size = 0;
+                    double P50Ns = 0.0;
+                    if ((*Kernel)->TryGetStringField(TEXT("name"), Name)
+                        && (*Kernel)->TryGetNumberField(TEXT("size"), Size)
+                        && (*Kernel)->TryGetNumberField(TEXT("p50_ns"), P50Ns))
+                    {
+                        OutBaseline.P50ByKey.Add(FString::Printf(TEXT("%s/%d"), *Name, Size), P50Ns);
+                    }
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        TArray<FUtilityBenchmarkResult> Results;
+    };
+
+    /** 基准测试数据 */
+    class FUtilityBenchmarkFixtures
+    {
+    public:
+        /** 上下文环的大小（每次调用轮换输入，避免分支预测和缓存结果失真） */
+        static constexpr int32 NumContexts = 64;
+
+        /**
+         * 创建包含指定数量评分因素的配置文件
+         * 前六项使用内置类型，其余使用不同名称的自定义输入
+         */
+        static FUtilityProfile CreateProfile(int32 NumConsiderations, bool bMultiplicative = false)
+        {
+            static const EConsiderationType BuiltInTypes[] =
+            {
+                EConsiderationType::Health,
+                EConsiderationType::Distance,
+                EConsiderationType::ElementAdvantage,
+                EConsiderationType::ThreatLevel,
+                EConsiderationType::Cooldown,
+                EConsiderationType::TeamStatus,
+            };
+
+            FUtilityProfile Profile;
+            Profile.ProfileName = FString::Printf(TEXT("Benchmark%d"), NumConsiderations);
+            Profile.bUseMultiplicativeCombination = bMultiplicative;
+
+            for (int32 i = 0; i < NumConsiderations; ++i)
+            {
+                FUtilityConsideration Consideration;
+                if (i < UE_ARRAY_COUNT(BuiltInTypes))
+                {
+                    Consideration.ConsiderationType = BuiltInTypes[i];
+                }
+                else
+                {
+                    Consideration.ConsiderationType = EConsiderationType::Custom;
+                    Consideration.CustomKey = FString::Printf(TEXT("Benchmark.Input%d"), i);
+                }
+
+                // 三个关键帧的非线性曲线，接近实际配置
+                Consideration.ResponseCurve.EditorCurveData.Reset();
+                Consideration.ResponseCurve.EditorCurveData.AddKey(0.0f, 0.1f);
+                Consideration.ResponseCurve.EditorCurveData.AddKey(0.5f, 0.8f - 0.02f * i);
+                Consideration.ResponseCurve.EditorCurveData.AddKey(1.0f, 0.3f);
+                Profile.Considerations.Add(Consideration);
+                Profile.SetWeight(Consideration.ConsiderationType, 1.0f + 0.1f * i);
+            }
+
+            Profile.BakeResponseCurves();
+            return Profile;
+        }
+
+        /** 创建轮换使用的上下文 */
+        static TArray<FUtilityContext> CreateContexts()
+        {
+            TArray<FUtilityContext> Contexts;
+            Contexts.SetNum(NumContexts);
+            for (int32 i = 0; i < NumContexts; ++i)
+            {
+                FUtilityContext& Context = Contexts[i];
+                Context.CurrentTime = 0.0f;
+                Context.HealthPercent = (i % 17) / 16.0f;
+                Context.TargetHealthPercent = (i % 11) / 10.0f;
+                Context.DistanceToTarget = (i % 23) * 60.0f;
+                Context.ElementAdvantage = (i % 3) - 1.0f;
+                Context.ThreatLevel = (i % 7) / 6.0f;
+                Context.SetCustomValue(UtilityCustomSlots::Cooldown, (i % 5) / 4.0f);
+                Context.SetCustomValue(UtilityCustomSlots::TeamStatus, (i % 9) / 8.0f);
+                for (int32 Input = 6; Input < 16; ++Input)
+                {
+                    Context.SetCustomValue(FString::Printf(TEXT("Benchmark.Input%d"), Input), ((i + Input) % 13) / 12.0f);
+                }
+            }
+            return Contexts;
+        }
+    };
+}
+
+using namespace ElementalCombat::Tests;
+
+/**
+ * Utility AI评分内核微基准测试
+ * 覆盖1-16个评分因素的配置文件和1-10000个AI的批量评分，输出ns/op、p50和p99
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUtilityAIBenchmarkTest,
+    "ElementalCombat.AI.Utility.Benchmark",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FUtilityAIBenchmarkTest::RunTest(const FString& Parameters)
+{
+    // Arrange - Benchmark.Input*使用固定名称的槽位，重复运行复用同一批槽位
+    FUtilityBenchmarkRunner Runner;
+    const TArray<FUtilityContext> Contexts = FUtilityBenchmarkFixtures::CreateContexts();
+    const int32 ContextMask = FUtilityBenchmarkFixtures::NumContexts - 1;
+    static_assert((FUtilityBenchmarkFixtures::NumContexts & (FUtilityBenchmarkFixtures::NumContexts - 1)) == 0, "上下文数量必须是2的幂");
+
+    // 累加结果防止编译器消除被测代码
+    volatile float Sink = 0.0f;
+
+    // Act - 单项评分
+    {
+        const FUtilityProfile Profile = FUtilityBenchmarkFixtures::CreateProfile(1);
+        const FUtilityConsideration& Baked = Profile.Considerations[0];
+        FUtilityConsideration Unbaked = Baked;
+        Unbaked.InvalidateBakedCurve();
+
+        Runner.Measure(TEXT("Consideration.CalculateScore.Baked"), 1, 1, [&](int32 i)
+        {
+            Sink = Sink + Baked.CalculateScore(Contexts[i & ContextMask]);
+        });
+        Runner.Measure(TEXT("Consideration.CalculateScore.RichCurve"), 1, 1, [&](int32 i)
+        {
+            Sink = Sink + Unbaked.CalculateScore(Contexts[i & ContextMask]);
+        });
+    }
+
+    // 配置文件评分、组合、配置文件哈希和增量评分（1-16个评分因素）
+    for (const int32 NumConsiderations : { 1, 2, 4, 8, 16 })
+    {
+        const FUtilityProfile Profile = FUtilityBenchmarkFixtures::CreateProfile(NumConsiderations);
+        FCompiledUtilityProfile Compiled;
+        Compiled.Compile(Profile);
+
+        Runner.Measure(TEXT("Profile.CalculateScore"), NumConsiderations, 1, [&](int32 i)
+        {
+            Sink = Sink + Profile.CalculateScore(Contexts[i & ContextMask]);
+        });
+
+        Runner.Measure(TEXT("CompiledProfile.CalculateScore"), NumConsiderations, 1, [&](int32 i)
+        {
+            Sink = Sink + Compiled.CalculateScore(Contexts[i & ContextMask]);
+        });
+
+        FUtilityIncrementalScoreState State;
+        Runner.Measure(TEXT("CompiledProfile.CalculateScoreIncremental.Stationary"), NumConsiderations, 1, [&](int32 i)
+        {
+            Sink = Sink + Compiled.CalculateScoreIncremental(Contexts[0], State);
+        });
+
+        TArray<float> Scores;
+        TArray<float> Weights;
+        for (int32 i = 0; i < NumConsiderations; ++i)
+        {
+            Scores.Add((i % 5 + 1) / 5.0f);
+            Weights.Add(1.0f + 0.1f * i);
+        }
+        Runner.Measure(TEXT("Calculator.CombineScores.Additive"), NumConsiderations, 1, [&](int32 i)
+        {
+            Scores[0] = (i & ContextMask) / static_cast<float>(ContextMask);
+            Sink = Sink + UUtilityCalculator::CombineScores(Scores, Weights, false);
+        });
+        Runner.Measure(TEXT("Calculator.CombineScores.Multiplicative"), NumConsiderations, 1, [&](int32 i)
+        {
+            Scores[0] = 0.01f + (i & ContextMask) / static_cast<float>(ContextMask);
+            Sink = Sink + UUtilityCalculator::CombineScores(Scores, Weights, true);
+        });
+
+        Runner.Measure(TEXT("ScoreCache.ComputeProfileIdentity"), NumConsiderations, 1, [&](int32 i)
+        {
+            Sink = Sink + static_cast<float>(FUtilityScoreCache::ComputeProfileIdentity(Profile) & 0xFF);
+        });
+    }
+
+    // 缓存查找（默认容量，满载）
+    {
+        FUtilityScoreCache Cache;
+        FUtilityScoreCache::FConfig Config;
+        Config.ValidDuration = 1.0e6f;
+        Cache.Configure(Config);
+
+        const uint32 Identity = 1;
+        for (const FUtilityContext& Context : Contexts)
+        {
+            Cache.Add(Identity, Context, Context.HealthPercent);
+        }
+
+        float CachedScore = 0.0f;
+        Runner.Measure(TEXT("ScoreCache.Find.Hit"), Config.Capacity, 1, [&](int32 i)
+        {
+            Cache.Find(Identity, Contexts[i & ContextMask], CachedScore);
+            Sink = Sink + CachedScore;
+        });
+        Runner.Measure(TEXT("ScoreCache.Find.Miss"), Config.Capacity, 1, [&](int32 i)
+        {
+            Cache.Find(Identity + 1, Contexts[i & ContextMask], CachedScore);
+            Sink = Sink + CachedScore;
+        });
+    }
+
+    // 批量评分（1-10000个AI，8个评分因素），按每个AI计时
+    {
+        const FUtilityProfile Profile = FUtilityBenchmarkFixtures::CreateProfile(8);
+        FCompiledUtilityProfile Compiled;
+        Compiled.Compile(Profile);
+
+        for (const int32 AgentCount : { 1, 10, 100, 1000, 10000 })
+        {
+            TArray<float> Health, Distance, Advantage, Threat, Cooldown, TeamStatus, CustomA, CustomB, Scores;
+            for (int32 i = 0; i < AgentCount; ++i)
+            {
+                const FUtilityContext& Context = Contexts[i & ContextMask];
+                Health.Add(Context.HealthPercent);
+                Distance.Add(Context.DistanceToTarget);
+                Advantage.Add(Context.ElementAdvantage);
+                Threat.Add(Context.ThreatLevel);
+                Cooldown.Add(Context.GetCustomValue(UtilityCustomSlots::Cooldown));
+                TeamStatus.Add(Context.GetCustomValue(UtilityCustomSlots::TeamStatus));
+                CustomA.Add(Context.GetCustomValue(TEXT("Benchmark.Input6")));
+                CustomB.Add(Context.GetCustomValue(TEXT("Benchmark.Input7")));
+            }
+            Scores.SetNumZeroed(AgentCount);
+
+            FUtilityBatchInputs Inputs;
+            Inputs.Count = AgentCount;
+            Inputs.HealthPercent = Health;
+            Inputs.DistanceToTarget = Distance;
+            Inputs.ElementAdvantage = Advantage;
+            Inputs.ThreatLevel = Threat;
+            Inputs.SetCustomColumn(UtilityCustomSlots::Cooldown, Cooldown);
+            Inputs.SetCustomColumn(UtilityCustomSlots::TeamStatus, TeamStatus);
+            Inputs.SetCustomColumn(TEXT("Benchmark.Input6"), CustomA);
+            Inputs.SetCustomColumn(TEXT("Benchmark.Input7"), CustomB);
+
+            Runner.Measure(TEXT("CompiledProfile.CalculateScores.Batch"), AgentCount, AgentCount, [&](int32 i)
+            {
+                Compiled.CalculateScores(Inputs, Scores);
+                Sink = Sink + Scores[i % AgentCount];
+            });
+
+            Runner.Measure(TEXT("Profile.CalculateScore.PerAgent"), AgentCount, AgentCount, [&](int32 i)
+            {
+                float Sum = 0.0f;
+                for (int32 Agent = 0; Agent < AgentCount; ++Agent)
+                {
+                    Sum += Profile.CalculateScore(Contexts[Agent & ContextMask]);
+                }
+                Sink = Sink + Sum;
+            });
+        }
+    }
+
+    // 输出结果
+    FUtilityBenchmarkBaseline Baseline;
+    const bool bHasBaseline = FUtilityBenchmarkRunner::LoadBaseline(Baseline);
+
+    const FString OutputDir = FUtilityBenchmarkRunner::GetOutputDir();
+    const FString JsonText = Runner.ToJson(Baseline);
+    FFileHelper::SaveStringToFile(JsonText, *FPaths::Combine(OutputDir, TEXT("UtilityAIBenchmark.json")));
+    FFileHelper::SaveStringToFile(Runner.ToCsv(), *FPaths::Combine(OutputDir, TEXT("UtilityAIBenchmark.csv")));
+
+    for (const FUtilityBenchmarkResult& Result : Runner.GetResults())
+    {
+        UE_LOG(LogTemp, Display, TEXT("Utility基准 %-56s size=%5d  %9.2f ns/op  p50=%9.2f  p99=%9.2f"),
+               *Result.Kernel, Result.Size, Result.MeanNs, Result.P50Ns, Result.P99Ns);
+    }
+
+    if (FParse::Param(FCommandLine::Get(), TEXT("UpdateUtilityBenchmarkBaseline")))
+    {
+        const bool bSaved = FFileHelper::SaveStringToFile(JsonText, *FUtilityBenchmarkRunner::GetBaselinePath());
+        TestTrue(TEXT("Baseline should be written"), bSaved);
+        UE_LOG(LogTemp, Display, TEXT("Utility基准基线已更新: %s"), *FUtilityBenchmarkRunner::GetBaselinePath());
+        return true;
+    }
+
+    // Assert - 与基线比较p50
+    // 实测基线下缺少基线或内核未录制都视为失败，避免回归检查被静默跳过；预算估计的基线只报告
+    if (!bHasBaseline)
+    {
+        AddError(FString::Printf(TEXT("Benchmark baseline not found or unreadable: %s"), *FUtilityBenchmarkRunner::GetBaselinePath()));
+        return false;
+    }
+
+    if (Baseline.bMeasured)
+    {
+        AddInfo(FString::Printf(TEXT("Gating against baseline measured on %s"), *Baseline.RecordedOn));
+    }
+    else
+    {
+        AddInfo(TEXT("Baseline holds budget estimates, not measurements; regressions are reported only. Record it on reference hardware with -UpdateUtilityBenchmarkBaseline to enable the gate."));
+    }
+
+    auto ReportMismatch = [this, &Baseline](const FString& Message)
+    {
+        if (Baseline.bMeasured)
+        {
+            AddError(Message);
+        }
+        else
+        {
+            AddInfo(Message);
+        }
+    };
+
+    TSet<FString> MeasuredKeys;
+    for (const FUtilityBenchmarkResult& Result : Runner.GetResults())
+    {
+        MeasuredKeys.Add(Result.GetKey());
+
+        const double* BaselineP50 = Baseline.P50ByKey.Find(Result.GetKey());
+        if (!BaselineP50 || *BaselineP50 <= 0.0)
+        {
+            ReportMismatch(FString::Printf(TEXT("%s has no baseline; run with -UpdateUtilityBenchmarkBaseline to record one"), *Result.GetKey()));
+            continue;
+        }
+
+        const double ChangePercent = (Result.P50Ns / *BaselineP50 - 1.0) * 100.0;
+        if (ChangePercent > Baseline.ThresholdPercent)
+        {
+            ReportMismatch(FString::Printf(TEXT("%s regressed %.1f%% (p50 %.2f ns vs baseline %.2f ns, threshold %.1f%%)"),
+                                           *Result.GetKey(), ChangePercent, Result.P50Ns, *BaselineP50, Baseline.ThresholdPercent));
+        }
+    }
+
+    // 基线中已不再测量的内核说明基线过期
+    for (const TPair<FString, double>& Pair : Baseline.P50ByKey)
+    {
+        if (!MeasuredKeys.Contains(Pair.Key))
+        {
+            ReportMismatch(FString::Printf(TEXT("Baseline kernel %s is no longer measured; re-record the baseline"), *Pair.Key));
+        }
+    }
+
+    return true;
+}
@@ -4,7 +4,16 @@
 #include "Misc/AutomationTest.h"
 #include "AI/Utility/UtilityAITypes.h"
 #include "AI/Utility/IUtilityScorer.h"
+#include "AI/Utility/UtilityCalculator.h"
+#include "AI/Utility/UtilityCurveLUT.h"
+#include "AI/Utility/UtilityAISubsystem.h"
+#include "AI/Utility/UtilityScoreCache.h"
+#include "AI/Utility/UtilityProfileRegistry.h"
+#include "AI/Utility/UtilityProfileSetEvaluator.h"
+#include "AI/Utility/UtilityInputProviders.h"
+#include "Engine/DataTable.h"
 #include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
 #include "GameFramework/Actor.h"
 
 // === Utility AI基础功能测试 ===
@@ -31,14 +40,66 @@ bool FUtilityContextTest::RunTest(const FString& Parameters)
     TestEqual(TEXT("Element advantage input value"), Context.GetInputValue(EConsiderationType::ElementAdvantage), 1.0f); // (1+1)*0.5
     TestEqual(TEXT("Threat level input value"), Context.GetInputValue(EConsiderationType::ThreatLevel), 0.6f);
 
-    // 测试自定义值
-    Context.SetCustomValue(TEXT("TestKey"), 0.8f);
-    TestEqual(TEXT("Custom value"), Context.GetCustomValue(TEXT("TestKey")), 0.8f);
+    // 测试自定义值（槽位只追加，测试使用固定名称，重复运行复用同一个槽位）
+    Context.SetCustomValue(TEXT("Test.CustomInput"), 0.8f);
+    TestEqual(TEXT("Custom value"), Context.GetCustomValue(TEXT("Test.CustomInput")), 0.8f);
     TestEqual(TEXT("Non-existent custom value"), Context.GetCustomValue(TEXT("NonExistent"), 0.5f), 0.5f);
 
     return true;
 }
 
+/**
+ * 测试自定义输入槽位
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUtilityCustomSlotTest,
+    "ElementalCombat.AI.Utility.CustomSlots",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FUtilityCustomSlotTest::RunTest(const FString& Parameters)
+{
+    // Arrange - 内置槽位应预先注册
+    FUtilityCustomSlotRegistry& Registry = FUtilityCustomSlotRegistry::Get();
+    TestEqual(TEXT("Cooldown slot registered"), Registry.FindSlot(TEXT("CooldownPercent")), UtilityCustomSlots::Cooldown);
+    TestEqual(TEXT("Team status slot registered"), Registry.FindSlot(TEXT("TeamStatusPercent")), UtilityCustomSlots::TeamStatus);
+
+    const int32 TestSlot = Registry.FindOrAddSlot(TEXT("Test.CustomInput"));
+    TestTrue(TEXT("Custom slot registered"), TestSlot != INDEX_NONE);
+    TestEqual(TEXT("Registration is idempotent"), Registry.FindOrAddSlot(TEXT("Test.CustomInput")), TestSlot);
+    TestEqual(TEXT("Slot name round-trips"), Registry.GetSlotName(TestSlot), FName(TEXT("Test.CustomInput")));
+
+    // Act & Assert - 名称接口和槽位接口读写同一份数据
+    FUtilityContext Context;
+    TestFalse(TEXT("Slot unset by default"), Context.HasCustomValue(TestSlot));
+    Context.SetCustomValue(TEXT("Test.CustomInput"), 0.35f);
+    TestEqual(TEXT("Slot read after name write"), Context.GetCustomValue(TestSlot), 0.35f);
+
+    Context.SetCustomValue(UtilityCustomSlots::Cooldown, 0.2f);
+    TestEqual(TEXT("Cooldown input from slot"), Context.GetInputValue(EConsiderationType::Cooldown), 0.2f);
+    TestEqual(TEXT("Team status default"), Context.GetInputValue(EConsiderationType::TeamStatus), 0.5f);
+
+    // Custom类型的评分因素解析槽位后按下标读取
+    FUtilityConsideration CustomConsideration;
+    CustomConsideration.ConsiderationType = EConsiderationType::Custom;
+    CustomConsideration.CustomKey = TEXT("Test.CustomInput");
+    const float UnresolvedScore = CustomConsideration.CalculateScore(Context);
+    CustomConsideration.ResolveCustomSlot();
+    TestEqual(TEXT("Resolved custom slot"), CustomConsideration.GetCustomSlot(), TestSlot);
+    TestEqual(TEXT("Resolved score matches name lookup"), CustomConsideration.CalculateScore(Context), UnresolvedScore);
+
+    // 越界槽位应被忽略
+    Context.SetCustomValue(INDEX_NONE, 1.0f);
+    TestEqual(TEXT("Invalid slot returns default"), Context.GetCustomValue(INDEX_NONE, 0.7f), 0.7f);
+
+    // 槽位只追加：已解析的下标在之后的注册中保持有效
+    const int32 NumSlotsBefore = Registry.GetNumSlots();
+    const int32 OtherSlot = Registry.FindOrAddSlot(TEXT("Test.LineOfSight"));
+    TestTrue(TEXT("Later registration appends"), OtherSlot != TestSlot && Registry.GetNumSlots() >= NumSlotsBefore);
+    TestEqual(TEXT("Earlier slot still resolves"), Registry.FindSlot(TEXT("Test.CustomInput")), TestSlot);
+    TestEqual(TEXT("Built-in slot kept"), Registry.FindSlot(TEXT("CooldownPercent")), UtilityCustomSlots::Cooldown);
+
+    return true;
+}
+
 /**
  * 测试FUtilityConsideration的评分计算
  */
@@ -178,6 +239,986 @@ bool FUtilityResponseCurveTest::RunTest(const FString& Parameters)
     return true;
 }
 
+/**
+ * 测试响应曲线查找表烘焙
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUtilityBakedCurveTest,
+    "ElementalCombat.AI.Utility.BakedCurve",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FUtilityBakedCurveTest::RunTest(const FString& Parameters)
+{
+    // Arrange - 创建非线性响应曲线
+    FUtilityConsideration Consideration;
+    Consideration.ConsiderationType = EConsiderationType::Health;
+    Consideration.ResponseCurve.EditorCurveData.Reset();
+    Consideration.ResponseCurve.EditorCurveData.AddKey(0.0f, 0.0f);
+    Consideration.ResponseCurve.EditorCurveData.AddKey(0.3f, 0.8f);
+    Consideration.ResponseCurve.EditorCurveData.AddKey(1.0f, 0.2f);
+    Consideration.BakedCurveSampleCount = 8;
+    Consideration.BakedCurveMaxError = 0.001f;
+
+    // 未烘焙时的直接求值结果作为基准
+    TArray<float> Inputs;
+    TArray<float> ReferenceScores;
+    FUtilityContext Context;
+    for (int32 i = 0; i <= 37; ++i)
+    {
+        Context.HealthPercent = static_cast<float>(i) / 37.0f;
+        Inputs.Add(Context.HealthPercent);
+        ReferenceScores.Add(Consideration.CalculateScore(Context));
+    }
+
+    // Act - 烘焙查找表
+    const bool bWithinError = Consideration.BakeResponseCurve();
+
+    // Assert - 误差约束应通过自动加密采样满足
+    TestTrue(TEXT("Baked curve within error bound"), bWithinError);
+    TestTrue(TEXT("Baked curve exists"), Consideration.HasBakedCurve());
+    TestTrue(TEXT("Sample count was refined"), Consideration.GetBakedCurve()->GetSampleCount() > 8);
+
+    float MaxDeviation = 0.0f;
+    TestTrue(TEXT("Validation passes"), Consideration.ValidateBakedCurve(MaxDeviation, 1001));
+    TestTrue(TEXT("Validation deviation within bound"), MaxDeviation <= Consideration.BakedCurveMaxError);
+
+    for (int32 i = 0; i < Inputs.Num(); ++i)
+    {
+        Context.HealthPercent = Inputs[i];
+        TestNearlyEqual(TEXT("Baked score matches curve"), Consideration.CalculateScore(Context), ReferenceScores[i], 0.001f);
+    }
+
+    // 批量路径应与标量路径完全一致（包括非4整数倍的尾部元素）
+    const FUtilityCurveLUT* LUT = Consideration.GetBakedCurve();
+    TArray<float> BatchOutputs;
+    BatchOutputs.SetNumZeroed(Inputs.Num());
+    LUT->EvalBatch(Inputs.GetData(), BatchOutputs.GetData(), Inputs.Num());
+    for (int32 i = 0; i < Inputs.Num(); ++i)
+    {
+        TestNearlyEqual(TEXT("Batch eval matches scalar eval"), BatchOutputs[i], LUT->Eval(Inputs[i]), KINDA_SMALL_NUMBER);
+    }
+
+    // 固定采样数量的校验模式应报告非零偏差
+    float CoarseDeviation = 0.0f;
+    TestTrue(TEXT("Coarse validation succeeds"), UUtilityCalculator::ValidateBakedResponseCurve(Consideration.ResponseCurve, 4, CoarseDeviation));
+    TestTrue(TEXT("Coarse bake reports deviation"), CoarseDeviation > MaxDeviation);
+
+    // 关闭bUseBakedCurve后即使查找表仍在也应直接求值曲线
+    const FRichCurve* RichCurve = Consideration.ResponseCurve.GetRichCurveConst();
+    Consideration.bUseBakedCurve = false;
+    TestTrue(TEXT("Stale LUT still present"), Consideration.HasBakedCurve());
+    for (const float Input : { 0.11f, 0.47f, 0.93f })
+    {
+        TestEqual(TEXT("Disabled flag evaluates curve directly"), Consideration.EvaluateCurve(Input), RichCurve->Eval(Input));
+    }
+
+    // 通过设置函数修改后自动重新烘焙
+    TestTrue(TEXT("Re-enabling rebakes"), Consideration.SetBakedCurveSettings(true, 16, 0.001f));
+    TestTrue(TEXT("Settings rebake produced a LUT"), Consideration.HasBakedCurve());
+
+    FRichCurve Flipped;
+    Flipped.AddKey(0.0f, 1.0f);
+    Flipped.AddKey(1.0f, 0.0f);
+    Consideration.SetResponseCurve(Flipped);
+    TestNearlyEqual(TEXT("Replaced curve is rebaked"), Consideration.EvaluateCurve(0.25f), 0.75f, 0.001f);
+
+    Consideration.SetBakedCurveSettings(false, 16, 0.001f);
+    TestFalse(TEXT("Disabling discards the LUT"), Consideration.HasBakedCurve());
+
+    return true;
+}
+
+/**
+ * 测试编译后的配置文件与原始配置文件评分一致
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCompiledUtilityProfileTest,
+    "ElementalCombat.AI.Utility.CompiledProfile",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FCompiledUtilityProfileTest::RunTest(const FString& Parameters)
+{
+    constexpr float Tolerance = 0.005f;
+
+    // Arrange - 创建包含多种曲线和权重的配置文件
+    FUtilityProfile Profile;
+    Profile.ProfileName = TEXT("CompiledTestProfile");
+
+    FUtilityConsideration HealthConsideration;
+    HealthConsideration.ConsiderationType = EConsiderationType::Health;
+    HealthConsideration.bInvertInput = true;
+    HealthConsideration.ResponseCurve.EditorCurveData.Reset();
+    HealthConsideration.ResponseCurve.EditorCurveData.AddKey(0.0f, 0.1f);
+    HealthConsideration.ResponseCurve.EditorCurveData.AddKey(0.5f, 0.3f);
+    HealthConsideration.ResponseCurve.EditorCurveData.AddKey(1.0f, 1.0f);
+    Profile.Considerations.Add(HealthConsideration);
+
+    FUtilityConsideration DistanceConsideration;
+    DistanceConsideration.ConsiderationType = EConsiderationType::Distance;
+    DistanceConsideration.InputMultiplier = 1.5f;
+    DistanceConsideration.OutputOffset = 0.1f;
+    DistanceConsideration.ResponseCurve.EditorCurveData.Reset();
+    DistanceConsideration.ResponseCurve.EditorCurveData.AddKey(0.0f, 1.0f);
+    DistanceConsideration.ResponseCurve.EditorCurveData.AddKey(1.0f, 0.2f);
+    Profile.Considerations.Add(DistanceConsideration);
+
+    FUtilityConsideration ElementConsideration;
+    ElementConsideration.ConsiderationType = EConsiderationType::ElementAdvantage;
+    Profile.Considerations.Add(ElementConsideration);
+
+    FUtilityConsideration ThreatConsideration;
+    ThreatConsideration.ConsiderationType = EConsiderationType::ThreatLevel;
+    Profile.Considerations.Add(ThreatConsideration);
+
+    Profile.SetWeight(EConsiderationType::Health, 0.3f);
+    Profile.SetWeight(EConsiderationType::Distance, 2.0f);
+    Profile.SetWeight(EConsiderationType::ElementAdvantage, 0.7f);
+    Profile.SetWeight(EConsiderationType::ThreatLevel, 0.0f); // 编译时应被剔除
+
+    for (const bool bMultiplicative : { false, true })
+    {
+        Profile.bUseMultiplicativeCombination = bMultiplicative;
+
+        // Act - 编译配置文件
+        FCompiledUtilityProfile Compiled;
+        TestTrue(TEXT("Compiled profile within error bound"), Compiled.Compile(Profile));
+        TestEqual(TEXT("Zero weight consideration dropped"), Compiled.GetNumActiveConsiderations(), 3);
+        TestEqual(TEXT("Weight stored by type"), Compiled.GetWeight(EConsiderationType::Distance), 2.0f);
+
+        // Assert - 在输入空间中逐点比较
+        for (int32 HealthStep = 0; HealthStep <= 10; ++HealthStep)
+        {
+            for (int32 DistanceStep = 0; DistanceStep <= 10; ++DistanceStep)
+            {
+                FUtilityContext Context;
+                Context.HealthPercent = HealthStep * 0.1f;
+                Context.DistanceToTarget = DistanceStep * 100.0f;
+                Context.ElementAdvantage = (HealthStep % 3) - 1.0f;
+                Context.ThreatLevel = DistanceStep * 0.1f;
+
+                bool bReferenceValid = false;
+                bool bCompiledValid = false;
+                const float ReferenceScore = Profile.CalculateScore(Context, nullptr, &bReferenceValid);
+                const float CompiledScore = UUtilityCalculator::CalculateUtilityScore(Compiled, Context, &bCompiledValid);
+
+                TestNearlyEqual(FString::Printf(TEXT("Compiled score matches (multiplicative=%d, health=%d, distance=%d)"), bMultiplicative, HealthStep, DistanceStep),
+                                CompiledScore, ReferenceScore, Tolerance);
+                TestEqual(TEXT("Compiled validity matches"), bCompiledValid, bReferenceValid);
+            }
+        }
+    }
+
+    // 空配置文件与全零权重配置文件的行为应与原始路径一致
+    FCompiledUtilityProfile EmptyCompiled;
+    EmptyCompiled.Compile(FUtilityProfile());
+    bool bEmptyValid = true;
+    TestEqual(TEXT("Empty compiled profile scores zero"), EmptyCompiled.CalculateScore(FUtilityContext(), &bEmptyValid), 0.0f);
+    TestFalse(TEXT("Empty compiled profile is invalid"), bEmptyValid);
+
+    return true;
+}
+
+/**
+ * 测试批量（结构数组）评分与逐个评分一致
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUtilityBatchScoringTest,
+    "ElementalCombat.AI.Utility.BatchScoring",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FUtilityBatchScoringTest::RunTest(const FString& Parameters)
+{
+    // Arrange - 配置文件覆盖内置输入和自定义输入
+    FUtilityProfile Profile;
+    Profile.ProfileName = TEXT("BatchTestProfile");
+
+    FUtilityConsideration HealthConsideration;
+    HealthConsideration.ConsiderationType = EConsiderationType::Health;
+    HealthConsideration.bInvertInput = true;
+    Profile.Considerations.Add(HealthConsideration);
+
+    FUtilityConsideration DistanceConsideration;
+    DistanceConsideration.ConsiderationType = EConsiderationType::Distance;
+    DistanceConsideration.ResponseCurve.EditorCurveData.Reset();
+    DistanceConsideration.ResponseCurve.EditorCurveData.AddKey(0.0f, 1.0f);
+    DistanceConsideration.ResponseCurve.EditorCurveData.AddKey(1.0f, 0.1f);
+    Profile.Considerations.Add(DistanceConsideration);
+
+    FUtilityConsideration AdvantageConsideration;
+    AdvantageConsideration.ConsiderationType = EConsiderationType::ElementAdvantage;
+    AdvantageConsideration.InputMultiplier = 0.8f;
+    Profile.Considerations.Add(AdvantageConsideration);
+
+    FUtilityConsideration CooldownConsideration;
+    CooldownConsideration.ConsiderationType = EConsiderationType::Cooldown;
+    Profile.Considerations.Add(CooldownConsideration);
+
+    // 人数跨越批处理块边界且不是4的整数倍
+    constexpr int32 AgentCount = 613;
+    TArray<float> Health, Distance, Advantage, Cooldown;
+    for (int32 i = 0; i < AgentCount; ++i)
+    {
+        Health.Add((i % 17) / 16.0f);
+        Distance.Add((i % 23) * 60.0f);
+        Advantage.Add((i % 3) - 1.0f);
+        Cooldown.Add((i % 5) / 4.0f);
+    }
+
+    FUtilityBatchInputs Inputs;
+    Inputs.Count = AgentCount;
+    Inputs.HealthPercent = Health;
+    Inputs.DistanceToTarget = Distance;
+    Inputs.ElementAdvantage = Advantage;
+    Inputs.SetCustomColumn(UtilityCustomSlots::Cooldown, Cooldown);
+
+    for (const bool bMultiplicative : { false, true })
+    {
+        Profile.bUseMultiplicativeCombination = bMultiplicative;
+        FCompiledUtilityProfile Compiled;
+        Compiled.Compile(Profile);
+
+        // Act - 批量评分
+        TArray<float> BatchScores;
+        BatchScores.SetNumUninitialized(AgentCount);
+        UUtilityCalculator::CalculateUtilityScores(Compiled, Inputs, BatchScores);
+
+        // Assert - 与逐个评分比较（未提供的威胁等级列使用默认值）
+        for (int32 i = 0; i < AgentCount; ++i)
+        {
+            FUtilityContext Context;
+            Context.HealthPercent = Health[i];
+            Context.DistanceToTarget = Distance[i];
+            Context.ElementAdvantage = Advantage[i];
+            Context.SetCustomValue(UtilityCustomSlots::Cooldown, Cooldown[i]);
+
+            const float SingleScore = Compiled.CalculateScore(Context);
+            if (!FMath::IsNearlyEqual(BatchScores[i], SingleScore, 1.0e-4f))
+            {
+                AddError(FString::Printf(TEXT("Batch score mismatch at %d (multiplicative=%d): %f vs %f"),
+                                         i, bMultiplicative, BatchScores[i], SingleScore));
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * 测试共享输入评估器合并等价评分因素，且每个配置文件的评分与单独评分逐位一致
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUtilityProfileSetEvaluatorTest,
+    "ElementalCombat.AI.Utility.ProfileSetEvaluator",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FUtilityProfileSetEvaluatorTest::RunTest(const FString& Parameters)
+{
+    // Arrange - 三个配置文件使用相同的评分因素，只有权重和组合方式不同，其中一个多一项不同曲线的距离评分
+    FUtilityConsideration HealthConsideration;
+    HealthConsideration.ConsiderationType = EConsiderationType::Health;
+    HealthConsideration.ResponseCurve.EditorCurveData.Reset();
+    HealthConsideration.ResponseCurve.EditorCurveData.AddKey(0.0f, 0.1f);
+    HealthConsideration.ResponseCurve.EditorCurveData.AddKey(1.0f, 0.9f);
+
+    FUtilityConsideration DistanceConsideration;
+    DistanceConsideration.ConsiderationType = EConsiderationType::Distance;
+
+    FUtilityConsideration ThreatConsideration;
+    ThreatConsideration.ConsiderationType = EConsiderationType::ThreatLevel;
+
+    FUtilityConsideration FarDistanceConsideration = DistanceConsideration;
+    FarDistanceConsideration.bInvertInput = true;
+
+    FUtilityProfile Fire;
+    Fire.ProfileName = TEXT("Fire");
+    Fire.Considerations = { HealthConsideration, DistanceConsideration, ThreatConsideration };
+    Fire.SetWeight(EConsiderationType::Health, 2.0f);
+
+    FUtilityProfile Water = Fire;
+    Water.ProfileName = TEXT("Water");
+    Water.SetWeight(EConsiderationType::Distance, 3.0f);
+    Water.bUseMultiplicativeCombination = true;
+
+    FUtilityProfile Earth = Fire;
+    Earth.ProfileName = TEXT("Earth");
+    Earth.Considerations.Add(FarDistanceConsideration);
+    Earth.SetWeight(EConsiderationType::ThreatLevel, 0.5f);
+
+    for (FUtilityProfile* Profile : { &Fire, &Water, &Earth })
+    {
+        Profile->BakeResponseCurves();
+    }
+
+    // Act
+    FUtilityProfileSetEvaluator Evaluator;
+    const FUtilityProfile* Profiles[] = { &Fire, &Water, &Earth };
+    Evaluator.Build(Profiles);
+
+    // Assert - 10项评分因素合并为4项
+    TestEqual(TEXT("All profiles should be registered"), Evaluator.GetNumProfiles(), 3);
+    TestEqual(TEXT("Total considerations should be counted before merging"), Evaluator.GetNumTotalConsiderations(), 10);
+    TestEqual(TEXT("Equivalent considerations should be merged"), Evaluator.GetNumUniqueConsiderations(), 4);
+    TestTrue(TEXT("Different modifiers should not be merged"), !FUtilityProfileSetEvaluator::AreEquivalent(DistanceConsideration, FarDistanceConsideration));
+
+    for (int32 Step = 0; Step <= 10; ++Step)
+    {
+        FUtilityContext Context;
+        Context.HealthPercent = Step * 0.1f;
+        Context.DistanceToTarget = (10 - Step) * 150.0f;
+        Context.ThreatLevel = (Step % 4) * 0.25f;
+
+        FUtilityRankedScore Ranked[UE_ARRAY_COUNT(Profiles)];
+        Evaluator.Evaluate(Context, Ranked);
+
+        for (int32 Rank = 0; Rank < UE_ARRAY_COUNT(Ranked); ++Rank)
+        {
+            const FUtilityRankedScore& Result = Ranked[Rank];
+            bool bReferenceValid = false;
+            const float ReferenceScore = Profiles[Result.ProfileIndex]->CalculateScore(Context, nullptr, &bReferenceValid);
+            TestTrue(FString::Printf(TEXT("Shared-input score should match profile %d exactly (step=%d)"), Result.ProfileIndex, Step), Result.Score == ReferenceScore);
+            TestEqual(TEXT("Validity should match"), Result.bIsValid, bReferenceValid);
+            if (Rank > 0)
+            {
+                TestTrue(TEXT("Results should be ranked from best to worst"), Ranked[Rank - 1].Score >= Result.Score);
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * 测试增量评分只重新求值输入变化的评分因素，且结果与完整评分一致
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUtilityIncrementalScoringTest,
+    "ElementalCombat.AI.Utility.IncrementalScoring",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FUtilityIncrementalScoringTest::RunTest(const FString& Parameters)
+{
+    // Arrange - 健康度精确重新评分，距离变化不超过阈值时沿用缓存输出
+    FUtilityProfile Profile;
+    Profile.ProfileName = TEXT("IncrementalTestProfile");
+
+    FUtilityConsideration HealthConsideration;
+    HealthConsideration.ConsiderationType = EConsiderationType::Health;
+    Profile.Considerations.Add(HealthConsideration);
+
+    FUtilityConsideration DistanceConsideration;
+    DistanceConsideration.ConsiderationType = EConsiderationType::Distance;
+    DistanceConsideration.RescoreInputEpsilon = 0.02f;
+    Profile.Considerations.Add(DistanceConsideration);
+
+    FUtilityConsideration ThreatConsideration;
+    ThreatConsideration.ConsiderationType = EConsiderationType::ThreatLevel;
+    Profile.Considerations.Add(ThreatConsideration);
+
+    Profile.SetWeight(EConsiderationType::Health, 1.0f);
+    Profile.SetWeight(EConsiderationType::Distance, 2.0f);
+    Profile.SetWeight(EConsiderationType::ThreatLevel, 1.0f);
+
+    for (const bool bMultiplicative : { false, true })
+    {
+        Profile.bUseMultiplicativeCombination = bMultiplicative;
+        FCompiledUtilityProfile Compiled;
+        Compiled.Compile(Profile);
+
+        FUtilityIncrementalScoreState State;
+        FUtilityContext Context;
+        Context.HealthPercent = 0.6f;
+        Context.DistanceToTarget = 400.0f;
+        Context.ThreatLevel = 0.3f;
+
+        // Act & Assert - 首次评分求值所有评分因素，结果逐位一致
+        float Score = Compiled.CalculateScoreIncremental(Context, State);
+        const float FullScore = Compiled.CalculateScore(Context);
+        TestEqual(TEXT("First evaluation should rescore every consideration"), State.LastRescoredCount, 3);
+        TestTrue(TEXT("First incremental score should match full score bitwise"), FMemory::Memcmp(&Score, &FullScore, sizeof(float)) == 0);
+
+        // 输入不变时不重新求值
+        Score = Compiled.CalculateScoreIncremental(Context, State);
+        TestEqual(TEXT("Stationary agent should rescore nothing"), State.LastRescoredCount, 0);
+        TestEqual(TEXT("Stationary agent should keep its score"), Score, FullScore);
+
+        // 只有健康度变化
+        Context.HealthPercent = 0.4f;
+        Score = Compiled.CalculateScoreIncremental(Context, State);
+        TestEqual(TEXT("Only the changed consideration should be rescored"), State.LastRescoredCount, 1);
+        TestNearlyEqual(TEXT("Incremental score should follow the changed input"), Score, Compiled.CalculateScore(Context), 1.0e-6f);
+
+        // 距离变化在阈值内（10单位 = 0.01标准化输入）时沿用缓存输出
+        const float ScoreBeforeMove = Score;
+        Context.DistanceToTarget = 410.0f;
+        Score = Compiled.CalculateScoreIncremental(Context, State);
+        TestEqual(TEXT("Movement within epsilon should not rescore"), State.LastRescoredCount, 0);
+        TestEqual(TEXT("Movement within epsilon should keep the score"), Score, ScoreBeforeMove);
+
+        // 相对上次求值的输入累计超过阈值后重新求值
+        Context.DistanceToTarget = 430.0f;
+        Score = Compiled.CalculateScoreIncremental(Context, State);
+        TestEqual(TEXT("Accumulated movement beyond epsilon should rescore"), State.LastRescoredCount, 1);
+        TestNearlyEqual(TEXT("Rescored distance should match full score"), Score, Compiled.CalculateScore(Context), 1.0e-6f);
+
+        // 权重覆盖变化时只重新组合
+        float Weights[FCompiledUtilityProfile::NumConsiderationTypes] = {};
+        Weights[static_cast<int32>(EConsiderationType::Health)] = 3.0f;
+        Weights[static_cast<int32>(EConsiderationType::Distance)] = 1.0f;
+        Weights[static_cast<int32>(EConsiderationType::ThreatLevel)] = 1.0f;
+        Score = Compiled.CalculateScoreIncremental(Context, State, Weights);
+        const float WeightedScore = Compiled.CalculateScoreWithWeights(Context, Weights);
+        TestEqual(TEXT("Weight change alone should not rescore considerations"), State.LastRescoredCount, 0);
+        TestTrue(TEXT("Reweighted incremental score should match bitwise"), FMemory::Memcmp(&Score, &WeightedScore, sizeof(float)) == 0);
+
+        // 同一地址上重新编译出的配置文件（评分因素数量相同）不应沿用旧状态
+        FUtilityProfile ShiftedProfile = Profile;
+        for (FUtilityConsideration& Consideration : ShiftedProfile.Considerations)
+        {
+            Consideration.OutputOffset = 0.2f;
+        }
+        const uint64 OldVersion = Compiled.GetVersion();
+        Compiled.Compile(ShiftedProfile);
+        TestNotEqual(TEXT("Recompiling should assign a new version"), Compiled.GetVersion(), OldVersion);
+
+        Score = Compiled.CalculateScoreIncremental(Context, State, Weights);
+        TestEqual(TEXT("Recompiled profile should rescore every consideration"), State.LastRescoredCount, 3);
+        TestNearlyEqual(TEXT("Recompiled profile should not reuse stale terms"), Score, Compiled.CalculateScoreWithWeights(Context, Weights), 1.0e-6f);
+    }
+
+    return true;
+}
+
+/**
+ * 测试定长评分缓存的量化命中、配置文件隔离、过期和CLOCK淘汰
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUtilityScoreCacheTest,
+    "ElementalCombat.AI.Utility.ScoreCache",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FUtilityScoreCacheTest::RunTest(const FString& Parameters)
+{
+    // Arrange - 两个只有权重不同的配置文件
+    FUtilityProfile ProfileA;
+    ProfileA.ProfileName = TEXT("CacheTestProfile");
+    FUtilityConsideration HealthConsideration;
+    HealthConsideration.ConsiderationType = EConsiderationType::Health;
+    ProfileA.Considerations.Add(HealthConsideration);
+    FUtilityConsideration DistanceConsideration;
+    DistanceConsideration.ConsiderationType = EConsiderationType::Distance;
+    ProfileA.Considerations.Add(DistanceConsideration);
+    ProfileA.Weights.Add(EConsiderationType::Health, 1.0f);
+    ProfileA.Weights.Add(EConsiderationType::Distance, 1.0f);
+
+    FUtilityProfile ProfileB = ProfileA;
+    ProfileB.Weights.Add(EConsiderationType::Distance, 3.0f);
+
+    const uint32 IdentityA = FUtilityScoreCache::ComputeProfileIdentity(ProfileA);
+    const uint32 IdentityB = FUtilityScoreCache::ComputeProfileIdentity(ProfileB);
+    TestNotEqual(TEXT("Profiles with different weights should have different identities"), IdentityA, IdentityB);
+    TestEqual(TEXT("Profile identity should be deterministic"), FUtilityScoreCache::ComputeProfileIdentity(ProfileA), IdentityA);
+
+    FUtilityScoreCache Cache;
+    FUtilityScoreCache::FConfig Config;
+    Config.Capacity = 4;
+    Config.ValidDuration = 1.0f;
+    Config.DistanceBucket = 50.0f;
+    Config.InputBucket = 0.1f;
+
+    FUtilityContext Context;
+    Context.CurrentTime = 10.0f;
+    Context.HealthPercent = 0.52f;
+    Context.DistanceToTarget = 410.0f;
+
+    float Score = 0.0f;
+    TestFalse(TEXT("Unconfigured cache should always miss"), Cache.Find(IdentityA, Context, Score));
+    Cache.Configure(Config);
+
+    // Act & Assert - 同一分桶内的输入命中
+    Cache.Add(IdentityA, Context, 0.75f);
+    FUtilityContext NearbyContext = Context;
+    NearbyContext.HealthPercent = 0.58f;
+    NearbyContext.DistanceToTarget = 440.0f;
+    TestTrue(TEXT("Inputs in the same buckets should hit"), Cache.Find(IdentityA, NearbyContext, Score));
+    TestEqual(TEXT("Cached score should be returned"), Score, 0.75f);
+
+    NearbyContext.DistanceToTarget = 460.0f;
+    TestFalse(TEXT("Distance in the next bucket should miss"), Cache.Find(IdentityA, NearbyContext, Score));
+
+    // 配置文件标识不同的查询互不命中
+    TestFalse(TEXT("A different profile must not reuse the entry"), Cache.Find(IdentityB, Context, Score));
+
+    // 过期条目视为未命中
+    FUtilityContext LaterContext = Context;
+    LaterContext.CurrentTime = 11.5f;
+    TestFalse(TEXT("Expired entry should miss"), Cache.Find(IdentityA, LaterContext, Score));
+    TestEqual(TEXT("Expired entry should be released"), Cache.GetStats().NumEntries, 0);
+
+    // 写入超过容量的条目，缓存大小保持不变并产生淘汰
+    for (int32 i = 0; i < 20; ++i)
+    {
+        FUtilityContext FillContext = Context;
+        FillContext.DistanceToTarget = i * 100.0f;
+        Cache.Add(IdentityA, FillContext, static_cast<float>(i));
+    }
+
+    const FUtilityScoreCacheStats Stats = Cache.GetStats();
+    TestEqual(TEXT("Cache should never exceed its capacity"), Stats.NumEntries, 4);
+    TestEqual(TEXT("Capacity should match configuration"), Stats.Capacity, 4);
+    TestEqual(TEXT("Entries beyond capacity should be evicted"), Stats.Evictions, static_cast<uint64>(16));
+    TestEqual(TEXT("Hits should be counted"), Stats.Hits, static_cast<uint64>(1));
+    TestEqual(TEXT("Misses should be counted"), Stats.Misses, static_cast<uint64>(4));
+    TestEqual(TEXT("Expirations should be counted"), Stats.Expirations, static_cast<uint64>(1));
+
+    // 最近写入的条目仍然可以命中
+    FUtilityContext LastContext = Context;
+    LastContext.DistanceToTarget = 1900.0f;
+    TestTrue(TEXT("Most recent entry should survive eviction"), Cache.Find(IdentityA, LastContext, Score));
+    TestEqual(TEXT("Most recent entry should keep its score"), Score, 19.0f);
+
+    // 清理过期条目
+    TestEqual(TEXT("RemoveExpired should release all stale entries"), Cache.RemoveExpired(20.0f), 4);
+    TestEqual(TEXT("Cache should be empty after removing expired entries"), Cache.GetStats().NumEntries, 0);
+
+    // 最大容量下写满并继续淘汰，下标表在替换后仍能找到每个存活的条目
+    Config.Capacity = FUtilityScoreCache::MaxCapacity;
+    Cache.Configure(Config);
+    Cache.ResetStats();
+    const int32 NumWrites = FUtilityScoreCache::MaxCapacity + FUtilityScoreCache::MaxCapacity / 2;
+    for (int32 i = 0; i < NumWrites; ++i)
+    {
+        FUtilityContext FillContext = Context;
+        FillContext.DistanceToTarget = i * 100.0f;
+        Cache.Add(IdentityA, FillContext, static_cast<float>(i));
+    }
+    TestEqual(TEXT("Full cache should stay at capacity"), Cache.GetStats().NumEntries, FUtilityScoreCache::MaxCapacity);
+
+    int32 NumFound = 0;
+    bool bScoresMatch = true;
+    for (int32 i = 0; i < NumWrites; ++i)
+    {
+        FUtilityContext FillContext = Context;
+        FillContext.DistanceToTarget = i * 100.0f;
+        if (Cache.Find(IdentityA, FillContext, Score))
+        {
+            ++NumFound;
+            bScoresMatch &= Score == static_cast<float>(i);
+        }
+    }
+    TestEqual(TEXT("Every resident entry should be reachable"), NumFound, FUtilityScoreCache::MaxCapacity);
+    TestTrue(TEXT("Reachable entries should keep their scores"), bScoresMatch);
+
+    return true;
+}
+
+/**
+ * 测试配置注册表的去重、曲线共享和权重覆盖视图
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUtilityProfileRegistryTest,
+    "ElementalCombat.AI.Utility.ProfileRegistry",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FUtilityProfileRegistryTest::RunTest(const FString& Parameters)
+{
+    // Arrange - 三行配置：Aggressive和Duplicate内容相同，Defensive只有权重不同
+    FUtilityProfileTableRow AggressiveRow;
+    AggressiveRow.Profile.ProfileName = TEXT("RegistryProfile");
+    FUtilityConsideration HealthConsideration;
+    HealthConsideration.ConsiderationType = EConsiderationType::Health;
+    AggressiveRow.Profile.Considerations.Add(HealthConsideration);
+    FUtilityConsideration DistanceConsideration;
+    DistanceConsideration.ConsiderationType = EConsiderationType::Distance;
+    DistanceConsideration.ResponseCurve.EditorCurveData.Reset();
+    DistanceConsideration.ResponseCurve.EditorCurveData.AddKey(0.0f, 1.0f);
+    DistanceConsideration.ResponseCurve.EditorCurveData.AddKey(1.0f, 0.0f);
+    AggressiveRow.Profile.Considerations.Add(DistanceConsideration);
+    AggressiveRow.Profile.SetWeight(EConsiderationType::Health, 1.0f);
+    AggressiveRow.Profile.SetWeight(EConsiderationType::Distance, 2.0f);
+
+    FUtilityProfileTableRow DefensiveRow = AggressiveRow;
+    DefensiveRow.Profile.SetWeight(EConsiderationType::Health, 3.0f);
+
+    UDataTable* DataTable = NewObject<UDataTable>();
+    DataTable->RowStruct = FUtilityProfileTableRow::StaticStruct();
+    DataTable->AddRow(TEXT("Aggressive"), AggressiveRow);
+    DataTable->AddRow(TEXT("Duplicate"), AggressiveRow);
+    DataTable->AddRow(TEXT("Defensive"), DefensiveRow);
+
+    UUtilityProfileRegistry* Registry = NewObject<UUtilityProfileRegistry>();
+
+    // Act
+    const int32 NumRows = Registry->LoadFromDataTable(DataTable);
+
+    // Assert - 行数、去重和曲线共享
+    TestEqual(TEXT("All rows should be loaded"), NumRows, 3);
+    TestEqual(TEXT("Identical rows should share one profile"), Registry->GetNumUniqueProfiles(), 2);
+    TestEqual(TEXT("Identical curves should be interned across profiles"), Registry->GetNumInternedCurves(), 2);
+
+    const FUtilityProfileHandle Aggressive = Registry->FindProfile(TEXT("Aggressive"));
+    const FUtilityProfileHandle Duplicate = Registry->FindProfile(TEXT("Duplicate"));
+    const FUtilityProfileHandle Defensive = Registry->FindProfile(TEXT("Defensive"));
+    TestTrue(TEXT("Rows should resolve to valid handles"), Aggressive.IsValid() && Defensive.IsValid());
+    TestTrue(TEXT("Duplicate rows should return the same shared instance"), Aggressive == Duplicate);
+    TestTrue(TEXT("Different rows should not share an instance"), Aggressive != Defensive);
+    TestTrue(TEXT("Compiled profile should alias the shared instance"), Aggressive.GetCompiled().Get() == &Aggressive.Get()->Compiled);
+    TestTrue(TEXT("Shared curve LUT should be reused by both profiles"),
+             Aggressive.GetProfile().Considerations[1].GetBakedCurve() == Defensive.GetProfile().Considerations[1].GetBakedCurve());
+    TestFalse(TEXT("Unknown rows should return an invalid handle"), Registry->FindProfile(TEXT("Missing")).IsValid());
+    TestTrue(TEXT("Registering an identical profile should reuse the loaded instance"), Registry->RegisterProfile(AggressiveRow.Profile) == Aggressive);
+
+    // 权重覆盖视图与按权重重新构建的配置文件评分一致
+    TMap<EConsiderationType, float> Multipliers;
+    Multipliers.Add(EConsiderationType::Health, 3.0f);
+    const FUtilityWeightOverlay Overlay = FUtilityWeightOverlay::FromMultipliers(Aggressive, Multipliers);
+    TestNotEqual(TEXT("Overlay identity should differ from the base profile"), Overlay.Identity, Aggressive.GetIdentity());
+
+    FUtilityContext Context;
+    Context.HealthPercent = 0.3f;
+    Context.DistanceToTarget = 250.0f;
+    TestNearlyEqual(TEXT("Overlay score should match an equivalent profile"),
+                    Overlay.CalculateScore(Context), Defensive.Get()->Compiled.CalculateScore(Context), 1.0e-6f);
+
+    // 基础相同的视图一遍评分，结果与逐个评分逐位一致
+    TMap<EConsiderationType, float> DistanceMultipliers;
+    DistanceMultipliers.Add(EConsiderationType::Distance, 0.5f);
+    const FUtilityWeightOverlay DistanceOverlay = FUtilityWeightOverlay::FromMultipliers(Aggressive, DistanceMultipliers);
+    const FUtilityWeightOverlay* Overlays[] = { &Overlay, &DistanceOverlay };
+    float SharedPassScores[UE_ARRAY_COUNT(Overlays)];
+    FUtilityWeightOverlay::CalculateScores(Overlays, Context, SharedPassScores);
+    TestTrue(TEXT("Shared pass should match overlay A exactly"), SharedPassScores[0] == Overlay.CalculateScore(Context));
+    TestTrue(TEXT("Shared pass should match overlay B exactly"), SharedPassScores[1] == DistanceOverlay.CalculateScore(Context));
+
+    // 按绝对权重创建的视图与等价的倍率视图相同
+    float AbsoluteWeights[FCompiledUtilityProfile::NumConsiderationTypes];
+    for (int32 i = 0; i < FCompiledUtilityProfile::NumConsiderationTypes; ++i)
+    {
+        AbsoluteWeights[i] = Aggressive.Get()->Compiled.GetWeight(static_cast<EConsiderationType>(i));
+    }
+    AbsoluteWeights[static_cast<int32>(EConsiderationType::Health)] *= 3.0f;
+    const FUtilityWeightOverlay AbsoluteOverlay = FUtilityWeightOverlay::FromWeights(Aggressive, AbsoluteWeights);
+    TestEqual(TEXT("Absolute weights should produce the same identity"), AbsoluteOverlay.Identity, Overlay.Identity);
+
+    return true;
+}
+
+/**
+ * 测试输入提供者只在配置文件引用对应输入时调用，且同一上下文内只调用一次
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUtilityInputProviderTest,
+    "ElementalCombat.AI.Utility.InputProviders",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FUtilityInputProviderTest::RunTest(const FString& Parameters)
+{
+    // Arrange - 注册一个计数的自定义输入，模拟昂贵的视线检测
+    FUtilityInputProviderRegistry& Registry = FUtilityInputProviderRegistry::Get();
+    int32 NumLineOfSightCalls = 0;
+    const int32 LineOfSightSlot = Registry.RegisterCustomProvider(TEXT("Test.LineOfSight"), [&NumLineOfSightCalls](const FUtilityInputQuery& Query, FUtilityContext& OutContext)
+    {
+        ++NumLineOfSightCalls;
+        OutContext.SetCustomValue(FUtilityCustomSlotRegistry::Get().FindSlot(TEXT("Test.LineOfSight")), 0.25f);
+    });
+    TestTrue(TEXT("Custom provider should get a slot"), LineOfSightSlot != INDEX_NONE);
+    const uint32 LineOfSightInput = UtilityInputs::ForCustomSlot(LineOfSightSlot);
+
+    FUtilityProfile HealthOnly;
+    FUtilityConsideration HealthConsideration;
+    HealthConsideration.ConsiderationType = EConsiderationType::Health;
+    HealthOnly.Considerations.Add(HealthConsideration);
+
+    FUtilityProfile WithLineOfSight = HealthOnly;
+    FUtilityConsideration LineOfSightConsideration;
+    LineOfSightConsideration.ConsiderationType = EConsiderationType::Custom;
+    LineOfSightConsideration.CustomKey = TEXT("Test.LineOfSight");
+    WithLineOfSight.Considerations.Add(LineOfSightConsideration);
+    WithLineOfSight.SetWeight(EConsiderationType::Custom, 1.0f);
+    WithLineOfSight.BakeResponseCurves();
+
+    FCompiledUtilityProfile Compiled;
+    Compiled.Compile(WithLineOfSight);
+
+    // Assert - 输入掩码
+    TestEqual(TEXT("Health-only profile should require only health"), HealthOnly.GetRequiredInputs(), UtilityInputs::Health);
+    TestEqual(TEXT("Profile mask should include the custom input"), WithLineOfSight.GetRequiredInputs(), UtilityInputs::Health | LineOfSightInput);
+    TestEqual(TEXT("Compiled mask should match the source profile"), Compiled.GetRequiredInputs(), WithLineOfSight.GetRequiredInputs());
+    TestTrue(TEXT("Built-in inputs should have default providers"),
+             (Registry.GetProvidedInputs() & UtilityInputs::AllBuiltIn) == UtilityInputs::AllBuiltIn);
+
+    // Act - 未引用的输入不采集
+    FUtilityContext Context;
+    uint32 ComputedInputs = 0;
+    Registry.Populate(FUtilityInputQuery(), HealthOnly.GetRequiredInputs(), Context, ComputedInputs);
+    TestEqual(TEXT("Unreferenced provider should not run"), NumLineOfSightCalls, 0);
+    TestEqual(TEXT("Only the requested input should be marked computed"), ComputedInputs, UtilityInputs::Health);
+
+    // Act - 引用后采集一次，同一上下文内重复请求不再调用
+    const int32 NumInvoked = Registry.Populate(FUtilityInputQuery(), Compiled.GetRequiredInputs(), Context, ComputedInputs);
+    Registry.Populate(FUtilityInputQuery(), Compiled.GetRequiredInputs(), Context, ComputedInputs);
+
+    // Assert
+    TestEqual(TEXT("Only the missing input should be collected"), NumInvoked, 1);
+    TestEqual(TEXT("Referenced provider should run once per context"), NumLineOfSightCalls, 1);
+    TestEqual(TEXT("Provider value should be visible to scoring"), Context.GetCustomValue(LineOfSightSlot), 0.25f);
+
+    // Cleanup - 注册表为全局对象，移除测试提供者
+    Registry.UnregisterProvider(LineOfSightInput);
+    TestEqual(TEXT("Unregistered provider should be removed"), Registry.GetProvidedInputs() & LineOfSightInput, 0u);
+
+    return true;
+}
+
+/**
+ * 测试Utility AI子系统的分片调度、结果陈旧度和权重覆盖
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUtilityAISubsystemTest,
+    "ElementalCombat.AI.Utility.Subsystem",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FUtilityAISubsystemTest::RunTest(const FString& Parameters)
+{
+    // Arrange - 创建测试世界和编译后的配置文件
+    UWorld* TestWorld = UWorld::CreateWorld(EWorldType::Game, false);
+    UUtilityAISubsystem* Subsystem = TestWorld ? TestWorld->GetSubsystem<UUtilityAISubsystem>() : nullptr;
+    if (!TestNotNull(TEXT("Utility AI subsystem should exist"), Subsystem))
+    {
+        if (TestWorld)
+        {
+            TestWorld->DestroyWorld(false);
+        }
+        return false;
+    }
+
+    FUtilityProfile Profile;
+    Profile.ProfileName = TEXT("SubsystemTestProfile");
+    FUtilityConsideration HealthConsideration;
+    HealthConsideration.ConsiderationType = EConsiderationType::Health;
+    Profile.Considerations.Add(HealthConsideration);
+    FUtilityConsideration ThreatConsideration;
+    ThreatConsideration.ConsiderationType = EConsiderationType::ThreatLevel;
+    Profile.Considerations.Add(ThreatConsideration);
+    Profile.SetWeight(EConsiderationType::Health, 1.0f);
+    Profile.SetWeight(EConsiderationType::ThreatLevel, 1.0f);
+
+    TSharedRef<FCompiledUtilityProfile> Compiled = MakeShared<FCompiledUtilityProfile>();
+    Compiled->Compile(Profile);
+
+    constexpr int32 RequestCount = 8;
+    TArray<int32> EvaluationCounts;
+    EvaluationCounts.SetNumZeroed(RequestCount);
+    TArray<FUtilityScoreRequestHandle> Handles;
+
+    for (int32 i = 0; i < RequestCount; ++i)
+    {
+        FUtilityScoreRequestDesc Desc;
+        Desc.Profile = Compiled;
+        Desc.UpdateInterval = 0.0f;
+        Desc.bEvaluateImmediately = false;
+        Desc.ContextProvider = [&EvaluationCounts, i](FUtilityContext& OutContext)
+        {
+            ++EvaluationCounts[i];
+            OutContext.HealthPercent = i / static_cast<float>(RequestCount);
+            OutContext.ThreatLevel = 0.5f;
+            return true;
+        };
+        Handles.Add(Subsystem->RegisterRequest(MoveTemp(Desc)));
+    }
+
+    // Act - 预算为0时每帧只评分一个请求，轮询一圈后每个请求恰好评分一次
+    Subsystem->SetTimeBudgetMicroseconds(0.0f);
+    for (int32 Frame = 0; Frame < RequestCount; ++Frame)
+    {
+        Subsystem->Tick(0.1f);
+        TestEqual(TEXT("One evaluation per frame under zero budget"), Subsystem->GetLastFrameEvaluationCount(), 1);
+    }
+
+    // 评分结果在下一帧发布，这里直接发布最后一帧的结果
+    Subsystem->FlushPendingEvaluations();
+
+    // Assert - 轮询公平性
+    for (int32 i = 0; i < RequestCount; ++i)
+    {
+        TestEqual(FString::Printf(TEXT("Request %d evaluated exactly once"), i), EvaluationCounts[i], 1);
+        TestEqual(FString::Printf(TEXT("Request %d frame age"), i), Subsystem->GetResultFrameAge(Handles[i]), static_cast<uint64>(RequestCount - 1 - i));
+    }
+    TestNearlyEqual(TEXT("Oldest result age in seconds"), Subsystem->GetResultAge(Handles[0]), 0.7, 1.0e-6);
+
+    // 结果与直接评分一致
+    const FUtilityScoreResult* Result = Subsystem->GetResult(Handles[3]);
+    if (TestNotNull(TEXT("Result should exist"), Result))
+    {
+        TestNearlyEqual(TEXT("Subsystem score matches compiled profile"), Result->Score, Compiled->CalculateScore(Result->Context), 1.0e-6f);
+    }
+
+    // 权重覆盖与修改配置文件权重后的评分一致
+    float Weights[FCompiledUtilityProfile::NumConsiderationTypes];
+    for (int32 i = 0; i < FCompiledUtilityProfile::NumConsiderationTypes; ++i)
+    {
+        Weights[i] = Compiled->GetWeight(static_cast<EConsiderationType>(i));
+    }
+    Weights[static_cast<int32>(EConsiderationType::ThreatLevel)] = 3.0f;
+    Subsystem->SetRequestWeights(Handles[3], MakeArrayView(Weights));
+    Result = Subsystem->EvaluateNow(Handles[3]);
+
+    FUtilityProfile ReweightedProfile = Profile;
+    ReweightedProfile.SetWeight(EConsiderationType::ThreatLevel, 3.0f);
+    if (TestNotNull(TEXT("Immediate result should exist"), Result))
+    {
+        TestNearlyEqual(TEXT("Weight override matches reweighted profile"), Result->Score, ReweightedProfile.CalculateScore(Result->Context), 0.005f);
+        TestEqual(TEXT("Immediate evaluation resets age"), Subsystem->GetResultAge(Handles[3]), 0.0);
+    }
+
+    // 大预算时一帧内评分全部到期请求
+    Subsystem->SetTimeBudgetMicroseconds(1.0e6f);
+    Subsystem->Tick(0.1f);
+    TestEqual(TEXT("All due requests evaluated under large budget"), Subsystem->GetLastFrameEvaluationCount(), RequestCount);
+    TestEqual(TEXT("No deferred requests"), Subsystem->GetLastFrameDeferredCount(), 0);
+
+    // 注销后句柄失效，槽位复用不会让旧句柄读到新请求
+    FUtilityScoreRequestHandle StaleHandle = Handles[0];
+    Subsystem->UnregisterRequest(Handles[0]);
+    TestFalse(TEXT("Unregistered handle reset"), Handles[0].IsValid());
+    TestFalse(TEXT("Stale handle invalid"), Subsystem->IsRequestValid(StaleHandle));
+    TestNull(TEXT("Stale handle has no result"), Subsystem->GetResult(StaleHandle));
+    TestEqual(TEXT("Request count after unregister"), Subsystem->GetNumRequests(), RequestCount - 1);
+
+    // 等待过久的低优先级请求提升优先级，不会被每帧到期的高优先级请求一直顺延
+    for (FUtilityScoreRequestHandle& Handle : Handles)
+    {
+        Subsystem->UnregisterRequest(Handle);
+    }
+
+    int32 HighEvaluations = 0;
+    int32 LowEvaluations = 0;
+    auto RegisterAgingRequest = [Subsystem, &Compiled](int32 Priority, int32& Counter)
+    {
+        FUtilityScoreRequestDesc Desc;
+        Desc.Profile = Compiled;
+        Desc.UpdateInterval = 0.0f;
+        Desc.Priority = Priority;
+        Desc.bEvaluateImmediately = false;
+        Desc.ContextProvider = [&Counter](FUtilityContext& OutContext)
+        {
+            ++Counter;
+            return true;
+        };
+        return Subsystem->RegisterRequest(MoveTemp(Desc));
+    };
+    FUtilityScoreRequestHandle HighHandle = RegisterAgingRequest(1, HighEvaluations);
+    FUtilityScoreRequestHandle LowHandle = RegisterAgingRequest(0, LowEvaluations);
+
+    Subsystem->SetTimeBudgetMicroseconds(0.0f);
+    constexpr int32 AgingFrames = 20;
+    for (int32 Frame = 0; Frame < AgingFrames; ++Frame)
+    {
+        Subsystem->Tick(0.1f);
+    }
+    Subsystem->FlushPendingEvaluations();
+
+    TestTrue(TEXT("Low priority request is not starved"), LowEvaluations > 0);
+    TestTrue(TEXT("High priority request still gets most frames"), HighEvaluations > AgingFrames / 2);
+    TestEqual(TEXT("One evaluation per frame"), HighEvaluations + LowEvaluations, AgingFrames);
+
+    Subsystem->UnregisterRequest(HighHandle);
+    Subsystem->UnregisterRequest(LowHandle);
+
+    // Cleanup
+    TestWorld->DestroyWorld(false);
+
+    return true;
+}
+
+/**
+ * 测试并行评分与串行评分结果逐位一致，且结果在下一帧发布
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUtilityAISubsystemParallelTest,
+    "ElementalCombat.AI.Utility.SubsystemParallel",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FUtilityAISubsystemParallelTest::RunTest(const FString& Parameters)
+{
+    IConsoleVariable* ForceSerialVar = IConsoleManager::Get().FindConsoleVariable(TEXT("ElementalCombat.AI.Utility.ForceSerial"));
+    if (!TestNotNull(TEXT("ForceSerial cvar should exist"), ForceSerialVar))
+    {
+        return false;
+    }
+    const bool bOriginalForceSerial = ForceSerialVar->GetBool();
+
+    // Arrange - 乘法组合配置文件，覆盖Exp和对数域查找表
+    FUtilityProfile Profile;
+    Profile.ProfileName = TEXT("ParallelTestProfile");
+    Profile.bUseMultiplicativeCombination = true;
+    for (const EConsiderationType Type : { EConsiderationType::Health, EConsiderationType::Distance, EConsiderationType::ThreatLevel })
+    {
+        FUtilityConsideration Consideration;
+        Consideration.ConsiderationType = Type;
+        Consideration.OutputOffset = 0.05f;
+        Profile.Considerations.Add(Consideration);
+    }
+    Profile.SetWeight(EConsiderationType::Health, 0.4f);
+    Profile.SetWeight(EConsiderationType::Distance, 1.3f);
+    Profile.SetWeight(EConsiderationType::ThreatLevel, 0.7f);
+
+    TSharedRef<FCompiledUtilityProfile> Compiled = MakeShared<FCompiledUtilityProfile>();
+    Compiled->Compile(Profile);
+
+    constexpr int32 RequestCount = 500;
+    auto RunScoring = [this, &Compiled](bool bForceSerial, TArray<float>& OutScores)
+    {
+        IConsoleManager::Get().FindConsoleVariable(TEXT("ElementalCombat.AI.Utility.ForceSerial"))->Set(bForceSerial, ECVF_SetByCode);
+
+        UWorld* TestWorld = UWorld::CreateWorld(EWorldType::Game, false);
+        UUtilityAISubsystem* Subsystem = TestWorld->GetSubsystem<UUtilityAISubsystem>();
+        Subsystem->SetTimeBudgetMicroseconds(1.0e9f);
+
+        TArray<FUtilityScoreRequestHandle> Handles;
+        for (int32 i = 0; i < RequestCount; ++i)
+        {
+            FUtilityScoreRequestDesc Desc;
+            Desc.Profile = Compiled;
+            Desc.bEvaluateImmediately = false;
+            Desc.ContextProvider = [i](FUtilityContext& OutContext)
+            {
+                OutContext.HealthPercent = (i % 37) / 36.0f;
+                OutContext.DistanceToTarget = (i % 41) * 27.3f;
+                OutContext.ThreatLevel = (i % 13) / 12.0f;
+                return true;
+            };
+            Handles.Add(Subsystem->RegisterRequest(MoveTemp(Desc)));
+        }
+
+        // 第一帧只提交评分，结果尚未发布
+        Subsystem->Tick(0.016f);
+        TestEqual(TEXT("All requests submitted"), Subsystem->GetLastFrameEvaluationCount(), RequestCount);
+        TestFalse(TEXT("Result not published in the submitting frame"), Subsystem->GetResult(Handles[0])->HasResult());
+
+        // 第二帧开始时发布
+        Subsystem->Tick(0.016f);
+        OutScores.Reset();
+        for (const FUtilityScoreRequestHandle& Handle : Handles)
+        {
+            const FUtilityScoreResult* Result = Subsystem->GetResult(Handle);
+            OutScores.Add(Result && Result->HasResult() ? Result->Score : -1.0f);
+        }
+
+        TestWorld->DestroyWorld(false);
+    };
+
+    // Act - 分别以串行和并行方式评分
+    TArray<float> SerialScores;
+    TArray<float> ParallelScores;
+    RunScoring(true, SerialScores);
+    RunScoring(false, ParallelScores);
+    ForceSerialVar->Set(bOriginalForceSerial, ECVF_SetByCode);
+
+    // Assert - 逐位比较
+    TestEqual(TEXT("Score count matches"), ParallelScores.Num(), SerialScores.Num());
+    for (int32 i = 0; i < FMath::Min(SerialScores.Num(), ParallelScores.Num()); ++i)
+    {
+        if (FMemory::Memcmp(&SerialScores[i], &ParallelScores[i], sizeof(float)) != 0)
+        {
+            AddError(FString::Printf(TEXT("Parallel score differs from serial at %d: %.9g vs %.9g"), i, ParallelScores[i], SerialScores[i]));
+            break;
+        }
+    }
+
+    return true;
+}
+
 /**
  * 测试UUtilityScorerComponent
  */
@@ -0,0 +1,96 @@
+// Copyright 2025 guigui17f. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "ElementalCombatTestBase.h"
+#include "TestHelpers.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Combat/CombatDamageSubsystem.h"
+
+/**
+ * 伤害队列合并测试
+ * 同一帧内对同一目标的多次命中合并为一次结算，目标按第一次命中的顺序结算
+ */
+class FCombatDamageCoalescingTestImpl : public FElementalCombatTestBase
+{
+public:
+	FCombatDamageCoalescingTestImpl()
+		: FElementalCombatTestBase(TEXT("CombatDamageCoalescing"), false) {}
+
+	virtual bool RunTest(const FString& Parameters) override
+	{
+		UWorld* World = CreateTestWorld();
+		UCombatDamageSubsystem* DamageSubsystem = UCombatDamageSubsystem::Get(World);
+		TestNotNull(TEXT("伤害子系统存在"), DamageSubsystem);
+		if (!DamageSubsystem)
+		{
+			return false;
+		}
+
+		AActor* Causer = World->SpawnActor<AActor>();
+		AActor* StrongCauser = World->SpawnActor<AActor>();
+		AActor* TargetA = World->SpawnActor<AActor>();
+		AActor* TargetB = World->SpawnActor<AActor>();
+		AActor* TargetC = World->SpawnActor<AActor>();
+
+		TArray<AActor*> ResolvedOrder;
+		TArray<FCombatResolvedDamage> ResolvedResults;
+		const FDelegateHandle Handle = DamageSubsystem->OnDamageResolved.AddLambda(
+			[&ResolvedOrder, &ResolvedResults](AActor* Target, const FCombatResolvedDamage& Resolved)
+			{
+				ResolvedOrder.Add(Target);
+				ResolvedResults.Add(Resolved);
+			});
+
+		// A、B、A、C、A：A被命中三次，第二次伤害最大
+		DamageSubsystem->QueueDamage(TargetA, 5.0f, Causer, FVector(1.0f, 0.0f, 0.0f), FVector(10.0f, 0.0f, 0.0f));
+		DamageSubsystem->QueueDamage(TargetB, 2.0f, Causer, FVector::ZeroVector, FVector::ZeroVector);
+		DamageSubsystem->QueueDamage(TargetA, 8.0f, StrongCauser, FVector(2.0f, 0.0f, 0.0f), FVector(0.0f, 10.0f, 0.0f));
+		DamageSubsystem->QueueDamage(TargetC, 1.0f, Causer, FVector::ZeroVector, FVector::ZeroVector);
+		DamageSubsystem->QueueDamage(TargetA, 8.0f, Causer, FVector(3.0f, 0.0f, 0.0f), FVector(0.0f, 0.0f, 10.0f));
+		TestEqual(TEXT("五次命中进入队列"), DamageSubsystem->GetNumQueuedEvents(), 5);
+		TestEqual(TEXT("结算前没有调用伤害接口"), ResolvedOrder.Num(), 0);
+
+		DamageSubsystem->ResolveQueuedDamage();
+		TestEqual(TEXT("队列已清空"), DamageSubsystem->GetNumQueuedEvents(), 0);
+		TestEqual(TEXT("每个目标结算一次"), ResolvedOrder.Num(), 3);
+		if (ResolvedOrder.Num() == 3)
+		{
+			TestTrue(TEXT("按第一次命中的顺序结算"), ResolvedOrder[0] == TargetA && ResolvedOrder[1] == TargetB && ResolvedOrder[2] == TargetC);
+
+			const FCombatResolvedDamage& ResolvedA = ResolvedResults[0];
+			TestEqual(TEXT("A合并三次命中"), ResolvedA.NumHits, 3);
+			TestEqual(TEXT("A的伤害为总和"), ResolvedA.Damage, 21.0f);
+			TestTrue(TEXT("A的冲量为总和"), ResolvedA.Impulse.Equals(FVector(10.0f, 10.0f, 10.0f)));
+			TestTrue(TEXT("伤害相同时取较早的命中"), ResolvedA.Location.Equals(FVector(2.0f, 0.0f, 0.0f)));
+			TestTrue(TEXT("来源取伤害最大的命中"), ResolvedA.Causer.Get() == StrongCauser);
+			TestEqual(TEXT("B只有一次命中"), ResolvedResults[1].NumHits, 1);
+		}
+		TestEqual(TEXT("累计入队五次"), DamageSubsystem->GetNumEventsQueued(), static_cast<uint64>(5));
+		TestEqual(TEXT("累计结算三个目标"), DamageSubsystem->GetNumTargetsResolved(), static_cast<uint64>(3));
+
+		// 大世界坐标下命中位置不丢失精度
+		ResolvedResults.Reset();
+		const FVector FarLocation(10000000.25, -20000000.5, 0.125);
+		DamageSubsystem->QueueDamage(TargetC, 1.0f, Causer, FarLocation, FVector::ZeroVector);
+		DamageSubsystem->ResolveQueuedDamage();
+		TestTrue(TEXT("远处命中位置保持双精度"), ResolvedResults.Num() == 1 && ResolvedResults[0].Location == FarLocation);
+
+		// 已销毁的目标不结算
+		ResolvedOrder.Reset();
+		DamageSubsystem->QueueDamage(TargetB, 1.0f, Causer, FVector::ZeroVector, FVector::ZeroVector);
+		TargetB->Destroy();
+		DamageSubsystem->ResolveQueuedDamage();
+		TestEqual(TEXT("已销毁的目标不结算"), ResolvedOrder.Num(), 0);
+
+		DamageSubsystem->OnDamageResolved.Remove(Handle);
+		return true;
+	}
+};
+
+ELEMENTAL_TEST(Combat.Damage, CombatDamageCoalescing)
+bool FCombatDamageCoalescingTest::RunTest(const FString& Parameters)
+{
+	FCombatDamageCoalescingTestImpl TestImpl;
+	return TestImpl.RunTest(Parameters);
+}
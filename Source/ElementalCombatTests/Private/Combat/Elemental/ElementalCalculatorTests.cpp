@@ -3,6 +3,8 @@
 #include "CoreMinimal.h"
 #include "TestHelpers.h"
 #include "Combat/Elemental/ElementalCalculator.h"
+#include "Combat/Elemental/ElementalConfigManager.h"
+#include "Combat/Elemental/DefaultElementalDataAsset.h"
 
 /**
  * 五行相克关系验证测试
@@ -168,4 +170,49 @@ bool FCalculateFinalDamageTest::RunTest(const FString& Parameters)
 		LargeDamage * 1.5f, 1.0f);
 	
 	return true;
-}
\ No newline at end of file
+}
+
+/**
+ * 预计算相克表测试
+ */
+ELEMENTAL_TEST(Combat.Elemental, CounterMatrix)
+bool FCounterMatrixTest::RunTest(const FString& Parameters)
+{
+	// 默认相克表与硬编码规则一致
+	const FElementalCounterMatrix DefaultMatrix = FElementalCounterMatrix::Build(nullptr);
+	for (int32 AttackerIndex = 0; AttackerIndex < FElementalCounterMatrix::NumElements; ++AttackerIndex)
+	{
+		for (int32 DefenderIndex = 0; DefenderIndex < FElementalCounterMatrix::NumElements; ++DefenderIndex)
+		{
+			const EElementalType Attacker = static_cast<EElementalType>(AttackerIndex);
+			const EElementalType Defender = static_cast<EElementalType>(DefenderIndex);
+			const bool bAdvantage = FElementalCounterMatrix::IsDefaultAdvantage(Attacker, Defender);
+			const float Expected = bAdvantage ? 1.5f : (FElementalCounterMatrix::IsDefaultAdvantage(Defender, Attacker) ? 0.5f : 1.0f);
+
+			TestEqual(FString::Printf(TEXT("默认克制关系 %d->%d"), AttackerIndex, DefenderIndex), DefaultMatrix.IsAdvantage(Attacker, Defender), bAdvantage);
+			TestEqual(FString::Printf(TEXT("默认倍率 %d->%d"), AttackerIndex, DefenderIndex), DefaultMatrix.GetMultiplier(Attacker, Defender), Expected);
+		}
+	}
+
+	// 从数据资产构建：克制使用配置倍率，被克制使用对称倍率并限制下限
+	UDefaultElementalDataAsset* Asset = NewObject<UDefaultElementalDataAsset>();
+	Asset->SetCustomMultipliers(1.8f);
+	const FElementalCounterMatrix CustomMatrix = FElementalCounterMatrix::Build(Asset);
+	TestNearlyEqual(TEXT("水克火使用配置倍率"), CustomMatrix.GetMultiplier(EElementalType::Water, EElementalType::Fire), 1.8f, KINDA_SMALL_NUMBER);
+	TestNearlyEqual(TEXT("火被水克使用对称倍率"), CustomMatrix.GetMultiplier(EElementalType::Fire, EElementalType::Water), 0.2f, KINDA_SMALL_NUMBER);
+	TestNearlyEqual(TEXT("金水无关系"), CustomMatrix.GetMultiplier(EElementalType::Metal, EElementalType::Water), 1.0f, KINDA_SMALL_NUMBER);
+	TestTrue(TEXT("水克火"), CustomMatrix.IsAdvantage(EElementalType::Water, EElementalType::Fire));
+	TestFalse(TEXT("火不克水"), CustomMatrix.IsAdvantage(EElementalType::Fire, EElementalType::Water));
+
+	Asset->SetCustomMultipliers(2.5f);
+	const FElementalCounterMatrix ClampedMatrix = FElementalCounterMatrix::Build(Asset);
+	TestNearlyEqual(TEXT("被克制倍率不低于下限"), ClampedMatrix.GetMultiplier(EElementalType::Metal, EElementalType::Fire),
+		FElementalCounterMatrix::MinDisadvantageMultiplier, KINDA_SMALL_NUMBER);
+
+	// None和越界的值按中性处理
+	TestEqual(TEXT("None攻击无效果"), CustomMatrix.GetMultiplier(EElementalType::None, EElementalType::Fire), 1.0f);
+	TestEqual(TEXT("越界元素无效果"), CustomMatrix.GetMultiplier(static_cast<EElementalType>(200), EElementalType::Fire), 1.0f);
+	TestFalse(TEXT("越界元素无克制"), CustomMatrix.IsAdvantage(EElementalType::Water, static_cast<EElementalType>(200)));
+
+	return true;
+}
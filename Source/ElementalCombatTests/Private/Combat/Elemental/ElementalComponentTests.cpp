@@ -4,7 +4,9 @@
 #include "ElementalCombatTestBase.h"
 #include "TestHelpers.h"
 #include "Combat/Elemental/ElementalComponent.h"
+#include "Combat/Elemental/ElementalStatusEffectSubsystem.h"
 #include "GameFramework/Actor.h"
+#include "HAL/PlatformTime.h"
 
 /**
  * 元素组件创建和初始化测试
@@ -178,35 +180,37 @@ public:
 		Component->SetElementEffectData(EElementalType::Water, WaterData);
 		
 		// 获取并验证火元素数据
-		const FElementalEffectData* RetrievedFire = Component->GetElementEffectDataPtr(EElementalType::Fire);
-		TestNotNull(TEXT("火元素数据存在"), RetrievedFire);
-		if (RetrievedFire)
+		FElementalEffectData RetrievedFire;
+		const bool bHasFire = Component->GetElementEffectData(EElementalType::Fire, RetrievedFire);
+		TestTrue(TEXT("火元素数据存在"), bHasFire);
+		if (bHasFire)
 		{
-			TestNearlyEqual(TEXT("火DOT伤害"), RetrievedFire->DotDamage, 15.0f, 0.01f);
-			TestNearlyEqual(TEXT("火DOT间隔"), RetrievedFire->DotTickInterval, 0.5f, 0.01f);
-			TestNearlyEqual(TEXT("火DOT持续"), RetrievedFire->DotDuration, 5.0f, 0.01f);
+			TestNearlyEqual(TEXT("火DOT伤害"), RetrievedFire.DotDamage, 15.0f, 0.01f);
+			TestNearlyEqual(TEXT("火DOT间隔"), RetrievedFire.DotTickInterval, 0.5f, 0.01f);
+			TestNearlyEqual(TEXT("火DOT持续"), RetrievedFire.DotDuration, 5.0f, 0.01f);
 		}
 		
 		// 获取并验证水元素数据
-		const FElementalEffectData* RetrievedWater = Component->GetElementEffectDataPtr(EElementalType::Water);
-		TestNotNull(TEXT("水元素数据存在"), RetrievedWater);
-		if (RetrievedWater)
+		FElementalEffectData RetrievedWater;
+		const bool bHasWater = Component->GetElementEffectData(EElementalType::Water, RetrievedWater);
+		TestTrue(TEXT("水元素数据存在"), bHasWater);
+		if (bHasWater)
 		{
-			TestNearlyEqual(TEXT("水减速比例"), RetrievedWater->SlowPercentage, 0.6f, 0.01f);
-			TestNearlyEqual(TEXT("水减速时间"), RetrievedWater->SlowDuration, 4.0f, 0.01f);
+			TestNearlyEqual(TEXT("水减速比例"), RetrievedWater.SlowPercentage, 0.6f, 0.01f);
+			TestNearlyEqual(TEXT("水减速时间"), RetrievedWater.SlowDuration, 4.0f, 0.01f);
 		}
 		
 		// 获取未设置的数据
-		const FElementalEffectData* UnsetData = Component->GetElementEffectDataPtr(EElementalType::Metal);
-		TestNull(TEXT("未设置数据为空"), UnsetData);
+		FElementalEffectData UnsetData;
+		TestFalse(TEXT("未设置数据为空"), Component->GetElementEffectData(EElementalType::Metal, UnsetData));
 		
 		// 更新已有数据
 		FireData.DotDamage = 20.0f;
 		Component->SetElementEffectData(EElementalType::Fire, FireData);
-		const FElementalEffectData* UpdatedFire = Component->GetElementEffectDataPtr(EElementalType::Fire);
-		if (UpdatedFire)
+		FElementalEffectData UpdatedFire;
+		if (Component->GetElementEffectData(EElementalType::Fire, UpdatedFire))
 		{
-			TestNearlyEqual(TEXT("更新后火DOT伤害"), UpdatedFire->DotDamage, 20.0f, 0.01f);
+			TestNearlyEqual(TEXT("更新后火DOT伤害"), UpdatedFire.DotDamage, 20.0f, 0.01f);
 		}
 		
 		return true;
@@ -636,4 +640,258 @@ bool FElementalBoundaryTest::RunTest(const FString& Parameters)
 {
 	FElementalBoundaryTestImpl TestImpl;
 	return TestImpl.RunTest(Parameters);
-}
\ No newline at end of file
+}
+
+/**
+ * 共享效果表测试
+ * 生成500个带元素组件的Actor，比较引用共享效果表和逐个复制效果数据的内存占用与查询耗时
+ */
+class FElementalSharedEffectTableTestImpl : public FElementalCombatTestBase
+{
+public:
+	FElementalSharedEffectTableTestImpl() 
+		: FElementalCombatTestBase(TEXT("ElementalSharedEffectTable"), false) {}
+	
+	virtual bool RunTest(const FString& Parameters) override
+	{
+		constexpr int32 NumActors = 500;
+		constexpr int32 NumLookupRounds = 20;
+
+		// 准备五种元素的效果数据
+		TArray<FElementalEffectData> Effects;
+		for (int32 ElementIndex = 1; ElementIndex < FElementalEffectTable::NumElements; ++ElementIndex)
+		{
+			FElementalEffectData& Effect = Effects.AddDefaulted_GetRef();
+			Effect.Element = static_cast<EElementalType>(ElementIndex);
+			Effect.DamageMultiplier = 1.0f + ElementIndex * 0.1f;
+			Effect.EffectDescription = FText::FromString(FString::Printf(TEXT("Effect %d"), ElementIndex));
+		}
+		const TSharedRef<const FElementalEffectTable> Table = FElementalEffectTable::Make(Effects, 1);
+		TestEqual(TEXT("效果表包含五种元素"), Table->Num(), Effects.Num());
+		TestNull(TEXT("None元素没有效果数据"), Table->FindParams(EElementalType::None));
+
+		// 完整效果数据按需组合，与构建时的输入一致
+		FElementalEffectData RebuiltEffect;
+		TestTrue(TEXT("可以组合完整效果数据"), Table->GetEffectData(Effects[0].Element, RebuiltEffect));
+		TestEqual(TEXT("组合后的倍率一致"), RebuiltEffect.DamageMultiplier, Effects[0].DamageMultiplier);
+		TestTrue(TEXT("组合后的描述一致"), RebuiltEffect.EffectDescription.EqualTo(Effects[0].EffectDescription));
+
+		UWorld* World = CreateTestWorld();
+		TArray<UElementalComponent*> SharedComponents;
+		TArray<UElementalComponent*> CopiedComponents;
+		for (int32 Index = 0; Index < NumActors; ++Index)
+		{
+			UElementalComponent* Shared = NewObject<UElementalComponent>(World->SpawnActor<AActor>());
+			Shared->RegisterComponent();
+			Shared->SetEffectTable(Table);
+			SharedComponents.Add(Shared);
+
+			// 原来的做法：每个组件保存一份完整副本
+			UElementalComponent* Copied = NewObject<UElementalComponent>(World->SpawnActor<AActor>());
+			Copied->RegisterComponent();
+			Copied->SetEffectTable(nullptr);
+			for (const FElementalEffectData& Effect : Effects)
+			{
+				Copied->SetElementEffectData(Effect.Element, Effect);
+			}
+			CopiedComponents.Add(Copied);
+		}
+
+		// 内存：共享方式只有一份效果表
+		SIZE_T SharedBytes = Table->GetAllocatedSize();
+		SIZE_T CopiedBytes = 0;
+		for (int32 Index = 0; Index < NumActors; ++Index)
+		{
+			SharedBytes += SharedComponents[Index]->GetEffectOverridesAllocatedSize();
+			CopiedBytes += CopiedComponents[Index]->GetEffectOverridesAllocatedSize();
+			TestTrue(TEXT("组件引用同一份效果表"), SharedComponents[Index]->GetEffectTable().Get() == &Table.Get());
+		}
+		TestEqual(TEXT("共享组件没有覆盖数据"), SharedComponents[0]->GetNumEffectOverrides(), 0);
+		TestTrue(TEXT("共享效果表占用更少内存"), SharedBytes < CopiedBytes);
+
+		// 查询：两种方式结果一致，并记录耗时
+		auto MeasureLookups = [&](const TArray<UElementalComponent*>& Components, float& OutChecksum)
+		{
+			OutChecksum = 0.0f;
+			const uint64 Start = FPlatformTime::Cycles64();
+			for (int32 Round = 0; Round < NumLookupRounds; ++Round)
+			{
+				for (const UElementalComponent* Component : Components)
+				{
+					for (int32 ElementIndex = 1; ElementIndex < FElementalEffectTable::NumElements; ++ElementIndex)
+					{
+						if (const FElementalEffectParams* Data = Component->GetElementEffectParamsPtr(static_cast<EElementalType>(ElementIndex)))
+						{
+							OutChecksum += Data->DamageMultiplier;
+						}
+					}
+				}
+			}
+			return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - Start);
+		};
+
+		float SharedChecksum = 0.0f;
+		float CopiedChecksum = 0.0f;
+		const double SharedMs = MeasureLookups(SharedComponents, SharedChecksum);
+		const double CopiedMs = MeasureLookups(CopiedComponents, CopiedChecksum);
+		TestEqual(TEXT("两种方式查询结果一致"), SharedChecksum, CopiedChecksum);
+
+		AddInfo(FString::Printf(TEXT("%d actors: shared table %llu bytes, per-component copies %llu bytes; lookups %.3f ms vs %.3f ms"),
+			NumActors, static_cast<uint64>(SharedBytes), static_cast<uint64>(CopiedBytes), SharedMs, CopiedMs));
+
+		// 覆盖只影响单个组件
+		FElementalEffectData Override = Effects[0];
+		Override.DamageMultiplier = 3.0f;
+		SharedComponents[0]->SetElementEffectData(Override.Element, Override);
+		TestEqual(TEXT("覆盖后读取覆盖值"), SharedComponents[0]->GetElementEffectParamsPtr(Override.Element)->DamageMultiplier, 3.0f);
+		TestEqual(TEXT("其他组件仍读取共享值"), SharedComponents[1]->GetElementEffectParamsPtr(Override.Element)->DamageMultiplier, Effects[0].DamageMultiplier);
+		TestEqual(TEXT("共享效果表未被修改"), Table->FindParams(Override.Element)->DamageMultiplier, Effects[0].DamageMultiplier);
+		FElementalEffectData OverrideData;
+		TestTrue(TEXT("蓝图接口读取覆盖数据"), SharedComponents[0]->GetElementEffectData(Override.Element, OverrideData) && OverrideData.DamageMultiplier == 3.0f);
+
+		return true;
+	}
+};
+
+ELEMENTAL_TEST(Combat.Elemental, ElementalSharedEffectTable)
+bool FElementalSharedEffectTableTest::RunTest(const FString& Parameters)
+{
+	FElementalSharedEffectTableTestImpl TestImpl;
+	return TestImpl.RunTest(Parameters);
+}
+
+/**
+ * 状态效果子系统测试
+ * 验证批量推进的触发时间、叠加规则和同帧伤害合并，并记录2000个燃烧目标的推进耗时
+ */
+class FElementalStatusEffectSubsystemTestImpl : public FElementalCombatTestBase
+{
+public:
+	FElementalStatusEffectSubsystemTestImpl() 
+		: FElementalCombatTestBase(TEXT("ElementalStatusEffectSubsystem"), false) {}
+	
+	virtual bool RunTest(const FString& Parameters) override
+	{
+		UWorld* World = CreateTestWorld();
+		UElementalStatusEffectSubsystem* StatusEffects = UElementalStatusEffectSubsystem::Get(World);
+		TestNotNull(TEXT("状态效果子系统存在"), StatusEffects);
+		if (!StatusEffects)
+		{
+			return false;
+		}
+
+		// 1. 通过组件施加：减速1秒，燃烧每0.5秒10点共4次
+		UElementalComponent* Component = NewObject<UElementalComponent>(World->SpawnActor<AActor>());
+		Component->RegisterComponent();
+
+		FElementalEffectParams EffectData;
+		EffectData.SlowPercentage = 0.5f;
+		EffectData.SlowDuration = 1.0f;
+		EffectData.DotDamage = 10.0f;
+		EffectData.DotTickInterval = 0.5f;
+		EffectData.DotDuration = 2.0f;
+		Component->ApplyElementalEffects(EffectData, nullptr, 0.0f);
+		TestTrue(TEXT("施加后立即减速"), Component->IsSlowed());
+		TestTrue(TEXT("施加后立即燃烧"), Component->IsBurning());
+		TestEqual(TEXT("子系统中有两个效果"), StatusEffects->GetNumActiveEffects(), 2);
+
+		const double DamageBefore = StatusEffects->GetTotalDamageResolved();
+		StatusEffects->Advance(0.6f);
+		TestEqual(TEXT("0.6秒时触发一次燃烧"), StatusEffects->GetTotalDamageResolved() - DamageBefore, 10.0);
+		TestTrue(TEXT("0.6秒时仍在减速"), Component->IsSlowed());
+
+		StatusEffects->Advance(0.6f);
+		TestEqual(TEXT("1.2秒时触发两次燃烧"), StatusEffects->GetTotalDamageResolved() - DamageBefore, 20.0);
+		TestFalse(TEXT("1.2秒时减速结束"), Component->IsSlowed());
+		TestTrue(TEXT("1.2秒时仍在燃烧"), Component->IsBurning());
+
+		// 一帧跨过多个间隔时一次结算
+		StatusEffects->Advance(1.0f);
+		TestEqual(TEXT("2.2秒时共触发四次燃烧"), StatusEffects->GetTotalDamageResolved() - DamageBefore, 40.0);
+		TestFalse(TEXT("燃烧结束"), Component->IsBurning());
+		TestEqual(TEXT("效果全部移除"), StatusEffects->GetNumActiveEffects(), 0);
+
+		// 2. 叠加规则（直接注册另一个组件）
+		UElementalComponent* StackComponent = NewObject<UElementalComponent>(World->SpawnActor<AActor>());
+		StackComponent->RegisterComponent();
+		FElementalStatusTargetHandle Handle = StatusEffects->RegisterTarget(StackComponent);
+		TestTrue(TEXT("目标句柄有效"), StatusEffects->IsTargetValid(Handle));
+
+		for (int32 Index = 0; Index < 3; ++Index)
+		{
+			StatusEffects->ApplyBurn(Handle, 5.0f, 1.0f, 2, nullptr);
+		}
+		TestEqual(TEXT("默认替换规则只保留一层"), StatusEffects->GetNumEffects(Handle, EElementalStatusEffectType::Burn), 1);
+
+		FElementalStatusStackingRule StackRule;
+		StackRule.Stacking = EElementalStatusStacking::Stack;
+		StackRule.MaxStacks = 3;
+		StatusEffects->SetStackingRule(EElementalStatusEffectType::Burn, StackRule);
+		for (int32 Index = 0; Index < 5; ++Index)
+		{
+			StatusEffects->ApplyBurn(Handle, 5.0f, 1.0f, 2, nullptr);
+		}
+		TestEqual(TEXT("叠加规则不超过最大层数"), StatusEffects->GetNumEffects(Handle, EElementalStatusEffectType::Burn), 3);
+
+		// 三层在同一帧触发，合并为一次结算
+		const double StackDamageBefore = StatusEffects->GetTotalDamageResolved();
+		StatusEffects->Advance(1.0f);
+		TestEqual(TEXT("三层燃烧同帧合并"), StatusEffects->GetTotalDamageResolved() - StackDamageBefore, 15.0);
+
+		FElementalStatusStackingRule StrongestRule;
+		StrongestRule.Stacking = EElementalStatusStacking::KeepStrongest;
+		StatusEffects->SetStackingRule(EElementalStatusEffectType::Slow, StrongestRule);
+		StatusEffects->ApplySlow(Handle, 0.6f, 1.0f, nullptr);
+		StatusEffects->ApplySlow(Handle, 0.2f, 1.0f, nullptr);
+		TestEqual(TEXT("保留最强规则只保留一层减速"), StatusEffects->GetNumEffects(Handle, EElementalStatusEffectType::Slow), 1);
+		TestTrue(TEXT("子系统同步减速标记"), StackComponent->IsSlowed());
+
+		StatusEffects->RemoveAllEffects(Handle);
+		TestEqual(TEXT("清除后目标没有效果"), StatusEffects->GetNumActiveEffects(), 0);
+		TestFalse(TEXT("清除后无减速"), StackComponent->IsSlowed());
+		TestFalse(TEXT("清除后无燃烧"), StackComponent->IsBurning());
+
+		StatusEffects->UnregisterTarget(Handle);
+		TestFalse(TEXT("注销后句柄失效"), StatusEffects->IsTargetValid(Handle));
+
+		// 3. 2000个目标各叠加两层燃烧，批量推进
+		constexpr int32 NumTargets = 2000;
+		constexpr int32 NumFrames = 10;
+		TArray<FElementalStatusTargetHandle> Handles;
+		for (int32 Index = 0; Index < NumTargets; ++Index)
+		{
+			UElementalComponent* Target = NewObject<UElementalComponent>(World->SpawnActor<AActor>());
+			Target->RegisterComponent();
+			FElementalStatusTargetHandle& TargetHandle = Handles.Add_GetRef(StatusEffects->RegisterTarget(Target));
+			StatusEffects->ApplyBurn(TargetHandle, 1.0f, 0.1f, NumFrames, nullptr);
+			StatusEffects->ApplyBurn(TargetHandle, 1.0f, 0.1f, NumFrames, nullptr);
+		}
+		TestEqual(TEXT("所有燃烧效果已加入"), StatusEffects->GetNumActiveEffects(), NumTargets * 2);
+
+		const double BulkDamageBefore = StatusEffects->GetTotalDamageResolved();
+		double TotalMicroseconds = 0.0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			StatusEffects->Advance(0.1f);
+			TotalMicroseconds += StatusEffects->GetLastAdvanceMicroseconds();
+		}
+		TestEqual(TEXT("批量推进结算全部伤害"), StatusEffects->GetTotalDamageResolved() - BulkDamageBefore, static_cast<double>(NumTargets * 2 * NumFrames));
+		TestEqual(TEXT("批量推进后效果全部结束"), StatusEffects->GetNumActiveEffects(), 0);
+
+		AddInfo(FString::Printf(TEXT("%d targets x 2 burn stacks: %.1f us per advance"), NumTargets, TotalMicroseconds / NumFrames));
+
+		for (FElementalStatusTargetHandle& TargetHandle : Handles)
+		{
+			StatusEffects->UnregisterTarget(TargetHandle);
+		}
+
+		return true;
+	}
+};
+
+ELEMENTAL_TEST(Combat.Elemental, ElementalStatusEffectSubsystem)
+bool FElementalStatusEffectSubsystemTest::RunTest(const FString& Parameters)
+{
+	FElementalStatusEffectSubsystemTestImpl TestImpl;
+	return TestImpl.RunTest(Parameters);
+}
@@ -121,4 +121,51 @@ bool FElementalRelationshipStructTest::RunTest(const FString& Parameters)
 	TestEqual(TEXT("克制列表有2个元素"), TestRelation.Counters.Num(), 2);
 	
 	return true;
-}
\ No newline at end of file
+}
+
+/**
+ * 效果数据冷热拆分测试
+ */
+ELEMENTAL_TEST(Combat.Elemental, ElementalEffectDataSplit)
+bool FElementalEffectDataSplitTest::RunTest(const FString& Parameters)
+{
+	FElementalEffectData SourceData;
+	SourceData.Element = EElementalType::Water;
+	SourceData.DamageMultiplier = 1.2f;
+	SourceData.LifeStealPercentage = 0.1f;
+	SourceData.SlowPercentage = 0.4f;
+	SourceData.SlowDuration = 2.0f;
+	SourceData.DotDamage = 3.0f;
+	SourceData.DotTickInterval = 0.5f;
+	SourceData.DotDuration = 4.0f;
+	SourceData.DamageReduction = 0.25f;
+	SourceData.ElementColor = FLinearColor::Blue;
+	SourceData.EffectDescription = FText::FromString(TEXT("水"));
+
+	// 数值参数
+	const FElementalEffectParams Params(SourceData);
+	TestTrue(TEXT("数值参数元素"), Params.Element == EElementalType::Water);
+	TestEqual(TEXT("数值参数伤害倍率"), Params.DamageMultiplier, SourceData.DamageMultiplier);
+	TestEqual(TEXT("数值参数吸血"), Params.LifeStealPercentage, SourceData.LifeStealPercentage);
+	TestEqual(TEXT("数值参数减速"), Params.SlowPercentage, SourceData.SlowPercentage);
+	TestEqual(TEXT("数值参数减速时间"), Params.SlowDuration, SourceData.SlowDuration);
+	TestEqual(TEXT("数值参数DOT伤害"), Params.DotDamage, SourceData.DotDamage);
+	TestEqual(TEXT("数值参数DOT间隔"), Params.DotTickInterval, SourceData.DotTickInterval);
+	TestEqual(TEXT("数值参数DOT持续"), Params.DotDuration, SourceData.DotDuration);
+	TestEqual(TEXT("数值参数减伤"), Params.DamageReduction, SourceData.DamageReduction);
+	TestTrue(TEXT("数值参数比完整数据小"), sizeof(FElementalEffectParams) < sizeof(FElementalEffectData));
+
+	// 默认值与完整数据一致
+	const FElementalEffectParams DefaultParams;
+	const FElementalEffectParams ConvertedDefaults{FElementalEffectData()};
+	TestEqual(TEXT("默认DOT间隔一致"), DefaultParams.DotTickInterval, ConvertedDefaults.DotTickInterval);
+	TestEqual(TEXT("默认伤害倍率一致"), DefaultParams.DamageMultiplier, ConvertedDefaults.DamageMultiplier);
+
+	// 表现数据
+	const FElementalPresentationData Presentation(SourceData);
+	TestEqual(TEXT("表现数据颜色"), Presentation.ElementColor, FLinearColor::Blue);
+	TestTrue(TEXT("表现数据描述"), Presentation.EffectDescription.EqualTo(SourceData.EffectDescription));
+	TestNull(TEXT("表现数据投掷物类"), Presentation.ProjectileClass);
+
+	return true;
+}